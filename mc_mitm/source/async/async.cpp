@@ -14,6 +14,7 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 #include "async.hpp"
+#include "../mcmitm_thread_stacks.hpp"
 
 namespace ams::async {
 
@@ -49,6 +50,8 @@ namespace ams::async {
         os::InitializeMessageQueue(&g_work_queue, g_message_buffer, MessageBufferSize);
 
         for (unsigned int i = 0; i < ThreadCount; ++i) {
+            mitm::RegisterThreadStack(&g_thread_pool[i], g_thread_stacks[i], ThreadStackSize);
+
             R_TRY(os::CreateThread(&g_thread_pool[i],
                 WorkerThreadFunc,
                 nullptr,
@@ -14,13 +14,19 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 #include "bluetooth_ble.hpp"
+#include "bluetooth_event_queue.hpp"
 #include "../btdrv_mitm_flags.hpp"
 
 namespace ams::bluetooth::ble {
 
     namespace {
 
-        constinit os::SdkMutex g_event_data_lock;
+        constexpr size_t EventQueueCapacity = 2;
+
+        constinit bluetooth::EventQueue<bluetooth::BleEventType, bluetooth::BleEventInfo, EventQueueCapacity> g_event_queue;
+        constinit ncm::ProgramId g_forward_client = ncm::InvalidProgramId;
+
+        // Only accessed from the event thread
         constinit bluetooth::BleEventInfo g_event_info;
         constinit bluetooth::BleEventType g_current_event_type;
 
@@ -29,7 +35,6 @@ namespace ams::bluetooth::ble {
         os::SystemEvent g_system_event_user_fwd(os::EventClearMode_AutoClear, true);
 
         os::Event g_init_event(os::EventClearMode_ManualClear);
-        os::Event g_data_read_event(os::EventClearMode_AutoClear);
 
     }
 
@@ -37,6 +42,10 @@ namespace ams::bluetooth::ble {
         return g_init_event.TryWait();
     }
 
+    void SetForwardClient(ncm::ProgramId program_id) {
+        g_forward_client = program_id;
+    }
+
     void SignalInitialized() {
         g_init_event.Signal();
     }
@@ -57,26 +66,29 @@ namespace ams::bluetooth::ble {
         return &g_system_event_user_fwd;
     }
 
-    Result GetEventInfo(bluetooth::BleEventType *type, void *buffer, size_t size) {
-        std::scoped_lock lk(g_event_data_lock);
+    Result GetEventInfo(ncm::ProgramId program_id, bluetooth::BleEventType *type, void *buffer, size_t size) {
+        // The forward client consumes queued events in order, everyone else sees the latest event
+        bool pending = false;
+        if (program_id != g_forward_client || !g_event_queue.Pop(type, buffer, size, &pending)) {
+            g_event_queue.GetLatest(type, buffer, size);
+        }
 
-        *type = g_current_event_type;
-        std::memcpy(buffer, &g_event_info, size);
+        // The forward event auto-clears, so signals raised while it was still set collapse into one. Re-signal until the queue drains
+        if (pending) {
+            g_system_event_fwd.Signal();
+        }
 
-        g_data_read_event.Signal();
-        
         R_SUCCEED();
     }
 
     void HandleEvent() {
-        {
-            std::scoped_lock lk(g_event_data_lock);
-            R_ABORT_UNLESS(btdrvGetBleManagedEventInfo(&g_event_info, sizeof(bluetooth::BleEventInfo), &g_current_event_type));
-        }
+        R_ABORT_UNLESS(btdrvGetBleManagedEventInfo(&g_event_info, sizeof(bluetooth::BleEventInfo), &g_current_event_type));
+
+        const bool forward = !g_redirect_ble_events;
+        g_event_queue.Publish(g_current_event_type, &g_event_info, sizeof(bluetooth::BleEventInfo), forward);
 
-        if (!g_redirect_ble_events) {
+        if (forward) {
             g_system_event_fwd.Signal();
-            g_data_read_event.Wait();
         }
 
         if (g_system_event_user_fwd.GetBase()->state) {
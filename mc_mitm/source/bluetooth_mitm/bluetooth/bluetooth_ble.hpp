@@ -21,6 +21,7 @@
 namespace ams::bluetooth::ble {
 
     bool IsInitialized();
+    void SetForwardClient(ncm::ProgramId program_id);
     void SignalInitialized();
     void WaitInitialized();
 
@@ -28,7 +29,7 @@ namespace ams::bluetooth::ble {
     os::SystemEvent *GetForwardEvent();
     os::SystemEvent *GetUserForwardEvent();
 
-    Result GetEventInfo(bluetooth::BleEventType *type, void *buffer, size_t size);
+    Result GetEventInfo(ncm::ProgramId program_id, bluetooth::BleEventType *type, void *buffer, size_t size);
     void HandleEvent();
 
 }
@@ -14,6 +14,7 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 #include "bluetooth_core.hpp"
+#include "bluetooth_event_queue.hpp"
 #include "../btdrv_ext.h"
 #include "../btdrv_mitm_flags.hpp"
 #include "../../controllers/controller_management.hpp"
@@ -22,7 +23,16 @@ namespace ams::bluetooth::core {
 
     namespace {
 
-        constinit os::SdkMutex g_event_info_lock;
+        constexpr size_t EventQueueCapacity = 4;
+
+        constinit bluetooth::EventQueue<bluetooth::EventType, bluetooth::EventInfo, EventQueueCapacity> g_event_queue;
+        constinit ncm::ProgramId g_forward_client = ncm::InvalidProgramId;
+
+        constinit os::SdkMutex g_custom_event_lock;
+        constinit bluetooth::EventInfo g_custom_event_info;
+        constinit bluetooth::EventType g_custom_event_type;
+
+        // Only accessed from the event thread
         constinit bluetooth::EventInfo g_event_info;
         constinit bluetooth::EventType g_current_event_type;
 
@@ -33,7 +43,6 @@ namespace ams::bluetooth::core {
         os::Event g_init_event(os::EventClearMode_ManualClear);
         os::Event g_enable_event(os::EventClearMode_ManualClear);
         os::Event g_custom_data_event(os::EventClearMode_AutoClear);
-        os::Event g_data_read_event(os::EventClearMode_AutoClear);
 
         bluetooth::Address ReverseBluetoothAddress(bluetooth::Address address) {
             u64 tmp;
@@ -48,6 +57,10 @@ namespace ams::bluetooth::core {
         return g_init_event.TryWait();
     }
 
+    void SetForwardClient(ncm::ProgramId program_id) {
+        g_forward_client = program_id;
+    }
+
     void SignalInitialized() {
         g_init_event.Signal();
     }
@@ -81,9 +94,7 @@ namespace ams::bluetooth::core {
     }
 
     void SignalFakeEvent(bluetooth::EventType type, const void *data, size_t size) {
-        g_current_event_type = type;
-        std::memcpy(&g_event_info, data, size);
-
+        g_event_queue.Publish(type, data, size, true);
         g_system_event_fwd.Signal();
     }
 
@@ -132,22 +143,35 @@ namespace ams::bluetooth::core {
     }
 
     Result GetEventInfo(ncm::ProgramId program_id, bluetooth::EventType *type, void *buffer, size_t size) {
-        std::scoped_lock lk(g_event_info_lock);
+        // The forward client consumes queued events in order, everyone else sees the latest event
+        bool pending = false;
+        if (program_id != g_forward_client || !g_event_queue.Pop(type, buffer, size, &pending)) {
+            g_event_queue.GetLatest(type, buffer, size);
+        }
 
-        *type = g_current_event_type;
-        std::memcpy(buffer, &g_event_info, size);
+        // The forward event auto-clears, so signals raised while it was still set collapse into one. Re-signal until the queue drains
+        if (pending) {
+            g_system_event_fwd.Signal();
+        }
 
         if (program_id == ncm::SystemProgramId::Btm) {
             auto event_info = reinterpret_cast<bluetooth::EventInfo *>(buffer);
 
             if (hos::GetVersion() < hos::Version_12_0_0) {
-                ModifyEventInfov1(event_info, g_current_event_type);
+                ModifyEventInfov1(event_info, *type);
             } else {
-                ModifyEventInfov12(event_info, g_current_event_type);
+                ModifyEventInfov12(event_info, *type);
             }
         }
 
-        g_data_read_event.Signal();
+        R_SUCCEED();
+    }
+
+    Result GetCustomEventInfo(bluetooth::EventType *type, void *buffer, size_t size) {
+        std::scoped_lock lk(g_custom_event_lock);
+
+        *type = g_custom_event_type;
+        std::memcpy(buffer, &g_custom_event_info, std::min(size, sizeof(g_custom_event_info)));
 
         R_SUCCEED();
     }
@@ -192,29 +216,37 @@ namespace ams::bluetooth::core {
     }
 
     void HandleEvent() {
-        {
-            std::scoped_lock lk(g_event_info_lock);
-            R_ABORT_UNLESS(btdrvGetEventInfo(&g_event_info, sizeof(bluetooth::EventInfo), &g_current_event_type));
-        }
+        R_ABORT_UNLESS(btdrvGetEventInfo(&g_event_info, sizeof(bluetooth::EventInfo), &g_current_event_type));
 
         // Process custom event and return
         if (g_current_event_type == BtdrvEventType_MissionControlCustomEvent) {
+            {
+                std::scoped_lock lk(g_custom_event_lock);
+                g_custom_event_type = g_current_event_type;
+                std::memcpy(&g_custom_event_info, &g_event_info, sizeof(g_custom_event_info));
+            }
+
             g_custom_data_event.Signal();
-            g_data_read_event.Wait();
             return;
         }
 
+        bool forward = false;
         if (!g_redirect_core_events) {
             if ((hos::GetVersion() < hos::Version_12_0_0) && (g_current_event_type == BtdrvEventTypeOld_PairingPinCodeRequest)) {
                 HandlePinCodeRequestEventV1(&g_event_info);
             } else if ((hos::GetVersion() >= hos::Version_12_0_0) && (g_current_event_type == BtdrvEventType_PairingPinCodeRequest)) {
                 HandlePinCodeRequestEventV12(&g_event_info);
             } else {
-                g_system_event_fwd.Signal();
-                g_data_read_event.Wait();
+                forward = true;
             }
         }
 
+        g_event_queue.Publish(g_current_event_type, &g_event_info, sizeof(bluetooth::EventInfo), forward);
+
+        if (forward) {
+            g_system_event_fwd.Signal();
+        }
+
         if (g_system_event_user_fwd.GetBase()->state) {
             g_system_event_user_fwd.Signal();
         }
@@ -21,6 +21,7 @@
 namespace ams::bluetooth::core {
 
     bool IsInitialized();
+    void SetForwardClient(ncm::ProgramId program_id);
     void SignalInitialized();
     void WaitInitialized();
     void SignalEnabled();
@@ -33,6 +34,7 @@ namespace ams::bluetooth::core {
 
     void SignalFakeEvent(bluetooth::EventType type, const void *data, size_t size);
     Result GetEventInfo(ncm::ProgramId program_id, bluetooth::EventType *type, void *buffer, size_t size);
+    Result GetCustomEventInfo(bluetooth::EventType *type, void *buffer, size_t size);
     void HandleEvent();
 
 }
@@ -0,0 +1,124 @@
+/*
+ * Copyright (c) 2020-2025 ndeadly
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+#include <switch.h>
+#include <stratosphere.hpp>
+
+namespace ams::bluetooth {
+
+    // Bounded FIFO of event records sitting between the bluetooth event thread and the
+    // client that owns the forward event. Publishing never blocks: once the queue is full the
+    // newest event waits in an overflow slot until a Pop makes room, replacing any event already
+    // waiting there. Replaced events are counted rather than silently lost.
+    template<typename EventType, typename EventInfo, size_t Capacity>
+    class EventQueue {
+        static_assert(Capacity > 0);
+
+        private:
+            struct EventRecord {
+                EventType type{};
+                EventInfo info{};
+            };
+
+        public:
+            constexpr EventQueue() : m_mutex(), m_records(), m_latest(), m_overflow(), m_head(0), m_count(0), m_overflow_pending(false), m_dropped_count(0) { }
+
+            // Record an event. The latest event is always updated for secondary readers, and the event
+            // is appended to the queue for the forward client when enqueue is set
+            void Publish(EventType type, const void *data, size_t size, bool enqueue) {
+                std::scoped_lock lk(m_mutex);
+
+                CopyIn(&m_latest, type, data, size);
+
+                if (enqueue) {
+                    if (m_count < Capacity) {
+                        CopyIn(&m_records[(m_head + m_count) % Capacity], type, data, size);
+                        ++m_count;
+                    } else {
+                        if (m_overflow_pending) {
+                            ++m_dropped_count;
+                        }
+
+                        CopyIn(&m_overflow, type, data, size);
+                        m_overflow_pending = true;
+                    }
+                }
+            }
+
+            // Remove the oldest queued event. Returns false if the queue is empty. out_pending is set if
+            // further events remain queued after this one
+            bool Pop(EventType *type, void *buffer, size_t size, bool *out_pending) {
+                std::scoped_lock lk(m_mutex);
+
+                *out_pending = false;
+                if (m_count == 0) {
+                    return false;
+                }
+
+                CopyOut(&m_records[m_head], type, buffer, size);
+                m_head = (m_head + 1) % Capacity;
+                --m_count;
+
+                // The freed record takes the overflowed event, keeping it behind everything queued before it
+                if (m_overflow_pending) {
+                    m_records[(m_head + m_count) % Capacity] = m_overflow;
+                    ++m_count;
+                    m_overflow_pending = false;
+                }
+
+                *out_pending = m_count > 0;
+
+                return true;
+            }
+
+            // Number of events replaced in the overflow slot before the forward client could read them
+            size_t GetDroppedCount() {
+                std::scoped_lock lk(m_mutex);
+                return m_dropped_count;
+            }
+
+            // Copy the most recently published event without consuming anything
+            void GetLatest(EventType *type, void *buffer, size_t size) {
+                std::scoped_lock lk(m_mutex);
+                CopyOut(&m_latest, type, buffer, size);
+            }
+
+        private:
+            static void CopyIn(EventRecord *record, EventType type, const void *data, size_t size) {
+                size = std::min(size, sizeof(EventInfo));
+
+                record->type = type;
+                std::memcpy(&record->info, data, size);
+                std::memset(reinterpret_cast<u8 *>(&record->info) + size, 0, sizeof(EventInfo) - size);
+            }
+
+            static void CopyOut(const EventRecord *record, EventType *type, void *buffer, size_t size) {
+                *type = record->type;
+                std::memcpy(buffer, &record->info, std::min(size, sizeof(EventInfo)));
+            }
+
+        private:
+            os::SdkMutex m_mutex;
+            EventRecord m_records[Capacity];
+            EventRecord m_latest;
+            EventRecord m_overflow;
+            size_t m_head;
+            size_t m_count;
+            bool m_overflow_pending;
+            size_t m_dropped_count;
+    };
+
+}
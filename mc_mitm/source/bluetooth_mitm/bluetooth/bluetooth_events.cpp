@@ -18,6 +18,7 @@
 #include "bluetooth_core.hpp"
 #include "bluetooth_hid.hpp"
 #include "bluetooth_ble.hpp"
+#include "../../mcmitm_thread_stacks.hpp"
 
 namespace ams::bluetooth::events {
 
@@ -77,6 +78,8 @@ namespace ams::bluetooth::events {
     }
 
     Result Initialize() {
+        mitm::RegisterThreadStack(&g_thread, g_thread_stack, ThreadStackSize);
+
         R_TRY(os::CreateThread(&g_thread,
             EventHandlerThreadFunc,
             nullptr,
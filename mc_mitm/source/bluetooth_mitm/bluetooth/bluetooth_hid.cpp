@@ -14,6 +14,7 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 #include "bluetooth_hid.hpp"
+#include "bluetooth_event_queue.hpp"
 #include "../btdrv_mitm_flags.hpp"
 #include "../../controllers/controller_management.hpp"
 
@@ -21,7 +22,12 @@ namespace ams::bluetooth::hid {
 
     namespace {
 
-        constinit os::SdkMutex g_event_info_lock;
+        constexpr size_t EventQueueCapacity = 4;
+
+        constinit bluetooth::EventQueue<bluetooth::HidEventType, bluetooth::HidEventInfo, EventQueueCapacity> g_event_queue;
+        constinit ncm::ProgramId g_forward_client = ncm::InvalidProgramId;
+
+        // Only accessed from the event thread
         constinit bluetooth::HidEventInfo g_event_info;
         constinit bluetooth::HidEventType g_current_event_type;
 
@@ -30,7 +36,6 @@ namespace ams::bluetooth::hid {
         os::SystemEvent g_system_event_user_fwd(os::EventClearMode_AutoClear, true);
 
         os::Event g_init_event(os::EventClearMode_ManualClear);
-        os::Event g_data_read_event(os::EventClearMode_AutoClear);
 
     }
 
@@ -38,6 +43,10 @@ namespace ams::bluetooth::hid {
         return g_init_event.TryWait();
     }
 
+    void SetForwardClient(ncm::ProgramId program_id) {
+        g_forward_client = program_id;
+    }
+
     void SignalInitialized() {
         g_init_event.Signal();
     }
@@ -59,19 +68,21 @@ namespace ams::bluetooth::hid {
     }
 
     void SignalFakeEvent(bluetooth::HidEventType type, const void *data, size_t size) {
-        g_current_event_type = type;
-        std::memcpy(&g_event_info, data, size);
-
+        g_event_queue.Publish(type, data, size, true);
         g_system_event_fwd.Signal();
     }
 
-    Result GetEventInfo(bluetooth::HidEventType *type, void *buffer, size_t size) {
-        std::scoped_lock lk(g_event_info_lock);
-
-        *type = g_current_event_type;
-        std::memcpy(buffer, &g_event_info, size);
+    Result GetEventInfo(ncm::ProgramId program_id, bluetooth::HidEventType *type, void *buffer, size_t size) {
+        // The forward client consumes queued events in order, everyone else sees the latest event
+        bool pending = false;
+        if (program_id != g_forward_client || !g_event_queue.Pop(type, buffer, size, &pending)) {
+            g_event_queue.GetLatest(type, buffer, size);
+        }
 
-        g_data_read_event.Signal();
+        // The forward event auto-clears, so signals raised while it was still set collapse into one. Re-signal until the queue drains
+        if (pending) {
+            g_system_event_fwd.Signal();
+        }
 
         R_SUCCEED();
     }
@@ -103,10 +114,7 @@ namespace ams::bluetooth::hid {
     }
 
     void HandleEvent() {
-        {
-            std::scoped_lock lk(g_event_info_lock);
-            R_ABORT_UNLESS(btdrvGetHidEventInfo(&g_event_info, sizeof(bluetooth::HidEventInfo), &g_current_event_type));
-        }
+        R_ABORT_UNLESS(btdrvGetHidEventInfo(&g_event_info, sizeof(bluetooth::HidEventInfo), &g_current_event_type));
 
         switch (g_current_event_type) {
             case BtdrvHidEventType_Connection:
@@ -116,8 +124,8 @@ namespace ams::bluetooth::hid {
                 break;
         }
 
+        g_event_queue.Publish(g_current_event_type, &g_event_info, sizeof(bluetooth::HidEventInfo), true);
         g_system_event_fwd.Signal();
-        g_data_read_event.Wait();
 
         if (g_system_event_user_fwd.GetBase()->state) {
             g_system_event_user_fwd.Signal();
@@ -21,6 +21,7 @@
 namespace ams::bluetooth::hid {
 
     bool IsInitialized();
+    void SetForwardClient(ncm::ProgramId program_id);
     void SignalInitialized();
     void WaitInitialized();
 
@@ -29,7 +30,7 @@ namespace ams::bluetooth::hid {
     os::SystemEvent *GetUserForwardEvent();
 
     void SignalFakeEvent(bluetooth::HidEventType type, const void *data, size_t size);
-    Result GetEventInfo(bluetooth::HidEventType *type, void *buffer, size_t size);
+    Result GetEventInfo(ncm::ProgramId program_id, bluetooth::HidEventType *type, void *buffer, size_t size);
     void HandleEvent();
 
 }
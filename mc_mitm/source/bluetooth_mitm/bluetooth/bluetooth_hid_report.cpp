@@ -18,6 +18,7 @@
 #include "../btdrv_shim.h"
 #include "../btdrv_mitm_flags.hpp"
 #include "../../controllers/controller_management.hpp"
+#include "../../mcmitm_thread_stacks.hpp"
 
 namespace ams::bluetooth::hid::report {
 
@@ -109,6 +110,8 @@ namespace ams::bluetooth::hid::report {
     }
 
     Result Initialize() {
+        mitm::RegisterThreadStack(&g_thread, g_thread_stack, ThreadStackSize);
+
         R_TRY(os::CreateThread(&g_thread,
             EventThreadFunc,
             nullptr,
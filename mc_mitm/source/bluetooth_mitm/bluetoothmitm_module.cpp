@@ -15,6 +15,7 @@
  */
 #include "bluetoothmitm_module.hpp"
 #include "btdrv_mitm_service.hpp"
+#include "../mcmitm_thread_stacks.hpp"
 #include <stratosphere.hpp>
 
 namespace ams::mitm::bluetooth {
@@ -71,6 +72,8 @@ namespace ams::mitm::bluetooth {
     }
 
     void Launch() {
+        mitm::RegisterThreadStack(&g_thread, g_thread_stack, ThreadStackSize);
+
         R_ABORT_UNLESS(os::CreateThread(&g_thread,
             BtdrvMitmThreadFunction,
             nullptr,
@@ -40,6 +40,9 @@ namespace ams::mitm::bluetooth {
             // Initialise the hid report circular buffer
             R_TRY(ams::bluetooth::hid::report::InitializeReportBuffer());
 
+            // Queued events are delivered in order to the client that owns the forward event
+            ams::bluetooth::core::SetForwardClient(m_client_info.program_id);
+
             // Signal that the interface is initialised
             ams::bluetooth::core::SignalInitialized();
         } else {
@@ -75,6 +78,8 @@ namespace ams::mitm::bluetooth {
             // Return our forwarder event handle to the caller instead
             out_handle.SetValue(ams::bluetooth::hid::GetForwardEvent()->GetReadableHandle(), false);
 
+            ams::bluetooth::hid::SetForwardClient(m_client_info.program_id);
+
             // Signal that the interface is initialised
             ams::bluetooth::hid::SignalInitialized();
         } else {
@@ -113,7 +118,7 @@ namespace ams::mitm::bluetooth {
     }
 
     Result BtdrvMitmService::GetHidEventInfo(sf::Out<ams::bluetooth::HidEventType> out_type, const sf::OutPointerBuffer &out_buffer) {
-        R_RETURN(ams::bluetooth::hid::GetEventInfo(out_type.GetPointer(), out_buffer.GetPointer(), out_buffer.GetSize()));
+        R_RETURN(ams::bluetooth::hid::GetEventInfo(m_client_info.program_id, out_type.GetPointer(), out_buffer.GetPointer(), out_buffer.GetSize()));
     }
 
     Result BtdrvMitmService::RegisterHidReportEvent(sf::OutCopyHandle out_handle) {
@@ -158,6 +163,8 @@ namespace ams::mitm::bluetooth {
             // Return our forwarder event handle to the caller instead
             out_handle.SetValue(ams::bluetooth::ble::GetForwardEvent()->GetReadableHandle(), false);
 
+            ams::bluetooth::ble::SetForwardClient(m_client_info.program_id);
+
             // Signal that the interface is initialised
             ams::bluetooth::ble::SignalInitialized();
         }  else {
@@ -168,7 +175,7 @@ namespace ams::mitm::bluetooth {
     }
 
     Result BtdrvMitmService::GetBleManagedEventInfo(sf::Out<ams::bluetooth::BleEventType> out_type, const sf::OutPointerBuffer &out_buffer) {
-        R_RETURN(ams::bluetooth::ble::GetEventInfo(out_type.GetPointer(), out_buffer.GetPointer(), out_buffer.GetSize()));
+        R_RETURN(ams::bluetooth::ble::GetEventInfo(m_client_info.program_id, out_type.GetPointer(), out_buffer.GetPointer(), out_buffer.GetSize()));
     }
 
     /* Deprecated */
@@ -15,6 +15,7 @@
  */
 #include "btmmitm_module.hpp"
 #include "btm_mitm_service.hpp"
+#include "../mcmitm_thread_stacks.hpp"
 #include <stratosphere.hpp>
 
 namespace ams::mitm::btm {
@@ -71,6 +72,8 @@ namespace ams::mitm::btm {
     }
 
     void Launch() {
+        mitm::RegisterThreadStack(&g_thread, g_thread_stack, ThreadStackSize);
+
         R_ABORT_UNLESS(os::CreateThread(&g_thread,
             BtmMitmThreadFunction,
             nullptr,
@@ -64,18 +64,7 @@ namespace ams::controller {
             m_left_stick  = PackAnalogStickValues(src->input0x01_v2.left_stick.x,  InvertAnalogStickValue(src->input0x01_v2.left_stick.y));
             m_right_stick = PackAnalogStickValues(src->input0x01_v2.right_stick.x, InvertAnalogStickValue(src->input0x01_v2.right_stick.y));
 
-            m_buttons.dpad_down  = (src->input0x01_v2.dpad == EightBitDoDPadV2_S)  ||
-                                   (src->input0x01_v2.dpad == EightBitDoDPadV2_SE) ||
-                                   (src->input0x01_v2.dpad == EightBitDoDPadV2_SW);
-            m_buttons.dpad_up    = (src->input0x01_v2.dpad == EightBitDoDPadV2_N)  ||
-                                   (src->input0x01_v2.dpad == EightBitDoDPadV2_NE) ||
-                                   (src->input0x01_v2.dpad == EightBitDoDPadV2_NW);
-            m_buttons.dpad_right = (src->input0x01_v2.dpad == EightBitDoDPadV2_E)  ||
-                                   (src->input0x01_v2.dpad == EightBitDoDPadV2_NE) ||
-                                   (src->input0x01_v2.dpad == EightBitDoDPadV2_SE);
-            m_buttons.dpad_left  = (src->input0x01_v2.dpad == EightBitDoDPadV2_W)  ||
-                                   (src->input0x01_v2.dpad == EightBitDoDPadV2_NW) ||
-                                   (src->input0x01_v2.dpad == EightBitDoDPadV2_SW);
+            MapHatSwitch<EightBitDoDPadV2_N>(&m_buttons, src->input0x01_v2.dpad);
 
             m_buttons.A = src->input0x01_v2.buttons.B;
             m_buttons.B = src->input0x01_v2.buttons.A;
@@ -85,8 +74,8 @@ namespace ams::controller {
             m_buttons.L = src->input0x01_v2.buttons.L1;
             m_buttons.R = src->input0x01_v2.buttons.R1;
 
-            m_buttons.ZL = src->input0x01_v2.left_trigger  > (m_trigger_threshold * TriggerMax);
-            m_buttons.ZR = src->input0x01_v2.right_trigger > (m_trigger_threshold * TriggerMax);
+            m_buttons.ZL = src->input0x01_v2.left_trigger  > this->GetTriggerThreshold<TriggerMax>();
+            m_buttons.ZR = src->input0x01_v2.right_trigger > this->GetTriggerThreshold<TriggerMax>();
 
             if (m_controller_type == EightBitDoControllerType_Sn30ProXboxCloud) {
                 m_buttons.minus = src->input0x01_v2.buttons.v1.select;
@@ -148,18 +137,7 @@ namespace ams::controller {
             m_left_stick  = PackAnalogStickValues(src->input0x03_v3.left_stick.x,  InvertAnalogStickValue(src->input0x03_v3.left_stick.y));
             m_right_stick = PackAnalogStickValues(src->input0x03_v3.right_stick.x, InvertAnalogStickValue(src->input0x03_v3.right_stick.y));
 
-            m_buttons.dpad_down  = (src->input0x03_v3.dpad == EightBitDoDPadV2_S)  ||
-                                   (src->input0x03_v3.dpad == EightBitDoDPadV2_SE) ||
-                                   (src->input0x03_v3.dpad == EightBitDoDPadV2_SW);
-            m_buttons.dpad_up    = (src->input0x03_v3.dpad == EightBitDoDPadV2_N)  ||
-                                   (src->input0x03_v3.dpad == EightBitDoDPadV2_NE) ||
-                                   (src->input0x03_v3.dpad == EightBitDoDPadV2_NW);
-            m_buttons.dpad_right = (src->input0x03_v3.dpad == EightBitDoDPadV2_E)  ||
-                                   (src->input0x03_v3.dpad == EightBitDoDPadV2_NE) ||
-                                   (src->input0x03_v3.dpad == EightBitDoDPadV2_SE);
-            m_buttons.dpad_left  = (src->input0x03_v3.dpad == EightBitDoDPadV2_W)  ||
-                                   (src->input0x03_v3.dpad == EightBitDoDPadV2_NW) ||
-                                   (src->input0x03_v3.dpad == EightBitDoDPadV2_SW);
+            MapHatSwitch<EightBitDoDPadV2_N>(&m_buttons, src->input0x03_v3.dpad);
 
             m_buttons.A = src->input0x03_v3.buttons.B;
             m_buttons.B = src->input0x03_v3.buttons.A;
@@ -169,8 +147,8 @@ namespace ams::controller {
             m_buttons.L = src->input0x03_v3.buttons.L1;
             m_buttons.R = src->input0x03_v3.buttons.R1;
 
-            m_buttons.ZL = src->input0x03_v3.left_trigger  > (m_trigger_threshold * TriggerMax);
-            m_buttons.ZR = src->input0x03_v3.right_trigger > (m_trigger_threshold * TriggerMax);
+            m_buttons.ZL = src->input0x03_v3.left_trigger  > this->GetTriggerThreshold<TriggerMax>();
+            m_buttons.ZR = src->input0x03_v3.right_trigger > this->GetTriggerThreshold<TriggerMax>();
 
             m_buttons.minus = src->input0x03_v3.buttons.v2.select;
             m_buttons.plus  = src->input0x03_v3.buttons.v2.start;
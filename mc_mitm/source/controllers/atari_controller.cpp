@@ -41,18 +41,7 @@ namespace ams::controller {
         m_left_stick  = PackAnalogStickValues(src->input0x01.left_stick.x,  InvertAnalogStickValue(src->input0x01.left_stick.y));
         m_right_stick = PackAnalogStickValues(src->input0x01.right_stick.x, InvertAnalogStickValue(src->input0x01.right_stick.y));
         
-        m_buttons.dpad_down  = (src->input0x01.buttons.dpad == AtariDPad_S)  ||
-                               (src->input0x01.buttons.dpad == AtariDPad_SE) ||
-                               (src->input0x01.buttons.dpad == AtariDPad_SW);
-        m_buttons.dpad_up    = (src->input0x01.buttons.dpad == AtariDPad_N)  ||
-                               (src->input0x01.buttons.dpad == AtariDPad_NE) ||
-                               (src->input0x01.buttons.dpad == AtariDPad_NW);
-        m_buttons.dpad_right = (src->input0x01.buttons.dpad == AtariDPad_E)  ||
-                               (src->input0x01.buttons.dpad == AtariDPad_NE) ||
-                               (src->input0x01.buttons.dpad == AtariDPad_SE);
-        m_buttons.dpad_left  = (src->input0x01.buttons.dpad == AtariDPad_W)  ||
-                               (src->input0x01.buttons.dpad == AtariDPad_NW) ||
-                               (src->input0x01.buttons.dpad == AtariDPad_SW);
+        MapHatSwitch<AtariDPad_N>(&m_buttons, src->input0x01.buttons.dpad);
 
         m_buttons.A = src->input0x01.buttons.B;
         m_buttons.B = src->input0x01.buttons.A;
@@ -61,8 +50,8 @@ namespace ams::controller {
 
         m_buttons.R  = src->input0x01.buttons.RB;
         m_buttons.L  = src->input0x01.buttons.LB;
-        m_buttons.ZR = src->input0x01.right_trigger > (m_trigger_threshold * TriggerMax);
-        m_buttons.ZL = src->input0x01.left_trigger  > (m_trigger_threshold * TriggerMax);
+        m_buttons.ZR = src->input0x01.right_trigger > this->GetTriggerThreshold<TriggerMax>();
+        m_buttons.ZL = src->input0x01.left_trigger  > this->GetTriggerThreshold<TriggerMax>();
 
         m_buttons.lstick_press = src->input0x01.buttons.L3;
         m_buttons.rstick_press = src->input0x01.buttons.R3;
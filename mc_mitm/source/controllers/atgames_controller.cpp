@@ -18,12 +18,6 @@
 
 namespace ams::controller {
 
-    namespace {
-
-        constexpr float StickScaleFactor = float(UINT12_MAX) / UINT8_MAX;
-
-    }
-
     void AtGamesController::ProcessInputData(const bluetooth::HidReport *report) {
         auto atgames_report = reinterpret_cast<const AtGamesReportData *>(&report->data);
 
@@ -47,21 +41,10 @@ namespace ams::controller {
             );
             m_right_stick.SetData(
                 SwitchAnalogStick::Center,
-                static_cast<u16>(StickScaleFactor * (UINT8_MAX - src->input0x01.right_stick.x)) & UINT12_MAX
+                static_cast<u16>(ScaleAnalogStickValue<UINT8_MAX>(UINT8_MAX - src->input0x01.right_stick.x)) & UINT12_MAX
             );
             
-            m_buttons.dpad_down  = (src->input0x01.dpad == AtGamesDPad_S)  ||
-                                   (src->input0x01.dpad == AtGamesDPad_SE) ||
-                                   (src->input0x01.dpad == AtGamesDPad_SW);
-            m_buttons.dpad_up    = (src->input0x01.dpad == AtGamesDPad_N)  ||
-                                   (src->input0x01.dpad == AtGamesDPad_NE) ||
-                                   (src->input0x01.dpad == AtGamesDPad_NW);
-            m_buttons.dpad_right = (src->input0x01.dpad == AtGamesDPad_E)  ||
-                                   (src->input0x01.dpad == AtGamesDPad_NE) ||
-                                   (src->input0x01.dpad == AtGamesDPad_SE);
-            m_buttons.dpad_left  = (src->input0x01.dpad == AtGamesDPad_W)  ||
-                                   (src->input0x01.dpad == AtGamesDPad_NW) ||
-                                   (src->input0x01.dpad == AtGamesDPad_SW);
+            MapHatSwitch<AtGamesDPad_N>(&m_buttons, src->input0x01.dpad);
 
             m_buttons.A = src->input0x01.play;
             m_buttons.B = src->input0x01.rewind;
@@ -80,21 +63,10 @@ namespace ams::controller {
             );
             m_right_stick.SetData(
                 SwitchAnalogStick::Center,
-                static_cast<u16>(StickScaleFactor * (UINT8_MAX - src->input0x01.right_stick.x)) & UINT12_MAX
+                static_cast<u16>(ScaleAnalogStickValue<UINT8_MAX>(UINT8_MAX - src->input0x01.right_stick.x)) & UINT12_MAX
             );
             
-            m_buttons.dpad_down  = (src->input0x01.dpad == AtGamesDPad_S)  ||
-                                   (src->input0x01.dpad == AtGamesDPad_SE) ||
-                                   (src->input0x01.dpad == AtGamesDPad_SW);
-            m_buttons.dpad_up    = (src->input0x01.dpad == AtGamesDPad_N)  ||
-                                   (src->input0x01.dpad == AtGamesDPad_NE) ||
-                                   (src->input0x01.dpad == AtGamesDPad_NW);
-            m_buttons.dpad_right = (src->input0x01.dpad == AtGamesDPad_E)  ||
-                                   (src->input0x01.dpad == AtGamesDPad_NE) ||
-                                   (src->input0x01.dpad == AtGamesDPad_SE);
-            m_buttons.dpad_left  = (src->input0x01.dpad == AtGamesDPad_W)  ||
-                                   (src->input0x01.dpad == AtGamesDPad_NW) ||
-                                   (src->input0x01.dpad == AtGamesDPad_SW);
+            MapHatSwitch<AtGamesDPad_N>(&m_buttons, src->input0x01.dpad);
 
             m_buttons.A = src->input0x01.a_button;
             m_buttons.B = src->input0x01.b_button;
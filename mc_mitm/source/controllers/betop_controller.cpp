@@ -18,6 +18,39 @@
 
 namespace ams::controller {
 
+    namespace {
+
+        constexpr size_t ButtonsOffset = offsetof(BetopInputReport0x03, buttons);
+
+        constexpr ReportField InputReport0x03Layout[] = {
+            AxisField(ReportFieldTarget_LeftStickX,  offsetof(BetopInputReport0x03, left_stick.x),  8),
+            AxisField(ReportFieldTarget_LeftStickY,  offsetof(BetopInputReport0x03, left_stick.y),  8, ReportFieldFlag_Inverted),
+            AxisField(ReportFieldTarget_RightStickX, offsetof(BetopInputReport0x03, right_stick.x), 8),
+            AxisField(ReportFieldTarget_RightStickY, offsetof(BetopInputReport0x03, right_stick.y), 8, ReportFieldFlag_Inverted),
+
+            HatSwitchField(offsetof(BetopInputReport0x03, buttons.dpad), 0, 8, BetopDPad_N),
+
+            ButtonField(ButtonsOffset + 1, 1, SwitchButton_A),
+            ButtonField(ButtonsOffset + 1, 0, SwitchButton_B),
+            ButtonField(ButtonsOffset + 1, 4, SwitchButton_X),
+            ButtonField(ButtonsOffset + 1, 3, SwitchButton_Y),
+
+            ButtonField(ButtonsOffset + 1, 7, SwitchButton_R),
+            ButtonField(ButtonsOffset + 2, 1, SwitchButton_ZR),
+            ButtonField(ButtonsOffset + 1, 6, SwitchButton_L),
+            ButtonField(ButtonsOffset + 2, 0, SwitchButton_ZL),
+
+            ButtonField(ButtonsOffset + 2, 5, SwitchButton_LStick),
+            ButtonField(ButtonsOffset + 2, 6, SwitchButton_RStick),
+
+            ButtonField(ButtonsOffset + 2, 2, SwitchButton_Minus),
+            ButtonField(ButtonsOffset + 2, 3, SwitchButton_Plus),
+
+            ButtonField(ButtonsOffset + 2, 4, SwitchButton_Home),
+        };
+
+    }
+
     void BetopController::ProcessInputData(const bluetooth::HidReport *report) {
         auto betop_report = reinterpret_cast<const BetopReportData *>(&report->data);
 
@@ -30,39 +63,7 @@ namespace ams::controller {
     }
 
     void BetopController::MapInputReport0x03(const BetopReportData *src) {
-        m_left_stick  = PackAnalogStickValues(src->input0x03.left_stick.x,  InvertAnalogStickValue(src->input0x03.left_stick.y));
-        m_right_stick = PackAnalogStickValues(src->input0x03.right_stick.x, InvertAnalogStickValue(src->input0x03.right_stick.y));
-
-        m_buttons.dpad_down  = (src->input0x03.buttons.dpad == BetopDPad_S)  ||
-                               (src->input0x03.buttons.dpad == BetopDPad_SE) ||
-                               (src->input0x03.buttons.dpad == BetopDPad_SW);
-        m_buttons.dpad_up    = (src->input0x03.buttons.dpad == BetopDPad_N)  ||
-                               (src->input0x03.buttons.dpad == BetopDPad_NE) ||
-                               (src->input0x03.buttons.dpad == BetopDPad_NW);
-        m_buttons.dpad_right = (src->input0x03.buttons.dpad == BetopDPad_E)  ||
-                               (src->input0x03.buttons.dpad == BetopDPad_NE) ||
-                               (src->input0x03.buttons.dpad == BetopDPad_SE);
-        m_buttons.dpad_left  = (src->input0x03.buttons.dpad == BetopDPad_W)  ||
-                               (src->input0x03.buttons.dpad == BetopDPad_NW) ||
-                               (src->input0x03.buttons.dpad == BetopDPad_SW);
-
-        m_buttons.A = src->input0x03.buttons.B;
-        m_buttons.B = src->input0x03.buttons.A;
-        m_buttons.X = src->input0x03.buttons.Y;
-        m_buttons.Y = src->input0x03.buttons.X;
-
-        m_buttons.R  = src->input0x03.buttons.R1;
-        m_buttons.ZR = src->input0x03.buttons.R2;
-        m_buttons.L  = src->input0x03.buttons.L1;
-        m_buttons.ZL = src->input0x03.buttons.L2;
-
-        m_buttons.lstick_press = src->input0x03.buttons.L3;
-        m_buttons.rstick_press = src->input0x03.buttons.R3;
-
-        m_buttons.minus = src->input0x03.buttons.select;
-        m_buttons.plus  = src->input0x03.buttons.start;
-
-        m_buttons.home = src->input0x03.buttons.home;
+        this->MapReportLayout<InputReport0x03Layout>(reinterpret_cast<const u8 *>(&src->input0x03));
     }
 
 }
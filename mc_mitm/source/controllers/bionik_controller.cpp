@@ -41,18 +41,7 @@ namespace ams::controller {
         m_left_stick  = PackAnalogStickValues(src->input0x03.left_stick.x,  InvertAnalogStickValue(src->input0x03.left_stick.y));
         m_right_stick = PackAnalogStickValues(src->input0x03.right_stick.x, InvertAnalogStickValue(src->input0x03.right_stick.y));
 
-        m_buttons.dpad_down  = (src->input0x03.buttons.dpad == BionikDPad_S)  ||
-                               (src->input0x03.buttons.dpad == BionikDPad_SE) ||
-                               (src->input0x03.buttons.dpad == BionikDPad_SW);
-        m_buttons.dpad_up    = (src->input0x03.buttons.dpad == BionikDPad_N)  ||
-                               (src->input0x03.buttons.dpad == BionikDPad_NE) ||
-                               (src->input0x03.buttons.dpad == BionikDPad_NW);
-        m_buttons.dpad_right = (src->input0x03.buttons.dpad == BionikDPad_E)  ||
-                               (src->input0x03.buttons.dpad == BionikDPad_NE) ||
-                               (src->input0x03.buttons.dpad == BionikDPad_SE);
-        m_buttons.dpad_left  = (src->input0x03.buttons.dpad == BionikDPad_W)  ||
-                               (src->input0x03.buttons.dpad == BionikDPad_NW) ||
-                               (src->input0x03.buttons.dpad == BionikDPad_SW);
+        MapHatSwitch<BionikDPad_N>(&m_buttons, src->input0x03.buttons.dpad);
 
         m_buttons.A = src->input0x03.buttons.B;
         m_buttons.B = src->input0x03.buttons.A;
@@ -61,8 +50,8 @@ namespace ams::controller {
 
         m_buttons.R  = src->input0x03.buttons.R1;
         m_buttons.L  = src->input0x03.buttons.L1;
-        m_buttons.ZR = src->input0x03.right_trigger > (m_trigger_threshold * TriggerMax);
-        m_buttons.ZL = src->input0x03.left_trigger  > (m_trigger_threshold * TriggerMax);
+        m_buttons.ZR = src->input0x03.right_trigger > this->GetTriggerThreshold<TriggerMax>();
+        m_buttons.ZL = src->input0x03.left_trigger  > this->GetTriggerThreshold<TriggerMax>();
 
         m_buttons.lstick_press = src->input0x03.buttons.L3;
         m_buttons.rstick_press = src->input0x03.buttons.R3;
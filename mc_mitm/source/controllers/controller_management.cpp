@@ -21,7 +21,7 @@ namespace ams::controller {
 
     namespace {
 
-        const std::string OfficialGamepadNames[] = {
+        constexpr const char *OfficialGamepadNames[] = {
             "NintendoGamepad",
             "Joy-Con (L)",
             "Joy-Con (R)",
@@ -36,6 +36,25 @@ namespace ams::controller {
             "Lic3 Pro Controller",
         };
 
+        static_assert(util::size(OfficialGamepadNames) <= BITSIZEOF(u16));
+
+        // Bitmask of official names starting with each possible first byte, so a lookup only compares against a few candidates
+        constexpr auto OfficialGamepadNameCandidates = [] {
+            std::array<u16, 0x100> candidates = {};
+            for (size_t i = 0; i < util::size(OfficialGamepadNames); ++i) {
+                candidates[static_cast<u8>(OfficialGamepadNames[i][0])] |= (1 << i);
+            }
+            return candidates;
+        }();
+
+        constexpr auto OfficialGamepadNameLengths = [] {
+            std::array<u8, util::size(OfficialGamepadNames)> lengths = {};
+            for (size_t i = 0; i < util::size(OfficialGamepadNames); ++i) {
+                lengths[i] = std::char_traits<char>::length(OfficialGamepadNames[i]);
+            }
+            return lengths;
+        }();
+
         constexpr u8 DeviceClassMajorPeripheral = 0x05;
         constexpr u8 DeviceClassMinorGamepad    = 0x08;
         constexpr u8 DeviceClassMinorJoystick   = 0x04;
@@ -216,10 +235,12 @@ namespace ams::controller {
                (((cod->class_of_device[2] & 0x0f) == DeviceClassMinorGamepad) || ((cod->class_of_device[2] & 0x0f) == DeviceClassMinorJoystick) || ((cod->class_of_device[2] & 0x40) == DeviceClassMinorKeyboard));
     }
 
-    bool IsOfficialSwitchControllerName(const std::string& name) {
-        for (auto n : OfficialGamepadNames) {
-            if (name.rfind(n, 0) == 0)
+    bool IsOfficialSwitchControllerName(const char *name) {
+        for (u16 candidates = OfficialGamepadNameCandidates[static_cast<u8>(name[0])]; candidates != 0; candidates &= (candidates - 1)) {
+            const auto i = util::CountTrailingZeros(candidates);
+            if (std::strncmp(name, OfficialGamepadNames[i], OfficialGamepadNameLengths[i]) == 0) {
                 return true;
+            }
         }
 
         return false;
@@ -351,4 +372,39 @@ namespace ams::controller {
         return nullptr;
     }
 
+    void FlushControllerVirtualMemory() {
+        for (size_t i = 0;; ++i) {
+            std::shared_ptr<SwitchController> controller;
+            {
+                std::scoped_lock lk(g_controller_lock);
+                if (i >= g_controllers.size()) {
+                    break;
+                }
+                controller = g_controllers[i];
+            }
+
+            // Write back outside of the lock so SD access doesn't stall report handling
+            controller->FlushVirtualMemory();
+        }
+    }
+
+    s64 ProcessScheduledOutput(s64 now) {
+        s64 next_due = RumbleScheduleIdle;
+        for (size_t i = 0;; ++i) {
+            std::shared_ptr<SwitchController> controller;
+            {
+                std::scoped_lock lk(g_controller_lock);
+                if (i >= g_controllers.size()) {
+                    break;
+                }
+                controller = g_controllers[i];
+            }
+
+            // Output reports are written outside of the lock for the same reason as above
+            next_due = std::min(next_due, controller->ProcessScheduledOutput(now));
+        }
+
+        return next_due;
+    }
+
 }
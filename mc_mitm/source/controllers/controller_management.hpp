@@ -88,10 +88,13 @@ namespace ams::controller {
 
     ControllerType Identify(const bluetooth::DevicesSettings *device);
     bool IsAllowedDeviceClass(const bluetooth::DeviceClass *cod);
-    bool IsOfficialSwitchControllerName(const std::string& name);
+    bool IsOfficialSwitchControllerName(const char *name);
 
     void AttachHandler(const bluetooth::Address *address);
     void RemoveHandler(const bluetooth::Address *address);
     std::shared_ptr<SwitchController> LocateHandler(const bluetooth::Address *address);
 
+    void FlushControllerVirtualMemory();
+    s64 ProcessScheduledOutput(s64 now);
+
 }
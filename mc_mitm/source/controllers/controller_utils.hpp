@@ -15,6 +15,7 @@
  */
 #pragma once
 #include <switch.h>
+#include <bit>
 
 namespace ams::controller {
 
@@ -26,4 +27,41 @@ namespace ams::controller {
         return level ? ((level / 64) + 1) << 1 : 0;
     }
 
+    // Trigger values above which ZL/ZR are considered pressed, precomputed from the activation percentage for each trigger range of up to 16 bits
+    class TriggerThresholds {
+        public:
+            constexpr TriggerThresholds() : m_thresholds() { }
+
+            void SetActivationThreshold(int percentage) {
+                for (size_t width = 0; width < sizeof(m_thresholds) / sizeof(m_thresholds[0]); ++width) {
+                    m_thresholds[width] = ((1 << width) - 1) * percentage / 100;
+                }
+            }
+
+            template<u32 TriggerMax>
+            constexpr int Get() const {
+                constexpr int Width = std::bit_width(TriggerMax);
+                static_assert((Width <= 16) && (TriggerMax == (u32(1) << Width) - 1), "Trigger range must be a whole number of bits");
+                return m_thresholds[Width];
+            }
+
+        private:
+            u16 m_thresholds[17];
+    };
+
+    // Sensor axis calibration, stored as a bias and a precomputed reciprocal so applying it is a subtract and a multiply
+    struct AxisCalibration {
+        float bias;
+        float scale;
+
+        constexpr float Apply(s32 value) const {
+            return (value - bias) * scale;
+        }
+    };
+
+    // Maps bias to 0 and full_scale_value to full_scale
+    constexpr AxisCalibration MakeAxisCalibration(s32 bias, s32 full_scale_value, float full_scale) {
+        return { float(bias), full_scale_value != bias ? full_scale / float(full_scale_value - bias) : 0.0f };
+    }
+
 }
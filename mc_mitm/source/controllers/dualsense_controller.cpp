@@ -79,6 +79,18 @@ namespace ams::controller {
         // Request motion calibration data from DualSense
         R_TRY(this->GetCalibrationData(&m_motion_calibration));
 
+        const auto &cal = m_motion_calibration;
+        m_accel_scale = {
+            MakeAxisCalibration(0, cal.acc.x_max, 1.0f),
+            MakeAxisCalibration(0, cal.acc.y_max, 1.0f),
+            MakeAxisCalibration(0, cal.acc.z_max, 1.0f)
+        };
+        m_gyro_scale = {
+            MakeAxisCalibration(cal.gyro.pitch_bias, cal.gyro.pitch_max, cal.gyro.speed_max),
+            MakeAxisCalibration(cal.gyro.yaw_bias,   cal.gyro.yaw_max,   cal.gyro.speed_max),
+            MakeAxisCalibration(cal.gyro.roll_bias,  cal.gyro.roll_max,  cal.gyro.speed_max)
+        };
+
         auto config = mitm::GetGlobalConfig();
         m_lightbar_brightness = config->misc.dualsense_lightbar_brightness;
 
@@ -86,8 +98,7 @@ namespace ams::controller {
     }
 
     Result DualsenseController::SetVibration(const SwitchMotorData *motor_data) {
-        m_rumble_state.amp_motor_left  = static_cast<u8>(255 * std::max(motor_data->left_motor.low_band_amp, motor_data->right_motor.low_band_amp));
-        m_rumble_state.amp_motor_right = static_cast<u8>(255 * std::max(motor_data->left_motor.high_band_amp, motor_data->right_motor.high_band_amp));
+        ApplyRumbleResponse(mitm::GetRumbleResponse(RumbleProfile_Dualsense), motor_data, &m_rumble_state.amp_motor_left, &m_rumble_state.amp_motor_right);
         return this->PushRumbleLedState();
     }
 
@@ -147,8 +158,8 @@ namespace ams::controller {
 
         this->MapButtons(&src->input0x01.buttons);
 
-        m_buttons.ZR = src->input0x01.right_trigger > (m_trigger_threshold * TriggerMax);
-        m_buttons.ZL = src->input0x01.left_trigger  > (m_trigger_threshold * TriggerMax);
+        m_buttons.ZR = src->input0x01.right_trigger > this->GetTriggerThreshold<TriggerMax>();
+        m_buttons.ZL = src->input0x01.left_trigger  > this->GetTriggerThreshold<TriggerMax>();
     }
 
     void DualsenseController::MapInputReport0x31(const DualsenseReportData *src) {
@@ -175,8 +186,8 @@ namespace ams::controller {
 
         this->MapButtons(&src->input0x31.buttons);
 
-        m_buttons.ZR = src->input0x31.right_trigger > (m_trigger_threshold * TriggerMax);
-        m_buttons.ZL = src->input0x31.left_trigger  > (m_trigger_threshold * TriggerMax);
+        m_buttons.ZR = src->input0x31.right_trigger > this->GetTriggerThreshold<TriggerMax>();
+        m_buttons.ZL = src->input0x31.left_trigger  > this->GetTriggerThreshold<TriggerMax>();
 
         if (src->input0x31.buttons.touchpad) {
             for (int i = 0; i < 2; ++i) {
@@ -197,28 +208,20 @@ namespace ams::controller {
             }
         }
 
-        m_accel.x = -src->input0x31.acc_z / float(m_motion_calibration.acc.z_max);
-        m_accel.y = -src->input0x31.acc_x / float(m_motion_calibration.acc.x_max);
-        m_accel.z =  src->input0x31.acc_y / float(m_motion_calibration.acc.y_max);
+        m_accel.x = -m_accel_scale.z.Apply(src->input0x31.acc_z);
+        m_accel.y = -m_accel_scale.x.Apply(src->input0x31.acc_x);
+        m_accel.z =  m_accel_scale.y.Apply(src->input0x31.acc_y);
+
+        m_gyro.x = -m_gyro_scale.z.Apply(src->input0x31.vel_z);
+        m_gyro.y = -m_gyro_scale.x.Apply(src->input0x31.vel_x);
+        m_gyro.z =  m_gyro_scale.y.Apply(src->input0x31.vel_y);
 
-        m_gyro.x = -(float(src->input0x31.vel_z) - m_motion_calibration.gyro.roll_bias)  / ((m_motion_calibration.gyro.roll_max  - m_motion_calibration.gyro.roll_bias)  / m_motion_calibration.gyro.speed_max);
-        m_gyro.y = -(float(src->input0x31.vel_x) - m_motion_calibration.gyro.pitch_bias) / ((m_motion_calibration.gyro.pitch_max - m_motion_calibration.gyro.pitch_bias) / m_motion_calibration.gyro.speed_max);
-        m_gyro.z =  (float(src->input0x31.vel_y) - m_motion_calibration.gyro.yaw_bias) / ((m_motion_calibration.gyro.yaw_max - m_motion_calibration.gyro.yaw_bias) / m_motion_calibration.gyro.speed_max);
+        // Sensor timestamp counts in units of 1/3us
+        this->SetSensorTimestamp(src->input0x31.timestamp, 32, 1000, 3);
     }
 
     void DualsenseController::MapButtons(const DualsenseButtonData *buttons) {
-        m_buttons.dpad_down  = (buttons->dpad == DualsenseDPad_S)  ||
-                               (buttons->dpad == DualsenseDPad_SE) ||
-                               (buttons->dpad == DualsenseDPad_SW);
-        m_buttons.dpad_up    = (buttons->dpad == DualsenseDPad_N)  ||
-                               (buttons->dpad == DualsenseDPad_NE) ||
-                               (buttons->dpad == DualsenseDPad_NW);
-        m_buttons.dpad_right = (buttons->dpad == DualsenseDPad_E)  ||
-                               (buttons->dpad == DualsenseDPad_NE) ||
-                               (buttons->dpad == DualsenseDPad_SE);
-        m_buttons.dpad_left  = (buttons->dpad == DualsenseDPad_W)  ||
-                               (buttons->dpad == DualsenseDPad_NW) ||
-                               (buttons->dpad == DualsenseDPad_SW);
+        MapHatSwitch<DualsenseDPad_N>(&m_buttons, buttons->dpad);
 
         m_buttons.A = buttons->circle;
         m_buttons.B = buttons->cross;
@@ -283,7 +286,7 @@ namespace ams::controller {
         m_output_report.size = sizeof(report.output0x31) + sizeof(report.id);
         std::memcpy(m_output_report.data, &report, m_output_report.size);
 
-        R_RETURN(this->WriteDataReport(&m_output_report));
+        R_RETURN(this->WriteOutputReport(&m_output_report));
     }
 
 }
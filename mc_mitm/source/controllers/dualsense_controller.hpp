@@ -15,6 +15,7 @@
  */
 #pragma once
 #include "emulated_switch_controller.hpp"
+#include "controller_utils.hpp"
 
 namespace ams::controller {
 
@@ -197,6 +198,8 @@ namespace ams::controller {
 
             DualsenseVersionInfo m_version_info;
             DualsenseImuCalibrationData m_motion_calibration;
+            Vec3d<AxisCalibration> m_accel_scale;
+            Vec3d<AxisCalibration> m_gyro_scale;
     };
 
 }
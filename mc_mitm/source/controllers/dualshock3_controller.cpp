@@ -37,6 +37,10 @@ namespace ams::controller {
         constexpr u8 TriggerMax = UINT8_MAX;
         constexpr float AccelScaleFactor = 1 / 113.0f;
 
+        // Rumble reports only run the motors for a short duration (RumbleDuration), so an unchanged report has to be resent well before then
+        constexpr u8 RumbleDuration = 10;
+        constexpr TimeSpan RumbleRefreshInterval = TimeSpan::FromMilliSeconds(50);
+
         constinit const u8 EnablePayload[] = { 0xf4, 0x42, 0x03, 0x00, 0x00 };
         constinit const u8 LedConfig[] = { 0xff, 0x27, 0x10, 0x00, 0x32 };
         constinit const u8 PlayerLedPatterns[] = { 0b1000, 0b1100, 0b1110, 0b1111, 0b1001, 0b0101, 0b1101, 0b0110 };
@@ -184,6 +188,11 @@ namespace ams::controller {
         R_SUCCEED();
     }
 
+    Dualshock3Controller::Dualshock3Controller(const bluetooth::Address *address, HardwareID id)
+    : EmulatedSwitchController(address, id) {
+        m_output_limiter.SetRefreshInterval(RumbleRefreshInterval.GetNanoSeconds());
+    }
+
     Result Dualshock3Controller::Initialize() {
         R_TRY(EmulatedSwitchController::Initialize());
         R_TRY(this->SendEnablePayload());
@@ -192,8 +201,7 @@ namespace ams::controller {
     }
 
     Result Dualshock3Controller::SetVibration(const SwitchMotorData *motor_data) {
-        m_rumble_state.amp_motor_left  = static_cast<u8>(255 * std::max(motor_data->left_motor.low_band_amp, motor_data->right_motor.low_band_amp));
-        m_rumble_state.amp_motor_right = static_cast<u8>(255 * std::max(motor_data->left_motor.high_band_amp, motor_data->right_motor.high_band_amp));
+        ApplyRumbleResponse(mitm::GetRumbleResponse(RumbleProfile_Dualshock3), motor_data, &m_rumble_state.amp_motor_left, &m_rumble_state.amp_motor_right);
         R_RETURN(this->PushRumbleLedState());
     }
 
@@ -259,9 +267,9 @@ namespace ams::controller {
         m_buttons.Y = src->input0x01.buttons.square;
 
         m_buttons.R  = src->input0x01.buttons.R1;
-        m_buttons.ZR = src->input0x01.right_trigger > (m_trigger_threshold * TriggerMax);
+        m_buttons.ZR = src->input0x01.right_trigger > this->GetTriggerThreshold<TriggerMax>();
         m_buttons.L  = src->input0x01.buttons.L1;
-        m_buttons.ZL = src->input0x01.left_trigger  > (m_trigger_threshold * TriggerMax);
+        m_buttons.ZL = src->input0x01.left_trigger  > this->GetTriggerThreshold<TriggerMax>();
 
         m_buttons.minus = src->input0x01.buttons.select;
         m_buttons.plus  = src->input0x01.buttons.start;
@@ -288,9 +296,9 @@ namespace ams::controller {
 
         Dualshock3ReportData report = {};
         report.id = 0x01;
-        report.output0x01.data[1] = 10;
+        report.output0x01.data[1] = RumbleDuration;
         report.output0x01.data[2] = m_rumble_state.amp_motor_right ? 1 : 0;
-        report.output0x01.data[3] = 10;
+        report.output0x01.data[3] = RumbleDuration;
         report.output0x01.data[4] = m_rumble_state.amp_motor_left;
         report.output0x01.data[9] = m_led_mask << 1;
         std::memcpy(&report.output0x01.data[10], LedConfig, sizeof(LedConfig));
@@ -301,7 +309,12 @@ namespace ams::controller {
         m_output_report.size = sizeof(report.output0x01) + sizeof(report.id);
         std::memcpy(m_output_report.data, &report, m_output_report.size);
 
-        R_RETURN(this->SetReport(BtdrvBluetoothHhReportType_Output, &m_output_report));
+        R_RETURN(this->WriteOutputReport(&m_output_report));
+    }
+
+    Result Dualshock3Controller::CommitOutputReport(const bluetooth::HidReport *report) {
+        // Called from the shared rumble scheduler thread, so don't wait on the acknowledgement. A failed write is retried on the next submission
+        R_RETURN(this->SetReportAsync(BtdrvBluetoothHhReportType_Output, report));
     }
 
 }
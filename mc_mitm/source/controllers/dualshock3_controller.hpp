@@ -102,8 +102,7 @@ namespace ams::controller {
             static Result UsbPair(UsbHsInterface *iface);
 
         public:
-            Dualshock3Controller(const bluetooth::Address *address, HardwareID id)
-            : EmulatedSwitchController(address, id) { }
+            Dualshock3Controller(const bluetooth::Address *address, HardwareID id);
 
             Result Initialize(void);
             Result SetVibration(const SwitchMotorData *motor_data);
@@ -117,6 +116,7 @@ namespace ams::controller {
 
             Result SendEnablePayload(void);
             Result PushRumbleLedState();
+            Result CommitOutputReport(const bluetooth::HidReport *report) override;
 
             u8 m_led_mask;
             Dualshock3RumbleData m_rumble_state;
@@ -58,14 +58,26 @@ namespace ams::controller {
         // Request motion calibration data from Dualshock4
         if(R_FAILED(this->GetCalibrationData(&m_motion_calibration))) {
             m_enable_motion = false;
+        } else {
+            // Precompute calibration reciprocals so the per-report conversion doesn't need any divides
+            const auto &cal = m_motion_calibration;
+            m_accel_scale = {
+                MakeAxisCalibration(0, cal.acc.x_max, 1.0f),
+                MakeAxisCalibration(0, cal.acc.y_max, 1.0f),
+                MakeAxisCalibration(0, cal.acc.z_max, 1.0f)
+            };
+            m_gyro_scale = {
+                MakeAxisCalibration(cal.gyro.pitch_bias, cal.gyro.pitch_max, cal.gyro.speed_max),
+                MakeAxisCalibration(cal.gyro.yaw_bias,   cal.gyro.yaw_max,   cal.gyro.speed_max),
+                MakeAxisCalibration(cal.gyro.roll_bias,  cal.gyro.roll_max,  cal.gyro.speed_max)
+            };
         }
 
         R_SUCCEED();
     }
 
     Result Dualshock4Controller::SetVibration(const SwitchMotorData *motor_data) {
-        m_rumble_state.amp_motor_left  = static_cast<u8>(255 * std::max(motor_data->left_motor.low_band_amp,  motor_data->right_motor.low_band_amp));
-        m_rumble_state.amp_motor_right = static_cast<u8>(255 * std::max(motor_data->left_motor.high_band_amp, motor_data->right_motor.high_band_amp));
+        ApplyRumbleResponse(mitm::GetRumbleResponse(RumbleProfile_Dualshock4), motor_data, &m_rumble_state.amp_motor_left, &m_rumble_state.amp_motor_right);
         R_RETURN(this->PushRumbleLedState());
     }
 
@@ -110,8 +122,8 @@ namespace ams::controller {
 
         this->MapButtons(&src->input0x01.buttons);
 
-        m_buttons.ZR = src->input0x01.right_trigger > (m_trigger_threshold * TriggerMax);
-        m_buttons.ZL = src->input0x01.left_trigger  > (m_trigger_threshold * TriggerMax);
+        m_buttons.ZR = src->input0x01.right_trigger > this->GetTriggerThreshold<TriggerMax>();
+        m_buttons.ZL = src->input0x01.left_trigger  > this->GetTriggerThreshold<TriggerMax>();
     }
 
     void Dualshock4Controller::MapInputReport0x11(const Dualshock4ReportData *src) {
@@ -138,8 +150,8 @@ namespace ams::controller {
 
         this->MapButtons(&src->input0x11.buttons);
 
-        m_buttons.ZR = src->input0x11.right_trigger > (m_trigger_threshold * TriggerMax);
-        m_buttons.ZL = src->input0x11.left_trigger  > (m_trigger_threshold * TriggerMax);
+        m_buttons.ZR = src->input0x11.right_trigger > this->GetTriggerThreshold<TriggerMax>();
+        m_buttons.ZL = src->input0x11.left_trigger  > this->GetTriggerThreshold<TriggerMax>();
 
         if (src->input0x11.buttons.touchpad) {
             for (int i = 0; i < src->input0x11.num_reports; ++i) {
@@ -165,28 +177,20 @@ namespace ams::controller {
             m_buttons.capture = 0;
         }
 
-        m_accel.x = -src->input0x11.acc_z / float(m_motion_calibration.acc.z_max);
-        m_accel.y = -src->input0x11.acc_x / float(m_motion_calibration.acc.x_max);
-        m_accel.z =  src->input0x11.acc_y / float(m_motion_calibration.acc.y_max);
+        m_accel.x = -m_accel_scale.z.Apply(src->input0x11.acc_z);
+        m_accel.y = -m_accel_scale.x.Apply(src->input0x11.acc_x);
+        m_accel.z =  m_accel_scale.y.Apply(src->input0x11.acc_y);
+
+        m_gyro.x = -m_gyro_scale.z.Apply(src->input0x11.vel_z);
+        m_gyro.y = -m_gyro_scale.x.Apply(src->input0x11.vel_x);
+        m_gyro.z =  m_gyro_scale.y.Apply(src->input0x11.vel_y);
 
-        m_gyro.x = -(src->input0x11.vel_z - m_motion_calibration.gyro.roll_bias)  / ((m_motion_calibration.gyro.roll_max  - m_motion_calibration.gyro.roll_bias)  / m_motion_calibration.gyro.speed_max);
-        m_gyro.y = -(src->input0x11.vel_x - m_motion_calibration.gyro.pitch_bias) / ((m_motion_calibration.gyro.pitch_max - m_motion_calibration.gyro.pitch_bias) / m_motion_calibration.gyro.speed_max);
-        m_gyro.z =  (src->input0x11.vel_y - m_motion_calibration.gyro.yaw_bias)   / ((m_motion_calibration.gyro.yaw_max   - m_motion_calibration.gyro.yaw_bias)   / m_motion_calibration.gyro.speed_max);
+        // Sensor timestamp counts in units of 16/3us
+        this->SetSensorTimestamp(src->input0x11.timestamp, 16, 16000, 3);
     }
 
     void Dualshock4Controller::MapButtons(const Dualshock4ButtonData *buttons) {
-        m_buttons.dpad_down  = (buttons->dpad == Dualshock4DPad_S)  ||
-                               (buttons->dpad == Dualshock4DPad_SE) ||
-                               (buttons->dpad == Dualshock4DPad_SW);
-        m_buttons.dpad_up    = (buttons->dpad == Dualshock4DPad_N)  ||
-                               (buttons->dpad == Dualshock4DPad_NE) ||
-                               (buttons->dpad == Dualshock4DPad_NW);
-        m_buttons.dpad_right = (buttons->dpad == Dualshock4DPad_E)  ||
-                               (buttons->dpad == Dualshock4DPad_NE) ||
-                               (buttons->dpad == Dualshock4DPad_SE);
-        m_buttons.dpad_left  = (buttons->dpad == Dualshock4DPad_W)  ||
-                               (buttons->dpad == Dualshock4DPad_NW) ||
-                               (buttons->dpad == Dualshock4DPad_SW);
+        MapHatSwitch<Dualshock4DPad_N>(&m_buttons, buttons->dpad);
 
         m_buttons.A = buttons->circle;
         m_buttons.B = buttons->cross;
@@ -246,7 +250,7 @@ namespace ams::controller {
         m_output_report.size = sizeof(report.output0x11) + sizeof(report.id);
         std::memcpy(m_output_report.data, &report, m_output_report.size);
 
-        R_RETURN(this->WriteDataReport(&m_output_report));
+        R_RETURN(this->WriteOutputReport(&m_output_report));
     }
 
 }
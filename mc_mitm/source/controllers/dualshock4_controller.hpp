@@ -15,6 +15,7 @@
  */
 #pragma once
 #include "emulated_switch_controller.hpp"
+#include "controller_utils.hpp"
 
 namespace ams::controller {
 
@@ -234,6 +235,8 @@ namespace ams::controller {
             Dualshock4RumbleData m_rumble_state;
 
             Dualshock4ImuCalibrationData m_motion_calibration;
+            Vec3d<AxisCalibration> m_accel_scale;
+            Vec3d<AxisCalibration> m_gyro_scale;
     };
 
 }
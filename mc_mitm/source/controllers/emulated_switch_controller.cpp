@@ -14,8 +14,10 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 #include "emulated_switch_controller.hpp"
+#include "switch_rumble_scheduler.hpp"
 #include "../utils.hpp"
 #include "../mcmitm_config.hpp"
+#include "../mcmitm_heap.hpp"
 
 namespace ams::controller {
 
@@ -25,6 +27,9 @@ namespace ams::controller {
         constexpr u8 ComputeCrc8(const void *data, size_t size) {
             return utils::Crc8<7>::Calculate(data, size);
         }
+
+        // Maps the motion_drift_correction setting to the accelerometer correction gain, in rad/s per unit of tilt error
+        constexpr float MotionDriftCorrectionScale = 0.05f;
     }
 
     EmulatedSwitchController::EmulatedSwitchController(const bluetooth::Address *address, HardwareID id)
@@ -34,13 +39,28 @@ namespace ams::controller {
     , m_battery(BATTERY_MAX)
     , m_led_pattern(0)
     , m_input_report_mode(0x30)
+    , m_stale_report_sections(InputReportSection_All)
+    , m_packed_motion_sequence(0)
+    , m_sensor_timestamp(0)
+    , m_has_sensor_timestamp(false)
+    , m_last_rumble_timestamp(0)
+    , m_rumble_active(false)
     , m_mcu_mode(McuMode_Suspended) {
         this->ClearControllerState();
 
         auto config = mitm::GetGlobalConfig();
         m_enable_rumble = config->general.enable_rumble;
         m_enable_motion = config->general.enable_motion;
-        m_trigger_threshold = config->misc.analog_trigger_activation_threshold / 100.0;
+        m_trigger_thresholds.SetActivationThreshold(config->misc.analog_trigger_activation_threshold);
+        m_gyro_auto_calibration = config->misc.gyro_auto_calibration;
+        m_motion_packer.SetDriftCorrection(config->misc.motion_drift_correction * MotionDriftCorrectionScale);
+        m_output_limiter.SetMinInterval(TimeSpan::FromMilliSeconds(config->misc.output_report_min_interval).GetNanoSeconds());
+        m_rumble_watchdog_timeout = TimeSpan::FromMilliSeconds(config->misc.rumble_watchdog_timeout).GetNanoSeconds();
+        m_button_remap = mitm::GetButtonRemap(address, id.vid, id.pid);
+
+        auto stick_profile = mitm::GetAnalogStickProfile(address, id.vid, id.pid);
+        m_left_stick_response = stick_profile && stick_profile->left_table.enabled ? &stick_profile->left_table : nullptr;
+        m_right_stick_response = stick_profile && stick_profile->right_table.enabled ? &stick_profile->right_table : nullptr;
     };
 
     Result EmulatedSwitchController::Initialize() {
@@ -50,7 +70,7 @@ namespace ams::controller {
         std::string controller_dir = GetControllerDirectory(&m_address);
         R_TRY(fs::EnsureDirectory(controller_dir.c_str()));
 
-        R_TRY(m_virtual_memory.Initialize((controller_dir + "/spi_flash.bin").c_str()));
+        R_TRY(m_virtual_memory.Initialize(controller_dir.c_str()));
 
         R_SUCCEED();
     }
@@ -61,43 +81,102 @@ namespace ams::controller {
         m_right_stick.SetData(SwitchAnalogStick::Center, SwitchAnalogStick::Center);
         std::memset(&m_accel, 0, sizeof(m_accel));
         std::memset(&m_gyro, 0, sizeof(m_gyro));
-        m_motion_packer->SetGyroSensitivity(GyroSensitivity_2000Dps);
-        m_motion_packer->SetAccelSensitivity(AccelSensitivity_8G);
+        std::memset(&m_buffered_accel, 0, sizeof(m_buffered_accel));
+        std::memset(&m_buffered_gyro, 0, sizeof(m_buffered_gyro));
+        m_motion_samples.Clear();
+        m_sensor_clock.Reset();
+        m_motion_filter.Reset();
+        m_motion_packer.SetGyroSensitivity(GyroSensitivity_2000Dps);
+        m_motion_packer.SetAccelSensitivity(AccelSensitivity_8G);
     }
 
     void EmulatedSwitchController::UpdateControllerState(const bluetooth::HidReport *report) {
         this->ProcessInputData(report);
 
+        // Input mappers may kick off async work on state changes, but translating the report into the Switch format must never allocate
+        mitm::ScopedNoHeapAllocation no_allocation;
+
+        this->BufferMotionSample();
+
+        // The report buffer is kept between updates, so only the sections that have been invalidated or whose source data has changed need to be rebuilt
         auto input_report = reinterpret_cast<SwitchInputReport *>(m_input_report.data);
         input_report->id = m_input_report_mode;
         input_report->timer = (input_report->timer + 1) & 0xff;
         input_report->conn_info = (0 << 1) | m_ext_power;
         input_report->battery = m_battery | m_charging;
         input_report->buttons = m_buttons;
+        if (m_button_remap) {
+            ApplyButtonRemap(m_button_remap, &input_report->buttons);
+        }
         input_report->left_stick = m_left_stick;
-        input_report->right_stick = m_right_stick; 
-
-        m_motion_packer->PackData(&input_report->type0x30.motion_data, m_accel, m_gyro);
+        input_report->right_stick = m_right_stick;
+        if (m_left_stick_response) {
+            ApplyAnalogStickResponse(m_left_stick_response, &input_report->left_stick);
+        }
+        if (m_right_stick_response) {
+            ApplyAnalogStickResponse(m_right_stick_response, &input_report->right_stick);
+        }
 
-        const SwitchMcuResponse empty_mcu_response = {
-          .command = McuCommand_EmptyAwaitingCmd,
-          .data = {},
-        };
+        // Motion data sits at the same offset for both 0x30 and 0x31 reports
+        this->PackMotionData(input_report);
 
         switch (m_input_report_mode) {
             case 0x31:
-                m_motion_packer->PackData(&input_report->type0x31.motion_data, m_accel, m_gyro);
-                std::memcpy(&input_report->type0x31.mcu_response, &empty_mcu_response, sizeof(empty_mcu_response));
-                input_report->type0x31.crc = ComputeCrc8(&empty_mcu_response, sizeof(SwitchMcuResponse));
+                if (m_stale_report_sections & InputReportSection_McuResponse) {
+                    const SwitchMcuResponse empty_mcu_response = {
+                      .command = McuCommand_EmptyAwaitingCmd,
+                      .data = {},
+                    };
+
+                    std::memcpy(&input_report->type0x31.mcu_response, &empty_mcu_response, sizeof(empty_mcu_response));
+                    input_report->type0x31.crc = ComputeCrc8(&empty_mcu_response, sizeof(SwitchMcuResponse));
+                    m_stale_report_sections &= ~InputReportSection_McuResponse;
+                }
                 m_input_report.size = offsetof(SwitchInputReport, type0x31) + sizeof(input_report->type0x31);
                 break;
             default:
-                m_motion_packer->PackData(&input_report->type0x30.motion_data, m_accel, m_gyro);
                 m_input_report.size = offsetof(SwitchInputReport, type0x30) + sizeof(input_report->type0x30);
                 break;
         }
     }
 
+    void EmulatedSwitchController::SetSensorTimestamp(u32 counter, u32 counter_bits, s64 period_num, s64 period_den) {
+        m_sensor_timestamp = m_sensor_clock.Update(counter, counter_bits, period_num, period_den, os::ConvertToTimeSpan(os::GetSystemTick()).GetNanoSeconds());
+        m_has_sensor_timestamp = true;
+    }
+
+    void EmulatedSwitchController::BufferMotionSample() {
+        const bool has_sensor_timestamp = m_has_sensor_timestamp;
+        m_has_sensor_timestamp = false;
+
+        // Reports that didn't carry new sensor data leave the buffer alone
+        if ((std::memcmp(&m_accel, &m_buffered_accel, sizeof(m_accel)) == 0) && (std::memcmp(&m_gyro, &m_buffered_gyro, sizeof(m_gyro)) == 0)) {
+            return;
+        }
+
+        m_buffered_accel = m_accel;
+        m_buffered_gyro = m_gyro;
+
+        const s64 timestamp = has_sensor_timestamp ? m_sensor_timestamp : os::ConvertToTimeSpan(os::GetSystemTick()).GetNanoSeconds();
+        m_motion_samples.Push(timestamp, m_accel, m_gyro_auto_calibration ? m_motion_filter.Apply(timestamp, m_accel, m_gyro) : m_gyro);
+    }
+
+    void EmulatedSwitchController::PackMotionData(SwitchInputReport *input_report) {
+        // Stateless packers produce identical output for identical input, so there's nothing to do unless new samples have arrived
+        if (!(m_stale_report_sections & InputReportSection_Motion) && !m_motion_packer.IsStateful()) {
+            if (m_motion_samples.GetSequence() == m_packed_motion_sequence) {
+                return;
+            }
+        }
+
+        MotionSample samples[SwitchMotionSampleCount];
+        m_motion_samples.GetSwitchSamples(samples);
+
+        m_motion_packer.PackData(&input_report->type0x30.motion_data, samples);
+        m_packed_motion_sequence = m_motion_samples.GetSequence();
+        m_stale_report_sections &= ~InputReportSection_Motion;
+    }
+
     Result EmulatedSwitchController::HandleOutputDataReport(const bluetooth::HidReport *report) {
         auto output_report = reinterpret_cast<const SwitchOutputReport *>(&report->data);
 
@@ -121,16 +200,74 @@ namespace ams::controller {
     }
 
     Result EmulatedSwitchController::HandleRumbleData(const SwitchEncodedMotorData *encoded_motor_data) {
+        mitm::ScopedNoHeapAllocation no_allocation;
+
         if (m_enable_rumble) {
-            SwitchMotorData motor_data;
-            if (m_rumble_handler.GetDecodedValues(encoded_motor_data, &motor_data)) {
-                R_TRY(this->SetVibration(&motor_data));
+            const s64 now = os::ConvertToTimeSpan(os::GetSystemTick()).GetNanoSeconds();
+
+            // Only the arrival time is recorded here. The scheduler thread checks it against the watchdog deadline whenever it next wakes
+            m_last_rumble_timestamp = now;
+
+            // Samples are played back from the scheduler thread so that multi-sample packets are spread over their intended duration
+            if (m_rumble_handler.ScheduleSamples(encoded_motor_data, now)) {
+                SignalRumbleScheduler();
             }
         }
 
         R_SUCCEED();
     }
 
+    s64 EmulatedSwitchController::ProcessScheduledOutput(s64 now) {
+        mitm::ScopedNoHeapAllocation no_allocation;
+
+        SwitchMotorData motor_data;
+        s64 next_due;
+        if (m_rumble_handler.GetDueSample(now, &motor_data, &next_due) && m_enable_rumble) {
+            this->SetVibration(&motor_data);
+            m_rumble_active = (motor_data.left_motor.low_band_amp  > 0) || (motor_data.left_motor.high_band_amp  > 0) ||
+                              (motor_data.right_motor.low_band_amp > 0) || (motor_data.right_motor.high_band_amp > 0);
+        }
+
+        // Stop the motors if the console stops sending rumble updates while they are running
+        if (m_rumble_active && (m_rumble_watchdog_timeout > 0)) {
+            const s64 deadline = m_last_rumble_timestamp + m_rumble_watchdog_timeout;
+            if (now >= deadline) {
+                m_rumble_handler.Clear();
+                m_rumble_active = false;
+                next_due = RumbleScheduleIdle;
+                this->CancelVibration();
+            } else {
+                next_due = std::min(next_due, deadline);
+            }
+        }
+
+        std::scoped_lock lk(m_output_mutex);
+
+        if (m_output_limiter.TakePendingReport(now, &m_output_report) && R_SUCCEEDED(this->CommitOutputReport(&m_output_report))) {
+            m_output_limiter.RecordWrite(&m_output_report, now);
+        }
+
+        return std::min(next_due, m_output_limiter.GetPendingDue());
+    }
+
+    Result EmulatedSwitchController::WriteOutputReport(const bluetooth::HidReport *report) {
+        const s64 now = os::ConvertToTimeSpan(os::GetSystemTick()).GetNanoSeconds();
+
+        switch (m_output_limiter.Submit(report, now)) {
+            case OutputReportAction_Write:
+                R_TRY(this->CommitOutputReport(report));
+                m_output_limiter.RecordWrite(report, now);
+                break;
+            case OutputReportAction_Defer:
+                SignalRumbleScheduler();
+                break;
+            default:
+                break;
+        }
+
+        R_SUCCEED();
+    }
+
     Result EmulatedSwitchController::HandleHidCommand(const SwitchHidCommand *command) {
         switch (command->id) {
             case HidCommand_GetDeviceInfo:
@@ -227,6 +364,7 @@ namespace ams::controller {
 
     Result EmulatedSwitchController::HandleHidCommandSetDataFormat(const SwitchHidCommand *command) {
         m_input_report_mode = command->set_data_format.id;
+        m_stale_report_sections = InputReportSection_All;
 
         const SwitchHidCommandResponse response = {
             .ack = 0x80,
@@ -484,32 +622,27 @@ namespace ams::controller {
     Result EmulatedSwitchController::HandleHidCommandSensorSleep(const SwitchHidCommand* command) {
         m_enable_motion = mitm::GetGlobalConfig()->general.enable_motion;
 
-        GyroSensitivity gyro_sensitivity = m_motion_packer->GetGyroSensitivity();
-        AccelSensitivity accel_sensitivity = m_motion_packer->GetAccelSensitivity();
-
+        MotionPackingMode mode = MotionPackingMode_Disabled;
         if (m_enable_motion) {
             switch (command->sensor_sleep.mode) {
                 case SensorSleepType_Active:
-                    m_motion_packer = std::make_unique<StandardMotionPacker>();
+                    mode = MotionPackingMode_Standard;
                     break;
 
                 case SensorSleepType_ActiveDscaleMode1:
                 case SensorSleepType_ActiveDscaleMode2:
                 case SensorSleepType_ActiveDscaleMode3:
                 case SensorSleepType_ActiveDscaleMode4:
-                    m_motion_packer = std::make_unique<QuaternionMotionPacker>();
+                    mode = MotionPackingMode_Quaternion;
                     break;
 
                 default:
-                    m_motion_packer = std::make_unique<NullMotionPacker>();
                     break;
             }
-        } else {
-            m_motion_packer = std::make_unique<NullMotionPacker>();
         }
 
-        m_motion_packer->SetGyroSensitivity(gyro_sensitivity);
-        m_motion_packer->SetAccelSensitivity(accel_sensitivity);
+        m_motion_packer.SetMode(mode);
+        m_stale_report_sections |= InputReportSection_Motion;
 
         const SwitchHidCommandResponse response = {
             .ack = 0x80,
@@ -520,8 +653,9 @@ namespace ams::controller {
     }
 
     Result EmulatedSwitchController::HandleHidCommandSensorConfig(const SwitchHidCommand *command) {
-        m_motion_packer->SetGyroSensitivity(command->sensor_config.gyro_sensitivity);
-        m_motion_packer->SetAccelSensitivity(command->sensor_config.accel_sensitivity);
+        m_motion_packer.SetGyroSensitivity(command->sensor_config.gyro_sensitivity);
+        m_motion_packer.SetAccelSensitivity(command->sensor_config.accel_sensitivity);
+        m_stale_report_sections |= InputReportSection_Motion;
 
         const SwitchHidCommandResponse response = {
             .ack = 0x80,
@@ -533,6 +667,9 @@ namespace ams::controller {
 
     Result EmulatedSwitchController::HandleHidCommandMotorEnable(const SwitchHidCommand *command) {
         m_enable_rumble = mitm::GetGlobalConfig()->general.enable_rumble & command->motor_enable.enabled;
+        if (!m_enable_rumble) {
+            m_rumble_handler.Clear();
+        }
 
         const SwitchHidCommandResponse response = {
             .ack = 0x80,
@@ -558,6 +695,9 @@ namespace ams::controller {
         std::memcpy(&input_report->type0x21.hid_command_response, response, sizeof(SwitchHidCommandResponse));
         m_input_report.size = offsetof(SwitchInputReport, type0x21) + sizeof(input_report->type0x21);
 
+        // Command response overlaps the motion and mcu sections of the report template
+        m_stale_report_sections = InputReportSection_All;
+
         // Write a fake response into the report buffer
         R_RETURN(bluetooth::hid::report::WriteHidDataReport(m_address, &m_input_report));
     }
@@ -646,11 +786,16 @@ namespace ams::controller {
         input_report->right_stick = m_right_stick;
         input_report->vibrator = 0;
 
-        m_motion_packer->PackData(&input_report->type0x31.motion_data, m_accel, m_gyro);
+        MotionSample samples[SwitchMotionSampleCount];
+        m_motion_samples.GetSwitchSamples(samples);
+        m_motion_packer.PackData(&input_report->type0x31.motion_data, samples);
         std::memcpy(&input_report->type0x31.mcu_response, response, sizeof(SwitchMcuResponse));
         input_report->type0x31.crc = ComputeCrc8(response, sizeof(SwitchMcuResponse));
         m_input_report.size = offsetof(SwitchInputReport, type0x31) + sizeof(input_report->type0x31);
 
+        // Mcu response is no longer the empty one expected by the report template
+        m_stale_report_sections |= InputReportSection_McuResponse;
+
         // Write a fake response into the report buffer
         R_RETURN(bluetooth::hid::report::WriteHidDataReport(m_address, &m_input_report));
     }
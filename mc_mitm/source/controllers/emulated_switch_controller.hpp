@@ -16,9 +16,18 @@
 #pragma once
 #include "switch_controller.hpp"
 #include "virtual_spi_flash.hpp"
+#include "report_layout.hpp"
+#include "switch_motion_filter.hpp"
+#include "output_report_limiter.hpp"
 
 namespace ams::controller {
 
+    enum InputReportSection : u8 {
+        InputReportSection_Motion      = BIT(0),
+        InputReportSection_McuResponse = BIT(1),
+        InputReportSection_All         = InputReportSection_Motion | InputReportSection_McuResponse
+    };
+
     class EmulatedSwitchController : public SwitchController {
 
         public:
@@ -30,12 +39,25 @@ namespace ams::controller {
 
             Result HandleOutputDataReport(const bluetooth::HidReport *report) override;
 
+            Result FlushVirtualMemory() override { R_RETURN(m_virtual_memory.Flush()); }
+
+            s64 ProcessScheduledOutput(s64 now) override;
+
+            u32 GetSuppressedOutputReportCount() const { return m_output_limiter.GetSuppressedCount(); }
+
         protected:
             void ClearControllerState();
             virtual Result SetVibration(const SwitchMotorData *motor_data) { AMS_UNUSED(motor_data); R_SUCCEED(); }
             virtual Result CancelVibration() { R_SUCCEED(); }
             virtual Result SetPlayerLed(u8 led_mask) { AMS_UNUSED(led_mask); R_SUCCEED(); }
 
+            // Sends a rumble/LED state report through the output limiter. Must be called with m_output_mutex held
+            Result WriteOutputReport(const bluetooth::HidReport *report);
+            virtual Result CommitOutputReport(const bluetooth::HidReport *report) { R_RETURN(this->WriteDataReport(report)); }
+
+            template<u32 TriggerMax>
+            int GetTriggerThreshold() const { return m_trigger_thresholds.Get<TriggerMax>(); }
+
             void UpdateControllerState(const bluetooth::HidReport *report) override;
             virtual void ProcessInputData(const bluetooth::HidReport *report) { AMS_UNUSED(report); }
 
@@ -70,6 +92,17 @@ namespace ams::controller {
             Result FakeHidCommandResponse(const SwitchHidCommandResponse *response);
             Result FakeMcuResponse(const SwitchMcuResponse *response);
 
+            // Mappers for controllers with a hardware sensor clock report the counter for each motion sample here, so samples are timestamped by the device rather than on arrival
+            void SetSensorTimestamp(u32 counter, u32 counter_bits, s64 period_num, s64 period_den);
+            void BufferMotionSample();
+            void PackMotionData(SwitchInputReport *input_report);
+
+            // Maps an input report payload (the bytes following the report id) described by a ReportField table
+            template<const auto &Fields>
+            void MapReportLayout(const u8 *data) {
+                ReportLayout<Fields>::Map(data, m_trigger_thresholds, &m_buttons, &m_left_stick, &m_right_stick, &m_battery);
+            }
+
             bool m_charging;
             bool m_ext_power;
             u8 m_battery;
@@ -82,14 +115,31 @@ namespace ams::controller {
             Vec3d<float> m_gyro;
 
             u8 m_input_report_mode;
+            u8 m_stale_report_sections;
+            Vec3d<float> m_buffered_accel;
+            Vec3d<float> m_buffered_gyro;
+            MotionSampleBuffer m_motion_samples;
+            u32 m_packed_motion_sequence;
+            SensorClock m_sensor_clock;
+            s64 m_sensor_timestamp;
+            bool m_has_sensor_timestamp;
+            MotionFilter m_motion_filter;
+            bool m_gyro_auto_calibration;
 
             SwitchRumbleHandler m_rumble_handler;
-            std::unique_ptr<SwitchMotionPacker> m_motion_packer = std::make_unique<NullMotionPacker>();
+            OutputReportLimiter m_output_limiter;
+            std::atomic<s64> m_last_rumble_timestamp;
+            bool m_rumble_active;
+            s64 m_rumble_watchdog_timeout;
+            SwitchMotionPacker m_motion_packer;
 
             bool m_enable_rumble;
             bool m_enable_motion;
 
-            float m_trigger_threshold;
+            TriggerThresholds m_trigger_thresholds;
+            const ButtonRemapTable *m_button_remap;
+            const AnalogStickResponseTable *m_left_stick_response;
+            const AnalogStickResponseTable *m_right_stick_response;
 
             McuModeType m_mcu_mode;
 
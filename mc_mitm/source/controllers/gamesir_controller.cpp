@@ -43,18 +43,7 @@ namespace ams::controller {
         m_left_stick  = PackAnalogStickValues(src->input0x03.left_stick.x,  InvertAnalogStickValue(src->input0x03.left_stick.y));
         m_right_stick = PackAnalogStickValues(src->input0x03.right_stick.x, InvertAnalogStickValue(src->input0x03.right_stick.y));
 
-        m_buttons.dpad_down  = (src->input0x03.buttons.dpad == GamesirDpad2_S)  ||
-                               (src->input0x03.buttons.dpad == GamesirDpad2_SE) ||
-                               (src->input0x03.buttons.dpad == GamesirDpad2_SW);
-        m_buttons.dpad_up    = (src->input0x03.buttons.dpad == GamesirDpad2_N)  ||
-                               (src->input0x03.buttons.dpad == GamesirDpad2_NE) ||
-                               (src->input0x03.buttons.dpad == GamesirDpad2_NW);
-        m_buttons.dpad_right = (src->input0x03.buttons.dpad == GamesirDpad2_E)  ||
-                               (src->input0x03.buttons.dpad == GamesirDpad2_NE) ||
-                               (src->input0x03.buttons.dpad == GamesirDpad2_SE);
-        m_buttons.dpad_left  = (src->input0x03.buttons.dpad == GamesirDpad2_W)  ||
-                               (src->input0x03.buttons.dpad == GamesirDpad2_NW) ||
-                               (src->input0x03.buttons.dpad == GamesirDpad2_SW);
+        MapHatSwitch<GamesirDpad2_N>(&m_buttons, src->input0x03.buttons.dpad);
 
         m_buttons.A = src->input0x03.buttons.B;
         m_buttons.B = src->input0x03.buttons.A;
@@ -62,9 +51,9 @@ namespace ams::controller {
         m_buttons.Y = src->input0x03.buttons.X;
 
         m_buttons.R  = src->input0x03.buttons.RB;
-        m_buttons.ZR = src->input0x03.right_trigger > (m_trigger_threshold * TriggerMax);
+        m_buttons.ZR = src->input0x03.right_trigger > this->GetTriggerThreshold<TriggerMax>();
         m_buttons.L  = src->input0x03.buttons.LB;
-        m_buttons.ZL = src->input0x03.left_trigger  > (m_trigger_threshold * TriggerMax);
+        m_buttons.ZL = src->input0x03.left_trigger  > this->GetTriggerThreshold<TriggerMax>();
 
         m_buttons.minus = src->input0x03.buttons.select;
         m_buttons.plus  = src->input0x03.buttons.start;
@@ -83,18 +72,7 @@ namespace ams::controller {
         m_left_stick  = PackAnalogStickValues(src->input0xc4.left_stick.x,  InvertAnalogStickValue(src->input0xc4.left_stick.y));
         m_right_stick = PackAnalogStickValues(src->input0xc4.right_stick.x, InvertAnalogStickValue(src->input0xc4.right_stick.y));
 
-        m_buttons.dpad_down   = (src->input0xc4.buttons.dpad == GamesirDpad_S)  ||
-                                (src->input0xc4.buttons.dpad == GamesirDpad_SE) ||
-                                (src->input0xc4.buttons.dpad == GamesirDpad_SW);
-        m_buttons.dpad_up     = (src->input0xc4.buttons.dpad == GamesirDpad_N)  ||
-                                (src->input0xc4.buttons.dpad == GamesirDpad_NE) ||
-                                (src->input0xc4.buttons.dpad == GamesirDpad_NW);
-        m_buttons.dpad_right  = (src->input0xc4.buttons.dpad == GamesirDpad_E)  ||
-                                (src->input0xc4.buttons.dpad == GamesirDpad_NE) ||
-                                (src->input0xc4.buttons.dpad == GamesirDpad_SE);
-        m_buttons.dpad_left   = (src->input0xc4.buttons.dpad == GamesirDpad_W)  ||
-                                (src->input0xc4.buttons.dpad == GamesirDpad_NW) ||
-                                (src->input0xc4.buttons.dpad == GamesirDpad_SW);
+        MapHatSwitch<GamesirDpad_N>(&m_buttons, src->input0xc4.buttons.dpad);
 
         m_buttons.A = src->input0xc4.buttons.B;
         m_buttons.B = src->input0xc4.buttons.A;
@@ -102,9 +80,9 @@ namespace ams::controller {
         m_buttons.Y = src->input0xc4.buttons.X;
 
         m_buttons.R  = src->input0xc4.buttons.RB;
-        m_buttons.ZR = src->input0xc4.right_trigger > (m_trigger_threshold * TriggerMax);
+        m_buttons.ZR = src->input0xc4.right_trigger > this->GetTriggerThreshold<TriggerMax>();
         m_buttons.L  = src->input0xc4.buttons.LB;
-        m_buttons.ZL = src->input0xc4.left_trigger  > (m_trigger_threshold * TriggerMax);
+        m_buttons.ZL = src->input0xc4.left_trigger  > this->GetTriggerThreshold<TriggerMax>();
 
         m_buttons.minus = src->input0xc4.buttons.select;
         m_buttons.plus  = src->input0xc4.buttons.start;
@@ -40,18 +40,7 @@ namespace ams::controller {
         m_left_stick  = PackAnalogStickValues(src->input0x03.left_stick.x,  InvertAnalogStickValue(src->input0x03.left_stick.y));
         m_right_stick = PackAnalogStickValues(src->input0x03.right_stick.x, InvertAnalogStickValue(src->input0x03.right_stick.y));
         
-        m_buttons.dpad_down  = (src->input0x03.dpad == GamestickDPad_S)  ||
-                               (src->input0x03.dpad == GamestickDPad_SE) ||
-                               (src->input0x03.dpad == GamestickDPad_SW);
-        m_buttons.dpad_up    = (src->input0x03.dpad == GamestickDPad_N)  ||
-                               (src->input0x03.dpad == GamestickDPad_NE) ||
-                               (src->input0x03.dpad == GamestickDPad_NW);
-        m_buttons.dpad_right = (src->input0x03.dpad == GamestickDPad_E)  ||
-                               (src->input0x03.dpad == GamestickDPad_NE) ||
-                               (src->input0x03.dpad == GamestickDPad_SE);
-        m_buttons.dpad_left  = (src->input0x03.dpad == GamestickDPad_W)  ||
-                               (src->input0x03.dpad == GamestickDPad_NW) ||
-                               (src->input0x03.dpad == GamestickDPad_SW);
+        MapHatSwitch<GamestickDPad_N>(&m_buttons, src->input0x03.dpad);
         
         m_buttons.A = src->input0x03.buttons.B;
         m_buttons.B = src->input0x03.buttons.A;
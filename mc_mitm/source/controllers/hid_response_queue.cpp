@@ -0,0 +1,174 @@
+/*
+ * Copyright (c) 2020-2025 ndeadly
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "hid_response_queue.hpp"
+
+namespace ams::controller {
+
+    namespace {
+
+        const bluetooth::HidReport *GetDataReport(const bluetooth::HidReportEventInfo *event_info) {
+            if (hos::GetVersion() >= hos::Version_9_0_0) {
+                return &event_info->data_report.v9.report;
+            } else if (hos::GetVersion() >= hos::Version_7_0_0) {
+                return reinterpret_cast<const bluetooth::HidReport *>(&event_info->data_report.v7.report);
+            } else {
+                return reinterpret_cast<const bluetooth::HidReport *>(&event_info->data_report.v1.report);
+            }
+        }
+
+        void CopyReport(bluetooth::HidReport *dst, const bluetooth::HidReport *src) {
+            dst->size = src->size;
+            std::memcpy(dst->data, src->data, src->size);
+        }
+
+    }
+
+    HidResponseQueue::HidResponseQueue() : m_mutex(), m_slots(), m_next_sequence(0), m_outstanding(0) {
+        for (auto &slot : m_slots) {
+            os::InitializeEvent(&slot.ready_event, false, os::EventClearMode_AutoClear);
+        }
+    }
+
+    HidResponseQueue::~HidResponseQueue() {
+        for (auto &slot : m_slots) {
+            os::FinalizeEvent(&slot.ready_event);
+        }
+    }
+
+    bool HidResponseQueue::Push(Ticket *out_ticket, bluetooth::HidEventType type, u8 report_id, bluetooth::HidReport *out_report, bool wait, s64 now) {
+        std::scoped_lock lk(m_mutex);
+
+        // A request nobody waits on is given up on if the controller never replies to it, so it can't take the reply meant for a newer one
+        for (auto &slot : m_slots) {
+            if (slot.in_use && !slot.wait && (now - slot.timestamp >= ResponseTimeout.GetNanoSeconds())) {
+                this->Release(&slot);
+            }
+        }
+
+        for (size_t i = 0; i < MaxOutstandingRequests; ++i) {
+            auto slot = &m_slots[i];
+            if (!slot->in_use) {
+                slot->in_use = true;
+                slot->wait = wait;
+                slot->completed = false;
+                slot->type = type;
+                slot->report_id = report_id;
+                slot->sequence = m_next_sequence++;
+                slot->timestamp = now;
+                slot->out_report = out_report;
+                slot->result = ResultSuccess();
+                os::ClearEvent(&slot->ready_event);
+                ++m_outstanding;
+
+                *out_ticket = i;
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    void HidResponseQueue::Cancel(Ticket ticket) {
+        std::scoped_lock lk(m_mutex);
+        this->Release(&m_slots[ticket]);
+    }
+
+    Result HidResponseQueue::Wait(Ticket ticket) {
+        auto slot = &m_slots[ticket];
+
+        os::TimedWaitEvent(&slot->ready_event, ResponseTimeout);
+
+        std::scoped_lock lk(m_mutex);
+
+        // Checked under the lock, as the reply may have arrived just after the wait timed out
+        const Result result = slot->completed ? slot->result : Result(-1); // This should return a proper failure code
+        this->Release(slot);
+
+        R_RETURN(result);
+    }
+
+    bool HidResponseQueue::Complete(bluetooth::HidEventType type, const bluetooth::HidReportEventInfo *event_info) {
+        // Every input report passes through here, so skip the lock when nothing is outstanding
+        if (m_outstanding == 0) {
+            return false;
+        }
+
+        const bluetooth::HidReport *data_report = type == BtdrvHidEventType_Data ? GetDataReport(event_info) : nullptr;
+
+        std::scoped_lock lk(m_mutex);
+
+        // Find the oldest outstanding request for this reply. Sequence numbers are compared relative to the next one so wraparound is harmless
+        Slot *match = nullptr;
+        for (auto &slot : m_slots) {
+            if (!slot.in_use || slot.completed || (slot.type != type)) {
+                continue;
+            }
+
+            if ((data_report != nullptr) && (slot.report_id != data_report->data[0])) {
+                continue;
+            }
+
+            if ((match == nullptr) || (slot.sequence - m_next_sequence < match->sequence - m_next_sequence)) {
+                match = &slot;
+            }
+        }
+
+        if (match == nullptr) {
+            return false;
+        }
+
+        if (!match->wait) {
+            this->Release(match);
+            return true;
+        }
+
+        switch (type) {
+            case BtdrvHidEventType_Data:
+                CopyReport(match->out_report, data_report);
+                break;
+            case BtdrvHidEventType_SetReport:
+                match->result = event_info->set_report.res;
+                break;
+            case BtdrvHidEventType_GetReport:
+                if (hos::GetVersion() >= hos::Version_9_0_0) {
+                    match->result = event_info->get_report.v9.res;
+                    if (match->result.IsSuccess()) {
+                        CopyReport(match->out_report, &event_info->get_report.v9.report);
+                    }
+                } else {
+                    match->result = event_info->get_report.v1.res;
+                    if (match->result.IsSuccess()) {
+                        CopyReport(match->out_report, reinterpret_cast<const bluetooth::HidReport *>(&event_info->get_report.v1.report));
+                    }
+                }
+                break;
+            default:
+                break;
+        }
+
+        match->completed = true;
+        os::SignalEvent(&match->ready_event);
+
+        return true;
+    }
+
+    void HidResponseQueue::Release(Slot *slot) {
+        slot->in_use = false;
+        slot->out_report = nullptr;
+        --m_outstanding;
+    }
+
+}
@@ -0,0 +1,73 @@
+/*
+ * Copyright (c) 2020-2025 ndeadly
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+#include <stratosphere.hpp>
+#include "../bluetooth_mitm/bluetooth/bluetooth_types.hpp"
+
+namespace ams::controller {
+
+    // Tracks requests sent to a controller that expect a reply (data report, SET_REPORT or GET_REPORT) in a fixed set of slots.
+    // A reply is handed to the oldest outstanding request it matches. The lock is only held to claim, complete or release a slot, never while
+    // waiting on the controller, so a slow reply to one request doesn't hold up any other. Requests that don't wait have their reply swallowed
+    class HidResponseQueue {
+        NON_COPYABLE(HidResponseQueue);
+        NON_MOVEABLE(HidResponseQueue);
+
+        public:
+            static constexpr size_t MaxOutstandingRequests = 4;
+            static constexpr TimeSpan ResponseTimeout = TimeSpan::FromMilliSeconds(500);
+
+            using Ticket = size_t;
+
+            HidResponseQueue();
+            ~HidResponseQueue();
+
+            // Claims a slot for a request that is about to be sent. The reply to a data or GET_REPORT request is copied to out_report. If wait isn't set
+            // nobody waits on the reply and the slot is released as soon as it arrives. Returns false if too many requests are outstanding
+            bool Push(Ticket *out_ticket, bluetooth::HidEventType type, u8 report_id, bluetooth::HidReport *out_report, bool wait, s64 now);
+
+            // Releases the slot of a request that couldn't be sent
+            void Cancel(Ticket ticket);
+
+            // Waits for the reply to a request, then releases its slot
+            Result Wait(Ticket ticket);
+
+            // Hands a reply to the oldest outstanding request for it. Returns false if no request was waiting on it
+            bool Complete(bluetooth::HidEventType type, const bluetooth::HidReportEventInfo *event_info);
+
+        private:
+            struct Slot {
+                bool in_use;
+                bool wait;
+                bool completed;
+                bluetooth::HidEventType type;
+                u8 report_id;
+                u32 sequence;
+                s64 timestamp;
+                bluetooth::HidReport *out_report;
+                Result result;
+                os::EventType ready_event;
+            };
+
+            void Release(Slot *slot);
+
+            os::SdkMutex m_mutex;
+            Slot m_slots[MaxOutstandingRequests];
+            u32 m_next_sequence;
+            std::atomic<size_t> m_outstanding;
+    };
+
+}
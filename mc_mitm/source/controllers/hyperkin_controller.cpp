@@ -18,6 +18,27 @@
 
 namespace ams::controller {
 
+    namespace {
+
+        constexpr size_t ButtonsOffset = offsetof(HyperkinInputReport0x3f, buttons);
+
+        constexpr ReportField InputReport0x3fLayout[] = {
+            HatSwitchField(offsetof(HyperkinInputReport0x3f, buttons.dpad), 0, 8, HyperkinDPad_N),
+
+            ButtonField(ButtonsOffset + 0, 1, SwitchButton_A),
+            ButtonField(ButtonsOffset + 0, 0, SwitchButton_B),
+            ButtonField(ButtonsOffset + 0, 3, SwitchButton_X),
+            ButtonField(ButtonsOffset + 0, 2, SwitchButton_Y),
+
+            ButtonField(ButtonsOffset + 0, 4, SwitchButton_L),
+            ButtonField(ButtonsOffset + 0, 5, SwitchButton_R),
+
+            ButtonField(ButtonsOffset + 1, 0, SwitchButton_Minus),
+            ButtonField(ButtonsOffset + 1, 1, SwitchButton_Plus),
+        };
+
+    }
+
     void HyperkinController::ProcessInputData(const bluetooth::HidReport *report) {
         auto hyperkin_report = reinterpret_cast<const HyperkinReportData *>(&report->data);
 
@@ -30,29 +51,7 @@ namespace ams::controller {
     }
 
     void HyperkinController::MapInputReport0x3f(const HyperkinReportData *src) {
-        m_buttons.dpad_down  = (src->input0x3f.buttons.dpad == HyperkinDPad_S)  ||
-                               (src->input0x3f.buttons.dpad == HyperkinDPad_SE) ||
-                               (src->input0x3f.buttons.dpad == HyperkinDPad_SW);
-        m_buttons.dpad_up    = (src->input0x3f.buttons.dpad == HyperkinDPad_N)  ||
-                               (src->input0x3f.buttons.dpad == HyperkinDPad_NE) ||
-                               (src->input0x3f.buttons.dpad == HyperkinDPad_NW);
-        m_buttons.dpad_right = (src->input0x3f.buttons.dpad == HyperkinDPad_E)  ||
-                               (src->input0x3f.buttons.dpad == HyperkinDPad_NE) ||
-                               (src->input0x3f.buttons.dpad == HyperkinDPad_SE);
-        m_buttons.dpad_left  = (src->input0x3f.buttons.dpad == HyperkinDPad_W)  ||
-                               (src->input0x3f.buttons.dpad == HyperkinDPad_NW) ||
-                               (src->input0x3f.buttons.dpad == HyperkinDPad_SW);
-
-        m_buttons.A = src->input0x3f.buttons.A;
-        m_buttons.B = src->input0x3f.buttons.B;
-        m_buttons.X = src->input0x3f.buttons.X;
-        m_buttons.Y = src->input0x3f.buttons.Y;
-
-        m_buttons.L = src->input0x3f.buttons.L;
-        m_buttons.R = src->input0x3f.buttons.R;
-
-        m_buttons.minus = src->input0x3f.buttons.select;
-        m_buttons.plus  = src->input0x3f.buttons.start;
+        this->MapReportLayout<InputReport0x3fLayout>(reinterpret_cast<const u8 *>(&src->input0x3f));
     }
 
 }
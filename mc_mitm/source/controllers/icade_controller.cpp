@@ -18,6 +18,23 @@
 
 namespace ams::controller {
 
+    namespace {
+
+        // The iCade has no dedicated minus and plus buttons
+        constinit const ButtonComboRuleSet icade_button_combos = {
+            .rules = {
+                { .type = ButtonComboType_Combo, .chord = SwitchButton_ZL | SwitchButton_ZR | SwitchButton_L, .output = SwitchButton_Minus },
+                { .type = ButtonComboType_Combo, .chord = SwitchButton_ZL | SwitchButton_ZR | SwitchButton_R, .output = SwitchButton_Plus  },
+            },
+            .count = 2
+        };
+
+    }
+
+    ICadeController::ICadeController(const bluetooth::Address *address, HardwareID id)
+    : EmulatedSwitchController(address, id)
+    , m_icade_combos(&icade_button_combos) { }
+
     void ICadeController::ProcessInputData(const bluetooth::HidReport *report) {
         auto icade_report = reinterpret_cast<const ICadeReportData *>(&report->data);
 
@@ -62,22 +79,7 @@ namespace ams::controller {
     }
 
     void ICadeController::ApplyButtonCombos(SwitchButtonData *buttons) {
-        // Combo for minus button
-        if (buttons->ZL && buttons->ZR && buttons->L) {
-            buttons->minus = 1;
-            buttons->ZL = 0;
-            buttons->ZR = 0;
-            buttons->L = 0;
-        }
-
-        // Combo for plus button
-        if (buttons->ZL && buttons->ZR && buttons->R) {
-            buttons->plus = 1;
-            buttons->ZL = 0;
-            buttons->ZR = 0;
-            buttons->R = 0;
-        }
-
+        m_icade_combos.Apply(buttons);
         EmulatedSwitchController::ApplyButtonCombos(buttons);
     }
 
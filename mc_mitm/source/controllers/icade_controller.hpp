@@ -36,12 +36,14 @@ namespace ams::controller {
                 {0x15e4, 0x0132}    // ION iCade Controller
             };
 
-            ICadeController(const bluetooth::Address *address, HardwareID id)
-            : EmulatedSwitchController(address, id) { }
+            ICadeController(const bluetooth::Address *address, HardwareID id);
 
             void ProcessInputData(const bluetooth::HidReport *report) override;
             void ApplyButtonCombos(SwitchButtonData *buttons) override;
 
+        private:
+            SwitchButtonComboEngine m_icade_combos;
+
     };
 
 }
@@ -45,18 +45,7 @@ namespace ams::controller {
         m_left_stick  = PackAnalogStickValues(src->input0x07.left_stick.x,  InvertAnalogStickValue(src->input0x07.left_stick.y));
         m_right_stick = PackAnalogStickValues(src->input0x07.right_stick.x, InvertAnalogStickValue(src->input0x07.right_stick.y));
 
-        m_buttons.dpad_down  = (src->input0x07.buttons.dpad == IpegaDPad_S)  ||
-                               (src->input0x07.buttons.dpad == IpegaDPad_SE) ||
-                               (src->input0x07.buttons.dpad == IpegaDPad_SW);
-        m_buttons.dpad_up    = (src->input0x07.buttons.dpad == IpegaDPad_N)  ||
-                               (src->input0x07.buttons.dpad == IpegaDPad_NE) ||
-                               (src->input0x07.buttons.dpad == IpegaDPad_NW);
-        m_buttons.dpad_right = (src->input0x07.buttons.dpad == IpegaDPad_E)  ||
-                               (src->input0x07.buttons.dpad == IpegaDPad_NE) ||
-                               (src->input0x07.buttons.dpad == IpegaDPad_SE);
-        m_buttons.dpad_left  = (src->input0x07.buttons.dpad == IpegaDPad_W)  ||
-                               (src->input0x07.buttons.dpad == IpegaDPad_NW) ||
-                               (src->input0x07.buttons.dpad == IpegaDPad_SW);
+        MapHatSwitch<IpegaDPad_N>(&m_buttons, src->input0x07.buttons.dpad);
 
         m_buttons.A = src->input0x07.buttons.B;
         m_buttons.B = src->input0x07.buttons.A;
@@ -64,9 +53,9 @@ namespace ams::controller {
         m_buttons.Y = src->input0x07.buttons.X;
 
         m_buttons.R  = src->input0x07.buttons.RB;
-        m_buttons.ZR = src->input0x07.right_trigger > (m_trigger_threshold * TriggerMax);
+        m_buttons.ZR = src->input0x07.right_trigger > this->GetTriggerThreshold<TriggerMax>();
         m_buttons.L  = src->input0x07.buttons.LB;
-        m_buttons.ZL = src->input0x07.left_trigger  > (m_trigger_threshold * TriggerMax);
+        m_buttons.ZL = src->input0x07.left_trigger  > this->GetTriggerThreshold<TriggerMax>();
 
         m_buttons.minus = src->input0x07.buttons.view;
         m_buttons.plus  = src->input0x07.buttons.menu;
@@ -21,7 +21,7 @@ namespace ams::controller {
     namespace {
 
         constexpr u8 TriggerMax = UINT8_MAX;
-        constexpr float MediaModeStickScaleFactor = float(UINT12_MAX) / 39;
+        constexpr s32 MediaModeStickRange = 39;
 
     }
 
@@ -48,18 +48,7 @@ namespace ams::controller {
         m_left_stick  = PackAnalogStickValues(src->input0x01.left_stick.x,  InvertAnalogStickValue(src->input0x01.left_stick.y));
         m_right_stick = PackAnalogStickValues(src->input0x01.right_stick.x, InvertAnalogStickValue(src->input0x01.right_stick.y));
 
-        m_buttons.dpad_down  = (src->input0x01.buttons.dpad == MadCatzDPad_S)  ||
-                               (src->input0x01.buttons.dpad == MadCatzDPad_SE) ||
-                               (src->input0x01.buttons.dpad == MadCatzDPad_SW);
-        m_buttons.dpad_up    = (src->input0x01.buttons.dpad == MadCatzDPad_N)  ||
-                               (src->input0x01.buttons.dpad == MadCatzDPad_NE) ||
-                               (src->input0x01.buttons.dpad == MadCatzDPad_NW);
-        m_buttons.dpad_right = (src->input0x01.buttons.dpad == MadCatzDPad_E)  ||
-                               (src->input0x01.buttons.dpad == MadCatzDPad_NE) ||
-                               (src->input0x01.buttons.dpad == MadCatzDPad_SE);
-        m_buttons.dpad_left  = (src->input0x01.buttons.dpad == MadCatzDPad_W)  ||
-                               (src->input0x01.buttons.dpad == MadCatzDPad_NW) ||
-                               (src->input0x01.buttons.dpad == MadCatzDPad_SW);
+        MapHatSwitch<MadCatzDPad_N>(&m_buttons, src->input0x01.buttons.dpad);
 
         m_buttons.A = src->input0x01.buttons.B;
         m_buttons.B = src->input0x01.buttons.A;
@@ -67,9 +56,9 @@ namespace ams::controller {
         m_buttons.Y = src->input0x01.buttons.X;
 
         m_buttons.R  = src->input0x01.buttons.R1;
-        m_buttons.ZR = src->input0x01.right_trigger > (m_trigger_threshold * TriggerMax);
+        m_buttons.ZR = src->input0x01.right_trigger > this->GetTriggerThreshold<TriggerMax>();
         m_buttons.L  = src->input0x01.buttons.L1;
-        m_buttons.ZL = src->input0x01.left_trigger  > (m_trigger_threshold * TriggerMax);
+        m_buttons.ZL = src->input0x01.left_trigger  > this->GetTriggerThreshold<TriggerMax>();
 
         m_buttons.minus = src->input0x01.buttons.select;
         m_buttons.plus  = src->input0x01.buttons.start;
@@ -89,18 +78,7 @@ namespace ams::controller {
         m_left_stick  = PackAnalogStickValues(src->input0x81.left_stick.x,  InvertAnalogStickValue(src->input0x81.left_stick.y));
         m_right_stick = PackAnalogStickValues(src->input0x81.right_stick.x, InvertAnalogStickValue(src->input0x81.right_stick.y));
 
-        m_buttons.dpad_down  = (src->input0x81.buttons.dpad == MadCatzDPad_S)  ||
-                               (src->input0x81.buttons.dpad == MadCatzDPad_SE) ||
-                               (src->input0x81.buttons.dpad == MadCatzDPad_SW);
-        m_buttons.dpad_up    = (src->input0x81.buttons.dpad == MadCatzDPad_N)  ||
-                               (src->input0x81.buttons.dpad == MadCatzDPad_NE) ||
-                               (src->input0x81.buttons.dpad == MadCatzDPad_NW);
-        m_buttons.dpad_right = (src->input0x81.buttons.dpad == MadCatzDPad_E)  ||
-                               (src->input0x81.buttons.dpad == MadCatzDPad_NE) ||
-                               (src->input0x81.buttons.dpad == MadCatzDPad_SE);
-        m_buttons.dpad_left  = (src->input0x81.buttons.dpad == MadCatzDPad_W)  ||
-                               (src->input0x81.buttons.dpad == MadCatzDPad_NW) ||
-                               (src->input0x81.buttons.dpad == MadCatzDPad_SW);
+        MapHatSwitch<MadCatzDPad_N>(&m_buttons, src->input0x81.buttons.dpad);
 
         m_buttons.A = src->input0x81.buttons.B;
         m_buttons.B = src->input0x81.buttons.A;
@@ -108,9 +86,9 @@ namespace ams::controller {
         m_buttons.Y = src->input0x81.buttons.X;
 
         m_buttons.R  = src->input0x81.buttons.R1;
-        m_buttons.ZR = src->input0x81.right_trigger > (m_trigger_threshold * TriggerMax);
+        m_buttons.ZR = src->input0x81.right_trigger > this->GetTriggerThreshold<TriggerMax>();
         m_buttons.L  = src->input0x81.buttons.L1;
-        m_buttons.ZL = src->input0x81.left_trigger  > (m_trigger_threshold * TriggerMax);
+        m_buttons.ZL = src->input0x81.left_trigger  > this->GetTriggerThreshold<TriggerMax>();
 
         m_buttons.minus = src->input0x81.buttons.select;
         m_buttons.plus  = src->input0x81.buttons.start;
@@ -137,8 +115,8 @@ namespace ams::controller {
 
     void MadCatzController::MapInputReport0x83(const MadCatzReportData *src) {
         m_left_stick.SetData(
-            std::clamp<u16>(MediaModeStickScaleFactor * -src->input0x83.left_stick.x + 0x7ff, SwitchAnalogStick::Min, SwitchAnalogStick::Max),
-            std::clamp<u16>(MediaModeStickScaleFactor *  src->input0x83.left_stick.y + 0x7ff, SwitchAnalogStick::Min, SwitchAnalogStick::Max)
+            std::clamp<s32>(ScaleAnalogStickValue<MediaModeStickRange>(-src->input0x83.left_stick.x) + 0x7ff, SwitchAnalogStick::Min, SwitchAnalogStick::Max),
+            std::clamp<s32>(ScaleAnalogStickValue<MediaModeStickRange>( src->input0x83.left_stick.y) + 0x7ff, SwitchAnalogStick::Min, SwitchAnalogStick::Max)
         );
 
         m_buttons.ZR = src->input0x83.buttons.R2;
@@ -60,16 +60,16 @@ namespace ams::controller {
         this->MapAnalogSticks(&src->input0x01.left_stick, &src->input0x01.right_stick);
         this->MapButtons(&src->input0x01.buttons, src->id == 0x01);
 
-        m_buttons.ZR = src->input0x01.right_trigger > (m_trigger_threshold * TriggerMax);
-        m_buttons.ZL = src->input0x01.left_trigger  > (m_trigger_threshold * TriggerMax);
+        m_buttons.ZR = src->input0x01.right_trigger > this->GetTriggerThreshold<TriggerMax>();
+        m_buttons.ZL = src->input0x01.left_trigger  > this->GetTriggerThreshold<TriggerMax>();
     }
 
     void MocuteController::MapInputReport0x04(const MocuteReportData *src) {
         this->MapAnalogSticks(&src->input0x04.left_stick, &src->input0x04.right_stick);
         this->MapButtons(&src->input0x04.buttons, 1);
 
-        m_buttons.ZR = src->input0x04.right_trigger > (m_trigger_threshold * TriggerMax);
-        m_buttons.ZL = src->input0x04.left_trigger  > (m_trigger_threshold * TriggerMax);
+        m_buttons.ZR = src->input0x04.right_trigger > this->GetTriggerThreshold<TriggerMax>();
+        m_buttons.ZL = src->input0x04.left_trigger  > this->GetTriggerThreshold<TriggerMax>();
     }
 
     void MocuteController::MapAnalogSticks(const AnalogStick<u8> *left_stick, const AnalogStick<u8> *right_stick) {
@@ -84,18 +84,7 @@ namespace ams::controller {
             dpad = (dpad == 0) ? MocuteDPad_Released : dpad - 1;
         }
 
-        m_buttons.dpad_down  = (dpad == MocuteDPad_S)  ||
-                               (dpad == MocuteDPad_SE) ||
-                               (dpad == MocuteDPad_SW);
-        m_buttons.dpad_up    = (dpad == MocuteDPad_N)  ||
-                               (dpad == MocuteDPad_NE) ||
-                               (dpad == MocuteDPad_NW);
-        m_buttons.dpad_right = (dpad == MocuteDPad_E)  ||
-                               (dpad == MocuteDPad_NE) ||
-                               (dpad == MocuteDPad_SE);
-        m_buttons.dpad_left  = (dpad == MocuteDPad_W)  ||
-                               (dpad == MocuteDPad_NW) ||
-                               (dpad == MocuteDPad_SW);
+        MapHatSwitch<MocuteDPad_N>(&m_buttons, dpad);
 
         m_buttons.A = buttons->B;
         m_buttons.B = buttons->A;
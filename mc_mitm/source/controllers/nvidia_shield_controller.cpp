@@ -41,18 +41,7 @@ namespace ams::controller {
         m_left_stick  = PackAnalogStickValues(src->input0x01.left_stick.x,  InvertAnalogStickValue(src->input0x01.left_stick.y));
         m_right_stick = PackAnalogStickValues(src->input0x01.right_stick.x, InvertAnalogStickValue(src->input0x01.right_stick.y));
 
-        m_buttons.dpad_down  = (src->input0x01.dpad == NvidiaShieldDPad_S)  ||
-                               (src->input0x01.dpad == NvidiaShieldDPad_SE) ||
-                               (src->input0x01.dpad == NvidiaShieldDPad_SW);
-        m_buttons.dpad_up    = (src->input0x01.dpad == NvidiaShieldDPad_N)  ||
-                               (src->input0x01.dpad == NvidiaShieldDPad_NE) ||
-                               (src->input0x01.dpad == NvidiaShieldDPad_NW);
-        m_buttons.dpad_right = (src->input0x01.dpad == NvidiaShieldDPad_E)  ||
-                               (src->input0x01.dpad == NvidiaShieldDPad_NE) ||
-                               (src->input0x01.dpad == NvidiaShieldDPad_SE);
-        m_buttons.dpad_left  = (src->input0x01.dpad == NvidiaShieldDPad_W)  ||
-                               (src->input0x01.dpad == NvidiaShieldDPad_NW) ||
-                               (src->input0x01.dpad == NvidiaShieldDPad_SW);
+        MapHatSwitch<NvidiaShieldDPad_N>(&m_buttons, src->input0x01.dpad);
 
         m_buttons.A = src->input0x01.buttons.B;
         m_buttons.B = src->input0x01.buttons.A;
@@ -60,9 +49,9 @@ namespace ams::controller {
         m_buttons.Y = src->input0x01.buttons.X;
 
         m_buttons.R  = src->input0x01.buttons.RB;
-        m_buttons.ZR = src->input0x01.right_trigger > (m_trigger_threshold * TriggerMax);
+        m_buttons.ZR = src->input0x01.right_trigger > this->GetTriggerThreshold<TriggerMax>();
         m_buttons.L  = src->input0x01.buttons.LB;
-        m_buttons.ZL = src->input0x01.left_trigger  > (m_trigger_threshold * TriggerMax);
+        m_buttons.ZL = src->input0x01.left_trigger  > this->GetTriggerThreshold<TriggerMax>();
 
         m_buttons.minus = src->input0x01.back;
         m_buttons.plus  = src->input0x01.buttons.start;
@@ -0,0 +1,79 @@
+/*
+ * Copyright (c) 2020-2025 ndeadly
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "output_report_limiter.hpp"
+#include "switch_rumble_handler.hpp"
+
+namespace ams::controller {
+
+    void OutputReportLimiter::Reset() {
+        m_last_write_timestamp = 0;
+        m_last_size = 0;
+        m_pending_size = 0;
+    }
+
+    OutputReportAction OutputReportLimiter::Submit(const bluetooth::HidReport *report, s64 now) {
+        if (report->size > MaxReportSize) {
+            return OutputReportAction_Write;
+        }
+
+        // A newer report always supersedes one that is still being held back
+        if (m_pending_size > 0) {
+            m_pending_size = 0;
+            ++m_suppressed_count;
+        }
+
+        const bool refresh_due = (m_refresh_interval > 0) && (now - m_last_write_timestamp >= m_refresh_interval);
+        if (!refresh_due && (report->size == m_last_size) && (std::memcmp(report->data, m_last_report, m_last_size) == 0)) {
+            ++m_suppressed_count;
+            return OutputReportAction_Drop;
+        }
+
+        if ((m_last_size > 0) && (now - m_last_write_timestamp < m_min_interval)) {
+            std::memcpy(m_pending_report, report->data, report->size);
+            m_pending_size = report->size;
+            return OutputReportAction_Defer;
+        }
+
+        return OutputReportAction_Write;
+    }
+
+    bool OutputReportLimiter::TakePendingReport(s64 now, bluetooth::HidReport *out_report) {
+        if ((m_pending_size == 0) || (now < m_last_write_timestamp + m_min_interval)) {
+            return false;
+        }
+
+        out_report->size = m_pending_size;
+        std::memcpy(out_report->data, m_pending_report, m_pending_size);
+        m_pending_size = 0;
+
+        return true;
+    }
+
+    s64 OutputReportLimiter::GetPendingDue() const {
+        return m_pending_size > 0 ? m_last_write_timestamp + m_min_interval : RumbleScheduleIdle;
+    }
+
+    void OutputReportLimiter::RecordWrite(const bluetooth::HidReport *report, s64 now) {
+        if (report->size > MaxReportSize) {
+            return;
+        }
+
+        std::memcpy(m_last_report, report->data, report->size);
+        m_last_size = report->size;
+        m_last_write_timestamp = now;
+    }
+
+}
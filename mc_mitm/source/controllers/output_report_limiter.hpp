@@ -0,0 +1,66 @@
+/*
+ * Copyright (c) 2020-2025 ndeadly
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+#include <stratosphere.hpp>
+#include "../bluetooth_mitm/bluetooth/bluetooth_types.hpp"
+
+namespace ams::controller {
+
+    enum OutputReportAction {
+        OutputReportAction_Write,
+        OutputReportAction_Drop,
+        OutputReportAction_Defer,
+    };
+
+    // Filters rumble/LED state reports so that unchanged state isn't resent and writes are kept a minimum interval apart.
+    // A report held back by the interval is replaced by any newer one and flushed once the interval has elapsed, so the latest state always reaches the controller.
+    // Controllers that only play a report for a limited time set a refresh interval, after which an unchanged report is written again
+    class OutputReportLimiter {
+        public:
+            // Large enough for every state report we send. Anything bigger is always written straight through
+            static constexpr size_t MaxReportSize = 0x50;
+
+            OutputReportLimiter() : m_min_interval(0), m_refresh_interval(0), m_last_write_timestamp(0), m_last_size(0), m_pending_size(0), m_suppressed_count(0) { }
+
+            void SetMinInterval(s64 interval) { m_min_interval = interval; }
+            void SetRefreshInterval(s64 interval) { m_refresh_interval = interval; }
+            void Reset();
+
+            OutputReportAction Submit(const bluetooth::HidReport *report, s64 now);
+
+            // Copies out the held back report once it's due to be written
+            bool TakePendingReport(s64 now, bluetooth::HidReport *out_report);
+            s64 GetPendingDue() const;
+
+            // Marks a report as sent. Only call this once the write has succeeded, so a failed write is retried by the next submission
+            void RecordWrite(const bluetooth::HidReport *report, s64 now);
+
+            u32 GetSuppressedCount() const { return m_suppressed_count; }
+
+        private:
+            s64 m_min_interval;
+            s64 m_refresh_interval;
+            s64 m_last_write_timestamp;
+
+            u16 m_last_size;
+            u16 m_pending_size;
+            u8 m_last_report[MaxReportSize];
+            u8 m_pending_report[MaxReportSize];
+
+            u32 m_suppressed_count;
+    };
+
+}
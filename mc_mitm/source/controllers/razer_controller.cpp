@@ -20,7 +20,35 @@ namespace ams::controller {
 
     namespace {
 
-        constexpr u8 TriggerMax = UINT8_MAX;
+        constexpr size_t ButtonsOffset = offsetof(RazerInputReport0x01, buttons);
+
+        constexpr ReportField InputReport0x01Layout[] = {
+            AxisField(ReportFieldTarget_LeftStickX,  offsetof(RazerInputReport0x01, left_stick.x),  8),
+            AxisField(ReportFieldTarget_LeftStickY,  offsetof(RazerInputReport0x01, left_stick.y),  8, ReportFieldFlag_Inverted),
+            AxisField(ReportFieldTarget_RightStickX, offsetof(RazerInputReport0x01, right_stick.x), 8),
+            AxisField(ReportFieldTarget_RightStickY, offsetof(RazerInputReport0x01, right_stick.y), 8, ReportFieldFlag_Inverted),
+
+            HatSwitchField(ButtonsOffset, 0, 4, RazerDPad_N),
+
+            ButtonField(ButtonsOffset + 0, 5, SwitchButton_A),
+            ButtonField(ButtonsOffset + 0, 4, SwitchButton_B),
+            ButtonField(ButtonsOffset + 0, 7, SwitchButton_X),
+            ButtonField(ButtonsOffset + 0, 6, SwitchButton_Y),
+
+            ButtonField(ButtonsOffset + 1, 1, SwitchButton_R),
+            TriggerField(offsetof(RazerInputReport0x01, right_trigger), 8, SwitchButton_ZR),
+            ButtonField(ButtonsOffset + 1, 0, SwitchButton_L),
+            TriggerField(offsetof(RazerInputReport0x01, left_trigger), 8, SwitchButton_ZL),
+
+            ButtonField(ButtonsOffset + 2, 0, SwitchButton_Minus),
+            ButtonField(ButtonsOffset + 1, 3, SwitchButton_Plus),
+
+            ButtonField(ButtonsOffset + 1, 4, SwitchButton_LStick),
+            ButtonField(ButtonsOffset + 1, 5, SwitchButton_RStick),
+
+            ButtonField(ButtonsOffset + 1, 2, SwitchButton_Capture),
+            ButtonField(ButtonsOffset + 1, 7, SwitchButton_Home),
+        };
 
     }
 
@@ -36,40 +64,7 @@ namespace ams::controller {
     }
 
     void RazerController::MapInputReport0x01(const RazerReportData *src) {
-        m_left_stick  = PackAnalogStickValues(src->input0x01.left_stick.x,  InvertAnalogStickValue(src->input0x01.left_stick.y));
-        m_right_stick = PackAnalogStickValues(src->input0x01.right_stick.x, InvertAnalogStickValue(src->input0x01.right_stick.y));
-
-        m_buttons.dpad_down  = (src->input0x01.buttons.dpad == RazerDPad_S)  ||
-                               (src->input0x01.buttons.dpad == RazerDPad_SE) ||
-                               (src->input0x01.buttons.dpad == RazerDPad_SW);
-        m_buttons.dpad_up    = (src->input0x01.buttons.dpad == RazerDPad_N)  ||
-                               (src->input0x01.buttons.dpad == RazerDPad_NE) ||
-                               (src->input0x01.buttons.dpad == RazerDPad_NW);
-        m_buttons.dpad_right = (src->input0x01.buttons.dpad == RazerDPad_E)  ||
-                               (src->input0x01.buttons.dpad == RazerDPad_NE) ||
-                               (src->input0x01.buttons.dpad == RazerDPad_SE);
-        m_buttons.dpad_left  = (src->input0x01.buttons.dpad == RazerDPad_W)  ||
-                               (src->input0x01.buttons.dpad == RazerDPad_NW) ||
-                               (src->input0x01.buttons.dpad == RazerDPad_SW);
-
-        m_buttons.A = src->input0x01.buttons.B;
-        m_buttons.B = src->input0x01.buttons.A;
-        m_buttons.X = src->input0x01.buttons.Y;
-        m_buttons.Y = src->input0x01.buttons.X;
-
-        m_buttons.R  = src->input0x01.buttons.R1;
-        m_buttons.ZR = src->input0x01.right_trigger > (m_trigger_threshold * TriggerMax);
-        m_buttons.L  = src->input0x01.buttons.L1;
-        m_buttons.ZL = src->input0x01.left_trigger  > (m_trigger_threshold * TriggerMax);
-
-        m_buttons.minus = src->input0x01.buttons.select;
-        m_buttons.plus  = src->input0x01.buttons.start;
-
-        m_buttons.lstick_press = src->input0x01.buttons.L3;
-        m_buttons.rstick_press = src->input0x01.buttons.R3;
-
-        m_buttons.capture = src->input0x01.buttons.back;
-        m_buttons.home    = src->input0x01.buttons.home;
+        this->MapReportLayout<InputReport0x01Layout>(reinterpret_cast<const u8 *>(&src->input0x01));
     }
 
 }
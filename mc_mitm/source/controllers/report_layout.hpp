@@ -0,0 +1,220 @@
+/*
+ * Copyright (c) 2020-2025 ndeadly
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+#include "switch_controller.hpp"
+#include "controller_utils.hpp"
+#include <utility>
+
+namespace ams::controller {
+
+    enum ReportFieldTarget : u8 {
+        ReportFieldTarget_Button,
+        ReportFieldTarget_HatSwitch,
+        ReportFieldTarget_Trigger,
+        ReportFieldTarget_LeftStickX,
+        ReportFieldTarget_LeftStickY,
+        ReportFieldTarget_RightStickX,
+        ReportFieldTarget_RightStickY,
+        ReportFieldTarget_Battery100,
+        ReportFieldTarget_Battery255,
+    };
+
+    enum ReportFieldFlags : u8 {
+        ReportFieldFlag_None     = 0,
+        ReportFieldFlag_Signed   = BIT(0),
+        ReportFieldFlag_Inverted = BIT(1),
+    };
+
+    // Location of a value within a report, counted in bits from the first byte after the report id, and what it drives on the Switch side
+    struct ReportField {
+        ReportFieldTarget target;
+        u16 bit_offset;
+        u8 width;
+        u8 flags;
+        u32 arg;    // Button/Trigger: SwitchButton mask to set. HatSwitch: value the hat reports for north
+    };
+
+    constexpr ReportField ButtonField(size_t byte, u8 bit, u32 button) {
+        return { ReportFieldTarget_Button, u16(8 * byte + bit), 1, ReportFieldFlag_None, button };
+    }
+
+    constexpr ReportField HatSwitchField(size_t byte, u8 bit, u8 width, u8 north) {
+        return { ReportFieldTarget_HatSwitch, u16(8 * byte + bit), width, ReportFieldFlag_None, north };
+    }
+
+    // Trigger values are compared against the configured threshold of the field's full range
+    constexpr ReportField TriggerField(size_t byte, u8 width, u32 button) {
+        return { ReportFieldTarget_Trigger, u16(8 * byte), width, ReportFieldFlag_None, button };
+    }
+
+    constexpr ReportField AxisField(ReportFieldTarget axis, size_t byte, u8 width, u8 flags = ReportFieldFlag_None) {
+        return { axis, u16(8 * byte), width, flags, 0 };
+    }
+
+    constexpr ReportField BatteryField(ReportFieldTarget battery, size_t byte) {
+        return { battery, u16(8 * byte), 8, ReportFieldFlag_None, 0 };
+    }
+
+    // Generates the mapping code for a report described by an array of ReportFields. Every field is a compile time
+    // constant, so extraction reduces to the same loads, shifts and masks a hand written mapper would use
+    template<const auto &Fields>
+    class ReportLayout {
+
+        private:
+            static constexpr size_t FieldCount = util::size(Fields);
+
+            template<ReportFieldTarget Target>
+            static constexpr bool HasTarget() {
+                for (const auto &field : Fields) {
+                    if (field.target == Target) {
+                        return true;
+                    }
+                }
+                return false;
+            }
+
+            static constexpr u32 GetButtonMask() {
+                u32 mask = 0;
+                for (const auto &field : Fields) {
+                    if (field.target == ReportFieldTarget_Button || field.target == ReportFieldTarget_Trigger) {
+                        mask |= field.arg;
+                    } else if (field.target == ReportFieldTarget_HatSwitch) {
+                        mask |= SwitchButton_DpadDown | SwitchButton_DpadUp | SwitchButton_DpadRight | SwitchButton_DpadLeft;
+                    }
+                }
+                return mask;
+            }
+
+            static constexpr bool Validate() {
+                for (const auto &field : Fields) {
+                    if (field.width == 0 || field.width > 16) {
+                        return false;
+                    }
+                }
+                return true;
+            }
+
+            static_assert(Validate(), "Report fields must be between 1 and 16 bits wide");
+
+            struct Values {
+                u32 buttons;
+                u16 axes[4];
+                u8 battery;
+            };
+
+            template<size_t Offset, size_t Width>
+            static ALWAYS_INLINE u32 Extract(const u8 *data) {
+                constexpr size_t First = Offset / 8;
+                constexpr size_t Shift = Offset % 8;
+                constexpr size_t Bytes = (Shift + Width + 7) / 8;
+
+                u32 value = 0;
+                for (size_t i = 0; i < Bytes; ++i) {
+                    value |= u32(data[First + i]) << (8 * i);
+                }
+                return (value >> Shift) & ((u32(1) << Width) - 1);
+            }
+
+            // Matches ConvertAnalogStick12Bit for byte aligned fields, with InvertAnalogStickValue applied first when inverted
+            template<size_t Width, u8 Flags>
+            static constexpr u16 ConvertAxis(u32 value) {
+                constexpr u32 Max = (u32(1) << Width) - 1;
+
+                if constexpr (Flags & ReportFieldFlag_Signed) {
+                    value = (value + (Max >> 1) + 1) & Max;
+                }
+                if constexpr (Flags & ReportFieldFlag_Inverted) {
+                    value = Max - value;
+                }
+                return static_cast<u16>(u64(value) * UINT12_MAX / Max);
+            }
+
+            template<size_t Index>
+            static ALWAYS_INLINE void DecodeField(const u8 *data, const TriggerThresholds &trigger_thresholds, Values *out) {
+                constexpr ReportField Field = Fields[Index];
+                const u32 value = Extract<Field.bit_offset, Field.width>(data);
+
+                if constexpr (Field.target == ReportFieldTarget_Button) {
+                    out->buttons |= value ? Field.arg : 0;
+                } else if constexpr (Field.target == ReportFieldTarget_HatSwitch) {
+                    out->buttons |= u32(hat_switch_table<u8(Field.arg)>.dpad[value]) << 16;
+                } else if constexpr (Field.target == ReportFieldTarget_Trigger) {
+                    out->buttons |= int(value) > trigger_thresholds.Get<(u32(1) << Field.width) - 1>() ? Field.arg : 0;
+                } else if constexpr (Field.target >= ReportFieldTarget_LeftStickX && Field.target <= ReportFieldTarget_RightStickY) {
+                    out->axes[Field.target - ReportFieldTarget_LeftStickX] = ConvertAxis<Field.width, Field.flags>(value);
+                } else if constexpr (Field.target == ReportFieldTarget_Battery100) {
+                    out->battery = convert_battery_100(value);
+                } else if constexpr (Field.target == ReportFieldTarget_Battery255) {
+                    out->battery = convert_battery_255(value);
+                }
+            }
+
+            template<size_t... Indices>
+            static ALWAYS_INLINE void Decode(const u8 *data, const TriggerThresholds &trigger_thresholds, Values *out, std::index_sequence<Indices...>) {
+                (DecodeField<Indices>(data, trigger_thresholds, out), ...);
+            }
+
+            // Packs the axes in place like PackAnalogStickValues does, rather than calling out to SwitchAnalogStick's setters for every report
+            template<ReportFieldTarget X, ReportFieldTarget Y>
+            static ALWAYS_INLINE void ApplyStick(const Values *values, SwitchAnalogStick *stick) {
+                const u16 x = values->axes[X - ReportFieldTarget_LeftStickX];
+                const u16 y = values->axes[Y - ReportFieldTarget_LeftStickX];
+
+                if constexpr (HasTarget<X>()) {
+                    stick->m_xy[0] = x & 0xff;
+                }
+                if constexpr (HasTarget<X>() && HasTarget<Y>()) {
+                    stick->m_xy[1] = (x >> 8) | ((y & 0xff) << 4);
+                } else if constexpr (HasTarget<X>()) {
+                    stick->m_xy[1] = (stick->m_xy[1] & 0xf0) | (x >> 8);
+                } else if constexpr (HasTarget<Y>()) {
+                    stick->m_xy[1] = (stick->m_xy[1] & 0x0f) | ((y & 0xff) << 4);
+                }
+                if constexpr (HasTarget<Y>()) {
+                    stick->m_xy[2] = (y >> 4) & 0xff;
+                }
+            }
+
+        public:
+            // Only the buttons, sticks and battery described by the layout are written
+            static void Map(const u8 *data, const TriggerThresholds &trigger_thresholds, SwitchButtonData *buttons, SwitchAnalogStick *left_stick, SwitchAnalogStick *right_stick, u8 *battery) {
+                Values values = {};
+                Decode(data, trigger_thresholds, &values, std::make_index_sequence<FieldCount>());
+
+                // Merged a byte at a time. Copying the three bytes in and out of a word goes through the stack, and the wide load
+                // after narrow stores can't be forwarded
+                constexpr u32 Mask = GetButtonMask();
+                auto bytes = reinterpret_cast<u8 *>(buttons);
+                for (size_t i = 0; i < sizeof(SwitchButtonData); ++i) {
+                    const u8 byte_mask = Mask >> (8 * i);
+                    if (byte_mask == 0xff) {
+                        bytes[i] = values.buttons >> (8 * i);
+                    } else if (byte_mask != 0) {
+                        bytes[i] = (bytes[i] & ~byte_mask) | u8(values.buttons >> (8 * i));
+                    }
+                }
+
+                ApplyStick<ReportFieldTarget_LeftStickX, ReportFieldTarget_LeftStickY>(&values, left_stick);
+                ApplyStick<ReportFieldTarget_RightStickX, ReportFieldTarget_RightStickY>(&values, right_stick);
+
+                if constexpr (HasTarget<ReportFieldTarget_Battery100>() || HasTarget<ReportFieldTarget_Battery255>()) {
+                    *battery = values.battery;
+                }
+            }
+
+    };
+
+}
@@ -0,0 +1,70 @@
+/*
+ * Copyright (c) 2020-2025 ndeadly
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "rumble_response.hpp"
+
+namespace ams::controller {
+
+    namespace {
+
+        constexpr float MaxFrequencyOctaves = 2.0f;
+
+        void CompileFrequencyGain(float frequency_rolloff, float center_frequency, RumbleResponseTable *out) {
+            out->frequency_scale = (1 << RumbleFrequencyShift) / center_frequency;
+
+            for (size_t i = 0; i < RumbleFrequencySteps; ++i) {
+                // Switch frequencies stay within two octaves of the band centre
+                const float ratio = float(i) / (1 << RumbleFrequencyShift);
+                const float octaves = ratio > 0.0f ? std::min(std::fabs(std::log2(ratio)), MaxFrequencyOctaves) : MaxFrequencyOctaves;
+                out->frequency_gain[i] = static_cast<u8>(std::clamp(1.0f - frequency_rolloff * octaves, 0.0f, 1.0f) * 0xff);
+            }
+        }
+
+    }
+
+    void CompileRumbleResponse(float deadzone, float threshold, float saturation, float curve, float frequency_rolloff, float center_frequency, u8 output_max, RumbleResponseTable *out) {
+        out->amplitude_scale = RumbleAmplitudeSteps - 1;
+        CompileFrequencyGain(frequency_rolloff, center_frequency, out);
+
+        out->duty[0] = 0;
+        for (size_t i = 1; i < RumbleAmplitudeSteps; ++i) {
+            const float amplitude = float(i) / (RumbleAmplitudeSteps - 1);
+            if (amplitude < deadzone) {
+                out->duty[i] = 0;
+                continue;
+            }
+
+            const float duty = threshold + (saturation - threshold) * std::pow(amplitude, curve);
+            out->duty[i] = static_cast<u8>(std::clamp(duty, 0.0f, 1.0f) * output_max + 0.5f);
+        }
+    }
+
+    void CompileLinearRumbleResponse(float center_frequency, u8 output_max, RumbleResponseTable *out) {
+        out->amplitude_scale = output_max;
+        CompileFrequencyGain(0.0f, center_frequency, out);
+
+        for (size_t i = 0; i < RumbleAmplitudeSteps; ++i) {
+            out->duty[i] = std::min<size_t>(i, output_max);
+        }
+    }
+
+    void ApplyRumbleResponse(const RumbleResponseProfile *profile, const SwitchMotorData *motor_data, u8 *out_strong, u8 *out_weak) {
+        *out_strong = std::max(ApplyRumbleResponse(&profile->strong, motor_data->left_motor.low_band_amp,  motor_data->left_motor.low_band_freq),
+                               ApplyRumbleResponse(&profile->strong, motor_data->right_motor.low_band_amp, motor_data->right_motor.low_band_freq));
+        *out_weak   = std::max(ApplyRumbleResponse(&profile->weak,   motor_data->left_motor.high_band_amp,  motor_data->left_motor.high_band_freq),
+                               ApplyRumbleResponse(&profile->weak,   motor_data->right_motor.high_band_amp, motor_data->right_motor.high_band_freq));
+    }
+
+}
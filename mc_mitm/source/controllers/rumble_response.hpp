@@ -0,0 +1,70 @@
+/*
+ * Copyright (c) 2020-2025 ndeadly
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+#include <switch.h>
+#include "switch_rumble_handler.hpp"
+
+namespace ams::controller {
+
+    enum RumbleProfile {
+        RumbleProfile_Dualshock3,
+        RumbleProfile_Dualshock4,
+        RumbleProfile_Dualsense,
+        RumbleProfile_XboxOne,
+        RumbleProfile_Wii,
+        RumbleProfile_Count
+    };
+
+    // Full scale motor power in each controller's output report
+    constexpr u8 RumbleProfileOutputMax[RumbleProfile_Count] = { 0xff, 0xff, 0xff, 100, 0xff };
+
+    // Motor duty for each decoded amplitude, indexed by the amplitude scaled by the table's amplitude_scale (at most 8 bits)
+    constexpr size_t RumbleAmplitudeSteps = 0x100;
+
+    // Gain for each frequency in steps of 1/8 of the band centre frequency, up to 4x the centre
+    constexpr size_t RumbleFrequencyShift = 3;
+    constexpr size_t RumbleFrequencySteps = (4 << RumbleFrequencyShift) + 1;
+
+    struct RumbleResponseTable {
+        float amplitude_scale;
+        float frequency_scale;
+        u8 duty[RumbleAmplitudeSteps];
+        u8 frequency_gain[RumbleFrequencySteps];
+    };
+
+    // Tables for the heavy motor driven by the low band and the light motor driven by the high band
+    struct RumbleResponseProfile {
+        RumbleResponseTable strong;
+        RumbleResponseTable weak;
+    };
+
+    // Deadzone is the amplitude below which the motor is left off. Nonzero amplitudes above it are mapped between the threshold and saturation duties with curve as the exponent.
+    // Frequency rolloff is the fraction of amplitude lost per octave away from the band centre frequency. All but the curve are fractions of full scale
+    void CompileRumbleResponse(float deadzone, float threshold, float saturation, float curve, float frequency_rolloff, float center_frequency, u8 output_max, RumbleResponseTable *out);
+
+    // Maps amplitude straight to output_max * amplitude. The table is indexed at the output resolution, so the result is exact for any output_max
+    void CompileLinearRumbleResponse(float center_frequency, u8 output_max, RumbleResponseTable *out);
+
+    ALWAYS_INLINE u8 ApplyRumbleResponse(const RumbleResponseTable *table, float amplitude, float frequency) {
+        // Frequency scales the amplitude before the curve so weakened rumble still clears the motor threshold
+        const u8 gain = table->frequency_gain[std::min<size_t>(frequency * table->frequency_scale, RumbleFrequencySteps - 1)];
+        return table->duty[static_cast<u8>(amplitude * table->amplitude_scale) * gain / 0xff];
+    }
+
+    // Combines both sides of the Switch rumble data into duties for the strong and weak motors of a controller
+    void ApplyRumbleResponse(const RumbleResponseProfile *profile, const SwitchMotorData *motor_data, u8 *out_strong, u8 *out_weak);
+
+}
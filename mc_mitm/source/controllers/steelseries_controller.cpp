@@ -53,18 +53,7 @@ namespace ams::controller {
         m_left_stick  = PackAnalogStickValues(src->input0x01.left_stick.x,  InvertAnalogStickValue(src->input0x01.left_stick.y));
         m_right_stick = PackAnalogStickValues(src->input0x01.right_stick.x, InvertAnalogStickValue(src->input0x01.right_stick.y));
 
-        m_buttons.dpad_down  = (src->input0x01.dpad == SteelseriesDPad_S)  ||
-                               (src->input0x01.dpad == SteelseriesDPad_SE) ||
-                               (src->input0x01.dpad == SteelseriesDPad_SW);
-        m_buttons.dpad_up    = (src->input0x01.dpad == SteelseriesDPad_N)  ||
-                               (src->input0x01.dpad == SteelseriesDPad_NE) ||
-                               (src->input0x01.dpad == SteelseriesDPad_NW);
-        m_buttons.dpad_right = (src->input0x01.dpad == SteelseriesDPad_E)  ||
-                               (src->input0x01.dpad == SteelseriesDPad_NE) ||
-                               (src->input0x01.dpad == SteelseriesDPad_SE);
-        m_buttons.dpad_left  = (src->input0x01.dpad == SteelseriesDPad_W)  ||
-                               (src->input0x01.dpad == SteelseriesDPad_NW) ||
-                               (src->input0x01.dpad == SteelseriesDPad_SW);
+        MapHatSwitch<SteelseriesDPad_N>(&m_buttons, src->input0x01.dpad);
 
         m_buttons.A = src->input0x01.buttons.B;
         m_buttons.B = src->input0x01.buttons.A;
@@ -82,18 +71,7 @@ namespace ams::controller {
         m_left_stick  = PackAnalogStickValues(src->input0x01_v2.left_stick.x,  InvertAnalogStickValue(src->input0x01_v2.left_stick.y));
         m_right_stick = PackAnalogStickValues(src->input0x01_v2.right_stick.x, InvertAnalogStickValue(src->input0x01_v2.right_stick.y));
 
-        m_buttons.dpad_down  = (src->input0x01_v2.dpad == SteelseriesDPad_S)  ||
-                               (src->input0x01_v2.dpad == SteelseriesDPad_SE) ||
-                               (src->input0x01_v2.dpad == SteelseriesDPad_SW);
-        m_buttons.dpad_up    = (src->input0x01_v2.dpad == SteelseriesDPad_N)  ||
-                               (src->input0x01_v2.dpad == SteelseriesDPad_NE) ||
-                               (src->input0x01_v2.dpad == SteelseriesDPad_NW);
-        m_buttons.dpad_right = (src->input0x01_v2.dpad == SteelseriesDPad_E)  ||
-                               (src->input0x01_v2.dpad == SteelseriesDPad_NE) ||
-                               (src->input0x01_v2.dpad == SteelseriesDPad_SE);
-        m_buttons.dpad_left  = (src->input0x01_v2.dpad == SteelseriesDPad_W)  ||
-                               (src->input0x01_v2.dpad == SteelseriesDPad_NW) ||
-                               (src->input0x01_v2.dpad == SteelseriesDPad_SW);
+        MapHatSwitch<SteelseriesDPad_N>(&m_buttons, src->input0x01_v2.dpad);
 
         m_buttons.A = src->input0x01_v2.buttons.B;
         m_buttons.B = src->input0x01_v2.buttons.A;
@@ -124,18 +102,7 @@ namespace ams::controller {
         m_left_stick  = PackAnalogStickValues(src->input0xc4.left_stick.x,  InvertAnalogStickValue(src->input0xc4.left_stick.y));
         m_right_stick = PackAnalogStickValues(src->input0xc4.right_stick.x, InvertAnalogStickValue(src->input0xc4.right_stick.y));
 
-        m_buttons.dpad_down  = (src->input0xc4.dpad == SteelseriesDPad2_S)  ||
-                               (src->input0xc4.dpad == SteelseriesDPad2_SE) ||
-                               (src->input0xc4.dpad == SteelseriesDPad2_SW);
-        m_buttons.dpad_up    = (src->input0xc4.dpad == SteelseriesDPad2_N)  ||
-                               (src->input0xc4.dpad == SteelseriesDPad2_NE) ||
-                               (src->input0xc4.dpad == SteelseriesDPad2_NW);
-        m_buttons.dpad_right = (src->input0xc4.dpad == SteelseriesDPad2_E)  ||
-                               (src->input0xc4.dpad == SteelseriesDPad2_NE) ||
-                               (src->input0xc4.dpad == SteelseriesDPad2_SE);
-        m_buttons.dpad_left  = (src->input0xc4.dpad == SteelseriesDPad2_W)  ||
-                               (src->input0xc4.dpad == SteelseriesDPad2_NW) ||
-                               (src->input0xc4.dpad == SteelseriesDPad2_SW);
+        MapHatSwitch<SteelseriesDPad2_N>(&m_buttons, src->input0xc4.dpad);
 
         m_buttons.A = src->input0xc4.buttons.B;
         m_buttons.B = src->input0xc4.buttons.A;
@@ -143,9 +110,9 @@ namespace ams::controller {
         m_buttons.Y = src->input0xc4.buttons.X;
 
         m_buttons.R  = src->input0xc4.buttons.R1;
-        m_buttons.ZR = src->input0xc4.right_trigger > (m_trigger_threshold * TriggerMax);
+        m_buttons.ZR = src->input0xc4.right_trigger > this->GetTriggerThreshold<TriggerMax>();
         m_buttons.L  = src->input0xc4.buttons.L1;
-        m_buttons.ZL = src->input0xc4.left_trigger  > (m_trigger_threshold * TriggerMax);
+        m_buttons.ZL = src->input0xc4.left_trigger  > this->GetTriggerThreshold<TriggerMax>();
 
         m_buttons.lstick_press = src->input0xc4.buttons.L3;
         m_buttons.rstick_press = src->input0xc4.buttons.R3;   
@@ -14,6 +14,8 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 #include "switch_analog_stick.hpp"
+#include <algorithm>
+#include <cmath>
 
 namespace ams::controller {
 
@@ -51,4 +53,57 @@ namespace ams::controller {
         m_xy[2] ^= 0xff;
     }
 
+    void CompileAnalogStickResponse(float inner_deadzone, float outer_deadzone, float anti_deadzone, float curve, bool invert_x, bool invert_y, AnalogStickResponseTable *out) {
+        // The table pulls the corners of square-gated sticks in onto a circle, so only remap the radius when the profile actually reshapes it
+        out->remap_radius = (inner_deadzone > 0.0f) || (outer_deadzone > 0.0f) || (anti_deadzone > 0.0f) || (curve != 1.0f);
+        out->enabled = out->remap_radius || invert_x || invert_y;
+        out->invert_x = invert_x;
+        out->invert_y = invert_y;
+
+        if (!out->remap_radius) {
+            return;
+        }
+
+        const float live_range = std::max(1.0f - inner_deadzone - outer_deadzone, 0.001f);
+        for (size_t i = 0; i < AnalogStickRadiusSteps; ++i) {
+            const float radius = float(i << AnalogStickRadiusShift) / SwitchAnalogStick::Center;
+            if (radius <= inner_deadzone) {
+                out->radius[i] = 0;
+                continue;
+            }
+
+            const float t = std::pow(std::clamp((radius - inner_deadzone) / live_range, 0.0f, 1.0f), curve);
+            out->radius[i] = static_cast<u16>((anti_deadzone + (1.0f - anti_deadzone) * t) * SwitchAnalogStick::Center);
+        }
+    }
+
+    void ApplyAnalogStickResponse(const AnalogStickResponseTable *table, SwitchAnalogStick *stick) {
+        if (table->remap_radius) {
+            const s32 dx = s32(stick->GetX()) - SwitchAnalogStick::Center;
+            const s32 dy = s32(stick->GetY()) - SwitchAnalogStick::Center;
+
+            // Scale both axes by the same factor so the stick direction is preserved
+            const s32 radius = static_cast<s32>(std::sqrt(float(dx * dx + dy * dy)));
+            s32 x = SwitchAnalogStick::Center;
+            s32 y = SwitchAnalogStick::Center;
+            if (radius > 0) {
+                // Interpolate between the two nearest table entries
+                const size_t index = std::min<size_t>(radius >> AnalogStickRadiusShift, AnalogStickRadiusSteps - 2);
+                const s32 fraction = std::min<s32>(radius - (index << AnalogStickRadiusShift), 1 << AnalogStickRadiusShift);
+                const s32 out_radius = table->radius[index] + (((table->radius[index + 1] - table->radius[index]) * fraction) >> AnalogStickRadiusShift);
+                x += dx * out_radius / radius;
+                y += dy * out_radius / radius;
+            }
+
+            stick->SetData(std::clamp<s32>(x, SwitchAnalogStick::Min, SwitchAnalogStick::Max), std::clamp<s32>(y, SwitchAnalogStick::Min, SwitchAnalogStick::Max));
+        }
+
+        if (table->invert_x) {
+            stick->InvertX();
+        }
+        if (table->invert_y) {
+            stick->InvertY();
+        }
+    }
+
 }
@@ -37,6 +37,22 @@ namespace ams::controller {
         u8 m_xy[3];
     };
 
+    // Output radius for each input radius, in steps of 8 from the stick centre out to the corners of the 12-bit range
+    constexpr size_t AnalogStickRadiusShift = 3;
+    constexpr size_t AnalogStickRadiusSteps = (0xb50 >> AnalogStickRadiusShift) + 1;
+
+    struct AnalogStickResponseTable {
+        bool enabled;
+        bool remap_radius;
+        bool invert_x;
+        bool invert_y;
+        u16 radius[AnalogStickRadiusSteps];
+    };
+
+    // Deadzones are fractions of the full stick radius, curve is the exponent applied between them
+    void CompileAnalogStickResponse(float inner_deadzone, float outer_deadzone, float anti_deadzone, float curve, bool invert_x, bool invert_y, AnalogStickResponseTable *out);
+    void ApplyAnalogStickResponse(const AnalogStickResponseTable *table, SwitchAnalogStick *stick);
+
     struct SwitchAnalogStickFactoryCalibration {
         u8 calib[9];
     };
@@ -50,16 +66,22 @@ namespace ams::controller {
         return ~t;
     }
 
+    // Scales a value from a range spanning Max to the 12-bit stick range. Max is a constant, so the divide compiles down to a multiply and shift
+    template<s32 Max>
+    constexpr s32 ScaleAnalogStickValue(s32 value) {
+        return value * s32(UINT12_MAX) / Max;
+    }
+
     template<typename T> requires std::integral<T>
     constexpr u16 ConvertAnalogStick12Bit(T t) {
-        constexpr std::make_unsigned_t<T> UnsignedTMax = ~0;
-        constexpr double ScaleFactor = double(UINT12_MAX) / UnsignedTMax ;
+        using UnsignedT = std::make_unsigned_t<T>;
+        constexpr UnsignedT UnsignedTMax = ~0;
 
         if constexpr (std::is_unsigned_v<T>) {
-            return static_cast<u16>(ScaleFactor * t);
+            return static_cast<u16>(u64(t) * UINT12_MAX / UnsignedTMax);
         } else {
-            constexpr std::make_unsigned_t<T> Shift = (UnsignedTMax >> 1) + 1;
-            return static_cast<u16>((ScaleFactor * (t + Shift)) );
+            constexpr UnsignedT Shift = (UnsignedTMax >> 1) + 1;
+            return static_cast<u16>(u64(static_cast<UnsignedT>(t + Shift)) * UINT12_MAX / UnsignedTMax);
         }
     }
 
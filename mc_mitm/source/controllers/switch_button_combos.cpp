@@ -0,0 +1,103 @@
+/*
+ * Copyright (c) 2020-2025 ndeadly
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "switch_button_combos.hpp"
+#include "switch_controller.hpp"
+#include "../mcmitm_config.hpp"
+
+namespace ams::controller {
+
+    void CompileButtonRemap(const u32 *mapping, ButtonRemapTable *out) {
+        for (unsigned int byte = 0; byte < util::size(out->lut); ++byte) {
+            for (unsigned int value = 0; value < util::size(out->lut[byte]); ++value) {
+                u32 mask = 0;
+                for (unsigned int bit = 0; bit < 8; ++bit) {
+                    if (value & BIT(bit)) {
+                        mask |= mapping[8 * byte + bit];
+                    }
+                }
+
+                out->lut[byte][value] = mask;
+            }
+        }
+    }
+
+    void ApplyButtonRemap(const ButtonRemapTable *table, SwitchButtonData *buttons) {
+        auto bytes = reinterpret_cast<const u8 *>(buttons);
+        const u32 word = table->lut[0][bytes[0]] | table->lut[1][bytes[1]] | table->lut[2][bytes[2]];
+        std::memcpy(buttons, &word, sizeof(SwitchButtonData));
+    }
+
+    SwitchButtonComboEngine::SwitchButtonComboEngine()
+    : SwitchButtonComboEngine(&mitm::GetGlobalConfig()->button_combos) { }
+
+    void SwitchButtonComboEngine::Apply(SwitchButtonData *buttons) {
+        u32 word = 0;
+        std::memcpy(&word, buttons, sizeof(SwitchButtonData));
+
+        const s64 now = os::GetSystemTick().GetInt64Value();
+
+        for (unsigned int i = 0; i < m_rules->count; ++i) {
+            const ButtonComboRule *rule = &m_rules->rules[i];
+            RuleState *state = &m_states[i];
+
+            // Rules are evaluated in order, so earlier rules can consume buttons from later ones
+            const bool held = (word & rule->chord) == rule->chord;
+            if (held && !state->held) {
+                state->pressed_tick = now;
+            }
+
+            switch (rule->type) {
+                case ButtonComboType_Combo:
+                    if (held && (now - state->pressed_tick >= rule->hold)) {
+                        word = (word & ~rule->chord) | rule->output;
+                    }
+                    break;
+                case ButtonComboType_Turbo:
+                    if (held) {
+                        const u32 released = ((now - state->pressed_tick) % rule->period) >= (rule->period / 2);
+                        word &= ~(rule->output & -released);
+                    }
+                    break;
+                case ButtonComboType_Macro:
+                    // Start playback on the press edge. Once started, the macro runs to completion
+                    if (held && !state->held && !state->playing) {
+                        state->playing = true;
+                        state->step = 0;
+                        state->step_tick = now;
+                    }
+
+                    if (state->playing) {
+                        while ((state->step < rule->step_count) && (now - state->step_tick >= rule->steps[state->step].duration)) {
+                            state->step_tick += rule->steps[state->step].duration;
+                            ++state->step;
+                        }
+
+                        state->playing = state->step < rule->step_count;
+                        if (state->playing) {
+                            word = (word & ~rule->chord) | rule->steps[state->step].buttons;
+                        }
+                    }
+                    break;
+                AMS_UNREACHABLE_DEFAULT_CASE();
+            }
+
+            state->held = held;
+        }
+
+        std::memcpy(buttons, &word, sizeof(SwitchButtonData));
+    }
+
+}
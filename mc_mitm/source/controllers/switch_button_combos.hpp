@@ -0,0 +1,107 @@
+/*
+ * Copyright (c) 2020-2025 ndeadly
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+#include <stratosphere.hpp>
+
+namespace ams::controller {
+
+    // Button bits when SwitchButtonData is treated as a 24-bit little-endian word
+    enum SwitchButton : u32 {
+        SwitchButton_Y         = BIT(0),
+        SwitchButton_X         = BIT(1),
+        SwitchButton_B         = BIT(2),
+        SwitchButton_A         = BIT(3),
+        SwitchButton_R         = BIT(6),
+        SwitchButton_ZR        = BIT(7),
+        SwitchButton_Minus     = BIT(8),
+        SwitchButton_Plus      = BIT(9),
+        SwitchButton_RStick    = BIT(10),
+        SwitchButton_LStick    = BIT(11),
+        SwitchButton_Home      = BIT(12),
+        SwitchButton_Capture   = BIT(13),
+        SwitchButton_DpadDown  = BIT(16),
+        SwitchButton_DpadUp    = BIT(17),
+        SwitchButton_DpadRight = BIT(18),
+        SwitchButton_DpadLeft  = BIT(19),
+        SwitchButton_L         = BIT(22),
+        SwitchButton_ZL        = BIT(23),
+    };
+
+    constexpr size_t SwitchButtonBits = 24;
+
+    // Remaps each byte of the button word separately, so remapping is three lookups ORed together
+    struct ButtonRemapTable {
+        u32 lut[3][0x100];
+    };
+
+    enum ButtonComboType : u8 {
+        ButtonComboType_Combo,
+        ButtonComboType_Turbo,
+        ButtonComboType_Macro,
+    };
+
+    constexpr size_t MaxButtonComboRules = 16;
+    constexpr size_t MaxButtonMacroSteps = 8;
+
+    struct ButtonMacroStep {
+        u32 buttons;
+        s64 duration;
+    };
+
+    // Durations are stored in system ticks so evaluation doesn't need any conversions
+    struct ButtonComboRule {
+        ButtonComboType type;
+        u32 chord;      // Buttons that trigger the rule
+        u32 output;     // Combo: buttons reported in place of the chord. Turbo: buttons that are pulsed
+        s64 hold;       // Combo: time the chord must be held before it fires
+        s64 period;     // Turbo: length of one press/release cycle
+        u8 step_count;  // Macro: number of steps played back in place of the chord
+        ButtonMacroStep steps[MaxButtonMacroSteps];
+    };
+
+    struct ButtonComboRuleSet {
+        ButtonComboRule rules[MaxButtonComboRules];
+        u8 count;
+    };
+
+    struct SwitchButtonData;
+
+    void CompileButtonRemap(const u32 *mapping, ButtonRemapTable *out);
+    void ApplyButtonRemap(const ButtonRemapTable *table, SwitchButtonData *buttons);
+
+    class SwitchButtonComboEngine {
+
+        public:
+            SwitchButtonComboEngine();
+            SwitchButtonComboEngine(const ButtonComboRuleSet *rules) : m_rules(rules), m_states() { }
+
+            void Apply(SwitchButtonData *buttons);
+
+        private:
+            struct RuleState {
+                s64 pressed_tick;
+                s64 step_tick;
+                bool held;
+                bool playing;
+                u8 step;
+            };
+
+            const ButtonComboRuleSet *m_rules;
+            RuleState m_states[MaxButtonComboRules];
+
+    };
+
+}
@@ -15,6 +15,7 @@
  */
 #include "switch_controller.hpp"
 #include "../mcmitm_config.hpp"
+#include "../mcmitm_heap.hpp"
 #include <string>
 
 namespace ams::controller {
@@ -78,11 +79,7 @@ namespace ams::controller {
             report = reinterpret_cast<const bluetooth::HidReport *>(&event_info->data_report.v1.report);
         }
 
-        if (!m_future_responses.empty()) {
-            if ((m_future_responses.front()->GetType() == BtdrvHidEventType_Data) && (m_future_responses.front()->GetUserData() == report->data[0])) {
-                m_future_responses.front()->SetData(*event_info);
-            }
-        }
+        m_responses.Complete(BtdrvHidEventType_Data, event_info);
 
         std::scoped_lock lk(m_input_mutex);
 
@@ -100,17 +97,15 @@ namespace ams::controller {
             }
         }
 
+        mitm::ScopedNoHeapAllocation no_allocation;
+
         this->ApplyButtonCombos(&input_report->buttons); 
 
         R_RETURN(bluetooth::hid::report::WriteHidDataReport(m_address, &m_input_report));
     }
 
     Result SwitchController::HandleSetReportEvent(const bluetooth::HidReportEventInfo *event_info) {
-        if (!m_future_responses.empty()) {
-            if (m_future_responses.front()->GetType() == BtdrvHidEventType_SetReport) {
-                m_future_responses.front()->SetData(*event_info);
-            }
-
+        if (m_responses.Complete(BtdrvHidEventType_SetReport, event_info)) {
             R_SUCCEED();
         }
 
@@ -118,11 +113,7 @@ namespace ams::controller {
     }
 
     Result SwitchController::HandleGetReportEvent(const bluetooth::HidReportEventInfo *event_info) {
-        if (!m_future_responses.empty()) {
-            if (m_future_responses.front()->GetType() == BtdrvHidEventType_GetReport) {
-                m_future_responses.front()->SetData(*event_info);
-            }
-
+        if (m_responses.Complete(BtdrvHidEventType_GetReport, event_info)) {
             R_SUCCEED();
         }
 
@@ -138,80 +129,61 @@ namespace ams::controller {
         R_RETURN(btdrvWriteHidData(m_address, report));
     }
 
-    Result SwitchController::WriteDataReport(const bluetooth::HidReport *report, u8 response_id, bluetooth::HidReport *out_report) {       
-        auto response = std::make_shared<HidResponse>(BtdrvHidEventType_Data);
-        response->SetUserData(response_id);
-        m_future_responses.push(response);
-        ON_SCOPE_EXIT { m_future_responses.pop(); };
-
-        R_TRY(btdrvWriteHidData(m_address, report));
-
-        if (!response->TimedWait(ams::TimeSpan::FromMilliSeconds(500))) {
+    Result SwitchController::WriteDataReport(const bluetooth::HidReport *report, u8 response_id, bluetooth::HidReport *out_report) {
+        HidResponseQueue::Ticket ticket;
+        if (!m_responses.Push(&ticket, BtdrvHidEventType_Data, response_id, out_report, true, os::ConvertToTimeSpan(os::GetSystemTick()).GetNanoSeconds())) {
             return -1; // This should return a proper failure code
         }
 
-        auto response_data = response->GetData();
-
-        const bluetooth::HidReport *data_report;
-        if (hos::GetVersion() >= hos::Version_9_0_0) {
-            data_report = &response_data.data_report.v9.report;
-        } else if (hos::GetVersion() >= hos::Version_7_0_0) {
-            data_report = reinterpret_cast<const bluetooth::HidReport *>(&response_data.data_report.v7.report);
-        } else {
-            data_report = reinterpret_cast<const bluetooth::HidReport *>(&response_data.data_report.v1.report);
+        if (const Result rc = btdrvWriteHidData(m_address, report); R_FAILED(rc)) {
+            m_responses.Cancel(ticket);
+            R_RETURN(rc);
         }
 
-        out_report->size = data_report->size;
-        std::memcpy(&out_report->data, &data_report->data, data_report->size);
-
-        R_SUCCEED();
+        R_RETURN(m_responses.Wait(ticket));
     }
 
     Result SwitchController::SetReport(BtdrvBluetoothHhReportType type, const bluetooth::HidReport *report) {
-        auto response = std::make_shared<HidResponse>(BtdrvHidEventType_SetReport);
-        m_future_responses.push(response);
-        ON_SCOPE_EXIT { m_future_responses.pop(); };
+        HidResponseQueue::Ticket ticket;
+        if (!m_responses.Push(&ticket, BtdrvHidEventType_SetReport, 0, nullptr, true, os::ConvertToTimeSpan(os::GetSystemTick()).GetNanoSeconds())) {
+            return -1; // This should return a proper failure code
+        }
+
+        if (const Result rc = btdrvSetHidReport(m_address, type, report); R_FAILED(rc)) {
+            m_responses.Cancel(ticket);
+            R_RETURN(rc);
+        }
 
-        R_TRY(btdrvSetHidReport(m_address, type, report));
+        R_RETURN(m_responses.Wait(ticket));
+    }
 
-        if (!response->TimedWait(ams::TimeSpan::FromMilliSeconds(500))) {
+    Result SwitchController::SetReportAsync(BtdrvBluetoothHhReportType type, const bluetooth::HidReport *report) {
+        // The slot only swallows the acknowledgement so it isn't forwarded to the console. Fails if the controller has fallen too far behind acknowledging
+        HidResponseQueue::Ticket ticket;
+        if (!m_responses.Push(&ticket, BtdrvHidEventType_SetReport, 0, nullptr, false, os::ConvertToTimeSpan(os::GetSystemTick()).GetNanoSeconds())) {
             return -1; // This should return a proper failure code
         }
 
-        auto response_data = response->GetData();
+        if (const Result rc = btdrvSetHidReport(m_address, type, report); R_FAILED(rc)) {
+            m_responses.Cancel(ticket);
+            R_RETURN(rc);
+        }
 
-        return response_data.set_report.res;
+        R_SUCCEED();
     }
 
     Result SwitchController::GetReport(u8 id, BtdrvBluetoothHhReportType type, bluetooth::HidReport *out_report) {
-        auto response = std::make_shared<HidResponse>(BtdrvHidEventType_GetReport);
-        m_future_responses.push(response);
-        ON_SCOPE_EXIT { m_future_responses.pop(); };
-
-        R_TRY(btdrvGetHidReport(m_address, id, type));
-
-        if (!response->TimedWait(ams::TimeSpan::FromMilliSeconds(500))) {
+        HidResponseQueue::Ticket ticket;
+        if (!m_responses.Push(&ticket, BtdrvHidEventType_GetReport, id, out_report, true, os::ConvertToTimeSpan(os::GetSystemTick()).GetNanoSeconds())) {
             return -1; // This should return a proper failure code
         }
 
-        auto response_data = response->GetData();
-        
-        Result result;
-        const bluetooth::HidReport *get_report;
-        if (hos::GetVersion() >= hos::Version_9_0_0) {
-            result = response_data.get_report.v9.res;
-            get_report = &response_data.get_report.v9.report;
-        } else {
-            result = response_data.get_report.v1.res;
-            get_report = reinterpret_cast<const bluetooth::HidReport *>(&response_data.get_report.v1.report);
-        }
-
-        if (R_SUCCEEDED(result)) {
-            out_report->size = get_report->size;
-            std::memcpy(&out_report->data, &get_report->data, get_report->size);
+        if (const Result rc = btdrvGetHidReport(m_address, id, type); R_FAILED(rc)) {
+            m_responses.Cancel(ticket);
+            R_RETURN(rc);
         }
 
-        return result;
+        R_RETURN(m_responses.Wait(ticket));
     }
 
     void SwitchController::UpdateControllerState(const bluetooth::HidReport *report) {
@@ -220,19 +192,7 @@ namespace ams::controller {
     }
 
     void SwitchController::ApplyButtonCombos(SwitchButtonData *buttons) {
-        // Home combo = MINUS + DPAD_DOWN
-        if (buttons->minus && buttons->dpad_down) {
-            buttons->home = 1;
-            buttons->minus = 0;
-            buttons->dpad_down = 0;
-        }
-
-        // Capture combo = MINUS + DPAD_UP
-        if (buttons->minus && buttons->dpad_up) {
-            buttons->capture = 1;
-            buttons->minus = 0;
-            buttons->dpad_up = 0;
-        }
+        m_button_combos.Apply(buttons);
     }
 
 }
@@ -17,15 +17,13 @@
 #include "switch_analog_stick.hpp"
 #include "../bluetooth_mitm/bluetooth/bluetooth_types.hpp"
 #include "../bluetooth_mitm/bluetooth/bluetooth_hid_report.hpp"
-#include "../async/future_response.hpp"
+#include "hid_response_queue.hpp"
 #include "switch_rumble_handler.hpp"
 #include "switch_motion_packing.hpp"
-#include <queue>
+#include "switch_button_combos.hpp"
 
 namespace ams::controller {
 
-    using HidResponse = FutureResponse<bluetooth::HidEventType, bluetooth::HidReportEventInfo, u8>;
-
     constexpr auto BATTERY_MAX = 8;
 
     enum SwitchPlayerNumber : u8 {
@@ -84,6 +82,33 @@ namespace ams::controller {
         u8 ZL           : 1;
     } PACKED;
 
+    // Dpad state for each hat switch direction, clockwise from north. Bits are down, up, right, left
+    constexpr u8 HatSwitchDirections[] = { 0x2, 0x6, 0x4, 0x5, 0x1, 0x9, 0x8, 0xa };
+
+    // Full 8-bit hat value to dpad state lookup for a hat whose north direction is encoded as North. Anything outside the eight directions is neutral
+    template<u8 North>
+    struct HatSwitchTable {
+        u8 dpad[0x100];
+
+        constexpr HatSwitchTable() : dpad() {
+            for (unsigned int i = 0; i < 8; ++i) {
+                dpad[(North + i) & 0xff] = HatSwitchDirections[i];
+            }
+        }
+    };
+
+    template<u8 North>
+    constexpr inline HatSwitchTable<North> hat_switch_table = {};
+
+    template<u8 North>
+    inline void MapHatSwitch(SwitchButtonData *buttons, u8 hat) {
+        const u8 dpad = hat_switch_table<North>.dpad[hat];
+        buttons->dpad_down  = (dpad >> 0) & 1;
+        buttons->dpad_up    = (dpad >> 1) & 1;
+        buttons->dpad_right = (dpad >> 2) & 1;
+        buttons->dpad_left  = (dpad >> 3) & 1;
+    }
+
     struct Switch6AxisCalibrationData {
         struct {
             s16 x;
@@ -425,10 +450,16 @@ namespace ams::controller {
             virtual Result HandleGetReportEvent(const bluetooth::HidReportEventInfo *event_info);
             virtual Result HandleOutputDataReport(const bluetooth::HidReport *report);
 
+            virtual Result FlushVirtualMemory() { R_SUCCEED(); }
+
+            // Plays any queued rumble sample or held back output report that has fallen due and returns when the next one is due
+            virtual s64 ProcessScheduledOutput(s64 now) { AMS_UNUSED(now); return RumbleScheduleIdle; }
+
         protected:
             Result WriteDataReport(const bluetooth::HidReport *report);
             Result WriteDataReport(const bluetooth::HidReport *report, u8 response_id, bluetooth::HidReport *out_report);
             Result SetReport(BtdrvBluetoothHhReportType type, const bluetooth::HidReport *report);
+            Result SetReportAsync(BtdrvBluetoothHhReportType type, const bluetooth::HidReport *report);
             Result GetReport(u8 id, BtdrvBluetoothHhReportType type, bluetooth::HidReport *out_report);
 
             virtual void UpdateControllerState(const bluetooth::HidReport *report);
@@ -443,7 +474,9 @@ namespace ams::controller {
             os::SdkMutex m_output_mutex;
             bluetooth::HidReport m_output_report;
 
-            std::queue<std::shared_ptr<HidResponse>> m_future_responses;
+            HidResponseQueue m_responses;
+
+            SwitchButtonComboEngine m_button_combos;
     };
 
 }
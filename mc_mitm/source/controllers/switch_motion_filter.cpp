@@ -0,0 +1,78 @@
+/*
+ * Copyright (c) 2020-2025 ndeadly
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "switch_motion_filter.hpp"
+
+namespace ams::controller {
+
+    namespace {
+
+        // A sample counts as stationary when the bias corrected gyro (deg/s) and the change in accel (g) since the last sample are below these,
+        // and the accel magnitude is close to 1g
+        constexpr float StationaryGyroThreshold = 4.0f;
+        constexpr float StationaryAccelDelta = 0.03f;
+        constexpr float StationaryGravityTolerance = 0.1f;
+
+        // How long the controller has to rest before samples feed the bias estimate, and the time constant of the estimate
+        constexpr s64 StationaryHoldTime = 500'000'000;
+        constexpr float BiasTimeConstant = 2'000'000'000.0f;
+
+        // Caps the weight of a single sample after a gap in the data
+        constexpr s64 MaxSampleInterval = 50'000'000;
+
+    }
+
+    void MotionFilter::Reset() {
+        m_gyro_bias = {};
+        m_previous_accel = {};
+        m_previous_timestamp = 0;
+        m_stationary_time = 0;
+        m_has_previous = false;
+    }
+
+    Vec3d<float> MotionFilter::Apply(s64 timestamp, const Vec3d<float> &accel, const Vec3d<float> &gyro) {
+        Vec3d<float> corrected = { gyro.x - m_gyro_bias.x, gyro.y - m_gyro_bias.y, gyro.z - m_gyro_bias.z };
+
+        if (m_has_previous) {
+            const s64 dt = std::clamp<s64>(timestamp - m_previous_timestamp, 0, MaxSampleInterval);
+            const float gravity = accel.x * accel.x + accel.y * accel.y + accel.z * accel.z;
+
+            const bool stationary = std::fabs(corrected.x) < StationaryGyroThreshold &&
+                                    std::fabs(corrected.y) < StationaryGyroThreshold &&
+                                    std::fabs(corrected.z) < StationaryGyroThreshold &&
+                                    std::fabs(accel.x - m_previous_accel.x) < StationaryAccelDelta &&
+                                    std::fabs(accel.y - m_previous_accel.y) < StationaryAccelDelta &&
+                                    std::fabs(accel.z - m_previous_accel.z) < StationaryAccelDelta &&
+                                    std::fabs(gravity - 1.0f) < StationaryGravityTolerance;
+
+            m_stationary_time = stationary ? m_stationary_time + dt : 0;
+
+            // Whatever the gyro reads while resting is bias, so pull the estimate towards it
+            if (m_stationary_time >= StationaryHoldTime) {
+                const float alpha = std::min(dt / BiasTimeConstant, 1.0f);
+                m_gyro_bias.x += (gyro.x - m_gyro_bias.x) * alpha;
+                m_gyro_bias.y += (gyro.y - m_gyro_bias.y) * alpha;
+                m_gyro_bias.z += (gyro.z - m_gyro_bias.z) * alpha;
+            }
+        }
+
+        m_previous_accel = accel;
+        m_previous_timestamp = timestamp;
+        m_has_previous = true;
+
+        return corrected;
+    }
+
+}
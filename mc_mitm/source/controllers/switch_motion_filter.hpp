@@ -0,0 +1,41 @@
+/*
+ * Copyright (c) 2020-2025 ndeadly
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+#include "switch_motion_packing.hpp"
+
+namespace ams::controller {
+
+    // Estimates gyroscope bias online while the controller is resting and removes it from every sample
+    class MotionFilter {
+
+        public:
+            MotionFilter() { this->Reset(); }
+
+            void Reset();
+            Vec3d<float> Apply(s64 timestamp, const Vec3d<float> &accel, const Vec3d<float> &gyro);
+
+            const Vec3d<float> &GetGyroBias() const { return m_gyro_bias; }
+
+        private:
+            Vec3d<float> m_gyro_bias;
+            Vec3d<float> m_previous_accel;
+            s64 m_previous_timestamp;
+            s64 m_stationary_time;
+            bool m_has_previous;
+
+    };
+
+}
@@ -20,7 +20,14 @@ namespace ams::controller {
     namespace {
 
         // Degrees to radians and nanoseconds to seconds
-        constexpr double QuatScaleFactor = std::numbers::pi / 180.0f / 1000000000.0f;
+        constexpr float QuatScaleFactor = std::numbers::pi / 180.0 / 1000000000.0;
+
+        // Quaternion components are sent as 30 bit fixed point values where 0x40000000 is 1.0, of which the top 21 bits are packed
+        constexpr float QuatFixedPointScale = 0x40000000;
+        constexpr int QuatPackedShift = 10;
+
+        // Accel samples further than this from 1g are mostly linear acceleration and aren't used for tilt correction
+        constexpr float DriftCorrectionGravityTolerance = 0.2f;
 
         // See https://github.com/dekuNukem/Nintendo_Switch_Reverse_Engineering/issues/18#issuecomment-331324555
         constexpr float BaseGyroSensitivity = 936.0f / (13371 - 0); // 13371 and 0 (offset, would technically need to be done for each axis) match the factory_motion_calibration value in the SPI flash
@@ -29,40 +36,135 @@ namespace ams::controller {
         constexpr float GyroSensitivities[] = { BaseGyroSensitivity / 8, BaseGyroSensitivity / 4, BaseGyroSensitivity / 2, BaseGyroSensitivity };
         constexpr float AccelSensitivities[] = { BaseAccelSensitivity, BaseAccelSensitivity / 2, BaseAccelSensitivity / 4, BaseAccelSensitivity * 2};
 
+        Vec3d<s16> ScaleMotionValues(const Vec3d<float> &values, float sensitivity) {
+            return {
+                .x = static_cast<s16>(std::clamp<float>(values.x / sensitivity, INT16_MIN, INT16_MAX)),
+                .y = static_cast<s16>(std::clamp<float>(values.y / sensitivity, INT16_MIN, INT16_MAX)),
+                .z = static_cast<s16>(std::clamp<float>(values.z / sensitivity, INT16_MIN, INT16_MAX))
+            };
+        }
+
+        Vec3d<float> Lerp(const Vec3d<float> &a, const Vec3d<float> &b, float t) {
+            return { a.x + (b.x - a.x) * t, a.y + (b.y - a.y) * t, a.z + (b.z - a.z) * t };
+        }
+
+        // Slot 0 of a Switch report holds the newest sample and slot 2 the oldest
+        void PackAccelSamples(SwitchMotionData* motion_data, const MotionSample *samples, float sensitivity) {
+            motion_data->standard.accel_0 = ScaleMotionValues(samples[2].accel, sensitivity);
+            motion_data->standard.accel_1 = ScaleMotionValues(samples[1].accel, sensitivity);
+            motion_data->standard.accel_2 = ScaleMotionValues(samples[0].accel, sensitivity);
+        }
+
     }
 
-    void NullMotionPacker::PackData(SwitchMotionData* motion_data, Vec3d<float> accel, Vec3d<float> gyro) {
-        AMS_UNUSED(accel);
-        AMS_UNUSED(gyro);
-        std::memset(motion_data, 0, sizeof(SwitchMotionData));
-    };
+    void MotionSampleBuffer::Clear() {
+        m_head = 0;
+        m_count = 0;
+        ++m_sequence;
+    }
 
-    void StandardMotionPacker::PackData(SwitchMotionData* motion_data, Vec3d<float> accel, Vec3d<float> gyro) {
-        const Vec3d<s16> accel_scaled = {
-            .x = static_cast<s16>(std::clamp<float>(accel.x / AccelSensitivities[m_accel_sensitivity], INT16_MIN, INT16_MAX)),
-            .y = static_cast<s16>(std::clamp<float>(accel.y / AccelSensitivities[m_accel_sensitivity], INT16_MIN, INT16_MAX)),
-            .z = static_cast<s16>(std::clamp<float>(accel.z / AccelSensitivities[m_accel_sensitivity], INT16_MIN, INT16_MAX))
-        };
+    void MotionSampleBuffer::Push(s64 timestamp, const Vec3d<float> &accel, const Vec3d<float> &gyro) {
+        m_samples[m_head] = { timestamp, accel, gyro };
+        m_head = (m_head + 1) % Capacity;
+        m_count = std::min(m_count + 1, Capacity);
+        ++m_sequence;
+    }
 
-        motion_data->standard.accel_0 = accel_scaled;
-        motion_data->standard.accel_1 = accel_scaled;
-        motion_data->standard.accel_2 = accel_scaled;
+    void MotionSampleBuffer::GetSwitchSamples(MotionSample out[SwitchMotionSampleCount]) const {
+        if (m_count == 0) {
+            std::memset(out, 0, SwitchMotionSampleCount * sizeof(MotionSample));
+            return;
+        }
 
-        const Vec3d<s16> gyro_scaled = {
-            .x = static_cast<s16>(std::clamp<float>(gyro.x / GyroSensitivities[m_gyro_sensitivity], INT16_MIN, INT16_MAX)),
-            .y = static_cast<s16>(std::clamp<float>(gyro.y / GyroSensitivities[m_gyro_sensitivity], INT16_MIN, INT16_MAX)),
-            .z = static_cast<s16>(std::clamp<float>(gyro.z / GyroSensitivities[m_gyro_sensitivity], INT16_MIN, INT16_MAX))
-        };
+        const s64 latest = this->GetSample(0).timestamp;
+        for (size_t i = 0; i < SwitchMotionSampleCount; ++i) {
+            this->Resample(latest - (SwitchMotionSampleCount - 1 - i) * SwitchMotionSampleInterval, &out[i]);
+        }
+    }
+
+    void MotionSampleBuffer::Resample(s64 timestamp, MotionSample *out) const {
+        // Find the pair of buffered samples either side of the timestamp and interpolate between them. Anything older than the buffer holds the oldest sample
+        for (size_t age = 0; age + 1 < m_count; ++age) {
+            const MotionSample &newer = this->GetSample(age);
+            const MotionSample &older = this->GetSample(age + 1);
 
-        motion_data->standard.gyro_0 = gyro_scaled;
-        motion_data->standard.gyro_1 = gyro_scaled;
-        motion_data->standard.gyro_2 = gyro_scaled;
+            if (older.timestamp <= timestamp) {
+                const s64 span = newer.timestamp - older.timestamp;
+                const float t = span > 0 ? float(timestamp - older.timestamp) / float(span) : 1.0f;
+
+                *out = { timestamp, Lerp(older.accel, newer.accel, t), Lerp(older.gyro, newer.gyro, t) };
+                return;
+            }
+        }
+
+        *out = this->GetSample(m_count - 1);
+        out->timestamp = timestamp;
+    }
+
+    void NullMotionPacker::PackData(SwitchMotionData* motion_data) {
+        std::memset(motion_data, 0, sizeof(SwitchMotionData));
     };
 
-    QuaternionMotionPacker::QuaternionMotionPacker() {
-        m_previous_tick = os::GetSystemTick();
+    void StandardMotionPacker::PackData(SwitchMotionData* motion_data, const MotionSample *samples, GyroSensitivity gyro_sensitivity, AccelSensitivity accel_sensitivity) {
+        PackAccelSamples(motion_data, samples, AccelSensitivities[accel_sensitivity]);
+
+        const float gyro_scale = GyroSensitivities[gyro_sensitivity];
+        motion_data->standard.gyro_0 = ScaleMotionValues(samples[2].gyro, gyro_scale);
+        motion_data->standard.gyro_1 = ScaleMotionValues(samples[1].gyro, gyro_scale);
+        motion_data->standard.gyro_2 = ScaleMotionValues(samples[0].gyro, gyro_scale);
     };
 
+    void SwitchMotionPacker::SetMode(MotionPackingMode mode) {
+        // Rotation is integrated from scratch each time the console switches into quaternion mode
+        if (mode == MotionPackingMode_Quaternion && m_mode != MotionPackingMode_Quaternion) {
+            m_quaternion.Reset();
+        }
+
+        m_mode = mode;
+    }
+
+    void SwitchMotionPacker::PackData(SwitchMotionData* motion_data, const MotionSample *samples) {
+        switch (m_mode) {
+            case MotionPackingMode_Standard:
+                StandardMotionPacker::PackData(motion_data, samples, m_gyro_sensitivity, m_accel_sensitivity);
+                break;
+            case MotionPackingMode_Quaternion:
+                m_quaternion.PackData(motion_data, samples, m_accel_sensitivity);
+                break;
+            default:
+                NullMotionPacker::PackData(motion_data);
+                break;
+        }
+    }
+
+    s64 SensorClock::Update(u32 counter, u32 counter_bits, s64 period_num, s64 period_den, s64 system_timestamp) {
+        const u32 mask = counter_bits < 32 ? (u32(1) << counter_bits) - 1 : UINT32_MAX;
+        const s64 wrap_period = (s64(mask) + 1) * period_num / period_den;
+
+        if (m_valid && (system_timestamp - m_system_timestamp) < (wrap_period / 2)) {
+            m_timestamp += s64((counter - m_counter) & mask) * period_num / period_den;
+        } else {
+            m_timestamp = system_timestamp;
+            m_valid = true;
+        }
+
+        m_counter = counter;
+        m_system_timestamp = system_timestamp;
+
+        return m_timestamp;
+    }
+
+    QuaternionMotionPacker::QuaternionMotionPacker()
+    : m_drift_correction(0.0f) {
+        this->Reset();
+    }
+
+    void QuaternionMotionPacker::Reset() {
+        m_previous_timestamp = 0;
+        m_has_previous_timestamp = false;
+        m_rotation_state = Quaternion();
+    }
+
     constexpr QuaternionMotionPacker::Quaternion QuaternionMotionPacker::HamiltonProduct(Quaternion q1, Quaternion q2) {
         return Quaternion(q1.w * q2.x + q1.x * q2.w + q1.y * q2.z - q1.z * q2.y,
                           q1.w * q2.y + q1.y * q2.w + q1.z * q2.x - q1.x * q2.z,
@@ -70,89 +172,159 @@ namespace ams::controller {
                           q1.w * q2.w - q1.x * q2.x - q1.y * q2.y - q1.z * q2.z);
     };
 
-    constexpr QuaternionMotionPacker::Quaternion QuaternionMotionPacker::QuaternionNormalize(Quaternion q) {
-        double norm_inverse = 1.0f / std::sqrt(q.x * q.x + q.y * q.y + q.z * q.z + q.w * q.w);
-        return Quaternion(q.x * norm_inverse,
-                          q.y * norm_inverse,
-                          q.z * norm_inverse,
-                          q.w * norm_inverse);
+    constexpr QuaternionMotionPacker::Quaternion QuaternionMotionPacker::QuaternionRenormalize(Quaternion q) {
+        // The state only drifts slightly from unit length between updates, so a single Newton step towards 1 / |q| replaces the square root
+        const float scale = 1.5f - 0.5f * (q.x * q.x + q.y * q.y + q.z * q.z + q.w * q.w);
+        return Quaternion(q.x * scale,
+                          q.y * scale,
+                          q.z * scale,
+                          q.w * scale);
     };
 
-    void QuaternionMotionPacker::PackData(SwitchMotionData* motion_data, Vec3d<float> accel, Vec3d<float> gyro) {
-        const Vec3d<s16> accel_scaled = {
-            .x = static_cast<s16>(std::clamp<float>(accel.x / AccelSensitivities[m_accel_sensitivity], INT16_MIN, INT16_MAX)),
-            .y = static_cast<s16>(std::clamp<float>(accel.y / AccelSensitivities[m_accel_sensitivity], INT16_MIN, INT16_MAX)),
-            .z = static_cast<s16>(std::clamp<float>(accel.z / AccelSensitivities[m_accel_sensitivity], INT16_MIN, INT16_MAX))
-        };
+    constexpr QuaternionMotionPacker::Quaternion QuaternionMotionPacker::GyroRotation(Vec3d<float> gyro, s64 dt) {
+        const float angle_x = gyro.x * QuatScaleFactor * dt;
+        const float angle_y = gyro.y * QuatScaleFactor * dt;
+        const float angle_z = gyro.z * QuatScaleFactor * dt;
 
-        motion_data->standard.accel_0 = accel_scaled;
-        motion_data->standard.accel_1 = accel_scaled;
-        motion_data->standard.accel_2 = accel_scaled;
+        // Euler to quaternion as implemented by Nintendo
+        const float norm_squared = angle_x * angle_x + angle_y * angle_y + angle_z * angle_z;
+        const float vector_scale = norm_squared * norm_squared / 3840.0f - norm_squared / 48 + 0.5f;
+        const float scalar_component = norm_squared * norm_squared / 384.0f - norm_squared / 8 + 1;
+
+        // Seems to roughly translate to Quaternion(angle_x * 1/2 * cos(norm/2), angle_y * 1/2 * cos(norm/2), angle_z * 1/2 * cos(norm/2), cos(norm/2)), at least for small values
+        return Quaternion(angle_x * vector_scale, angle_y * vector_scale, angle_z * vector_scale, scalar_component);
+    }
+
+    QuaternionMotionPacker::Quaternion QuaternionMotionPacker::GravityAlignedRotation(const Vec3d<float> &accel) {
+        const float gravity = std::sqrt(accel.x * accel.x + accel.y * accel.y + accel.z * accel.z);
+        if (std::fabs(gravity - 1.0f) > DriftCorrectionGravityTolerance) {
+            return Quaternion();
+        }
+
+        // Shortest rotation taking the measured gravity direction onto +z, which is where the drift correction expects gravity for this state
+        const float w = 1.0f + accel.z / gravity;
+        if (w < 1e-6f) {
+            // Upside down, any half turn about a horizontal axis will do
+            return Quaternion(1.0f, 0.0f, 0.0f, 0.0f);
+        }
+
+        const float norm = std::sqrt(2.0f * w);
+        return Quaternion(accel.y / gravity / norm, -accel.x / gravity / norm, 0.0f, w / norm);
+    }
 
-        this->UpdateRotationState(gyro);
-        this->PackGyroFixedPrecision(motion_data);
+    void QuaternionMotionPacker::PackData(SwitchMotionData* motion_data, const MotionSample *samples, AccelSensitivity accel_sensitivity) {
+        PackAccelSamples(motion_data, samples, AccelSensitivities[accel_sensitivity]);
+
+        this->UpdateRotationState(samples);
+        this->PackGyroFixedPrecision(motion_data, samples);
     };
 
-    void QuaternionMotionPacker::UpdateRotationState(Vec3d<float> gyro) {
-        os::Tick current_tick = os::GetSystemTick();
+    Vec3d<float> QuaternionMotionPacker::CorrectGyroDrift(const MotionSample &sample) const {
+        const Vec3d<float> &a = sample.accel;
+        const float gravity = std::sqrt(a.x * a.x + a.y * a.y + a.z * a.z);
+        if (m_drift_correction <= 0.0f || std::fabs(gravity - 1.0f) > DriftCorrectionGravityTolerance) {
+            return sample.gyro;
+        }
 
-        double dt = os::ConvertToTimeSpan(current_tick - m_previous_tick).GetNanoSeconds();
+        // Direction of gravity in the controller frame according to the current rotation state
+        const Quaternion &q = m_rotation_state;
+        const float vx = 2.0f * (q.x * q.z - q.w * q.y);
+        const float vy = 2.0f * (q.w * q.x + q.y * q.z);
+        const float vz = q.w * q.w - q.x * q.x - q.y * q.y + q.z * q.z;
+
+        // The cross product with the measured direction is the axis and sine of the tilt error. Feeding it back into the gyro rate pulls the state towards the accelerometer
+        const float scale = m_drift_correction * 180.0f / std::numbers::pi_v<float> / gravity;
+        return {
+            sample.gyro.x + (a.y * vz - a.z * vy) * scale,
+            sample.gyro.y + (a.z * vx - a.x * vz) * scale,
+            sample.gyro.z + (a.x * vy - a.y * vx) * scale
+        };
+    }
 
-        double angle_x = gyro.x * QuatScaleFactor * dt;
-        double angle_y = gyro.y * QuatScaleFactor * dt;
-        double angle_z = gyro.z * QuatScaleFactor * dt;
+    void QuaternionMotionPacker::UpdateRotationState(const MotionSample *samples) {
+        if (!m_has_previous_timestamp) {
+            m_previous_timestamp = samples[SwitchMotionSampleCount - 1].timestamp;
+            m_has_previous_timestamp = true;
 
-        // Euler to quaternion as implemented by Nintendo
-        double norm_squared = angle_x * angle_x + angle_y * angle_y + angle_z * angle_z;
-        double vector_scale = norm_squared * norm_squared / 3840.0f - norm_squared / 48 + 0.5;
-        double scalar_component = norm_squared * norm_squared / 384.0f - norm_squared / 8 + 1;
+            // Drift correction pulls the state towards the measured gravity, so start there rather than have it swing over from identity
+            if (m_drift_correction > 0.0f) {
+                m_rotation_state = GravityAlignedRotation(samples[SwitchMotionSampleCount - 1].accel);
+            }
+        }
 
-        // Seems to roughly translate to Quaternion(angle_x * 1/2 * cos(norm/2), angle_y * 1/2 * cos(norm/2), angle_z * 1/2 * cos(norm/2), cos(norm/2)), at least for small values 
-        Quaternion current_rotation(angle_x * vector_scale, angle_y * vector_scale, angle_z * vector_scale, scalar_component);
+        // Integrate each sample newer than the current state over the time since the previous one. Sample timestamps come from the controller's sensor clock where available, so report jitter doesn't turn into rotation error
+        Vec3d<float> rates[SwitchMotionSampleCount];
+        for (size_t i = 0; i < SwitchMotionSampleCount; ++i) {
+            rates[i] = this->CorrectGyroDrift(samples[i]);
+            if (samples[i].timestamp > m_previous_timestamp) {
+                m_rotation_state = HamiltonProduct(m_rotation_state, GyroRotation(rates[i], samples[i].timestamp - m_previous_timestamp));
+                m_previous_timestamp = samples[i].timestamp;
+            }
+        }
 
-        m_rotation_state = QuaternionNormalize(HamiltonProduct(m_rotation_state, current_rotation));
+        m_rotation_state = QuaternionRenormalize(m_rotation_state);
 
-        m_previous_tick = current_tick;
+        // Earlier states are rotated back from the newest one using the same corrected angular velocity the forward step used over each interval
+        m_sample_states[SwitchMotionSampleCount - 1] = m_rotation_state;
+        for (size_t i = SwitchMotionSampleCount - 1; i > 0; --i) {
+            m_sample_states[i - 1] = HamiltonProduct(m_sample_states[i], GyroRotation(rates[i], -(samples[i].timestamp - samples[i - 1].timestamp)));
+        }
     };
 
-    void QuaternionMotionPacker::PackGyroFixedPrecision(SwitchMotionData* motion_data) {
-        // We will use this mode since it's the one that loses less precision for our (single) motion sample 
+    void QuaternionMotionPacker::PackGyroFixedPrecision(SwitchMotionData* motion_data, const MotionSample *samples) {
+        // We will use this mode since it's the one that loses the least precision on the newest sample
         motion_data->quaternion.packing_mode_2.packing_mode = 2;
 
-        // Locate the index of the component with the maximum absolute value
+        // Locate the index of the component with the maximum absolute value. This is taken from the mid sample and applied to all three
+        const Quaternion &mid = m_sample_states[1];
         int max_index = 0;
         for (int i = 1; i < 4; ++i) {
-            if (std::fabs(m_rotation_state.raw[i]) > std::fabs(m_rotation_state.raw[max_index])) {
+            if (std::fabs(mid.raw[i]) > std::fabs(mid.raw[max_index])) {
                 max_index = i;
             }
         }
 
         motion_data->quaternion.packing_mode_2.max_index = max_index;
 
-        // Exclude the max_index component from the component list, invert sign of the remaining components if it was negative. Scales the final result to a 30 bit fixed precision format where 0x40000000 is 1.0
-        s32 quaternion_30bit_components[3];
-        for (int i = 0; i < 3; ++i) {
-            quaternion_30bit_components[i] = m_rotation_state.raw[(max_index + i + 1) & 3] * 0x40000000 * (m_rotation_state.raw[max_index] < 0 ? -1 : 1);
+        // Exclude the max_index component from the component list, invert sign of the remaining components if it was negative. Scales the final result to a 30 bit fixed precision format and keeps the packed bits
+        s32 components[SwitchMotionSampleCount][3];
+        for (size_t sample = 0; sample < SwitchMotionSampleCount; ++sample) {
+            const Quaternion &q = m_sample_states[sample];
+            const float sign = q.raw[max_index] < 0 ? -1.0f : 1.0f;
+            for (int i = 0; i < 3; ++i) {
+                components[sample][i] = s32(q.raw[(max_index + i + 1) & 3] * QuatFixedPointScale * sign) >> QuatPackedShift;
+            }
         }
 
+        const s32 *first = components[0];
+        const s32 *mid_sample = components[1];
+        const s32 *last = components[2];
+
         // Insert into the last sample components, do bit operations to account for split data
-        motion_data->quaternion.packing_mode_2.last_sample_0 = quaternion_30bit_components[0] >> 10;
-        motion_data->quaternion.packing_mode_2.last_sample_1l = ((quaternion_30bit_components[1] >> 10) & 0x7F);
-        motion_data->quaternion.packing_mode_2.last_sample_1h = ((quaternion_30bit_components[1] >> 10) & 0x1FFF80) >> 7;
-        motion_data->quaternion.packing_mode_2.last_sample_2l = ((quaternion_30bit_components[2] >> 10) & 0x3);
-        motion_data->quaternion.packing_mode_2.last_sample_2h = ((quaternion_30bit_components[2] >> 10) & 0x1FFFFC) >> 2;
-
-        // We only store one sample, so all deltas are 0
-        motion_data->quaternion.packing_mode_2.delta_last_first_0 = 0;
-        motion_data->quaternion.packing_mode_2.delta_last_first_1 = 0;
-        motion_data->quaternion.packing_mode_2.delta_last_first_2l = 0;
-        motion_data->quaternion.packing_mode_2.delta_last_first_2h = 0;
-        motion_data->quaternion.packing_mode_2.delta_mid_avg_0 = 0;
-        motion_data->quaternion.packing_mode_2.delta_mid_avg_1 = 0;
-        motion_data->quaternion.packing_mode_2.delta_mid_avg_2 = 0;
-
-        // Timestamps handling is still a bit unclear, these are the values that result in no drifting 
-        auto timestamp_start = os::ConvertToTimeSpan(m_previous_tick).GetMilliSeconds();
+        motion_data->quaternion.packing_mode_2.last_sample_0 = last[0];
+        motion_data->quaternion.packing_mode_2.last_sample_1l = last[1] & 0x7F;
+        motion_data->quaternion.packing_mode_2.last_sample_1h = (last[1] & 0x1FFF80) >> 7;
+        motion_data->quaternion.packing_mode_2.last_sample_2l = last[2] & 0x3;
+        motion_data->quaternion.packing_mode_2.last_sample_2h = (last[2] & 0x1FFFFC) >> 2;
+
+        // The first and mid samples are sent as deltas, clamped to the signed range of their fields
+        s32 delta_last_first[3];
+        s32 delta_mid_avg[3];
+        for (int i = 0; i < 3; ++i) {
+            delta_last_first[i] = std::clamp<s32>(last[i] - first[i], -0x1000, 0xFFF);
+            delta_mid_avg[i] = std::clamp<s32>(mid_sample[i] - (last[i] + first[i]) / 2, -0x40, 0x3F);
+        }
+
+        motion_data->quaternion.packing_mode_2.delta_last_first_0 = delta_last_first[0];
+        motion_data->quaternion.packing_mode_2.delta_last_first_1 = delta_last_first[1];
+        motion_data->quaternion.packing_mode_2.delta_last_first_2l = delta_last_first[2] & 0x7;
+        motion_data->quaternion.packing_mode_2.delta_last_first_2h = (delta_last_first[2] & 0x1FF8) >> 3;
+        motion_data->quaternion.packing_mode_2.delta_mid_avg_0 = delta_mid_avg[0];
+        motion_data->quaternion.packing_mode_2.delta_mid_avg_1 = delta_mid_avg[1];
+        motion_data->quaternion.packing_mode_2.delta_mid_avg_2 = delta_mid_avg[2];
+
+        // Timestamps handling is still a bit unclear, these are the values that result in no drifting
+        auto timestamp_start = TimeSpan::FromNanoSeconds(samples[0].timestamp).GetMilliSeconds();
         motion_data->quaternion.packing_mode_2.timestamp_start_l = timestamp_start & 0x1;
         motion_data->quaternion.packing_mode_2.timestamp_start_h = (timestamp_start >> 1) & 0x3FF;
         motion_data->quaternion.packing_mode_2.timestamp_count = 3;
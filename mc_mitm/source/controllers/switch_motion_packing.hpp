@@ -137,61 +137,144 @@ namespace ams::controller {
         AccelSensitivity_16G = 3
     };
 
-    class SwitchMotionPacker {
+    // Switch reports carry three motion samples taken 5ms apart
+    constexpr size_t SwitchMotionSampleCount = 3;
+    constexpr s64 SwitchMotionSampleInterval = 5'000'000;
+
+    struct MotionSample {
+        s64 timestamp;  // Nanoseconds
+        Vec3d<float> accel;
+        Vec3d<float> gyro;
+    };
+
+    // Ring of the most recent samples received from the controller, so each Switch report can carry three distinct samples instead of one repeated
+    class MotionSampleBuffer {
         public:
-            virtual void PackData(SwitchMotionData* motion_data, Vec3d<float> accel, Vec3d<float> gyro) = 0;
-            void SetGyroSensitivity(GyroSensitivity sensitivity) { m_gyro_sensitivity = sensitivity; }
-            void SetAccelSensitivity(AccelSensitivity sensitivity) { m_accel_sensitivity = sensitivity; }
-            GyroSensitivity GetGyroSensitivity() { return m_gyro_sensitivity; }
-            AccelSensitivity GetAccelSensitivity() { return m_accel_sensitivity; }
+            static constexpr size_t Capacity = 8;
 
-        protected:
-            GyroSensitivity m_gyro_sensitivity;
-            AccelSensitivity m_accel_sensitivity;
-            float m_gyro_scaling_factor;
-            float m_accel_scaling_factor;
+            MotionSampleBuffer() : m_samples(), m_head(0), m_count(0), m_sequence(0) { }
+
+            void Clear();
+            void Push(s64 timestamp, const Vec3d<float> &accel, const Vec3d<float> &gyro);
+
+            // Fills out with samples at SwitchMotionSampleInterval spacing, oldest first, ending at the most recent sample
+            void GetSwitchSamples(MotionSample out[SwitchMotionSampleCount]) const;
+
+            // Incremented every time a sample is pushed
+            u32 GetSequence() const { return m_sequence; }
+
+        private:
+            const MotionSample &GetSample(size_t age) const { return m_samples[(m_head + Capacity - 1 - age) % Capacity]; }
+            void Resample(s64 timestamp, MotionSample *out) const;
+
+            MotionSample m_samples[Capacity];
+            size_t m_head;
+            size_t m_count;
+            u32 m_sequence;
+    };
+
+    enum MotionPackingMode : u8 {
+        MotionPackingMode_Disabled,
+        MotionPackingMode_Standard,
+        MotionPackingMode_Quaternion,
     };
 
-    class NullMotionPacker final : public SwitchMotionPacker {
+    class NullMotionPacker {
         public:
-            void PackData(SwitchMotionData* motion_data, Vec3d<float> accel, Vec3d<float> gyro) override;
+            static void PackData(SwitchMotionData* motion_data);
     };
 
-    class StandardMotionPacker final : public SwitchMotionPacker {
+    class StandardMotionPacker {
         public:
-            void PackData(SwitchMotionData* motion_data, Vec3d<float> accel, Vec3d<float> gyro) override;
+            static void PackData(SwitchMotionData* motion_data, const MotionSample *samples, GyroSensitivity gyro_sensitivity, AccelSensitivity accel_sensitivity);
     };
 
-    class QuaternionMotionPacker final : public SwitchMotionPacker {
+    class QuaternionMotionPacker {
         private:
             struct Quaternion {
                 constexpr Quaternion() : x(0), y(0), z(0), w(1) {};
-                constexpr Quaternion(double x, double y, double z, double w) : x(x), y(y), z(z), w(w) {};
+                constexpr Quaternion(float x, float y, float z, float w) : x(x), y(y), z(z), w(w) {};
 
                 union {
-                    double raw[4];
+                    float raw[4];
                     struct {
-                        double x;
-                        double y;
-                        double z;
-                        double w;
+                        float x;
+                        float y;
+                        float z;
+                        float w;
                     };
                 };
             };
-            
+
             static constexpr Quaternion HamiltonProduct(Quaternion q1, Quaternion q2);
-            static constexpr Quaternion QuaternionNormalize(Quaternion q);
-            
+            static constexpr Quaternion QuaternionRenormalize(Quaternion q);
+            static constexpr Quaternion GyroRotation(Vec3d<float> gyro, s64 dt);
+            static Quaternion GravityAlignedRotation(const Vec3d<float> &accel);
+
         public:
             QuaternionMotionPacker();
-            void PackData(SwitchMotionData* motion_data, Vec3d<float> accel, Vec3d<float> gyro) override;
-            
+            void Reset();
+            // Gain of the accelerometer tilt correction applied during integration, 0 disables it
+            void SetDriftCorrection(float gain) { m_drift_correction = gain; }
+            void PackData(SwitchMotionData* motion_data, const MotionSample *samples, AccelSensitivity accel_sensitivity);
+
         private:
-            void UpdateRotationState(Vec3d<float> gyro);
-            void PackGyroFixedPrecision(SwitchMotionData* motion_data);
-            
+            Vec3d<float> CorrectGyroDrift(const MotionSample &sample) const;
+            void UpdateRotationState(const MotionSample *samples);
+            void PackGyroFixedPrecision(SwitchMotionData* motion_data, const MotionSample *samples);
+
         private:
-            os::Tick m_previous_tick;
+            s64 m_previous_timestamp;
+            bool m_has_previous_timestamp;
+            float m_drift_correction;
             Quaternion m_rotation_state;
+            Quaternion m_sample_states[SwitchMotionSampleCount];
+    };
+
+    // Packs motion samples in whichever format the console last requested. Every packer lives in place, so mode changes don't allocate
+    // and the sensitivity settings carry across them
+    class SwitchMotionPacker {
+        public:
+            SwitchMotionPacker()
+            : m_mode(MotionPackingMode_Disabled)
+            , m_gyro_sensitivity(GyroSensitivity_2000Dps)
+            , m_accel_sensitivity(AccelSensitivity_8G) { }
+
+            void SetMode(MotionPackingMode mode);
+            MotionPackingMode GetMode() const { return m_mode; }
+
+            // samples holds SwitchMotionSampleCount samples, oldest first
+            void PackData(SwitchMotionData* motion_data, const MotionSample *samples);
+            // Whether packed output depends on anything other than the input samples and sensitivity settings
+            bool IsStateful() const { return m_mode == MotionPackingMode_Quaternion; }
+
+            void SetGyroSensitivity(GyroSensitivity sensitivity) { m_gyro_sensitivity = sensitivity; }
+            void SetAccelSensitivity(AccelSensitivity sensitivity) { m_accel_sensitivity = sensitivity; }
+            GyroSensitivity GetGyroSensitivity() const { return m_gyro_sensitivity; }
+            AccelSensitivity GetAccelSensitivity() const { return m_accel_sensitivity; }
+            void SetDriftCorrection(float gain) { m_quaternion.SetDriftCorrection(gain); }
+
+        private:
+            MotionPackingMode m_mode;
+            GyroSensitivity m_gyro_sensitivity;
+            AccelSensitivity m_accel_sensitivity;
+            QuaternionMotionPacker m_quaternion;
+    };
+
+    // Extends a wrapping hardware sensor counter into a nanosecond timeline. Resyncs to the system clock when samples are too far apart for the counter delta to be trusted
+    class SensorClock {
+        public:
+            SensorClock() : m_counter(0), m_timestamp(0), m_system_timestamp(0), m_valid(false) { }
+
+            void Reset() { m_valid = false; }
+
+            // Each counter increment lasts period_num / period_den nanoseconds
+            s64 Update(u32 counter, u32 counter_bits, s64 period_num, s64 period_den, s64 system_timestamp);
+
+        private:
+            u32 m_counter;
+            s64 m_timestamp;
+            s64 m_system_timestamp;
+            bool m_valid;
     };
 }
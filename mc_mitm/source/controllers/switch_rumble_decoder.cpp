@@ -19,64 +19,69 @@ namespace ams::controller {
 
     namespace {
 
-        constexpr float MinAmplitude     = -8.0f;
-        constexpr float MaxAmplitude     =  0.0f;
-        constexpr float DefaultAmplitude =  MinAmplitude;
+        // Amplitude and frequency are log2 values in fixed point with 5 fractional bits, the finest step any encoding can express
+        constexpr int FixedPointScale = 32;
 
-        constexpr float MinFrequency     = -2.0f;
-        constexpr float MaxFrequency     =  2.0f;
-        constexpr float DefaultFrequency =  0.0f;
+        constexpr s16 MinAmplitude     = -8 * FixedPointScale;
+        constexpr s16 MaxAmplitude     =  0 * FixedPointScale;
+        constexpr s16 DefaultAmplitude =  MinAmplitude;
 
-        constexpr float CenterFreqHigh = 320.0f;
-        constexpr float CenterFreqLow  = 160.0f;
+        constexpr s16 MinFrequency     = -2 * FixedPointScale;
+        constexpr s16 MaxFrequency     =  2 * FixedPointScale;
+        constexpr s16 DefaultFrequency =  0 * FixedPointScale;
 
-        constexpr float ExpBase2LookupResolution = 1.0f / 32;
-        constexpr float ExpBase2RangeStart = std::min(MinAmplitude, MinFrequency);
-        constexpr float ExpBase2RangeEnd   = std::max(MaxAmplitude, MaxFrequency);
-        constexpr size_t ExpBase2LookupLength = (std::fabs(ExpBase2RangeEnd - ExpBase2RangeStart) + ExpBase2LookupResolution) / ExpBase2LookupResolution;
+        constexpr std::array<float, MaxAmplitude - MinAmplitude + 1> AmplitudeLookup = []() {
+            std::array<float, MaxAmplitude - MinAmplitude + 1> table = {};
 
-        constexpr std::array<float, ExpBase2LookupLength> ExpBase2Lookup = []() {
-            std::array<float, ExpBase2LookupLength> table = {};
-
-            constexpr float AmplitudeThreshold = -7.9375f;
+            constexpr s16 AmplitudeThreshold = -254; // -7.9375
 
             for (size_t i = 0; i < table.size(); ++i) {
-                float f = ExpBase2RangeStart + i * ExpBase2LookupResolution;
-                if (f >= AmplitudeThreshold) {
-                    table[i] = std::exp2f(f);
+                const s16 value = MinAmplitude + i;
+                if (value >= AmplitudeThreshold) {
+                    table[i] = std::exp2f(static_cast<float>(value) / FixedPointScale);
                 }
             }
 
             return table;
         }();
 
-        constexpr u32 GetLookupIndex(float input) {
-            return (input - ExpBase2RangeStart) / ExpBase2LookupResolution;
+        constexpr auto MakeFrequencyLookup(float center_freq) {
+            std::array<float, MaxFrequency - MinFrequency + 1> table = {};
+
+            for (size_t i = 0; i < table.size(); ++i) {
+                const s16 value = MinFrequency + i;
+                table[i] = std::exp2f(static_cast<float>(value) / FixedPointScale) * center_freq;
+            }
+
+            return table;
         }
 
-        constexpr std::array<float, 128> Am7BitLookup = []() {
-            std::array<float, 128> table = {};
+        constexpr auto FrequencyLowLookup  = MakeFrequencyLookup(SwitchRumbleCenterFreqLow);
+        constexpr auto FrequencyHighLookup = MakeFrequencyLookup(SwitchRumbleCenterFreqHigh);
 
-            for (size_t i = 0; i < table.size(); ++i) {
+        constexpr std::array<s16, 128> Am7BitLookup = []() {
+            std::array<s16, 128> table = {};
+
+            for (int i = 0; i < static_cast<int>(table.size()); ++i) {
                 if (i == 0) {
-                    table[i] = -8.0f;
+                    table[i] = MinAmplitude;
                 } else if (i < 16) {
-                    table[i] = 0.25f * i - 7.75f;
+                    table[i] = 8 * i - 248;  // 0.25 * i - 7.75
                 } else if (i < 32) {
-                    table[i] = 0.0625f * i - 4.9375f;
+                    table[i] = 2 * i - 158;  // 0.0625 * i - 4.9375
                 } else {
-                    table[i] = 0.03125f * i - 3.96875f;
+                    table[i] = i - 127;      // 0.03125 * i - 3.96875
                 }
             }
 
             return table;
         }();
 
-        constexpr std::array<float, 128> Fm7BitLookup = []() {
-            std::array<float, 128> table = {};
+        constexpr std::array<s16, 128> Fm7BitLookup = []() {
+            std::array<s16, 128> table = {};
 
-            for (size_t i = 0; i < table.size(); ++i) {
-                table[i] = 0.03125f * i - 2.0f;
+            for (int i = 0; i < static_cast<int>(table.size()); ++i) {
+                table[i] = i - 64;           // 0.03125 * i - 2.0
             }
 
             return table;
@@ -92,59 +97,59 @@ namespace ams::controller {
         struct Switch5BitCommand {
             Switch5BitAction am_action;
             Switch5BitAction fm_action;
-            float am_offset;
-            float fm_offset;
+            s16 am_offset;
+            s16 fm_offset;
         };
 
         constexpr Switch5BitCommand CommandTable[] = {
-            { .am_action = Switch5BitAction_Default,    .fm_action = Switch5BitAction_Default,    .am_offset =  0.0f,     .fm_offset =  0.0f     },
-            { .am_action = Switch5BitAction_Substitute, .fm_action = Switch5BitAction_Ignore,     .am_offset =  0.0f,     .fm_offset =  0.0f     },
-            { .am_action = Switch5BitAction_Substitute, .fm_action = Switch5BitAction_Ignore,     .am_offset = -0.5f,     .fm_offset =  0.0f     },
-            { .am_action = Switch5BitAction_Substitute, .fm_action = Switch5BitAction_Ignore,     .am_offset = -1.0f,     .fm_offset =  0.0f     },
-            { .am_action = Switch5BitAction_Substitute, .fm_action = Switch5BitAction_Ignore,     .am_offset = -1.5f,     .fm_offset =  0.0f     },
-            { .am_action = Switch5BitAction_Substitute, .fm_action = Switch5BitAction_Ignore,     .am_offset = -2.0f,     .fm_offset =  0.0f     },
-            { .am_action = Switch5BitAction_Substitute, .fm_action = Switch5BitAction_Ignore,     .am_offset = -2.5f,     .fm_offset =  0.0f     },
-            { .am_action = Switch5BitAction_Substitute, .fm_action = Switch5BitAction_Ignore,     .am_offset = -3.0f,     .fm_offset =  0.0f     },
-            { .am_action = Switch5BitAction_Substitute, .fm_action = Switch5BitAction_Ignore,     .am_offset = -3.5f,     .fm_offset =  0.0f     },
-            { .am_action = Switch5BitAction_Substitute, .fm_action = Switch5BitAction_Ignore,     .am_offset = -4.0f,     .fm_offset =  0.0f     },
-            { .am_action = Switch5BitAction_Substitute, .fm_action = Switch5BitAction_Ignore,     .am_offset = -4.5f,     .fm_offset =  0.0f     },
-            { .am_action = Switch5BitAction_Substitute, .fm_action = Switch5BitAction_Ignore,     .am_offset = -5.0f,     .fm_offset =  0.0f     },
-            { .am_action = Switch5BitAction_Ignore,     .fm_action = Switch5BitAction_Substitute, .am_offset =  0.0f,     .fm_offset = -0.375f   },
-            { .am_action = Switch5BitAction_Ignore,     .fm_action = Switch5BitAction_Substitute, .am_offset =  0.0f,     .fm_offset = -0.1875f  },
-            { .am_action = Switch5BitAction_Ignore,     .fm_action = Switch5BitAction_Substitute, .am_offset =  0.0f,     .fm_offset =  0.0f     },
-            { .am_action = Switch5BitAction_Ignore,     .fm_action = Switch5BitAction_Substitute, .am_offset =  0.0f,     .fm_offset =  0.1875f  },
-            { .am_action = Switch5BitAction_Ignore,     .fm_action = Switch5BitAction_Substitute, .am_offset =  0.0f,     .fm_offset =  0.375f   },
-            { .am_action = Switch5BitAction_Sum,        .fm_action = Switch5BitAction_Sum,        .am_offset =  0.125f,   .fm_offset =  0.03125f },
-            { .am_action = Switch5BitAction_Sum,        .fm_action = Switch5BitAction_Ignore,     .am_offset =  0.125f,   .fm_offset =  0.0f     },
-            { .am_action = Switch5BitAction_Sum,        .fm_action = Switch5BitAction_Sum,        .am_offset =  0.125f,   .fm_offset = -0.03125f },
-            { .am_action = Switch5BitAction_Sum,        .fm_action = Switch5BitAction_Sum,        .am_offset =  0.03125f, .fm_offset =  0.03125f },
-            { .am_action = Switch5BitAction_Sum,        .fm_action = Switch5BitAction_Ignore,     .am_offset =  0.03125f, .fm_offset =  0.0f     },
-            { .am_action = Switch5BitAction_Sum,        .fm_action = Switch5BitAction_Sum,        .am_offset =  0.03125f, .fm_offset = -0.03125f },
-            { .am_action = Switch5BitAction_Ignore,     .fm_action = Switch5BitAction_Sum,        .am_offset =  0.0f,     .fm_offset =  0.03125f },
-            { .am_action = Switch5BitAction_Ignore,     .fm_action = Switch5BitAction_Ignore,     .am_offset =  0.0f,     .fm_offset =  0.0f     },
-            { .am_action = Switch5BitAction_Ignore,     .fm_action = Switch5BitAction_Sum,        .am_offset =  0.0f,     .fm_offset = -0.03125f },
-            { .am_action = Switch5BitAction_Sum,        .fm_action = Switch5BitAction_Sum,        .am_offset = -0.03125f, .fm_offset =  0.03125f },
-            { .am_action = Switch5BitAction_Sum,        .fm_action = Switch5BitAction_Ignore,     .am_offset = -0.03125f, .fm_offset =  0.0f     },
-            { .am_action = Switch5BitAction_Sum,        .fm_action = Switch5BitAction_Sum,        .am_offset = -0.03125f, .fm_offset = -0.03125f },
-            { .am_action = Switch5BitAction_Sum,        .fm_action = Switch5BitAction_Sum,        .am_offset = -0.125f,   .fm_offset =  0.03125f },
-            { .am_action = Switch5BitAction_Sum,        .fm_action = Switch5BitAction_Ignore,     .am_offset = -0.125f,   .fm_offset =  0.0f     },
-            { .am_action = Switch5BitAction_Sum,        .fm_action = Switch5BitAction_Sum,        .am_offset = -0.125f,   .fm_offset = -0.03125f }
+            { .am_action = Switch5BitAction_Default,    .fm_action = Switch5BitAction_Default,    .am_offset =    0, .fm_offset =   0 },
+            { .am_action = Switch5BitAction_Substitute, .fm_action = Switch5BitAction_Ignore,     .am_offset =    0, .fm_offset =   0 },
+            { .am_action = Switch5BitAction_Substitute, .fm_action = Switch5BitAction_Ignore,     .am_offset =  -16, .fm_offset =   0 },
+            { .am_action = Switch5BitAction_Substitute, .fm_action = Switch5BitAction_Ignore,     .am_offset =  -32, .fm_offset =   0 },
+            { .am_action = Switch5BitAction_Substitute, .fm_action = Switch5BitAction_Ignore,     .am_offset =  -48, .fm_offset =   0 },
+            { .am_action = Switch5BitAction_Substitute, .fm_action = Switch5BitAction_Ignore,     .am_offset =  -64, .fm_offset =   0 },
+            { .am_action = Switch5BitAction_Substitute, .fm_action = Switch5BitAction_Ignore,     .am_offset =  -80, .fm_offset =   0 },
+            { .am_action = Switch5BitAction_Substitute, .fm_action = Switch5BitAction_Ignore,     .am_offset =  -96, .fm_offset =   0 },
+            { .am_action = Switch5BitAction_Substitute, .fm_action = Switch5BitAction_Ignore,     .am_offset = -112, .fm_offset =   0 },
+            { .am_action = Switch5BitAction_Substitute, .fm_action = Switch5BitAction_Ignore,     .am_offset = -128, .fm_offset =   0 },
+            { .am_action = Switch5BitAction_Substitute, .fm_action = Switch5BitAction_Ignore,     .am_offset = -144, .fm_offset =   0 },
+            { .am_action = Switch5BitAction_Substitute, .fm_action = Switch5BitAction_Ignore,     .am_offset = -160, .fm_offset =   0 },
+            { .am_action = Switch5BitAction_Ignore,     .fm_action = Switch5BitAction_Substitute, .am_offset =    0, .fm_offset = -12 },
+            { .am_action = Switch5BitAction_Ignore,     .fm_action = Switch5BitAction_Substitute, .am_offset =    0, .fm_offset =  -6 },
+            { .am_action = Switch5BitAction_Ignore,     .fm_action = Switch5BitAction_Substitute, .am_offset =    0, .fm_offset =   0 },
+            { .am_action = Switch5BitAction_Ignore,     .fm_action = Switch5BitAction_Substitute, .am_offset =    0, .fm_offset =   6 },
+            { .am_action = Switch5BitAction_Ignore,     .fm_action = Switch5BitAction_Substitute, .am_offset =    0, .fm_offset =  12 },
+            { .am_action = Switch5BitAction_Sum,        .fm_action = Switch5BitAction_Sum,        .am_offset =    4, .fm_offset =   1 },
+            { .am_action = Switch5BitAction_Sum,        .fm_action = Switch5BitAction_Ignore,     .am_offset =    4, .fm_offset =   0 },
+            { .am_action = Switch5BitAction_Sum,        .fm_action = Switch5BitAction_Sum,        .am_offset =    4, .fm_offset =  -1 },
+            { .am_action = Switch5BitAction_Sum,        .fm_action = Switch5BitAction_Sum,        .am_offset =    1, .fm_offset =   1 },
+            { .am_action = Switch5BitAction_Sum,        .fm_action = Switch5BitAction_Ignore,     .am_offset =    1, .fm_offset =   0 },
+            { .am_action = Switch5BitAction_Sum,        .fm_action = Switch5BitAction_Sum,        .am_offset =    1, .fm_offset =  -1 },
+            { .am_action = Switch5BitAction_Ignore,     .fm_action = Switch5BitAction_Sum,        .am_offset =    0, .fm_offset =   1 },
+            { .am_action = Switch5BitAction_Ignore,     .fm_action = Switch5BitAction_Ignore,     .am_offset =    0, .fm_offset =   0 },
+            { .am_action = Switch5BitAction_Ignore,     .fm_action = Switch5BitAction_Sum,        .am_offset =    0, .fm_offset =  -1 },
+            { .am_action = Switch5BitAction_Sum,        .fm_action = Switch5BitAction_Sum,        .am_offset =   -1, .fm_offset =   1 },
+            { .am_action = Switch5BitAction_Sum,        .fm_action = Switch5BitAction_Ignore,     .am_offset =   -1, .fm_offset =   0 },
+            { .am_action = Switch5BitAction_Sum,        .fm_action = Switch5BitAction_Sum,        .am_offset =   -1, .fm_offset =  -1 },
+            { .am_action = Switch5BitAction_Sum,        .fm_action = Switch5BitAction_Sum,        .am_offset =   -4, .fm_offset =   1 },
+            { .am_action = Switch5BitAction_Sum,        .fm_action = Switch5BitAction_Ignore,     .am_offset =   -4, .fm_offset =   0 },
+            { .am_action = Switch5BitAction_Sum,        .fm_action = Switch5BitAction_Sum,        .am_offset =   -4, .fm_offset =  -1 }
         };
 
-        float ApplyCommand(Switch5BitAction action, float offset, float current_val, float default_val, float min, float max) {
+        s16 ApplyCommand(Switch5BitAction action, s16 offset, s16 current_val, s16 default_val, s16 min, s16 max) {
             switch (action) {
                 case Switch5BitAction_Ignore:     return current_val;
                 case Switch5BitAction_Substitute: return offset;
-                case Switch5BitAction_Sum:        return std::clamp(current_val + offset, min, max);
+                case Switch5BitAction_Sum:        return std::clamp<s16>(current_val + offset, min, max);
                 default:                          return default_val;
             }
         }
 
-        ALWAYS_INLINE float ApplyAmCommand(u8 amfm_code, float current_val) {
+        ALWAYS_INLINE s16 ApplyAmCommand(u8 amfm_code, s16 current_val) {
             return ApplyCommand(CommandTable[amfm_code].am_action, CommandTable[amfm_code].am_offset, current_val, DefaultAmplitude, MinAmplitude, MaxAmplitude);
         }
 
-        ALWAYS_INLINE float ApplyFmCommand(u8 amfm_code, float current_val) {
+        ALWAYS_INLINE s16 ApplyFmCommand(u8 amfm_code, s16 current_val) {
             return ApplyCommand(CommandTable[amfm_code].fm_action, CommandTable[amfm_code].fm_offset, current_val, DefaultFrequency, MinFrequency, MaxFrequency);
         }
 
@@ -304,10 +309,10 @@ namespace ams::controller {
     }
 
     void SwitchRumbleDecoder::GetCurrentOutputValue(SwitchVibrationValues* output) {
-        output->low_band_amp   = ExpBase2Lookup[GetLookupIndex(m_state.lo_amp_linear)];
-        output->low_band_freq  = ExpBase2Lookup[GetLookupIndex(m_state.lo_freq_linear)] * CenterFreqLow;
-        output->high_band_amp  = ExpBase2Lookup[GetLookupIndex(m_state.hi_amp_linear)];
-        output->high_band_freq = ExpBase2Lookup[GetLookupIndex(m_state.hi_freq_linear)] * CenterFreqHigh;
+        output->low_band_amp   = AmplitudeLookup[m_state.lo_amp_linear - MinAmplitude];
+        output->low_band_freq  = FrequencyLowLookup[m_state.lo_freq_linear - MinFrequency];
+        output->high_band_amp  = AmplitudeLookup[m_state.hi_amp_linear - MinAmplitude];
+        output->high_band_freq = FrequencyHighLookup[m_state.hi_freq_linear - MinFrequency];
     }
 
 }
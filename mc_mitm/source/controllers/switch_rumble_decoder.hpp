@@ -18,6 +18,9 @@
 
 namespace ams::controller {
 
+    constexpr float SwitchRumbleCenterFreqHigh = 320.0f;
+    constexpr float SwitchRumbleCenterFreqLow  = 160.0f;
+
     struct SwitchVibrationValues {
         float low_band_amp;
         float low_band_freq;
@@ -112,11 +115,12 @@ namespace ams::controller {
             void DecodeThree7Bit(const SwitchEncodedVibrationSamples *encoded, SwitchVibrationSamples *decoded);
             
         private:
+            // Log2 values in 1/32 steps
             struct {
-                float lo_amp_linear;
-                float lo_freq_linear;
-                float hi_amp_linear;
-                float hi_freq_linear;
+                s16 lo_amp_linear;
+                s16 lo_freq_linear;
+                s16 hi_amp_linear;
+                s16 hi_freq_linear;
             } m_state;
     };
 
@@ -17,22 +17,66 @@
 
 namespace ams::controller {
 
-    bool SwitchRumbleHandler::GetDecodedValues(const SwitchEncodedMotorData *encoded, SwitchMotorData *decoded) {
-        return this->GetNextDecodedValue(&m_decoder_left, &encoded->left_motor, &decoded->left_motor) | this->GetNextDecodedValue(&m_decoder_right, &encoded->right_motor, &decoded->right_motor);
+    bool SwitchRumbleHandler::ScheduleSamples(const SwitchEncodedMotorData *encoded, s64 now) {
+        std::scoped_lock lk(m_mutex);
+
+        SwitchMotorData samples[SwitchRumbleSampleCount];
+        const u8 count = std::max(DecodeMotorSamples(&m_decoder_left,  &encoded->left_motor,  samples, &SwitchMotorData::left_motor),
+                                  DecodeMotorSamples(&m_decoder_right, &encoded->right_motor, samples, &SwitchMotorData::right_motor));
+
+        // Leave the pending schedule alone if the packet didn't contain any new samples
+        if (count == 0) {
+            return false;
+        }
+
+        std::memcpy(m_samples, samples, sizeof(m_samples));
+        m_start_timestamp = now;
+        m_count = count;
+        m_next = 0;
+
+        return true;
     }
 
-    bool SwitchRumbleHandler::GetNextDecodedValue(SwitchRumbleDecoder *decoder, const SwitchEncodedVibrationSamples *encoded_samples, SwitchVibrationValues *out_sample) {
+    bool SwitchRumbleHandler::GetDueSample(s64 now, SwitchMotorData *out, s64 *next_due) {
+        std::scoped_lock lk(m_mutex);
+
+        u8 index = m_next;
+        while ((index < m_count) && (m_start_timestamp + index * SwitchRumbleSampleInterval <= now)) {
+            ++index;
+        }
+
+        const bool due = index > m_next;
+        if (due) {
+            *out = m_samples[index - 1];
+            m_next = index;
+        }
+
+        *next_due = index < m_count ? m_start_timestamp + index * SwitchRumbleSampleInterval : RumbleScheduleIdle;
+
+        return due;
+    }
+
+    void SwitchRumbleHandler::Clear() {
+        std::scoped_lock lk(m_mutex);
+
+        m_count = 0;
+        m_next = 0;
+    }
+
+    u8 SwitchRumbleHandler::DecodeMotorSamples(SwitchRumbleDecoder *decoder, const SwitchEncodedVibrationSamples *encoded_samples, SwitchMotorData *out_samples, SwitchVibrationValues SwitchMotorData::*motor) {
         SwitchVibrationSamples decoded_samples;
         decoder->DecodeSamples(encoded_samples, &decoded_samples);
-        if (decoded_samples.count > 0) {
-            // We will just take the first decoded sample and ignore the others
-            *out_sample = decoded_samples.samples[0];
-        } else {
-            // Repeat the current sample if no new samples were decoded
-            decoder->GetCurrentOutputValue(out_sample);
+
+        for (u8 i = 0; i < SwitchRumbleSampleCount; ++i) {
+            if (i < decoded_samples.count) {
+                out_samples[i].*motor = decoded_samples.samples[i];
+            } else {
+                // Hold the last decoded value (or the current one if nothing new was decoded) for the remainder of the packet
+                decoder->GetCurrentOutputValue(&(out_samples[i].*motor));
+            }
         }
 
-        return decoded_samples.count > 0;
+        return decoded_samples.count;
     }
 
 }
@@ -29,16 +29,38 @@ namespace ams::controller {
         SwitchVibrationValues right_motor;
     };
 
+    // Samples within a single rumble packet are intended to be played 5ms apart
+    constexpr size_t SwitchRumbleSampleCount = 3;
+    constexpr s64 SwitchRumbleSampleInterval = 5'000'000;
+
+    // Returned as the next due time when there are no samples left to play
+    constexpr s64 RumbleScheduleIdle = std::numeric_limits<s64>::max();
+
     class SwitchRumbleHandler {
         public:
-            bool GetDecodedValues(const SwitchEncodedMotorData *encoded, SwitchMotorData *decoded);
+            SwitchRumbleHandler() : m_start_timestamp(0), m_count(0), m_next(0) { }
+
+            // Decodes every sample in the packet and queues them for playback starting at the given time. Any samples still pending from the previous packet are replaced
+            bool ScheduleSamples(const SwitchEncodedMotorData *encoded, s64 now);
+
+            // Takes the most recent sample that has fallen due, skipping any that were superseded before they could be played
+            bool GetDueSample(s64 now, SwitchMotorData *out, s64 *next_due);
+
+            void Clear();
 
         private:
-            bool GetNextDecodedValue(SwitchRumbleDecoder *decoder, const SwitchEncodedVibrationSamples *encoded_samples, SwitchVibrationValues *out_sample);
+            static u8 DecodeMotorSamples(SwitchRumbleDecoder *decoder, const SwitchEncodedVibrationSamples *encoded_samples, SwitchMotorData *out_samples, SwitchVibrationValues SwitchMotorData::*motor);
 
         private:
+            os::SdkMutex m_mutex;
+
             SwitchRumbleDecoder m_decoder_left;
             SwitchRumbleDecoder m_decoder_right;
+
+            SwitchMotorData m_samples[SwitchRumbleSampleCount];
+            s64 m_start_timestamp;
+            u8 m_count;
+            u8 m_next;
     };
 
 }
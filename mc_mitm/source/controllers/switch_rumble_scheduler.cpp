@@ -0,0 +1,79 @@
+/*
+ * Copyright (c) 2020-2025 ndeadly
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "switch_rumble_scheduler.hpp"
+#include "switch_rumble_handler.hpp"
+#include "controller_management.hpp"
+#include "../mcmitm_thread_stacks.hpp"
+
+namespace ams::controller {
+
+    namespace {
+
+        constexpr s32 ThreadPriority = -11;
+        constexpr size_t ThreadStackSize = 0x1000;
+        alignas(os::ThreadStackAlignment) constinit u8 g_thread_stack[ThreadStackSize];
+        constinit os::ThreadType g_thread;
+
+        os::Event g_schedule_event(os::EventClearMode_AutoClear);
+
+        s64 GetCurrentTimestamp() {
+            return os::ConvertToTimeSpan(os::GetSystemTick()).GetNanoSeconds();
+        }
+
+        void RumbleSchedulerThreadFunc(void *) {
+            for (;;) {
+                const s64 next_due = ProcessScheduledOutput(GetCurrentTimestamp());
+
+                // Sleep until the next queued sample or held back output report falls due, or until new output arrives
+                if (next_due == RumbleScheduleIdle) {
+                    g_schedule_event.Wait();
+                } else {
+                    const s64 delay = next_due - GetCurrentTimestamp();
+                    if (delay > 0) {
+                        g_schedule_event.TimedWait(TimeSpan::FromNanoSeconds(delay));
+                    }
+                }
+            }
+        }
+
+    }
+
+    Result InitializeRumbleScheduler() {
+        mitm::RegisterThreadStack(&g_thread, g_thread_stack, ThreadStackSize);
+
+        R_TRY(os::CreateThread(&g_thread,
+            RumbleSchedulerThreadFunc,
+            nullptr,
+            g_thread_stack,
+            ThreadStackSize,
+            ThreadPriority
+        ));
+
+        os::SetThreadNamePointer(&g_thread, "mc::RumbleSchedulerThread");
+        os::StartThread(&g_thread);
+
+        R_SUCCEED();
+    }
+
+    void FinalizeRumbleScheduler() {
+        os::DestroyThread(&g_thread);
+    }
+
+    void SignalRumbleScheduler() {
+        g_schedule_event.Signal();
+    }
+
+}
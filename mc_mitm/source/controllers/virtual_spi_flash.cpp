@@ -20,7 +20,19 @@ namespace ams::controller {
 
     namespace {
 
-        constexpr size_t SpiFlashSize = 0x10000;
+        constexpr u32 JournalMagic = util::FourCC<'S','P','I','J'>::Code;
+
+        struct JournalHeader {
+            u32 magic;
+            u16 erased_sectors;
+            u16 page_count;
+            u32 crc;
+        };
+
+        struct JournalEntry {
+            u32 offset;
+            u8 data[VirtualSpiFlash::PageSize];
+        };
 
         // Factory calibration data representing analog stick ranges that span the entire 12-bit data type in x and y
         constinit const SwitchAnalogStickFactoryCalibration lstick_factory_calib = { 0xff, 0xf7, 0x7f, 0x00, 0x08, 0x80, 0x00, 0x08, 0x80 };
@@ -29,49 +41,200 @@ namespace ams::controller {
         // Stick parameters data that produce a 12.5% inner deadzone and a 5% outer deadzone (in relation to the full 12 bit range above)
         constinit const SwitchAnalogStickParameters default_stick_params = { 0x0f, 0x30, 0x61, 0x00, 0x31, 0xf3, 0xd4, 0x14, 0x54, 0x41, 0x15, 0x54, 0xc7, 0x79, 0x9c, 0x33, 0x36, 0x63 };
 
+        constinit const Switch6AxisCalibrationData factory_motion_calibration = {
+            .acc_bias = {0, 0, 0},
+            .acc_sensitivity = {16384, 16384, 16384},
+            .gyro_bias = {0, 0, 0},
+            .gyro_sensitivity = {13371, 13371, 13371}
+        };
+
+        constinit const struct {
+            SwitchAnalogStickFactoryCalibration lstick_factory_calib;
+            SwitchAnalogStickFactoryCalibration rstick_factory_calib;
+        } factory_stick_calibration = { lstick_factory_calib, rstick_factory_calib };
+
+        constinit const struct {
+            RGBColour body;
+            RGBColour buttons;
+            RGBColour left_grip;
+            RGBColour right_grip;
+        } factory_colours = { {0x32, 0x32, 0x32}, {0xe6, 0xe6, 0xe6}, {0x46, 0x46, 0x46}, {0x46, 0x46, 0x46} };
+
+        constinit const Switch6AxisHorizontalOffset factory_horizontal_offset = {0, 0, 0};
+
+        constinit const struct {
+            SwitchAnalogStickParameters lstick_default_parameters;
+            SwitchAnalogStickParameters rstick_default_parameters;
+        } factory_stick_parameters = { default_stick_params, default_stick_params };
+
+        struct DefaultMemoryRegion {
+            int offset;
+            const void *data;
+            size_t size;
+        };
+
+        // Built-in flash image shared by all controllers. Anything outside of these regions reads as erased
+        constinit const DefaultMemoryRegion default_memory_regions[] = {
+            { 0x6020, &factory_motion_calibration, sizeof(factory_motion_calibration) },
+            { 0x603d, &factory_stick_calibration,  sizeof(factory_stick_calibration)  },
+            { 0x6050, &factory_colours,            sizeof(factory_colours)            },
+            { 0x6080, &factory_horizontal_offset,  sizeof(factory_horizontal_offset)  },
+            { 0x6086, &factory_stick_parameters,   sizeof(factory_stick_parameters)   },
+        };
+
+        void ReadDefaultImage(int offset, void *data, size_t size) {
+            std::memset(data, 0xff, size);
+
+            for (auto &region : default_memory_regions) {
+                const int start = std::max(offset, region.offset);
+                const int end = std::min(offset + static_cast<int>(size), region.offset + static_cast<int>(region.size));
+                if (start < end) {
+                    std::memcpy(reinterpret_cast<u8 *>(data) + (start - offset), reinterpret_cast<const u8 *>(region.data) + (start - region.offset), end - start);
+                }
+            }
+        }
+
+        bool IsDefaultSectorErased(int offset) {
+            for (auto &region : default_memory_regions) {
+                if ((region.offset < offset + static_cast<int>(VirtualSpiFlash::SectorSize)) && (offset < region.offset + static_cast<int>(region.size))) {
+                    return false;
+                }
+            }
+
+            return true;
+        }
+
     }
 
     VirtualSpiFlash::~VirtualSpiFlash() {
-        fs::CloseFile(m_virtual_memory_file);
+        if (m_initialized) {
+            this->Flush();
+            fs::CloseFile(m_journal_file);
+        }
     }
 
-    Result VirtualSpiFlash::Initialize(const char *path) {
-        // Check if the virtual spi flash file already exists and create it if not
+    Result VirtualSpiFlash::Initialize(const char *directory) {
+        m_directory = directory;
+
+        for (auto &page : m_cached_pages) {
+            page.offset = InvalidPageOffset;
+            page.dirty = false;
+        }
+
+        // Find which sectors this controller has written to
+        for (unsigned int i = 0; i < Size / SectorSize; ++i) {
+            bool file_exists;
+            R_TRY(fs::HasFile(&file_exists, this->GetSectorPath(i * SectorSize).c_str()));
+            if (file_exists) {
+                m_overlay_sectors |= BIT(i);
+            }
+        }
+
+        // Convert a full flash image from an older version into overlay sectors
+        const std::string legacy_path = m_directory + "/spi_flash.bin";
+        bool legacy_exists;
+        R_TRY(fs::HasFile(&legacy_exists, legacy_path.c_str()));
+        if (legacy_exists) {
+            R_TRY(this->MigrateLegacyImage(legacy_path.c_str()));
+        }
+
+        // Open the write-back journal, creating it if necessary
+        const std::string journal_path = m_directory + "/spi_flash.journal";
         bool file_exists;
-        R_TRY(fs::HasFile(&file_exists, path));
+        R_TRY(fs::HasFile(&file_exists, journal_path.c_str()));
         if (!file_exists) {
-            R_TRY(this->CreateFile(path));
+            R_TRY(fs::CreateFile(journal_path.c_str(), 0));
         }
+        R_TRY(fs::OpenFile(std::addressof(m_journal_file), journal_path.c_str(), fs::OpenMode_ReadWrite | fs::OpenMode_AllowAppend));
+        ON_RESULT_FAILURE { fs::CloseFile(m_journal_file); };
 
-        // Open the virtual spi flash file for read and write
-        R_TRY(fs::OpenFile(std::addressof(m_virtual_memory_file), path, fs::OpenMode_ReadWrite));
+        // Replay any write-back that was interrupted before it reached the overlay
+        R_TRY(this->ApplyJournal());
 
         // Make sure that all memory regions that we care about are initialised with defaults
         R_TRY(this->EnsureInitialized());
 
+        m_initialized = true;
+
         R_SUCCEED();
     }
 
     Result VirtualSpiFlash::Read(int offset, void *data, size_t size) {
-        R_RETURN(fs::ReadFile(m_virtual_memory_file, offset, data, size));
+        std::scoped_lock lk(m_mutex);
+
+        R_UNLESS(offset >= 0 && offset + size <= Size, fs::ResultOutOfRange());
+
+        auto out = reinterpret_cast<u8 *>(data);
+        while (size > 0) {
+            const int page_offset = util::AlignDown(offset, PageSize);
+            const size_t copy_offset = offset - page_offset;
+            const size_t copy_size = std::min(size, PageSize - copy_offset);
+
+            CachedPage *page;
+            R_TRY(this->AcquirePage(page_offset, true, &page));
+            if (page != nullptr) {
+                std::memcpy(out, page->data + copy_offset, copy_size);
+            } else {
+                u8 page_data[PageSize];
+                R_TRY(this->ReadUncachedPage(page_offset, page_data));
+                std::memcpy(out, page_data + copy_offset, copy_size);
+            }
+
+            out += copy_size;
+            offset += copy_size;
+            size -= copy_size;
+        }
+
+        R_SUCCEED();
     }
 
     Result VirtualSpiFlash::Write(int offset, const void *data, size_t size) {
-        R_RETURN(fs::WriteFile(m_virtual_memory_file, offset, data, size, fs::WriteOption::Flush));
+        std::scoped_lock lk(m_mutex);
+
+        R_UNLESS(offset >= 0 && offset + size <= Size, fs::ResultOutOfRange());
+
+        auto in = reinterpret_cast<const u8 *>(data);
+        while (size > 0) {
+            const int page_offset = util::AlignDown(offset, PageSize);
+            const size_t copy_offset = offset - page_offset;
+            const size_t copy_size = std::min(size, PageSize - copy_offset);
+
+            // No need to fetch the current contents if the whole page is being overwritten
+            CachedPage *page;
+            R_TRY(this->AcquirePage(page_offset, copy_size != PageSize, &page));
+            if (page == nullptr) {
+                // Only reached when more pages have been modified since the last flush than the cache holds
+                R_TRY(this->FlushImpl());
+                R_TRY(this->AcquirePage(page_offset, copy_size != PageSize, &page));
+            }
+            std::memcpy(page->data + copy_offset, in, copy_size);
+            page->dirty = true;
+
+            in += copy_size;
+            offset += copy_size;
+            size -= copy_size;
+        }
+
+        R_SUCCEED();
     }
 
     Result VirtualSpiFlash::SectorErase(int offset) {
-        u8 buff[64];
-        std::memset(buff, 0xff, sizeof(buff));
+        std::scoped_lock lk(m_mutex);
+
+        R_UNLESS(offset >= 0 && static_cast<size_t>(offset) < Size, fs::ResultOutOfRange());
 
-        // Fill sector at offset with 0xff
-        unsigned int sector_size = 0x1000;
-        for (unsigned int i = 0; i < (sector_size / sizeof(buff)); ++i) {
-            R_TRY(fs::WriteFile(m_virtual_memory_file, offset, buff, sizeof(buff), fs::WriteOption::None));
-            offset += sizeof(buff);
+        const int sector_offset = util::AlignDown(offset, SectorSize);
+
+        // Cached pages within the sector now read back as erased
+        for (auto &page : m_cached_pages) {
+            if (page.offset != InvalidPageOffset && util::AlignDown(page.offset, SectorSize) == sector_offset) {
+                std::memset(page.data, 0xff, sizeof(page.data));
+                page.dirty = false;
+            }
         }
 
-        R_TRY(fs::FlushFile(m_virtual_memory_file));
+        // Defer erasing the sector on the SD card until the next write-back
+        m_erased_sectors |= BIT(sector_offset / SectorSize);
 
         R_SUCCEED();
     }
@@ -92,73 +255,271 @@ namespace ams::controller {
         R_SUCCEED();
     }
 
-    Result VirtualSpiFlash::CreateFile(const char *path) {
-        // Create file representing first 64KB of SPI flash
-        R_TRY(fs::CreateFile(path, SpiFlashSize));
+    Result VirtualSpiFlash::Flush() {
+        std::scoped_lock lk(m_mutex);
+        R_RETURN(this->FlushImpl());
+    }
+
+    Result VirtualSpiFlash::EnsureMemoryRegion(int offset, const void *data, size_t size) {
+        bool initialized;
+        R_TRY(this->CheckMemoryRegion(offset, size, &initialized));
+        if (!initialized) {
+            R_TRY(this->Write(offset, data, size));
+        }
 
-        R_TRY(fs::OpenFile(std::addressof(m_virtual_memory_file), path, fs::OpenMode_Write));
-        ON_SCOPE_EXIT { fs::CloseFile(m_virtual_memory_file); };
+        R_SUCCEED();
+    }
 
-        // Fill the file with 0xff
-        u8 buff[64];
-        std::memset(buff, 0xff, sizeof(buff));
-        unsigned int offset = 0;
-        while (offset < SpiFlashSize) {
-            size_t write_size = std::min(static_cast<size_t>(SpiFlashSize - offset), sizeof(buff));
-            R_TRY(fs::WriteFile(m_virtual_memory_file, offset, buff, write_size, fs::WriteOption::None));
-            offset += write_size;
+    Result VirtualSpiFlash::EnsureInitialized() {
+        // Only has an effect if the controller has erased a default region
+        for (auto &region : default_memory_regions) {
+            R_TRY(this->EnsureMemoryRegion(region.offset, region.data, region.size));
         }
 
-        R_TRY(fs::FlushFile(m_virtual_memory_file));
+        R_TRY(this->Flush());
 
         R_SUCCEED();
     }
 
-    Result VirtualSpiFlash::EnsureMemoryRegion(int offset, const void *data, size_t size) {
-        bool initialized;
-        R_TRY(this->CheckMemoryRegion(offset, size, &initialized));
-        if (!initialized) {
-            R_TRY(fs::WriteFile(m_virtual_memory_file, offset, data, size, fs::WriteOption::None));
+    std::string VirtualSpiFlash::GetSectorPath(int offset) {
+        char path[0x20];
+        util::SNPrintf(path, sizeof(path), "/spi_flash_%04x.bin", offset);
+        return m_directory + path;
+    }
+
+    Result VirtualSpiFlash::AcquirePage(int offset, bool load, CachedPage **out_page) {
+        ++m_access_count;
+
+        // Serve the request from the cache if possible, otherwise pick the least recently used clean slot. Modified pages stay
+        // put until the next Flush, which runs off the report path
+        CachedPage *victim = nullptr;
+        for (auto &page : m_cached_pages) {
+            if (page.offset == offset) {
+                page.last_access = m_access_count;
+                *out_page = &page;
+                R_SUCCEED();
+            }
+
+            if (page.dirty) {
+                continue;
+            }
+
+            if (victim == nullptr || page.offset == InvalidPageOffset || (victim->offset != InvalidPageOffset && page.last_access < victim->last_access)) {
+                victim = &page;
+            }
+        }
+
+        // Every slot holds unflushed changes, leave it to the caller to go around the cache
+        if (victim == nullptr) {
+            *out_page = nullptr;
+            R_SUCCEED();
         }
 
+        victim->offset = InvalidPageOffset;
+
+        if (load) {
+            R_TRY(this->ReadUncachedPage(offset, victim->data));
+        }
+
+        victim->offset = offset;
+        victim->last_access = m_access_count;
+        *out_page = victim;
+
         R_SUCCEED();
     }
 
-    Result VirtualSpiFlash::EnsureInitialized() {
-        const Switch6AxisCalibrationData factory_motion_calibration = {
-            .acc_bias = {0, 0, 0},
-            .acc_sensitivity = {16384, 16384, 16384},
-            .gyro_bias = {0, 0, 0},
-            .gyro_sensitivity = {13371, 13371, 13371}
+    Result VirtualSpiFlash::ReadUncachedPage(int offset, void *data) {
+        // Erases that haven't been written back yet take precedence over the backing sector
+        if (m_erased_sectors & BIT(offset / SectorSize)) {
+            std::memset(data, 0xff, PageSize);
+            R_SUCCEED();
+        }
+
+        R_RETURN(this->ReadBackingPage(offset, data));
+    }
+
+    Result VirtualSpiFlash::FlushImpl() {
+        JournalHeader header = {
+            .magic = JournalMagic,
+            .erased_sectors = m_erased_sectors,
+            .page_count = 0,
+            .crc = crc32Calculate(&m_erased_sectors, sizeof(m_erased_sectors))
         };
-        R_TRY(this->EnsureMemoryRegion(0x6020, &factory_motion_calibration, sizeof(factory_motion_calibration)));
 
-        const struct {
-            SwitchAnalogStickFactoryCalibration lstick_factory_calib;
-            SwitchAnalogStickFactoryCalibration rstick_factory_calib;
-        } factory_stick_calibration = { lstick_factory_calib, rstick_factory_calib };
-        R_TRY(this->EnsureMemoryRegion(0x603d, &factory_stick_calibration, sizeof(factory_stick_calibration)));
+        // Record all pending changes in the journal before touching the flash image
+        for (auto &page : m_cached_pages) {
+            if (page.dirty) {
+                const u32 entry_offset = page.offset;
+                const s64 file_offset = sizeof(JournalHeader) + header.page_count * sizeof(JournalEntry);
+                R_TRY(fs::WriteFile(m_journal_file, file_offset, &entry_offset, sizeof(entry_offset), fs::WriteOption::None));
+                R_TRY(fs::WriteFile(m_journal_file, file_offset + sizeof(entry_offset), page.data, sizeof(page.data), fs::WriteOption::None));
+
+                header.crc = crc32CalculateWithSeed(header.crc, &entry_offset, sizeof(entry_offset));
+                header.crc = crc32CalculateWithSeed(header.crc, page.data, sizeof(page.data));
+                ++header.page_count;
+            }
+        }
 
-        const struct {
-            RGBColour body;
-            RGBColour buttons;
-            RGBColour left_grip;
-            RGBColour right_grip;
-        } factory_colours = { {0x32, 0x32, 0x32}, {0xe6, 0xe6, 0xe6}, {0x46, 0x46, 0x46}, {0x46, 0x46, 0x46} };
-        R_TRY(this->EnsureMemoryRegion(0x6050, &factory_colours, sizeof(factory_colours)));
+        if ((header.erased_sectors == 0) && (header.page_count == 0)) {
+            R_SUCCEED();
+        }
 
-        const Switch6AxisHorizontalOffset offset = {0, 0, 0};
-        R_TRY(this->EnsureMemoryRegion(0x6080, &offset, sizeof(offset)));
+        // The header is written last so a torn journal is never mistaken for a complete one
+        R_TRY(fs::WriteFile(m_journal_file, 0, &header, sizeof(header), fs::WriteOption::Flush));
 
-        const struct {
-            SwitchAnalogStickParameters lstick_default_parameters;
-            SwitchAnalogStickParameters rstick_default_parameters;
-        } factory_stick_parameters = { default_stick_params, default_stick_params };
-        R_TRY(this->EnsureMemoryRegion(0x6086, &factory_stick_parameters, sizeof(factory_stick_parameters)));
+        R_TRY(this->ApplyJournal());
+
+        m_erased_sectors = 0;
+        for (auto &page : m_cached_pages) {
+            page.dirty = false;
+        }
+
+        R_SUCCEED();
+    }
+
+    Result VirtualSpiFlash::ApplyJournal() {
+        s64 journal_size;
+        R_TRY(fs::GetFileSize(&journal_size, m_journal_file));
+        if (journal_size < static_cast<s64>(sizeof(JournalHeader))) {
+            R_SUCCEED();
+        }
+
+        JournalHeader header;
+        R_TRY(fs::ReadFile(m_journal_file, 0, &header, sizeof(header)));
+        if ((header.magic != JournalMagic) || (journal_size < static_cast<s64>(sizeof(JournalHeader) + header.page_count * sizeof(JournalEntry)))) {
+            R_SUCCEED();
+        }
+
+        // Validate the journal contents before applying anything
+        JournalEntry entry;
+        u32 crc = crc32Calculate(&header.erased_sectors, sizeof(header.erased_sectors));
+        for (u16 i = 0; i < header.page_count; ++i) {
+            R_TRY(fs::ReadFile(m_journal_file, sizeof(JournalHeader) + i * sizeof(JournalEntry), &entry, sizeof(entry)));
+            crc = crc32CalculateWithSeed(crc, &entry, sizeof(entry));
+        }
+
+        if (crc == header.crc) {
+            for (unsigned int i = 0; i < Size / SectorSize; ++i) {
+                if (header.erased_sectors & BIT(i)) {
+                    R_TRY(this->EraseBackingSector(i * SectorSize));
+                }
+            }
+
+            for (u16 i = 0; i < header.page_count; ++i) {
+                R_TRY(fs::ReadFile(m_journal_file, sizeof(JournalHeader) + i * sizeof(JournalEntry), &entry, sizeof(entry)));
+                R_UNLESS(entry.offset + sizeof(entry.data) <= Size, fs::ResultOutOfRange());
+                R_TRY(this->WriteBackingPage(entry.offset, entry.data));
+            }
+        }
 
-        R_TRY(fs::FlushFile(m_virtual_memory_file));
+        // Retire the journal
+        header.magic = 0;
+        R_TRY(fs::WriteFile(m_journal_file, 0, &header, sizeof(header), fs::WriteOption::Flush));
 
         R_SUCCEED();
     }
 
+    Result VirtualSpiFlash::ReadBackingPage(int offset, void *data) {
+        const int sector_offset = util::AlignDown(offset, SectorSize);
+        if (!(m_overlay_sectors & BIT(sector_offset / SectorSize))) {
+            ReadDefaultImage(offset, data, PageSize);
+            R_SUCCEED();
+        }
+
+        fs::FileHandle file;
+        R_TRY(fs::OpenFile(std::addressof(file), this->GetSectorPath(sector_offset).c_str(), fs::OpenMode_Read));
+        ON_SCOPE_EXIT { fs::CloseFile(file); };
+
+        R_RETURN(fs::ReadFile(file, offset - sector_offset, data, PageSize));
+    }
+
+    Result VirtualSpiFlash::WriteBackingPage(int offset, const void *data) {
+        const int sector_offset = util::AlignDown(offset, SectorSize);
+        if (!(m_overlay_sectors & BIT(sector_offset / SectorSize))) {
+            R_TRY(this->CreateOverlaySector(sector_offset, false));
+        }
+
+        fs::FileHandle file;
+        R_TRY(fs::OpenFile(std::addressof(file), this->GetSectorPath(sector_offset).c_str(), fs::OpenMode_Write));
+        ON_SCOPE_EXIT { fs::CloseFile(file); };
+
+        R_RETURN(fs::WriteFile(file, offset - sector_offset, data, PageSize, fs::WriteOption::Flush));
+    }
+
+    Result VirtualSpiFlash::EraseBackingSector(int offset) {
+        // Nothing to store if the sector would read back as erased anyway
+        if (!(m_overlay_sectors & BIT(offset / SectorSize)) && IsDefaultSectorErased(offset)) {
+            R_SUCCEED();
+        }
+
+        if (m_overlay_sectors & BIT(offset / SectorSize)) {
+            R_TRY(fs::DeleteFile(this->GetSectorPath(offset).c_str()));
+            m_overlay_sectors &= ~BIT(offset / SectorSize);
+        }
+
+        R_RETURN(this->CreateOverlaySector(offset, true));
+    }
+
+    Result VirtualSpiFlash::CreateOverlaySector(int offset, bool erased) {
+        const std::string path = this->GetSectorPath(offset);
+        R_TRY(fs::CreateFile(path.c_str(), SectorSize));
+
+        fs::FileHandle file;
+        R_TRY(fs::OpenFile(std::addressof(file), path.c_str(), fs::OpenMode_Write));
+        ON_SCOPE_EXIT { fs::CloseFile(file); };
+
+        // Seed the sector with either erased or default contents
+        u8 buff[PageSize];
+        for (unsigned int i = 0; i < SectorSize; i += sizeof(buff)) {
+            if (erased) {
+                std::memset(buff, 0xff, sizeof(buff));
+            } else {
+                ReadDefaultImage(offset + i, buff, sizeof(buff));
+            }
+            R_TRY(fs::WriteFile(file, i, buff, sizeof(buff), fs::WriteOption::None));
+        }
+
+        R_TRY(fs::FlushFile(file));
+
+        m_overlay_sectors |= BIT(offset / SectorSize);
+
+        R_SUCCEED();
+    }
+
+    Result VirtualSpiFlash::MigrateLegacyImage(const char *path) {
+        {
+            fs::FileHandle file;
+            R_TRY(fs::OpenFile(std::addressof(file), path, fs::OpenMode_Read));
+            ON_SCOPE_EXIT { fs::CloseFile(file); };
+
+            u8 buff[PageSize];
+            u8 default_buff[PageSize];
+            for (unsigned int sector_offset = 0; sector_offset < Size; sector_offset += SectorSize) {
+                if (m_overlay_sectors & BIT(sector_offset / SectorSize)) {
+                    continue;
+                }
+
+                // Only sectors that differ from the built-in image need to be kept
+                bool modified = false;
+                for (unsigned int offset = sector_offset; offset < sector_offset + SectorSize; offset += sizeof(buff)) {
+                    R_TRY(fs::ReadFile(file, offset, buff, sizeof(buff)));
+                    ReadDefaultImage(offset, default_buff, sizeof(default_buff));
+                    if (std::memcmp(buff, default_buff, sizeof(buff)) != 0) {
+                        modified = true;
+                        break;
+                    }
+                }
+
+                if (modified) {
+                    for (unsigned int offset = sector_offset; offset < sector_offset + SectorSize; offset += sizeof(buff)) {
+                        R_TRY(fs::ReadFile(file, offset, buff, sizeof(buff)));
+                        R_TRY(this->WriteBackingPage(offset, buff));
+                    }
+                }
+            }
+        }
+
+        R_RETURN(fs::DeleteFile(path));
+    }
+
 }
@@ -15,26 +15,64 @@
  */
 #pragma once
 #include <stratosphere.hpp>
+#include <string>
 
 namespace ams::controller {
 
     class VirtualSpiFlash {
         public:
-            VirtualSpiFlash() {};
+            static constexpr size_t Size = 0x10000;
+            static constexpr size_t SectorSize = 0x1000;
+            static constexpr size_t PageSize = 0x100;
+
+            VirtualSpiFlash() : m_access_count(0), m_erased_sectors(0), m_overlay_sectors(0), m_initialized(false) {};
             ~VirtualSpiFlash();
             
-            Result Initialize(const char *path);
+            Result Initialize(const char *directory);
             Result Read(int offset, void *data, size_t size);
             Result Write(int offset, const void *data, size_t size);
             Result SectorErase(int offset);
             Result CheckMemoryRegion(int offset, size_t size, bool *is_initialized);
+            Result Flush();
 
         private:
-            Result CreateFile(const char *path);
+            // Enough for every page hid reads or writes between flushes (pairing, factory config and user calibration), so a
+            // dirty page never needs to be evicted on the report path
+            static constexpr size_t CachedPageCount = 8;
+            static constexpr int InvalidPageOffset = -1;
+
+            struct CachedPage {
+                int offset;
+                bool dirty;
+                u32 last_access;
+                u8 data[PageSize];
+            };
+
             Result EnsureMemoryRegion(int offset, const void *data, size_t size);
             Result EnsureInitialized();
 
-            fs::FileHandle m_virtual_memory_file;
+            Result AcquirePage(int offset, bool load, CachedPage **out_page);
+            Result ReadUncachedPage(int offset, void *data);
+            Result FlushImpl();
+            Result ApplyJournal();
+            Result ReadBackingPage(int offset, void *data);
+            Result WriteBackingPage(int offset, const void *data);
+            Result EraseBackingSector(int offset);
+            Result CreateOverlaySector(int offset, bool erased);
+            Result MigrateLegacyImage(const char *path);
+
+            std::string GetSectorPath(int offset);
+
+            os::SdkMutex m_mutex;
+
+            std::string m_directory;
+            fs::FileHandle m_journal_file;
+
+            CachedPage m_cached_pages[CachedPageCount];
+            u32 m_access_count;
+            u16 m_erased_sectors;
+            u16 m_overlay_sectors;
+            bool m_initialized;
     };
 
 }
@@ -15,6 +15,7 @@
  */
 #include "wii_controller.hpp"
 #include "controller_utils.hpp"
+#include "../mcmitm_config.hpp"
 #include "../async/async.hpp"
 #include <stratosphere.hpp>
 
@@ -25,10 +26,10 @@ namespace ams::controller {
         constinit const u8 InitData1[] = { 0x55 };
         constinit const u8 InitData2[] = { 0x00 };
 
-        constexpr float NunchuckStickScaleFactor = float(UINT12_MAX) / 0xb8;
-        constexpr float WiiUStickScaleFactor     = 2.0;
-        constexpr float LeftStickScaleFactor     = float(UINT12_MAX) / 0x3f;
-        constexpr float RighStickScaleFactor     = float(UINT12_MAX) / 0x1f;
+        constexpr s32 NunchuckStickRange = 0xb8;
+        constexpr s32 WiiUStickScaleFactor = 2;
+        constexpr s32 LeftStickRange       = 0x3f;
+        constexpr s32 RightStickRange      = 0x1f;
 
         constinit const u16 DpadStickPositions[] = { SwitchAnalogStick::Min, SwitchAnalogStick::Center, SwitchAnalogStick::Max };
 
@@ -61,6 +62,11 @@ namespace ams::controller {
         if (m_id.pid == 0x0306) {
             // Read the accelerometer calibration from Wiimote memory
             R_TRY(this->GetAccelerometerCalibration(&m_accel_calibration));
+            m_accel_scale = {
+                MakeAxisCalibration(m_accel_calibration.acc_x_0g, m_accel_calibration.acc_x_1g, 1.0f),
+                MakeAxisCalibration(m_accel_calibration.acc_y_0g, m_accel_calibration.acc_y_1g, 1.0f),
+                MakeAxisCalibration(m_accel_calibration.acc_z_0g, m_accel_calibration.acc_z_1g, 1.0f)
+            };
         }
 
         // Request a status report to check extension controller status
@@ -205,9 +211,9 @@ namespace ams::controller {
         u16 y_raw = (accel->y << 2) | (((buttons->raw[1] >> 4) & 0x1) << 1);
         u16 z_raw = (accel->z << 2) | (((buttons->raw[1] >> 5) & 0x1) << 1);
 
-        float x = -float(x_raw - m_accel_calibration.acc_x_0g) / float(m_accel_calibration.acc_x_1g - m_accel_calibration.acc_x_0g);
-        float y = -float(y_raw - m_accel_calibration.acc_y_0g) / float(m_accel_calibration.acc_y_1g - m_accel_calibration.acc_y_0g);
-        float z =  float(z_raw - m_accel_calibration.acc_z_0g) / float(m_accel_calibration.acc_z_1g - m_accel_calibration.acc_z_0g);
+        float x = -m_accel_scale.x.Apply(x_raw);
+        float y = -m_accel_scale.y.Apply(y_raw);
+        float z =  m_accel_scale.z.Apply(z_raw);
 
         if (m_orientation == WiiControllerOrientation_Horizontal) {
             m_accel.x =  x;
@@ -245,8 +251,8 @@ namespace ams::controller {
         auto extension_data = reinterpret_cast<const WiiNunchuckExtensionData *>(ext);
 
         m_left_stick.SetData(
-            std::clamp<u16>(static_cast<u16>(NunchuckStickScaleFactor * (extension_data->stick_x - 0x80) + SwitchAnalogStick::Center), SwitchAnalogStick::Min, SwitchAnalogStick::Max),
-            std::clamp<u16>(static_cast<u16>(NunchuckStickScaleFactor * (extension_data->stick_y - 0x80) + SwitchAnalogStick::Center), SwitchAnalogStick::Min, SwitchAnalogStick::Max)
+            std::clamp<s32>(ScaleAnalogStickValue<NunchuckStickRange>(extension_data->stick_x - 0x80) + SwitchAnalogStick::Center, SwitchAnalogStick::Min, SwitchAnalogStick::Max),
+            std::clamp<s32>(ScaleAnalogStickValue<NunchuckStickRange>(extension_data->stick_y - 0x80) + SwitchAnalogStick::Center, SwitchAnalogStick::Min, SwitchAnalogStick::Max)
         );
 
         m_buttons.L  = !extension_data->C;
@@ -257,12 +263,12 @@ namespace ams::controller {
         auto extension_data = reinterpret_cast<const WiiClassicControllerExtensionData *>(ext);
 
         m_left_stick.SetData(
-            static_cast<u16>(LeftStickScaleFactor * (extension_data->left_stick_x - 0x20) + SwitchAnalogStick::Center) & UINT12_MAX,
-            static_cast<u16>(LeftStickScaleFactor * (extension_data->left_stick_y - 0x20) + SwitchAnalogStick::Center) & UINT12_MAX
+            static_cast<u16>(ScaleAnalogStickValue<LeftStickRange>(extension_data->left_stick_x - 0x20) + SwitchAnalogStick::Center) & UINT12_MAX,
+            static_cast<u16>(ScaleAnalogStickValue<LeftStickRange>(extension_data->left_stick_y - 0x20) + SwitchAnalogStick::Center) & UINT12_MAX
         );
         m_right_stick.SetData(
-            static_cast<u16>(RighStickScaleFactor * (((extension_data->right_stick_x_43 << 3) | (extension_data->right_stick_x_21 << 1) | extension_data->right_stick_x_0) - 0x10) + SwitchAnalogStick::Center) & UINT12_MAX,
-            static_cast<u16>(RighStickScaleFactor * (extension_data->right_stick_y - 0x10) + SwitchAnalogStick::Center) & UINT12_MAX
+            static_cast<u16>(ScaleAnalogStickValue<RightStickRange>(((extension_data->right_stick_x_43 << 3) | (extension_data->right_stick_x_21 << 1) | extension_data->right_stick_x_0) - 0x10) + SwitchAnalogStick::Center) & UINT12_MAX,
+            static_cast<u16>(ScaleAnalogStickValue<RightStickRange>(extension_data->right_stick_y - 0x10) + SwitchAnalogStick::Center) & UINT12_MAX
         );
 
         m_buttons.dpad_down  |= !extension_data->buttons.dpad_down;
@@ -275,9 +281,9 @@ namespace ams::controller {
         m_buttons.X  = !extension_data->buttons.X;
         m_buttons.Y  = !extension_data->buttons.Y;
 
-        m_buttons.L  = !extension_data->buttons.L | (((extension_data->left_trigger_43 << 3) | (extension_data->left_trigger_20)) > (m_trigger_threshold * 0x1f));
+        m_buttons.L  = !extension_data->buttons.L | (((extension_data->left_trigger_43 << 3) | (extension_data->left_trigger_20)) > this->GetTriggerThreshold<0x1f>());
         m_buttons.ZL = !extension_data->buttons.ZL;
-        m_buttons.R  = !extension_data->buttons.R | (extension_data->right_trigger > (m_trigger_threshold * 0x1f));
+        m_buttons.R  = !extension_data->buttons.R | (extension_data->right_trigger > this->GetTriggerThreshold<0x1f>());
         m_buttons.ZR = !extension_data->buttons.ZR;
 
         m_buttons.minus |= !extension_data->buttons.minus;
@@ -290,12 +296,12 @@ namespace ams::controller {
         auto extension_data = reinterpret_cast<const WiiUProExtensionData *>(ext);
 
         m_left_stick.SetData(
-            std::clamp<u16>(((WiiUStickScaleFactor * (extension_data->left_stick_x - SwitchAnalogStick::Center))) + SwitchAnalogStick::Center, SwitchAnalogStick::Min, SwitchAnalogStick::Max),
-            std::clamp<u16>(((WiiUStickScaleFactor * (extension_data->left_stick_y - SwitchAnalogStick::Center))) + SwitchAnalogStick::Center, SwitchAnalogStick::Min, SwitchAnalogStick::Max)
+            std::clamp<s32>(((WiiUStickScaleFactor * (extension_data->left_stick_x - SwitchAnalogStick::Center))) + SwitchAnalogStick::Center, SwitchAnalogStick::Min, SwitchAnalogStick::Max),
+            std::clamp<s32>(((WiiUStickScaleFactor * (extension_data->left_stick_y - SwitchAnalogStick::Center))) + SwitchAnalogStick::Center, SwitchAnalogStick::Min, SwitchAnalogStick::Max)
         );
         m_right_stick.SetData(
-            std::clamp<u16>(((WiiUStickScaleFactor * (extension_data->right_stick_x - SwitchAnalogStick::Center))) + SwitchAnalogStick::Center, SwitchAnalogStick::Min, SwitchAnalogStick::Max),
-            std::clamp<u16>(((WiiUStickScaleFactor * (extension_data->right_stick_y - SwitchAnalogStick::Center))) + SwitchAnalogStick::Center, SwitchAnalogStick::Min, SwitchAnalogStick::Max)
+            std::clamp<s32>(((WiiUStickScaleFactor * (extension_data->right_stick_x - SwitchAnalogStick::Center))) + SwitchAnalogStick::Center, SwitchAnalogStick::Min, SwitchAnalogStick::Max),
+            std::clamp<s32>(((WiiUStickScaleFactor * (extension_data->right_stick_y - SwitchAnalogStick::Center))) + SwitchAnalogStick::Center, SwitchAnalogStick::Min, SwitchAnalogStick::Max)
         );
 
         m_buttons.dpad_down  = !extension_data->buttons.dpad_down;
@@ -405,8 +411,8 @@ namespace ams::controller {
         auto extension_data = reinterpret_cast<const WiiNunchuckPassthroughExtensionData *>(ext);
 
         m_left_stick.SetData(
-            std::clamp<u16>(static_cast<u16>(NunchuckStickScaleFactor * (extension_data->stick_x - 0x80) + SwitchAnalogStick::Center), SwitchAnalogStick::Min, SwitchAnalogStick::Max),
-            std::clamp<u16>(static_cast<u16>(NunchuckStickScaleFactor * (extension_data->stick_y - 0x80) + SwitchAnalogStick::Center), SwitchAnalogStick::Min, SwitchAnalogStick::Max)
+            std::clamp<s32>(ScaleAnalogStickValue<NunchuckStickRange>(extension_data->stick_x - 0x80) + SwitchAnalogStick::Center, SwitchAnalogStick::Min, SwitchAnalogStick::Max),
+            std::clamp<s32>(ScaleAnalogStickValue<NunchuckStickRange>(extension_data->stick_y - 0x80) + SwitchAnalogStick::Center, SwitchAnalogStick::Min, SwitchAnalogStick::Max)
         );
 
         m_buttons.L  = !extension_data->C;
@@ -417,12 +423,12 @@ namespace ams::controller {
         auto extension_data = reinterpret_cast<const WiiClassicControllerPassthroughExtensionData *>(ext);
 
         m_left_stick.SetData(
-            static_cast<u16>(LeftStickScaleFactor * ((extension_data->left_stick_x_51 << 1) - 0x20) + SwitchAnalogStick::Center) & UINT12_MAX,
-            static_cast<u16>(LeftStickScaleFactor * ((extension_data->left_stick_y_51 << 1) - 0x20) + SwitchAnalogStick::Center) & UINT12_MAX
+            static_cast<u16>(ScaleAnalogStickValue<LeftStickRange>((extension_data->left_stick_x_51 << 1) - 0x20) + SwitchAnalogStick::Center) & UINT12_MAX,
+            static_cast<u16>(ScaleAnalogStickValue<LeftStickRange>((extension_data->left_stick_y_51 << 1) - 0x20) + SwitchAnalogStick::Center) & UINT12_MAX
         );
         m_right_stick.SetData(
-            static_cast<u16>(RighStickScaleFactor * (((extension_data->right_stick_x_43 << 3) | (extension_data->right_stick_x_21 << 1) | extension_data->right_stick_x_0) - 0x10) + SwitchAnalogStick::Center) & UINT12_MAX,
-            static_cast<u16>(RighStickScaleFactor * (extension_data->right_stick_y - 0x10) + SwitchAnalogStick::Center) & UINT12_MAX
+            static_cast<u16>(ScaleAnalogStickValue<RightStickRange>(((extension_data->right_stick_x_43 << 3) | (extension_data->right_stick_x_21 << 1) | extension_data->right_stick_x_0) - 0x10) + SwitchAnalogStick::Center) & UINT12_MAX,
+            static_cast<u16>(ScaleAnalogStickValue<RightStickRange>(extension_data->right_stick_y - 0x10) + SwitchAnalogStick::Center) & UINT12_MAX
         );
 
         m_buttons.dpad_down  |= !extension_data->buttons.dpad_down;
@@ -435,9 +441,9 @@ namespace ams::controller {
         m_buttons.X  = !extension_data->buttons.X;
         m_buttons.Y  = !extension_data->buttons.Y;
 
-        m_buttons.L  = !extension_data->buttons.L | (((extension_data->left_trigger_43 << 3) | (extension_data->left_trigger_20)) > (m_trigger_threshold * 0x1f));
+        m_buttons.L  = !extension_data->buttons.L | (((extension_data->left_trigger_43 << 3) | (extension_data->left_trigger_20)) > this->GetTriggerThreshold<0x1f>());
         m_buttons.ZL = !extension_data->buttons.ZL;
-        m_buttons.R  = !extension_data->buttons.R | (extension_data->right_trigger > (m_trigger_threshold * 0x1f));
+        m_buttons.R  = !extension_data->buttons.R | (extension_data->right_trigger > this->GetTriggerThreshold<0x1f>());
         m_buttons.ZR = !extension_data->buttons.ZR;
 
         m_buttons.minus |= !extension_data->buttons.minus;
@@ -876,10 +882,10 @@ namespace ams::controller {
     }
 
     Result WiiController::SetVibration(const SwitchMotorData *motor_data) {
-        m_rumble_state = motor_data->left_motor.low_band_amp   > 0 ||
-                         motor_data->left_motor.high_band_amp  > 0 ||
-                         motor_data->right_motor.low_band_amp  > 0 ||
-                         motor_data->right_motor.high_band_amp > 0;
+        // The Wii remote motor can only be switched on or off
+        u8 duty_strong, duty_weak;
+        ApplyRumbleResponse(mitm::GetRumbleResponse(RumbleProfile_Wii), motor_data, &duty_strong, &duty_weak);
+        m_rumble_state = (duty_strong > 0) || (duty_weak > 0);
 
         std::scoped_lock lk(m_output_mutex);
 
@@ -888,7 +894,7 @@ namespace ams::controller {
         report_data->id = 0x10;
         report_data->output0x10.rumble = m_rumble_state;
 
-        R_RETURN(this->WriteDataReport(&m_output_report));
+        R_RETURN(this->WriteOutputReport(&m_output_report));
     }
 
     Result WiiController::CancelVibration() {
@@ -901,7 +907,7 @@ namespace ams::controller {
         report_data->id = 0x10;
         report_data->output0x10.rumble = m_rumble_state;
 
-        R_RETURN(this->WriteDataReport(&m_output_report));
+        R_RETURN(this->WriteOutputReport(&m_output_report));
     }
 
     Result WiiController::SetPlayerLed(u8 led_mask) {
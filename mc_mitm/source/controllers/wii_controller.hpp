@@ -15,6 +15,7 @@
  */
 #pragma once
 #include "emulated_switch_controller.hpp"
+#include "controller_utils.hpp"
 
 namespace ams::controller {
 
@@ -560,6 +561,7 @@ namespace ams::controller {
             bool m_mp_state_changing;
 
             WiiAccelerometerCalibrationData m_accel_calibration;
+            Vec3d<AxisCalibration> m_accel_scale;
 
             union {
                 MotionPlusCalibrationData motion_plus;
@@ -14,6 +14,7 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 #include "xbox_one_controller.hpp"
+#include "../mcmitm_config.hpp"
 #include <stratosphere.hpp>
 
 namespace ams::controller {
@@ -22,20 +23,43 @@ namespace ams::controller {
 
         constexpr u16 TriggerMax = 0x3ff;
 
+        // The longest pulse the controller can play back by itself, repeated back to back. 2.55s * 256 runs for almost 11 minutes
+        constexpr u8 SustainedPulseLength = 0xff;
+        constexpr u8 SustainedPulseLoops  = 0xff;
+
+        // Resend an unchanged rumble level well before the sustained pulse runs out
+        constexpr TimeSpan SustainedRumbleRefreshInterval = TimeSpan::FromMinutes(10);
+
+    }
+
+    XboxOneController::XboxOneController(const bluetooth::Address *address, HardwareID id)
+    : EmulatedSwitchController(address, id)
+    , m_rumble_state({0, 0}) {
+        // The controller keeps playing the previous level, so the output limiter only needs to resend an unchanged one before the sustained pulse runs out
+        m_output_limiter.SetRefreshInterval(SustainedRumbleRefreshInterval.GetNanoSeconds());
     }
 
     Result XboxOneController::SetVibration(const SwitchMotorData *motor_data) {
-        auto report = reinterpret_cast<XboxOneReportData *>(m_output_report.data);
-        m_output_report.size = sizeof(XboxOneOutputReport0x03) + 1;
-        report->id = 0x03;
-        report->output0x03.enable             = 0x3;
-        report->output0x03.magnitude_strong   = static_cast<u8>(100 * std::max(motor_data->left_motor.low_band_amp, motor_data->right_motor.low_band_amp));
-        report->output0x03.magnitude_weak     = static_cast<u8>(100 * std::max(motor_data->left_motor.high_band_amp, motor_data->right_motor.high_band_amp));
-        report->output0x03.pulse_sustain_10ms = 1;
-        report->output0x03.pulse_release_10ms = 0;
-        report->output0x03.loop_count         = 0;
+        XboxOneRumbleData rumble_state;
+        ApplyRumbleResponse(mitm::GetRumbleResponse(RumbleProfile_XboxOne), motor_data, &rumble_state.magnitude_strong, &rumble_state.magnitude_weak);
+
+        if ((rumble_state.magnitude_strong == 0) && (rumble_state.magnitude_weak == 0)) {
+            R_RETURN(this->CancelVibration());
+        }
+
+        std::scoped_lock lk(m_output_mutex);
+
+        m_rumble_state = rumble_state;
 
-        return this->WriteDataReport(&m_output_report);
+        R_RETURN(this->PushRumbleState(SustainedPulseLength, SustainedPulseLoops));
+    }
+
+    Result XboxOneController::CancelVibration() {
+        std::scoped_lock lk(m_output_mutex);
+
+        m_rumble_state = {0, 0};
+
+        R_RETURN(this->PushRumbleState(0, 0));
     }
 
     void XboxOneController::ProcessInputData(const bluetooth::HidReport *report) {
@@ -57,22 +81,11 @@ namespace ams::controller {
         m_left_stick  = PackAnalogStickValues(src->input0x01.left_stick.x,  InvertAnalogStickValue(src->input0x01.left_stick.y));
         m_right_stick = PackAnalogStickValues(src->input0x01.right_stick.x, InvertAnalogStickValue(src->input0x01.right_stick.y));
 
-        m_buttons.ZR = src->input0x01.right_trigger > (m_trigger_threshold * TriggerMax);
-        m_buttons.ZL = src->input0x01.left_trigger  > (m_trigger_threshold * TriggerMax);
+        m_buttons.ZR = src->input0x01.right_trigger > this->GetTriggerThreshold<TriggerMax>();
+        m_buttons.ZL = src->input0x01.left_trigger  > this->GetTriggerThreshold<TriggerMax>();
 
         if (new_format) {
-            m_buttons.dpad_down  = (src->input0x01.buttons.dpad == XboxOneDPad_S)  ||
-                                   (src->input0x01.buttons.dpad == XboxOneDPad_SE) ||
-                                   (src->input0x01.buttons.dpad == XboxOneDPad_SW);
-            m_buttons.dpad_up    = (src->input0x01.buttons.dpad == XboxOneDPad_N)  ||
-                                   (src->input0x01.buttons.dpad == XboxOneDPad_NE) ||
-                                   (src->input0x01.buttons.dpad == XboxOneDPad_NW);
-            m_buttons.dpad_right = (src->input0x01.buttons.dpad == XboxOneDPad_E)  ||
-                                   (src->input0x01.buttons.dpad == XboxOneDPad_NE) ||
-                                   (src->input0x01.buttons.dpad == XboxOneDPad_SE);
-            m_buttons.dpad_left  = (src->input0x01.buttons.dpad == XboxOneDPad_W)  ||
-                                   (src->input0x01.buttons.dpad == XboxOneDPad_NW) ||
-                                   (src->input0x01.buttons.dpad == XboxOneDPad_SW);
+            MapHatSwitch<XboxOneDPad_N>(&m_buttons, src->input0x01.buttons.dpad);
 
             m_buttons.A = src->input0x01.buttons.B;
             m_buttons.B = src->input0x01.buttons.A;
@@ -90,18 +103,7 @@ namespace ams::controller {
 
             m_buttons.home = src->input0x01.buttons.guide;
         } else {
-            m_buttons.dpad_down  = (src->input0x01.old.buttons.dpad == XboxOneDPad_S)  ||
-                                   (src->input0x01.old.buttons.dpad == XboxOneDPad_SE) ||
-                                   (src->input0x01.old.buttons.dpad == XboxOneDPad_SW);
-            m_buttons.dpad_up    = (src->input0x01.old.buttons.dpad == XboxOneDPad_N)  ||
-                                   (src->input0x01.old.buttons.dpad == XboxOneDPad_NE) ||
-                                   (src->input0x01.old.buttons.dpad == XboxOneDPad_NW);
-            m_buttons.dpad_right = (src->input0x01.old.buttons.dpad == XboxOneDPad_E)  ||
-                                   (src->input0x01.old.buttons.dpad == XboxOneDPad_NE) ||
-                                   (src->input0x01.old.buttons.dpad == XboxOneDPad_SE);
-            m_buttons.dpad_left  = (src->input0x01.old.buttons.dpad == XboxOneDPad_W)  ||
-                                   (src->input0x01.old.buttons.dpad == XboxOneDPad_NW) ||
-                                   (src->input0x01.old.buttons.dpad == XboxOneDPad_SW);
+            MapHatSwitch<XboxOneDPad_N>(&m_buttons, src->input0x01.old.buttons.dpad);
 
             m_buttons.A = src->input0x01.old.buttons.B;
             m_buttons.B = src->input0x01.old.buttons.A;
@@ -129,4 +131,20 @@ namespace ams::controller {
         m_charging = src->input0x04.charging;
     }
 
+    Result XboxOneController::PushRumbleState(u8 pulse_sustain_10ms, u8 loop_count) {
+        auto report = reinterpret_cast<XboxOneReportData *>(m_output_report.data);
+        m_output_report.size = sizeof(XboxOneOutputReport0x03) + 1;
+        report->id = 0x03;
+        report->output0x03.enable             = 0x3;
+        report->output0x03.magnitude_left     = 0;
+        report->output0x03.magnitude_right    = 0;
+        report->output0x03.magnitude_strong   = m_rumble_state.magnitude_strong;
+        report->output0x03.magnitude_weak     = m_rumble_state.magnitude_weak;
+        report->output0x03.pulse_sustain_10ms = pulse_sustain_10ms;
+        report->output0x03.pulse_release_10ms = 0;
+        report->output0x03.loop_count         = loop_count;
+
+        R_RETURN(this->WriteOutputReport(&m_output_report));
+    }
+
 }
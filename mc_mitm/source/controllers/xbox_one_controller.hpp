@@ -78,6 +78,11 @@ namespace ams::controller {
         u8              : 0;
     } PACKED;
 
+    struct XboxOneRumbleData {
+        u8 magnitude_strong;
+        u8 magnitude_weak;
+    };
+
     struct XboxOneOutputReport0x03 {
         u8 enable;
         u8 magnitude_left;
@@ -137,10 +142,10 @@ namespace ams::controller {
                 {0x045e, 0x0b0a}    // Official Xbox Adaptive Controller
             };
 
-            XboxOneController(const bluetooth::Address *address, HardwareID id)
-            : EmulatedSwitchController(address, id) { }
+            XboxOneController(const bluetooth::Address *address, HardwareID id);
 
             Result SetVibration(const SwitchMotorData *motor_data);
+            Result CancelVibration();
             void ProcessInputData(const bluetooth::HidReport *report) override;
 
         private:
@@ -148,6 +153,10 @@ namespace ams::controller {
             void MapInputReport0x02(const XboxOneReportData *src);
             void MapInputReport0x04(const XboxOneReportData *src);
 
+            Result PushRumbleState(u8 pulse_sustain_10ms, u8 loop_count);
+
+            XboxOneRumbleData m_rumble_state;
+
     };
 
 }
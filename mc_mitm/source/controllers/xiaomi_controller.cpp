@@ -21,7 +21,36 @@ namespace ams::controller {
 
     namespace {
 
-        constexpr u8 TriggerMax = UINT8_MAX;
+        constexpr size_t ButtonsOffset = offsetof(XiaomiInputReport0x04, buttons);
+
+        constexpr ReportField InputReport0x04Layout[] = {
+            BatteryField(ReportFieldTarget_Battery100, offsetof(XiaomiInputReport0x04, battery)),
+
+            AxisField(ReportFieldTarget_LeftStickX,  offsetof(XiaomiInputReport0x04, left_stick.x),  8),
+            AxisField(ReportFieldTarget_LeftStickY,  offsetof(XiaomiInputReport0x04, left_stick.y),  8, ReportFieldFlag_Inverted),
+            AxisField(ReportFieldTarget_RightStickX, offsetof(XiaomiInputReport0x04, right_stick.x), 8),
+            AxisField(ReportFieldTarget_RightStickY, offsetof(XiaomiInputReport0x04, right_stick.y), 8, ReportFieldFlag_Inverted),
+
+            HatSwitchField(offsetof(XiaomiInputReport0x04, buttons.dpad), 0, 8, XiaomiDPad_N),
+
+            ButtonField(ButtonsOffset + 0, 1, SwitchButton_A),
+            ButtonField(ButtonsOffset + 0, 0, SwitchButton_B),
+            ButtonField(ButtonsOffset + 0, 4, SwitchButton_X),
+            ButtonField(ButtonsOffset + 0, 3, SwitchButton_Y),
+
+            ButtonField(ButtonsOffset + 0, 7, SwitchButton_R),
+            TriggerField(offsetof(XiaomiInputReport0x04, right_trigger), 8, SwitchButton_ZR),
+            ButtonField(ButtonsOffset + 0, 6, SwitchButton_L),
+            TriggerField(offsetof(XiaomiInputReport0x04, left_trigger), 8, SwitchButton_ZL),
+
+            ButtonField(ButtonsOffset + 1, 2, SwitchButton_Minus),
+            ButtonField(ButtonsOffset + 1, 3, SwitchButton_Plus),
+
+            ButtonField(ButtonsOffset + 1, 5, SwitchButton_LStick),
+            ButtonField(ButtonsOffset + 1, 6, SwitchButton_RStick),
+
+            ButtonField(offsetof(XiaomiInputReport0x04, battery) + 1, 0, SwitchButton_Home),
+        };
 
         constinit const u8 InitPacket[] = { 0x20, 0x00, 0x00 };  // packet to init vibration apparently
 
@@ -51,41 +80,7 @@ namespace ams::controller {
     }
 
     void XiaomiController::MapInputReport0x04(const XiaomiReportData *src) {
-        m_battery = convert_battery_100(src->input0x04.battery);
-
-        m_left_stick  = PackAnalogStickValues(src->input0x04.left_stick.x,  InvertAnalogStickValue(src->input0x04.left_stick.y));
-        m_right_stick = PackAnalogStickValues(src->input0x04.right_stick.x, InvertAnalogStickValue(src->input0x04.right_stick.y));
-
-        m_buttons.dpad_down  = (src->input0x04.buttons.dpad == XiaomiDPad_S)  ||
-                               (src->input0x04.buttons.dpad == XiaomiDPad_SE) ||
-                               (src->input0x04.buttons.dpad == XiaomiDPad_SW);
-        m_buttons.dpad_up    = (src->input0x04.buttons.dpad == XiaomiDPad_N)  ||
-                               (src->input0x04.buttons.dpad == XiaomiDPad_NE) ||
-                               (src->input0x04.buttons.dpad == XiaomiDPad_NW);
-        m_buttons.dpad_right = (src->input0x04.buttons.dpad == XiaomiDPad_E)  ||
-                               (src->input0x04.buttons.dpad == XiaomiDPad_NE) ||
-                               (src->input0x04.buttons.dpad == XiaomiDPad_SE);
-        m_buttons.dpad_left  = (src->input0x04.buttons.dpad == XiaomiDPad_W)  ||
-                               (src->input0x04.buttons.dpad == XiaomiDPad_NW) ||
-                               (src->input0x04.buttons.dpad == XiaomiDPad_SW);
-
-        m_buttons.A = src->input0x04.buttons.B;
-        m_buttons.B = src->input0x04.buttons.A;
-        m_buttons.X = src->input0x04.buttons.Y;
-        m_buttons.Y = src->input0x04.buttons.X;
-
-        m_buttons.R  = src->input0x04.buttons.R1;
-        m_buttons.ZR = src->input0x04.right_trigger > (m_trigger_threshold * TriggerMax);
-        m_buttons.L  = src->input0x04.buttons.L1;
-        m_buttons.ZL = src->input0x04.left_trigger  > (m_trigger_threshold * TriggerMax);
-
-        m_buttons.minus = src->input0x04.buttons.back;
-        m_buttons.plus  = src->input0x04.buttons.menu;
-
-        m_buttons.lstick_press = src->input0x04.buttons.lstick_press;
-        m_buttons.rstick_press = src->input0x04.buttons.rstick_press;
-
-        m_buttons.home = src->input0x04.home;
+        this->MapReportLayout<InputReport0x04Layout>(reinterpret_cast<const u8 *>(&src->input0x04));
     }
 
 }
@@ -15,6 +15,7 @@
  */
 #include "mc_module.hpp"
 #include "mc_service.hpp"
+#include "../mcmitm_thread_stacks.hpp"
 
 namespace ams::mc {
 
@@ -67,6 +68,8 @@ namespace ams::mc {
     }
 
     void Launch() {
+        mitm::RegisterThreadStack(&g_thread, g_thread_stack, ThreadStackSize);
+
         R_ABORT_UNLESS(os::CreateThread(&g_thread,
             MissionControlThreadFunction,
             nullptr,
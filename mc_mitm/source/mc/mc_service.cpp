@@ -22,8 +22,6 @@ namespace ams::mc {
 
     namespace {
 
-        constexpr ncm::ProgramId MissionControlTitleId = ncm::ProgramId(0x010000000000bd00);
-
         constinit BtdrvExtCustomEventInfo g_event_info;
         constinit BtdrvExtCustomEventType g_current_event_type;
 
@@ -32,7 +30,7 @@ namespace ams::mc {
             bluetooth::core::GetCustomDataEvent()->Wait();
 
             // Fetch custom command reply data
-            R_TRY(bluetooth::core::GetEventInfo(MissionControlTitleId, reinterpret_cast<bluetooth::EventType *>(&g_current_event_type), &g_event_info, sizeof(g_event_info)));
+            R_TRY(bluetooth::core::GetCustomEventInfo(reinterpret_cast<bluetooth::EventType *>(&g_current_event_type), &g_event_info, sizeof(g_event_info)));
 
             // Return status code
             R_RETURN(g_event_info.hci_command_response.status);
@@ -83,4 +81,18 @@ namespace ams::mc {
         R_RETURN(btdrvextDmSetConfig(&set_config.config));
     }
 
+    Result MissionControlService::GetHeapStatistics(sf::Out<ams::mc::HeapStatistics> out) {
+        mitm::GetHeapStatistics(&out.GetPointer()->stats);
+        R_SUCCEED();
+    }
+
+    Result MissionControlService::DumpHeapStatistics() {
+        R_RETURN(mitm::DumpHeapStatistics());
+    }
+
+    Result MissionControlService::GetThreadStackStatistics(sf::Out<ams::mc::ThreadStackStatistics> out) {
+        mitm::GetThreadStackStatistics(&out.GetPointer()->stats);
+        R_SUCCEED();
+    }
+
 }
@@ -25,6 +25,9 @@
     AMS_SF_METHOD_INFO(C, H, 3, Result, GetHciHandle,          (bluetooth::Address address, sf::Out<u16> handle),                                       (address, handle)           ) \
     AMS_SF_METHOD_INFO(C, H, 4, Result, SendHciCommand,        (u16 opcode, const sf::InPointerBuffer &buffer, const sf::OutPointerBuffer &out_buffer), (opcode, buffer, out_buffer)) \
     AMS_SF_METHOD_INFO(C, H, 5, Result, DmSetConfig,           (const ams::mc::BsaSetConfig &set_config),                                               (set_config)                ) \
+    AMS_SF_METHOD_INFO(C, H, 6, Result, GetHeapStatistics,     (sf::Out<ams::mc::HeapStatistics> out),                                                  (out)                       ) \
+    AMS_SF_METHOD_INFO(C, H, 7, Result, DumpHeapStatistics,    (),                                                                                      ()                          ) \
+    AMS_SF_METHOD_INFO(C, H, 8, Result, GetThreadStackStatistics, (sf::Out<ams::mc::ThreadStackStatistics> out),                                        (out)                       ) \
 
 AMS_SF_DEFINE_INTERFACE(ams::mc, IMissionControlInterface, AMS_MISSION_CONTROL_INTERFACE_INFO, 0x30eba3d4)
 
@@ -38,6 +41,9 @@ namespace ams::mc {
             Result GetHciHandle(bluetooth::Address address, sf::Out<u16> handle);
             Result SendHciCommand(u16 opcode, const sf::InPointerBuffer &buffer, const sf::OutPointerBuffer &out_buffer);
             Result DmSetConfig(const ams::mc::BsaSetConfig &set_config);
+            Result GetHeapStatistics(sf::Out<ams::mc::HeapStatistics> out);
+            Result DumpHeapStatistics();
+            Result GetThreadStackStatistics(sf::Out<ams::mc::ThreadStackStatistics> out);
     };
     static_assert(IsIMissionControlInterface<MissionControlService>);
 
@@ -16,6 +16,8 @@
 #pragma once
 #include <stratosphere.hpp>
 #include "../bluetooth_mitm/bsa_defs.h"
+#include "../mcmitm_heap.hpp"
+#include "../mcmitm_thread_stacks.hpp"
 
 namespace ams::mc {
 
@@ -31,4 +33,12 @@ namespace ams::mc {
         tBSA_DM_SET_CONFIG config;
     };
 
+    struct HeapStatistics : sf::LargeData {
+        mitm::HeapStatistics stats;
+    };
+
+    struct ThreadStackStatistics : sf::LargeData {
+        mitm::ThreadStackStatistics stats;
+    };
+
 }
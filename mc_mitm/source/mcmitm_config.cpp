@@ -36,10 +36,87 @@ namespace ams::mitm {
                 .dualshock4_lightbar_brightness = 5,
                 .dualsense_lightbar_brightness = 5,
                 .dualsense_enable_player_leds = true,
-                .dualsense_vibration_intensity = 4
+                .dualsense_vibration_intensity = 4,
+                .gyro_auto_calibration = true,
+                .motion_drift_correction = 10,
+                .output_report_min_interval = 5,
+                .rumble_watchdog_timeout = 500,
+                .enable_heap_profiler = false
+            },
+            .button_combos = {
+                .rules = {
+                    { .type = controller::ButtonComboType_Combo, .chord = controller::SwitchButton_Minus | controller::SwitchButton_DpadDown, .output = controller::SwitchButton_Home    },
+                    { .type = controller::ButtonComboType_Combo, .chord = controller::SwitchButton_Minus | controller::SwitchButton_DpadUp,   .output = controller::SwitchButton_Capture },
+                },
+                .count = 2
+            },
+            .rumble = {
+                [controller::RumbleProfile_Dualshock3] = {
+                    .perceptual = true,
+                    .strong = { .deadzone = 2,  .threshold = 35,  .saturation = 100, .curve = 60,  .frequency_rolloff = 20 },
+                    .weak   = { .deadzone = 15, .threshold = 100, .saturation = 100, .curve = 100, .frequency_rolloff = 0  }
+                },
+                [controller::RumbleProfile_Dualshock4] = {
+                    .perceptual = true,
+                    .strong = { .deadzone = 2,  .threshold = 20,  .saturation = 100, .curve = 70,  .frequency_rolloff = 20 },
+                    .weak   = { .deadzone = 2,  .threshold = 15,  .saturation = 100, .curve = 70,  .frequency_rolloff = 20 }
+                },
+                [controller::RumbleProfile_Dualsense] = {
+                    .perceptual = true,
+                    .strong = { .deadzone = 2,  .threshold = 10,  .saturation = 100, .curve = 80,  .frequency_rolloff = 20 },
+                    .weak   = { .deadzone = 2,  .threshold = 10,  .saturation = 100, .curve = 80,  .frequency_rolloff = 20 }
+                },
+                [controller::RumbleProfile_XboxOne] = {
+                    .perceptual = true,
+                    .strong = { .deadzone = 2,  .threshold = 15,  .saturation = 100, .curve = 70,  .frequency_rolloff = 20 },
+                    .weak   = { .deadzone = 2,  .threshold = 10,  .saturation = 100, .curve = 70,  .frequency_rolloff = 20 }
+                },
+                [controller::RumbleProfile_Wii] = {
+                    .perceptual = true,
+                    .strong = { .deadzone = 15, .threshold = 100, .saturation = 100, .curve = 100, .frequency_rolloff = 0  },
+                    .weak   = { .deadzone = 15, .threshold = 100, .saturation = 100, .curve = 100, .frequency_rolloff = 0  }
+                }
             }
         };
 
+        constexpr const char *RumbleProfileNames[controller::RumbleProfile_Count] = {
+            "dualshock3",
+            "dualshock4",
+            "dualsense",
+            "xbox_one",
+            "wii"
+        };
+
+        // Set once the first user-defined rule replaces the default combos
+        constinit bool g_custom_button_combos = false;
+
+        struct ButtonName {
+            const char *name;
+            u32 mask;
+        };
+
+        constinit const ButtonName button_names[] = {
+            { "y",          controller::SwitchButton_Y         },
+            { "x",          controller::SwitchButton_X         },
+            { "b",          controller::SwitchButton_B         },
+            { "a",          controller::SwitchButton_A         },
+            { "r",          controller::SwitchButton_R         },
+            { "zr",         controller::SwitchButton_ZR        },
+            { "minus",      controller::SwitchButton_Minus     },
+            { "plus",       controller::SwitchButton_Plus      },
+            { "rstick",     controller::SwitchButton_RStick    },
+            { "lstick",     controller::SwitchButton_LStick    },
+            { "home",       controller::SwitchButton_Home      },
+            { "capture",    controller::SwitchButton_Capture   },
+            { "dpad_down",  controller::SwitchButton_DpadDown  },
+            { "dpad_up",    controller::SwitchButton_DpadUp    },
+            { "dpad_right", controller::SwitchButton_DpadRight },
+            { "dpad_left",  controller::SwitchButton_DpadLeft  },
+            { "l",          controller::SwitchButton_L         },
+            { "zl",         controller::SwitchButton_ZL        },
+            { "none",       0                                  },
+        };
+
         void ParseBoolean(const char *value, bool *out) {
             if (strcasecmp(value, "true") == 0)
                 *out = true;
@@ -77,6 +154,326 @@ namespace ams::mitm {
             *out = address;
         }
 
+        s64 MillisecondsToTicks(u32 ms) {
+            return os::ConvertToTick(TimeSpan::FromMilliSeconds(ms)).GetInt64Value();
+        }
+
+        // Parses a '+' separated list of button names, eg. "minus+dpad_down". Stops at the first character that can't be part of a name
+        const char *ParseButtons(const char *value, u32 *out) {
+            u32 mask = 0;
+            for (;;) {
+                size_t length = std::strspn(value, "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ_");
+                if (length == 0) {
+                    return nullptr;
+                }
+
+                bool found = false;
+                for (auto &button : button_names) {
+                    if ((std::strlen(button.name) == length) && (strncasecmp(value, button.name, length) == 0)) {
+                        mask |= button.mask;
+                        found = true;
+                        break;
+                    }
+                }
+
+                if (!found) {
+                    return nullptr;
+                }
+
+                value += length;
+                if (*value != '+') {
+                    break;
+                }
+                ++value;
+            }
+
+            *out = mask;
+            return value;
+        }
+
+        // Parses a duration of the form "@<milliseconds>"
+        const char *ParseDuration(const char *value, s64 *out) {
+            if (*value != '@') {
+                return nullptr;
+            }
+
+            char *end;
+            u32 ms = std::strtoul(value + 1, &end, 10);
+            if (end == value + 1) {
+                return nullptr;
+            }
+
+            *out = MillisecondsToTicks(ms);
+            return end;
+        }
+
+        // combo=<chord>><output>[@<hold ms>]
+        // turbo=<buttons>@<period ms>
+        // macro=<chord>><buttons>@<ms>,<buttons>@<ms>,...
+        void ParseButtonComboRule(const char *name, const char *value, controller::ButtonComboRuleSet *out) {
+            controller::ButtonComboRule rule = {};
+
+            if (strcasecmp(name, "combo") == 0) {
+                rule.type = controller::ButtonComboType_Combo;
+                if (!(value = ParseButtons(value, &rule.chord)) || (*value++ != '>') || !(value = ParseButtons(value, &rule.output))) {
+                    return;
+                }
+                if ((*value != '\0') && !(value = ParseDuration(value, &rule.hold))) {
+                    return;
+                }
+            } else if (strcasecmp(name, "turbo") == 0) {
+                rule.type = controller::ButtonComboType_Turbo;
+                if (!(value = ParseButtons(value, &rule.chord)) || !(value = ParseDuration(value, &rule.period)) || (rule.period < 2)) {
+                    return;
+                }
+                rule.output = rule.chord;
+            } else if (strcasecmp(name, "macro") == 0) {
+                rule.type = controller::ButtonComboType_Macro;
+                if (!(value = ParseButtons(value, &rule.chord)) || (*value++ != '>')) {
+                    return;
+                }
+                do {
+                    if (rule.step_count == controller::MaxButtonMacroSteps) {
+                        return;
+                    }
+                    auto step = &rule.steps[rule.step_count++];
+                    if (!(value = ParseButtons(value, &step->buttons)) || !(value = ParseDuration(value, &step->duration))) {
+                        return;
+                    }
+                } while (*value++ == ',');
+                --value;
+            } else {
+                return;
+            }
+
+            // Reject trailing garbage and chords that could never be pressed
+            if ((*value != '\0') || (rule.chord == 0)) {
+                return;
+            }
+
+            if (!g_custom_button_combos) {
+                out->count = 0;
+                g_custom_button_combos = true;
+            }
+
+            if (out->count < controller::MaxButtonComboRules) {
+                out->rules[out->count++] = rule;
+            }
+        }
+
+        // Per-device sections are named "<section> <vid>:<pid>" or "<section> <bluetooth address>". A bare "<section>" applies to every controller
+        bool ParseDeviceFilter(const char *device, DeviceFilter *out) {
+            DeviceFilter filter = {};
+
+            if (*device == '\0') {
+                filter.type = DeviceFilterType_Any;
+            } else if (std::strlen(device) == 3*sizeof(bluetooth::Address) - 1) {
+                filter.type = DeviceFilterType_Address;
+                ParseBluetoothAddress(device, &filter.address);
+            } else {
+                char *end;
+                filter.type = DeviceFilterType_HardwareId;
+                filter.vid = std::strtoul(device, &end, 16);
+                if (*end++ != ':') {
+                    return false;
+                }
+                filter.pid = std::strtoul(end, &end, 16);
+                if (*end != '\0') {
+                    return false;
+                }
+            }
+
+            *out = filter;
+            return true;
+        }
+
+        bool IsSameDeviceFilter(const DeviceFilter *a, const DeviceFilter *b) {
+            switch (a->type == b->type ? a->type : DeviceFilterType_Any) {
+                case DeviceFilterType_Address:
+                    return std::memcmp(&a->address, &b->address, sizeof(bluetooth::Address)) == 0;
+                case DeviceFilterType_HardwareId:
+                    return (a->vid == b->vid) && (a->pid == b->pid);
+                default:
+                    return a->type == b->type;
+            }
+        }
+
+        // Returns how specific the match is, or -1 if the filter doesn't apply to the controller
+        int MatchDeviceFilter(const DeviceFilter *filter, const bluetooth::Address *address, u16 vid, u16 pid) {
+            switch (filter->type) {
+                case DeviceFilterType_Address:
+                    return std::memcmp(&filter->address, address, sizeof(bluetooth::Address)) == 0 ? 2 : -1;
+                case DeviceFilterType_HardwareId:
+                    return (filter->vid == vid) && (filter->pid == pid) ? 1 : -1;
+                default:
+                    return 0;
+            }
+        }
+
+        // Entries are built in place in the config. The ini is parsed on the 0x1000 byte main thread stack, which a single
+        // ButtonRemapConfig (over 3KB with its lookup table) would almost fill if it were assembled there and copied in
+        template<typename T, typename F>
+        T *FindDeviceEntry(T *entries, u8 *count, size_t max_count, const char *device, F initialize) {
+            DeviceFilter filter;
+            if (!ParseDeviceFilter(device, &filter)) {
+                return nullptr;
+            }
+
+            for (unsigned int i = 0; i < *count; ++i) {
+                if (IsSameDeviceFilter(&entries[i].device, &filter)) {
+                    return &entries[i];
+                }
+            }
+
+            if (*count == max_count) {
+                return nullptr;
+            }
+
+            auto entry = &entries[(*count)++];
+            entry->device = filter;
+            initialize(entry);
+            return entry;
+        }
+
+        template<typename T>
+        const T *FindBestDeviceEntry(const T *entries, u8 count, const bluetooth::Address *address, u16 vid, u16 pid) {
+            const T *match = nullptr;
+            int match_priority = -1;
+
+            for (unsigned int i = 0; i < count; ++i) {
+                int priority = MatchDeviceFilter(&entries[i].device, address, vid, pid);
+                if (priority > match_priority) {
+                    match = &entries[i];
+                    match_priority = priority;
+                }
+            }
+
+            return match;
+        }
+
+        // <button>=<buttons reported in its place>
+        void ParseButtonRemap(const char *device, const char *name, const char *value, MissionControlConfig *config) {
+            u32 source;
+            const char *end = ParseButtons(name, &source);
+            if (!end || (*end != '\0') || (util::PopCount(source) != 1)) {
+                return;
+            }
+
+            u32 target;
+            end = ParseButtons(value, &target);
+            if (!end || (*end != '\0')) {
+                return;
+            }
+
+            auto remap = FindDeviceEntry(config->button_remaps.entries, &config->button_remaps.count, MaxButtonRemaps, device, [](ButtonRemapConfig *entry) {
+                // Buttons map to themselves unless overridden
+                for (unsigned int i = 0; i < controller::SwitchButtonBits; ++i) {
+                    entry->mapping[i] = BIT(i);
+                }
+            });
+            if (remap) {
+                remap->mapping[util::CountTrailingZeros(source)] = target;
+            }
+        }
+
+        void ParseAnalogStickConfig(const char *device, const char *name, const char *value, MissionControlConfig *config) {
+            auto profile = FindDeviceEntry(config->analog_sticks.entries, &config->analog_sticks.count, MaxAnalogStickProfiles, device, [](AnalogStickProfileConfig *entry) {
+                entry->left  = { .response_curve = 100 };
+                entry->right = { .response_curve = 100 };
+            });
+            if (!profile) {
+                return;
+            }
+
+            AnalogStickConfig *stick;
+            if (strncasecmp(name, "left_", 5) == 0) {
+                stick = &profile->left;
+            } else if (strncasecmp(name, "right_", 6) == 0) {
+                stick = &profile->right;
+            } else {
+                return;
+            }
+            name = std::strchr(name, '_') + 1;
+
+            if (strcasecmp(name, "inner_deadzone") == 0) {
+                ParseInt(value, &stick->inner_deadzone, 0, 50);
+            } else if (strcasecmp(name, "outer_deadzone") == 0) {
+                ParseInt(value, &stick->outer_deadzone, 0, 50);
+            } else if (strcasecmp(name, "anti_deadzone") == 0) {
+                ParseInt(value, &stick->anti_deadzone, 0, 90);
+            } else if (strcasecmp(name, "response_curve") == 0) {
+                ParseInt(value, &stick->response_curve, 10, 500);
+            } else if (strcasecmp(name, "invert_x") == 0) {
+                ParseBoolean(value, &stick->invert_x);
+            } else if (strcasecmp(name, "invert_y") == 0) {
+                ParseBoolean(value, &stick->invert_y);
+            }
+        }
+
+        void CompileAnalogStickConfig(const AnalogStickConfig *stick, controller::AnalogStickResponseTable *out) {
+            controller::CompileAnalogStickResponse(stick->inner_deadzone / 100.0f, stick->outer_deadzone / 100.0f, stick->anti_deadzone / 100.0f, stick->response_curve / 100.0f, stick->invert_x, stick->invert_y, out);
+        }
+
+        void ParseRumbleConfig(const char *profile_name, const char *name, const char *value, MissionControlConfig *config) {
+            RumbleProfileConfig *profile = nullptr;
+            for (int i = 0; i < controller::RumbleProfile_Count; ++i) {
+                if (strcasecmp(profile_name, RumbleProfileNames[i]) == 0) {
+                    profile = &config->rumble[i];
+                    break;
+                }
+            }
+            if (!profile) {
+                return;
+            }
+
+            if (strcasecmp(name, "response") == 0) {
+                if (strcasecmp(value, "perceptual") == 0) {
+                    profile->perceptual = true;
+                } else if (strcasecmp(value, "linear") == 0) {
+                    profile->perceptual = false;
+                }
+                return;
+            }
+
+            RumbleMotorConfig *motor;
+            if (strncasecmp(name, "strong_", 7) == 0) {
+                motor = &profile->strong;
+            } else if (strncasecmp(name, "weak_", 5) == 0) {
+                motor = &profile->weak;
+            } else {
+                return;
+            }
+            name = std::strchr(name, '_') + 1;
+
+            if (strcasecmp(name, "deadzone") == 0) {
+                ParseInt(value, &motor->deadzone, 0, 50);
+            } else if (strcasecmp(name, "threshold") == 0) {
+                ParseInt(value, &motor->threshold, 0, 100);
+            } else if (strcasecmp(name, "saturation") == 0) {
+                ParseInt(value, &motor->saturation, 0, 100);
+            } else if (strcasecmp(name, "curve") == 0) {
+                ParseInt(value, &motor->curve, 10, 500);
+            } else if (strcasecmp(name, "frequency_rolloff") == 0) {
+                ParseInt(value, &motor->frequency_rolloff, 0, 50);
+            }
+        }
+
+        void CompileRumbleMotorConfig(const RumbleMotorConfig *motor, bool perceptual, float center_frequency, u8 output_max, controller::RumbleResponseTable *out) {
+            if (perceptual) {
+                controller::CompileRumbleResponse(motor->deadzone / 100.0f, motor->threshold / 100.0f, motor->saturation / 100.0f, motor->curve / 100.0f, motor->frequency_rolloff / 100.0f, center_frequency, output_max, out);
+            } else {
+                controller::CompileLinearRumbleResponse(center_frequency, output_max, out);
+            }
+        }
+
+        void CompileRumbleConfig() {
+            for (int i = 0; i < controller::RumbleProfile_Count; ++i) {
+                auto profile = &g_global_config.rumble[i];
+                CompileRumbleMotorConfig(&profile->strong, profile->perceptual, controller::SwitchRumbleCenterFreqLow,  controller::RumbleProfileOutputMax[i], &profile->tables.strong);
+                CompileRumbleMotorConfig(&profile->weak,   profile->perceptual, controller::SwitchRumbleCenterFreqHigh, controller::RumbleProfileOutputMax[i], &profile->tables.weak);
+            }
+        }
+
         int ConfigIniHandler(void *user, const char *section, const char *name, const char *value) {
             auto config = reinterpret_cast<MissionControlConfig *>(user);
 
@@ -107,7 +504,27 @@ namespace ams::mitm {
                     ParseBoolean(value, &config->misc.dualsense_enable_player_leds);
                 } else if (strcasecmp(name, "dualsense_vibration_intensity") == 0) {
                     ParseInt(value, &config->misc.dualsense_vibration_intensity, 1, 8);
+                } else if (strcasecmp(name, "gyro_auto_calibration") == 0) {
+                    ParseBoolean(value, &config->misc.gyro_auto_calibration);
+                } else if (strcasecmp(name, "motion_drift_correction") == 0) {
+                    ParseInt(value, &config->misc.motion_drift_correction, 0, 100);
+                } else if (strcasecmp(name, "output_report_min_interval") == 0) {
+                    ParseInt(value, &config->misc.output_report_min_interval, 0, 100);
+                } else if (strcasecmp(name, "rumble_watchdog_timeout") == 0) {
+                    ParseInt(value, &config->misc.rumble_watchdog_timeout, 0, 5000);
+                } else if (strcasecmp(name, "enable_heap_profiler") == 0) {
+                    ParseBoolean(value, &config->misc.enable_heap_profiler);
                 }
+            } else if (strcasecmp(section, "button_combos") == 0) {
+                ParseButtonComboRule(name, value, &config->button_combos);
+            } else if (strncasecmp(section, "button_remap ", 13) == 0) {
+                ParseButtonRemap(section + 13, name, value, config);
+            } else if (strcasecmp(section, "analog_sticks") == 0) {
+                ParseAnalogStickConfig("", name, value, config);
+            } else if (strncasecmp(section, "analog_sticks ", 14) == 0) {
+                ParseAnalogStickConfig(section + 14, name, value, config);
+            } else if (strncasecmp(section, "rumble ", 7) == 0) {
+                ParseRumbleConfig(section + 7, name, value, config);
             } else {
                 return 0;
             }
@@ -125,6 +542,17 @@ namespace ams::mitm {
             ON_SCOPE_EXIT { fs::CloseFile(file); };
 
             util::ini::ParseFile(file, &g_global_config, ConfigIniHandler);
+
+            for (unsigned int i = 0; i < g_global_config.button_remaps.count; ++i) {
+                auto remap = &g_global_config.button_remaps.entries[i];
+                controller::CompileButtonRemap(remap->mapping, &remap->table);
+            }
+
+            for (unsigned int i = 0; i < g_global_config.analog_sticks.count; ++i) {
+                auto profile = &g_global_config.analog_sticks.entries[i];
+                CompileAnalogStickConfig(&profile->left, &profile->left_table);
+                CompileAnalogStickConfig(&profile->right, &profile->right_table);
+            }
         }
 
         void ReadSystemLanguage() {
@@ -139,6 +567,7 @@ namespace ams::mitm {
 
     void LoadConfiguration() {
         ParseIniConfiguration();
+        CompileRumbleConfig();
         ReadSystemLanguage();
     }
 
@@ -150,4 +579,17 @@ namespace ams::mitm {
         return g_system_language;
     }
 
+    const controller::ButtonRemapTable *GetButtonRemap(const bluetooth::Address *address, u16 vid, u16 pid) {
+        auto remap = FindBestDeviceEntry(g_global_config.button_remaps.entries, g_global_config.button_remaps.count, address, vid, pid);
+        return remap ? &remap->table : nullptr;
+    }
+
+    const AnalogStickProfileConfig *GetAnalogStickProfile(const bluetooth::Address *address, u16 vid, u16 pid) {
+        return FindBestDeviceEntry(g_global_config.analog_sticks.entries, g_global_config.analog_sticks.count, address, vid, pid);
+    }
+
+    const controller::RumbleResponseProfile *GetRumbleResponse(controller::RumbleProfile profile) {
+        return &g_global_config.rumble[profile].tables;
+    }
+
 }
@@ -14,9 +14,68 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 #include "bluetooth_mitm/bluetooth/bluetooth_types.hpp"
+#include "controllers/switch_button_combos.hpp"
+#include "controllers/switch_analog_stick.hpp"
+#include "controllers/rumble_response.hpp"
 
 namespace ams::mitm {
 
+    constexpr size_t MaxButtonRemaps = 4;
+    constexpr size_t MaxAnalogStickProfiles = 4;
+
+    enum DeviceFilterType : u8 {
+        DeviceFilterType_Any,
+        DeviceFilterType_HardwareId,
+        DeviceFilterType_Address,
+    };
+
+    // Selects which controllers a per-device config section applies to
+    struct DeviceFilter {
+        DeviceFilterType type;
+        bluetooth::Address address;
+        u16 vid;
+        u16 pid;
+    };
+
+    struct ButtonRemapConfig {
+        DeviceFilter device;
+        u32 mapping[controller::SwitchButtonBits];
+        controller::ButtonRemapTable table;
+    };
+
+    struct AnalogStickConfig {
+        int inner_deadzone;
+        int outer_deadzone;
+        int anti_deadzone;
+        int response_curve;
+        bool invert_x;
+        bool invert_y;
+    };
+
+    struct AnalogStickProfileConfig {
+        DeviceFilter device;
+        AnalogStickConfig left;
+        AnalogStickConfig right;
+        controller::AnalogStickResponseTable left_table;
+        controller::AnalogStickResponseTable right_table;
+    };
+
+    // Deadzone, threshold, saturation and frequency rolloff are percentages, curve is the exponent in percent
+    struct RumbleMotorConfig {
+        int deadzone;
+        int threshold;
+        int saturation;
+        int curve;
+        int frequency_rolloff;
+    };
+
+    struct RumbleProfileConfig {
+        bool perceptual;
+        RumbleMotorConfig strong;
+        RumbleMotorConfig weak;
+        controller::RumbleResponseProfile tables;
+    };
+
     struct MissionControlConfig {
         struct {
             bool enable_rumble;
@@ -36,11 +95,33 @@ namespace ams::mitm {
             int dualsense_lightbar_brightness;
             bool dualsense_enable_player_leds;
             int dualsense_vibration_intensity;
+            bool gyro_auto_calibration;
+            int motion_drift_correction;
+            int output_report_min_interval;
+            int rumble_watchdog_timeout;
+            bool enable_heap_profiler;
         } misc;
+
+        controller::ButtonComboRuleSet button_combos;
+
+        struct {
+            ButtonRemapConfig entries[MaxButtonRemaps];
+            u8 count;
+        } button_remaps;
+
+        struct {
+            AnalogStickProfileConfig entries[MaxAnalogStickProfiles];
+            u8 count;
+        } analog_sticks;
+
+        RumbleProfileConfig rumble[controller::RumbleProfile_Count];
     };
 
     void LoadConfiguration();
     MissionControlConfig *GetGlobalConfig();
     SetLanguage GetSystemLanguage();
+    const controller::ButtonRemapTable *GetButtonRemap(const bluetooth::Address *address, u16 vid, u16 pid);
+    const AnalogStickProfileConfig *GetAnalogStickProfile(const bluetooth::Address *address, u16 vid, u16 pid);
+    const controller::RumbleResponseProfile *GetRumbleResponse(controller::RumbleProfile profile);
 
 }
@@ -0,0 +1,491 @@
+/*
+ * Copyright (c) 2020-2025 ndeadly
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "mcmitm_heap.hpp"
+#include "mcmitm_thread_stacks.hpp"
+#include <switch.h>
+#include <cstdarg>
+
+namespace ams::mitm {
+
+    namespace {
+
+        constexpr size_t TrackedCallSiteCount = 32;
+        constexpr size_t SmallestSizeClass = 16;
+
+        // Small blocks are served from per size class free lists carved out of exp heap chunks. Chunks are
+        // never returned to the exp heap, so a freed block can always be read while another thread pops it.
+        // Each class holds at most HeapSlabMaxChunksPerClass chunks, past that its requests fall back to the exp heap
+        constexpr size_t SlabMaxSize = SmallestSizeClass << (HeapSlabClassCount - 1);
+        constexpr size_t SlabChunkSize = 1_KB;
+        constexpr size_t SlabWindowSize = 0x100;
+        constexpr size_t SlabAlignment = SmallestSizeClass;
+        constexpr const char HeapProfilePath[] = "sdmc:/config/MissionControl/heap_profile.txt";
+
+        struct CallSiteEntry {
+            uintptr_t address;
+            u32 allocation_count;
+            u32 allocated_bytes;
+        };
+
+        // Chunk windows are counted from the start of the heap, so it must be aligned to the window size like the chunks are
+        alignas(SlabWindowSize) constinit u8 g_heap_memory[64_KB];
+        constinit lmem::HeapHandle g_heap_handle;
+        constinit bool g_heap_initialized;
+        constinit os::SdkMutex g_heap_init_mutex;
+
+        // Free list heads pack an ABA tag in the upper half and the heap offset of the first free block in the lower half
+        constinit std::atomic<u64> g_slab_free_lists[HeapSlabClassCount];
+        constinit std::atomic<u32> g_slab_chunk_counts[HeapSlabClassCount];
+        constinit std::atomic<u32> g_slab_free_counts[HeapSlabClassCount];
+        constinit u8 g_slab_window_classes[sizeof(g_heap_memory) / SlabWindowSize];  // Size class + 1 of the chunk covering each window, or 0
+
+        // Cheap enough to always keep, so peak usage covers everything since boot
+        constinit std::atomic<size_t> g_current_usage;
+        constinit std::atomic<size_t> g_peak_usage;
+        constinit std::atomic<u32> g_allocation_count;
+        constinit std::atomic<u32> g_free_count;
+        constinit std::atomic<u32> g_failed_count;
+
+        constinit std::atomic<bool> g_profiler_enabled;
+        constinit os::SdkMutex g_profiler_lock;
+        constinit u32 g_size_class_counts[HeapSizeClassCount];
+        constinit CallSiteEntry g_call_sites[TrackedCallSiteCount];
+        constinit u32 g_untracked_call_sites;
+
+        constinit os::SdkMutex g_dump_lock;
+        constinit HeapStatistics g_dump_heap_statistics;
+        constinit ThreadStackStatistics g_dump_stack_statistics;
+
+        #if defined(AMS_BUILD_FOR_DEBUGGING)
+        constexpr size_t TrackedThreadCount = 32;
+
+        struct ThreadAllocationCounter {
+            std::atomic<const os::ThreadType *> thread;
+            std::atomic<u32> allocation_count;
+        };
+
+        constinit ThreadAllocationCounter g_thread_allocation_counters[TrackedThreadCount];
+
+        // Finds the counter for a thread, claiming a free one the first time the thread is seen
+        ThreadAllocationCounter *GetThreadAllocationCounter(const os::ThreadType *thread) {
+            for (auto &counter : g_thread_allocation_counters) {
+                const os::ThreadType *owner = counter.thread.load(std::memory_order_acquire);
+                if ((owner == nullptr) && counter.thread.compare_exchange_strong(owner, thread, std::memory_order_acq_rel)) {
+                    return &counter;
+                }
+
+                if (owner == thread) {
+                    return &counter;
+                }
+            }
+
+            return nullptr;
+        }
+        #endif
+
+        lmem::HeapHandle GetHeapHandle() {
+            if (AMS_UNLIKELY(!g_heap_initialized)) {
+                std::scoped_lock lk(g_heap_init_mutex);
+
+                if (AMS_LIKELY(!g_heap_initialized)) {
+                    g_heap_handle = lmem::CreateExpHeap(g_heap_memory, sizeof(g_heap_memory), lmem::CreateOption_ThreadSafe);
+                    g_heap_initialized = true;
+                }
+            }
+
+            return g_heap_handle;
+        }
+
+        size_t GetSizeClass(size_t size) {
+            size_t size_class = 0;
+            while ((size_class < HeapSizeClassCount - 1) && (size > (SmallestSizeClass << size_class))) {
+                ++size_class;
+            }
+
+            return size_class;
+        }
+
+        constexpr size_t GetSlabBlockSize(size_t slab_class) {
+            return SmallestSizeClass << slab_class;
+        }
+
+        u32 GetHeapOffset(const void *p) {
+            return reinterpret_cast<const u8 *>(p) - g_heap_memory;
+        }
+
+        std::atomic_ref<u32> GetNextFreeOffset(u32 offset) {
+            return std::atomic_ref<u32>(*reinterpret_cast<u32 *>(g_heap_memory + offset));
+        }
+
+        void PushSlabBlocks(size_t slab_class, u32 first, u32 last, u32 count) {
+            auto &free_list = g_slab_free_lists[slab_class];
+
+            u64 head = free_list.load(std::memory_order_relaxed);
+            do {
+                GetNextFreeOffset(last).store(static_cast<u32>(head), std::memory_order_relaxed);
+            } while (!free_list.compare_exchange_weak(head, (((head >> 32) + 1) << 32) | first, std::memory_order_release, std::memory_order_relaxed));
+
+            g_slab_free_counts[slab_class] += count;
+        }
+
+        void *PopSlabBlock(size_t slab_class) {
+            auto &free_list = g_slab_free_lists[slab_class];
+
+            u64 head = free_list.load(std::memory_order_acquire);
+            while (static_cast<u32>(head) != 0) {
+                // May read a stale link if the block was popped concurrently, in which case the tag makes the exchange fail
+                const u32 next = GetNextFreeOffset(static_cast<u32>(head)).load(std::memory_order_relaxed);
+                if (free_list.compare_exchange_weak(head, (((head >> 32) + 1) << 32) | next, std::memory_order_acquire, std::memory_order_acquire)) {
+                    --g_slab_free_counts[slab_class];
+                    return g_heap_memory + static_cast<u32>(head);
+                }
+            }
+
+            return nullptr;
+        }
+
+        void *RefillSlab(size_t slab_class) {
+            // Reserve the chunk against the cap first, so concurrent refills can't overshoot it
+            auto &chunk_count = g_slab_chunk_counts[slab_class];
+            if (chunk_count.load(std::memory_order_relaxed) >= HeapSlabMaxChunksPerClass) {
+                return nullptr;
+            }
+
+            if (chunk_count.fetch_add(1) >= HeapSlabMaxChunksPerClass) {
+                --chunk_count;
+                return nullptr;
+            }
+
+            auto chunk = reinterpret_cast<u8 *>(lmem::AllocateFromExpHeap(GetHeapHandle(), SlabChunkSize, SlabWindowSize));
+            if (chunk == nullptr) {
+                --chunk_count;
+                return nullptr;
+            }
+
+            const u32 chunk_offset = GetHeapOffset(chunk);
+            std::memset(&g_slab_window_classes[chunk_offset / SlabWindowSize], slab_class + 1, SlabChunkSize / SlabWindowSize);
+
+            // Hand the first block to the caller and link the rest together onto the free list
+            const size_t block_size = GetSlabBlockSize(slab_class);
+            const u32 block_count = SlabChunkSize / block_size;
+            for (u32 i = 1; i < block_count - 1; ++i) {
+                GetNextFreeOffset(chunk_offset + i * block_size).store(chunk_offset + (i + 1) * block_size, std::memory_order_relaxed);
+            }
+            PushSlabBlocks(slab_class, chunk_offset + block_size, chunk_offset + (block_count - 1) * block_size, block_count - 1);
+
+            return chunk;
+        }
+
+        void *AllocateFromSlab(size_t slab_class) {
+            if (void *p = PopSlabBlock(slab_class); p != nullptr) {
+                return p;
+            }
+
+            return RefillSlab(slab_class);
+        }
+
+        // Returns the size class + 1 of the slab owning a block, or 0 for exp heap blocks
+        size_t GetSlabClassOf(const void *p) {
+            const auto address = reinterpret_cast<uintptr_t>(p);
+            const auto heap = reinterpret_cast<uintptr_t>(g_heap_memory);
+            if ((address < heap) || (address >= heap + sizeof(g_heap_memory))) {
+                return 0;
+            }
+
+            return g_slab_window_classes[(address - heap) / SlabWindowSize];
+        }
+
+        void ProfileAllocation(size_t size, uintptr_t caller) {
+            std::scoped_lock lk(g_profiler_lock);
+
+            ++g_size_class_counts[GetSizeClass(size)];
+
+            for (auto &entry : g_call_sites) {
+                if (entry.address == caller || entry.address == 0) {
+                    entry.address = caller;
+                    ++entry.allocation_count;
+                    entry.allocated_bytes += size;
+                    return;
+                }
+            }
+
+            ++g_untracked_call_sites;
+        }
+
+        void *AllocateImpl(size_t size, size_t align, uintptr_t caller) {
+            void *p = nullptr;
+            size_t block_size = 0;
+            if ((size <= SlabMaxSize) && (align <= SlabAlignment)) {
+                const size_t slab_class = GetSizeClass(size);
+                p = AllocateFromSlab(slab_class);
+                block_size = GetSlabBlockSize(slab_class);
+            }
+
+            // Also catches small requests whose slab is out of blocks and at its chunk cap
+            if (p == nullptr) {
+                p = align != 0 ? lmem::AllocateFromExpHeap(GetHeapHandle(), size, align) : lmem::AllocateFromExpHeap(GetHeapHandle(), size);
+                block_size = p != nullptr ? lmem::GetExpHeapMemoryBlockSize(p) : 0;
+            }
+
+            if (AMS_UNLIKELY(p == nullptr)) {
+                ++g_failed_count;
+                return nullptr;
+            }
+
+            ++g_allocation_count;
+
+            #if defined(AMS_BUILD_FOR_DEBUGGING)
+            if (auto counter = GetThreadAllocationCounter(os::GetCurrentThread()); counter != nullptr) {
+                ++counter->allocation_count;
+            }
+            #endif
+
+            const size_t usage = g_current_usage.fetch_add(block_size) + block_size;
+
+            size_t peak = g_peak_usage;
+            while ((usage > peak) && !g_peak_usage.compare_exchange_weak(peak, usage)) {
+                // A failed exchange reloads the current peak
+            }
+
+            if (g_profiler_enabled) {
+                ProfileAllocation(size, caller);
+            }
+
+            return p;
+        }
+
+        void DeallocateImpl(void *p) {
+            if (p == nullptr) {
+                return;
+            }
+
+            ++g_free_count;
+
+            if (const size_t slab = GetSlabClassOf(p); slab != 0) {
+                g_current_usage -= GetSlabBlockSize(slab - 1);
+                PushSlabBlocks(slab - 1, GetHeapOffset(p), GetHeapOffset(p), 1);
+            } else {
+                g_current_usage -= lmem::GetExpHeapMemoryBlockSize(p);
+                lmem::FreeToExpHeap(GetHeapHandle(), p);
+            }
+        }
+
+        uintptr_t GetModuleBase() {
+            // The text segment is mapped first, so the region containing our code starts at the module base
+            MemoryInfo info;
+            u32 page_info;
+            R_ABORT_UNLESS(svcQueryMemory(&info, &page_info, reinterpret_cast<uintptr_t>(&GetModuleBase)));
+
+            return info.addr;
+        }
+
+        Result WriteLine(fs::FileHandle file, s64 *offset, const char *fmt, ...) {
+            char line[0x80];
+
+            std::va_list args;
+            va_start(args, fmt);
+            const int length = std::min<int>(util::VSNPrintf(line, sizeof(line), fmt, args), sizeof(line) - 1);
+            va_end(args);
+
+            R_TRY(fs::WriteFile(file, *offset, line, length, fs::WriteOption::None));
+            *offset += length;
+
+            R_SUCCEED();
+        }
+
+    }
+
+    void *Allocate(size_t size) {
+        return AllocateImpl(size, 0, reinterpret_cast<uintptr_t>(__builtin_return_address(0)));
+    }
+
+    void *AllocateWithAlign(size_t size, size_t align) {
+        return AllocateImpl(size, align, reinterpret_cast<uintptr_t>(__builtin_return_address(0)));
+    }
+
+    void Deallocate(void *p, size_t size) {
+        AMS_UNUSED(size);
+        DeallocateImpl(p);
+    }
+
+    #if defined(AMS_BUILD_FOR_DEBUGGING)
+    u32 GetThreadAllocationCount(const os::ThreadType *thread) {
+        auto counter = GetThreadAllocationCounter(thread);
+        return counter != nullptr ? counter->allocation_count.load() : 0;
+    }
+    #endif
+
+    void SetHeapProfilerEnabled(bool enabled) {
+        g_profiler_enabled = enabled;
+    }
+
+    void GetHeapStatistics(HeapStatistics *out) {
+        std::memset(out, 0, sizeof(HeapStatistics));
+
+        out->total_size       = sizeof(g_heap_memory);
+        out->current_usage    = g_current_usage;
+        out->peak_usage       = g_peak_usage;
+        out->free_size        = lmem::GetExpHeapTotalFreeSize(GetHeapHandle());
+        out->allocatable_size = lmem::GetExpHeapAllocatableSize(GetHeapHandle(), alignof(std::max_align_t));
+        out->allocation_count = g_allocation_count;
+        out->free_count       = g_free_count;
+        out->failed_count     = g_failed_count;
+
+        for (size_t i = 0; i < HeapSlabClassCount; ++i) {
+            out->slab_chunk_counts[i] = g_slab_chunk_counts[i];
+            out->slab_free_counts[i]  = g_slab_free_counts[i];
+        }
+
+        CallSiteEntry call_sites[TrackedCallSiteCount];
+        {
+            std::scoped_lock lk(g_profiler_lock);
+            std::memcpy(out->size_class_counts, g_size_class_counts, sizeof(g_size_class_counts));
+            std::memcpy(call_sites, g_call_sites, sizeof(g_call_sites));
+            out->untracked_call_sites = g_untracked_call_sites;
+        }
+
+        std::sort(std::begin(call_sites), std::end(call_sites), [](const CallSiteEntry &lhs, const CallSiteEntry &rhs) {
+            return lhs.allocation_count > rhs.allocation_count;
+        });
+
+        const uintptr_t module_base = GetModuleBase();
+        for (size_t i = 0; i < HeapCallSiteCount && call_sites[i].address != 0; ++i) {
+            out->call_sites[i].offset           = call_sites[i].address - module_base;
+            out->call_sites[i].allocation_count = call_sites[i].allocation_count;
+            out->call_sites[i].allocated_bytes  = call_sites[i].allocated_bytes;
+        }
+    }
+
+    Result DumpHeapStatistics() {
+        // Snapshots are kept off the mc service thread's small stack
+        std::scoped_lock lk(g_dump_lock);
+        auto &stats = g_dump_heap_statistics;
+        auto &stacks = g_dump_stack_statistics;
+
+        // Take the snapshots first, the file system allocates from this heap too
+        GetHeapStatistics(&stats);
+        GetThreadStackStatistics(&stacks);
+
+        bool file_exists;
+        R_TRY(fs::HasFile(&file_exists, HeapProfilePath));
+        if (file_exists) {
+            R_TRY(fs::DeleteFile(HeapProfilePath));
+        }
+        R_TRY(fs::CreateFile(HeapProfilePath, 0));
+
+        fs::FileHandle file;
+        R_TRY(fs::OpenFile(std::addressof(file), HeapProfilePath, fs::OpenMode_Write | fs::OpenMode_AllowAppend));
+        ON_SCOPE_EXIT { fs::CloseFile(file); };
+
+        s64 offset = 0;
+        R_TRY(WriteLine(file, &offset, "heap size: %u, in use: %u, peak: %u\n", stats.total_size, stats.current_usage, stats.peak_usage));
+        R_TRY(WriteLine(file, &offset, "free: %u, largest free block: %u\n", stats.free_size, stats.allocatable_size));
+        R_TRY(WriteLine(file, &offset, "allocations: %u, frees: %u, failed: %u\n", stats.allocation_count, stats.free_count, stats.failed_count));
+
+        u32 slab_chunk_count = 0;
+        for (size_t i = 0; i < HeapSlabClassCount; ++i) {
+            slab_chunk_count += stats.slab_chunk_counts[i];
+        }
+        R_TRY(WriteLine(file, &offset, "slabs: %zu bytes held, at most %zu\n", slab_chunk_count * SlabChunkSize, HeapSlabClassCount * HeapSlabMaxChunksPerClass * SlabChunkSize));
+
+        for (size_t i = 0; i < HeapSlabClassCount; ++i) {
+            R_TRY(WriteLine(file, &offset, "slab %zu: %u of %zu chunks, %u of %zu blocks free\n", GetSlabBlockSize(i), stats.slab_chunk_counts[i], HeapSlabMaxChunksPerClass, stats.slab_free_counts[i], stats.slab_chunk_counts[i] * (SlabChunkSize / GetSlabBlockSize(i))));
+        }
+
+        if (!g_profiler_enabled) {
+            R_TRY(WriteLine(file, &offset, "set enable_heap_profiler=true under [misc] for size class and call site statistics\n"));
+        } else {
+            R_TRY(WriteLine(file, &offset, "\nsize class: allocations\n"));
+            for (size_t i = 0; i < HeapSizeClassCount; ++i) {
+                const bool last = i == HeapSizeClassCount - 1;
+                R_TRY(WriteLine(file, &offset, "%s%zu: %u\n", last ? ">" : "<=", SmallestSizeClass << (last ? i - 1 : i), stats.size_class_counts[i]));
+            }
+
+            R_TRY(WriteLine(file, &offset, "\ncall site (module offset): allocations, bytes\n"));
+            for (const auto &call_site : stats.call_sites) {
+                if (call_site.allocation_count == 0) {
+                    break;
+                }
+                R_TRY(WriteLine(file, &offset, "0x%08lx: %u, %u\n", call_site.offset, call_site.allocation_count, call_site.allocated_bytes));
+            }
+            R_TRY(WriteLine(file, &offset, "untracked: %u\n", stats.untracked_call_sites));
+        }
+
+        // Stack usage is included too, so one dump covers the module's whole memory budget
+        R_TRY(WriteLine(file, &offset, "\nthread: peak stack usage / stack size\n"));
+        for (size_t i = 0; i < stacks.count; ++i) {
+            R_TRY(WriteLine(file, &offset, "%s: 0x%x / 0x%x\n", stacks.threads[i].name, stacks.threads[i].peak_usage, stacks.threads[i].stack_size));
+        }
+
+        #if defined(AMS_BUILD_FOR_DEBUGGING)
+        R_TRY(WriteLine(file, &offset, "\nthread: allocations\n"));
+        for (const auto &counter : g_thread_allocation_counters) {
+            const os::ThreadType *thread = counter.thread;
+            if (thread == nullptr) {
+                break;
+            }
+            const char *name = os::GetThreadNamePointer(thread);
+            R_TRY(WriteLine(file, &offset, "%s: %u\n", name != nullptr ? name : "unnamed", counter.allocation_count.load()));
+        }
+        #endif
+
+        R_RETURN(fs::FlushFile(file));
+    }
+
+}
+
+void *operator new(size_t size) {
+    return ams::mitm::AllocateImpl(size, 0, reinterpret_cast<uintptr_t>(__builtin_return_address(0)));
+}
+
+void *operator new(size_t size, const std::nothrow_t &) {
+    return ams::mitm::AllocateImpl(size, 0, reinterpret_cast<uintptr_t>(__builtin_return_address(0)));
+}
+
+void operator delete(void *p) {
+    return ams::mitm::DeallocateImpl(p);
+}
+
+void operator delete(void *p, size_t size) {
+    AMS_UNUSED(size);
+    return ams::mitm::DeallocateImpl(p);
+}
+
+void *operator new[](size_t size) {
+    return ams::mitm::AllocateImpl(size, 0, reinterpret_cast<uintptr_t>(__builtin_return_address(0)));
+}
+
+void *operator new[](size_t size, const std::nothrow_t &) {
+    return ams::mitm::AllocateImpl(size, 0, reinterpret_cast<uintptr_t>(__builtin_return_address(0)));
+}
+
+void operator delete[](void *p) {
+    return ams::mitm::DeallocateImpl(p);
+}
+
+void operator delete[](void *p, size_t size) {
+    AMS_UNUSED(size);
+    return ams::mitm::DeallocateImpl(p);
+}
+
+void *operator new(size_t size, std::align_val_t align) {
+    return ams::mitm::AllocateImpl(size, static_cast<size_t>(align), reinterpret_cast<uintptr_t>(__builtin_return_address(0)));
+}
+
+void operator delete(void *p, std::align_val_t align) {
+    AMS_UNUSED(align);
+    return ams::mitm::DeallocateImpl(p);
+}
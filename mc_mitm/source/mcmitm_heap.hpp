@@ -0,0 +1,79 @@
+/*
+ * Copyright (c) 2020-2025 ndeadly
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+#include <stratosphere.hpp>
+
+namespace ams::mitm {
+
+    constexpr size_t HeapSizeClassCount = 8;
+    constexpr size_t HeapSlabClassCount = 5;
+    constexpr size_t HeapSlabMaxChunksPerClass = 4;    // Chunks are 1KB, so the slabs never hold more than 20KB of the heap
+    constexpr size_t HeapCallSiteCount = 16;
+
+    struct HeapCallSite {
+        u64 offset;             // Return address relative to the module base
+        u32 allocation_count;
+        u32 allocated_bytes;
+    };
+
+    struct HeapStatistics {
+        u32 total_size;
+        u32 current_usage;
+        u32 peak_usage;
+        u32 free_size;
+        u32 allocatable_size;   // Largest single block that could currently be allocated
+        u32 allocation_count;
+        u32 free_count;
+        u32 failed_count;
+        u32 size_class_counts[HeapSizeClassCount];  // 16, 32, 64 ... 1024 bytes, then everything larger
+        u32 untracked_call_sites;
+        u32 reserved;
+        u32 slab_chunk_counts[HeapSlabClassCount];  // 16, 32, 64, 128 and 256 byte blocks
+        u32 slab_free_counts[HeapSlabClassCount];
+        HeapCallSite call_sites[HeapCallSiteCount]; // Sorted by allocation count
+    };
+
+    void *Allocate(size_t size);
+    void *AllocateWithAlign(size_t size, size_t align);
+    void Deallocate(void *p, size_t size);
+
+    void SetHeapProfilerEnabled(bool enabled);
+    void GetHeapStatistics(HeapStatistics *out);
+    Result DumpHeapStatistics();
+
+    #if defined(AMS_BUILD_FOR_DEBUGGING)
+    u32 GetThreadAllocationCount(const os::ThreadType *thread);
+    #endif
+
+    // Asserts in debug builds that the current thread doesn't allocate from the heap while the guard is in scope
+    class ScopedNoHeapAllocation {
+        NON_COPYABLE(ScopedNoHeapAllocation);
+        NON_MOVEABLE(ScopedNoHeapAllocation);
+
+        #if defined(AMS_BUILD_FOR_DEBUGGING)
+        public:
+            ScopedNoHeapAllocation() : m_allocation_count(GetThreadAllocationCount(os::GetCurrentThread())) { }
+            ~ScopedNoHeapAllocation() { AMS_ASSERT(GetThreadAllocationCount(os::GetCurrentThread()) == m_allocation_count); }
+
+        private:
+            u32 m_allocation_count;
+        #else
+        public:
+            ScopedNoHeapAllocation() { }
+        #endif
+    };
+
+}
@@ -28,6 +28,7 @@
 #include "bluetooth_mitm/bluetooth/bluetooth_hid_report.hpp"
 #include "bluetooth_mitm/bluetooth/bluetooth_ble.hpp"
 #include "usb/mc_usb_handler.hpp"
+#include "controllers/switch_rumble_scheduler.hpp"
 
 namespace ams::mitm {
 
@@ -75,6 +76,9 @@ namespace ams::mitm {
             // Start hid report handling thread
             ams::bluetooth::hid::report::Initialize();
 
+            // Start rumble sample scheduling thread
+            ams::controller::InitializeRumbleScheduler();
+
             // Wait for system to call BluetoothEnable
             ams::bluetooth::core::WaitEnabled();
 
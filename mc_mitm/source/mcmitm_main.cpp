@@ -17,49 +17,13 @@
 #include <stratosphere.hpp>
 #include "mcmitm_initialization.hpp"
 #include "mcmitm_config.hpp"
+#include "mcmitm_heap.hpp"
+#include "mcmitm_thread_stacks.hpp"
 #include "mcmitm_process_monitor.hpp"
+#include "controllers/controller_management.hpp"
 
 namespace ams {
 
-    namespace mitm {
-
-        namespace {
-
-            alignas(0x40) constinit u8 g_heap_memory[64_KB];
-            constinit lmem::HeapHandle g_heap_handle;
-            constinit bool g_heap_initialized;
-            constinit os::SdkMutex g_heap_init_mutex;
-
-            lmem::HeapHandle GetHeapHandle() {
-                if (AMS_UNLIKELY(!g_heap_initialized)) {
-                    std::scoped_lock lk(g_heap_init_mutex);
-
-                    if (AMS_LIKELY(!g_heap_initialized)) {
-                        g_heap_handle = lmem::CreateExpHeap(g_heap_memory, sizeof(g_heap_memory), lmem::CreateOption_ThreadSafe);
-                        g_heap_initialized = true;
-                    }
-                }
-
-                return g_heap_handle;
-            }
-
-            void *Allocate(size_t size) {
-                return lmem::AllocateFromExpHeap(GetHeapHandle(), size);
-            }
-
-            void *AllocateWithAlign(size_t size, size_t align) {
-                return lmem::AllocateFromExpHeap(GetHeapHandle(), size, align);
-            }
-
-            void Deallocate(void *p, size_t size) {
-                AMS_UNUSED(size);
-                return lmem::FreeToExpHeap(GetHeapHandle(), p);
-            }
-
-        }
-
-    }
-
     namespace init {
 
         void InitializeSystemModule() {
@@ -82,11 +46,16 @@ namespace ams {
         void Startup() {
             // Load module configuration from ini file
             mitm::LoadConfiguration();
+
+            mitm::SetHeapProfilerEnabled(mitm::GetGlobalConfig()->misc.enable_heap_profiler);
         }
 
     }
 
     void Main() {
+        // Unlike the module threads, the main thread is already running on its stack, so it can only be registered from here
+        mitm::RegisterCurrentThreadStack();
+
         // Launch mitm and other modules
         mitm::LaunchModules();
 
@@ -129,7 +98,7 @@ namespace ams {
                                 shutdown = true;
                                 [[fallthrough]];
                             case psc::PmState_SleepReady:
-                                /* Run sleep/shutdown code */
+                                controller::FlushControllerVirtualMemory();
                                 break;
                             default:
                                 break;
@@ -142,6 +111,7 @@ namespace ams {
                 case 1:
                     timer_event.Clear();
                     mc::CheckForProcessSwitch();
+                    controller::FlushControllerVirtualMemory();
                     break;
 
                 AMS_UNREACHABLE_DEFAULT_CASE();
@@ -156,44 +126,3 @@ namespace ams {
     }
 
 }
-
-void *operator new(size_t size) {
-    return ams::mitm::Allocate(size);
-}
-
-void *operator new(size_t size, const std::nothrow_t &) {
-    return ams::mitm::Allocate(size);
-}
-
-void operator delete(void *p) {
-    return ams::mitm::Deallocate(p, 0);
-}
-
-void operator delete(void *p, size_t size) {
-    return ams::mitm::Deallocate(p, size);
-}
-
-void *operator new[](size_t size) {
-    return ams::mitm::Allocate(size);
-}
-
-void *operator new[](size_t size, const std::nothrow_t &) {
-    return ams::mitm::Allocate(size);
-}
-
-void operator delete[](void *p) {
-    return ams::mitm::Deallocate(p, 0);
-}
-
-void operator delete[](void *p, size_t size) {
-    return ams::mitm::Deallocate(p, size);
-}
-
-void *operator new(size_t size, std::align_val_t align) {
-    return ams::mitm::AllocateWithAlign(size, static_cast<size_t>(align));
-}
-
-void operator delete(void *p, std::align_val_t align) {
-    AMS_UNUSED(align);
-    return ams::mitm::Deallocate(p, 0);
-}
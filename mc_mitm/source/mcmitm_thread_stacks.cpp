@@ -0,0 +1,93 @@
+/*
+ * Copyright (c) 2020-2025 ndeadly
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "mcmitm_thread_stacks.hpp"
+
+namespace ams::mitm {
+
+    namespace {
+
+        constexpr u64 StackCanary = 0xcdcdcdcdcdcdcdcd;
+
+        // Left unfilled below the frame registering a running thread, so the fill itself never writes over a live frame
+        constexpr size_t ActiveStackMargin = 0x100;
+
+        struct MonitoredThread {
+            const os::ThreadType *thread;
+            const u64 *stack;
+            size_t stack_size;
+        };
+
+        constinit os::SdkMutex g_thread_lock;
+        constinit MonitoredThread g_threads[MaxMonitoredThreads];
+        constinit size_t g_thread_count;
+
+        size_t GetPeakStackUsage(const MonitoredThread *monitored) {
+            // Stacks grow downwards, so the untouched region is the run of canaries at the bottom
+            const size_t word_count = monitored->stack_size / sizeof(u64);
+
+            size_t untouched = 0;
+            while ((untouched < word_count) && (monitored->stack[untouched] == StackCanary)) {
+                ++untouched;
+            }
+
+            return monitored->stack_size - untouched * sizeof(u64);
+        }
+
+        void AddMonitoredThread(const os::ThreadType *thread, const u64 *stack, size_t stack_size) {
+            std::scoped_lock lk(g_thread_lock);
+
+            AMS_ABORT_UNLESS(g_thread_count < MaxMonitoredThreads);
+
+            g_threads[g_thread_count++] = { thread, stack, stack_size };
+        }
+
+    }
+
+    void RegisterThreadStack(const os::ThreadType *thread, void *stack, size_t stack_size) {
+        auto words = reinterpret_cast<u64 *>(stack);
+        std::fill(words, words + stack_size / sizeof(u64), StackCanary);
+
+        AddMonitoredThread(thread, words, stack_size);
+    }
+
+    void RegisterCurrentThreadStack() {
+        const os::ThreadType *thread = os::GetCurrentThread();
+        auto words = reinterpret_cast<u64 *>(thread->stack);
+
+        // Everything above the stack pointer is in use. The unfilled margin is counted as used too, which overstates the peak by at most that much
+        const uintptr_t frame = reinterpret_cast<uintptr_t>(__builtin_frame_address(0));
+        auto live = reinterpret_cast<u64 *>(util::AlignDown(frame - ActiveStackMargin, sizeof(u64)));
+        AMS_ABORT_UNLESS(words < live);
+        std::fill(words, live, StackCanary);
+
+        AddMonitoredThread(thread, words, thread->stack_size);
+    }
+
+    void GetThreadStackStatistics(ThreadStackStatistics *out) {
+        std::memset(out, 0, sizeof(ThreadStackStatistics));
+
+        std::scoped_lock lk(g_thread_lock);
+
+        out->count = g_thread_count;
+        for (size_t i = 0; i < g_thread_count; ++i) {
+            const char *name = os::GetThreadNamePointer(g_threads[i].thread);
+            std::strncpy(out->threads[i].name, name != nullptr ? name : "unnamed", sizeof(out->threads[i].name) - 1);
+            out->threads[i].stack_size = g_threads[i].stack_size;
+            out->threads[i].peak_usage = GetPeakStackUsage(&g_threads[i]);
+        }
+    }
+
+}
@@ -0,0 +1,41 @@
+/*
+ * Copyright (c) 2020-2025 ndeadly
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+#include <stratosphere.hpp>
+
+namespace ams::mitm {
+
+    constexpr size_t MaxMonitoredThreads = 12;
+
+    struct ThreadStackUsage {
+        char name[0x20];
+        u32 stack_size;
+        u32 peak_usage;
+    };
+
+    struct ThreadStackStatistics {
+        u32 count;
+        u32 reserved;
+        ThreadStackUsage threads[MaxMonitoredThreads];
+    };
+
+    // Fills a thread stack with a canary pattern so its peak usage can be measured later. Must be called before the thread is created
+    void RegisterThreadStack(const os::ThreadType *thread, void *stack, size_t stack_size);
+    // For threads that are already running, e.g. the main thread. Only the part of the stack below the caller's frame is filled
+    void RegisterCurrentThreadStack();
+    void GetThreadStackStatistics(ThreadStackStatistics *out);
+
+}
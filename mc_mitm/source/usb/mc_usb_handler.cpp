@@ -15,6 +15,7 @@
  */
 #include "mc_usb_handler.hpp"
 #include "../controllers/dualshock3_controller.hpp"
+#include "../mcmitm_thread_stacks.hpp"
 
 namespace ams::usb {
 
@@ -100,6 +101,8 @@ namespace ams::usb {
     }
 
     void Launch() {
+        mitm::RegisterThreadStack(&g_thread, g_thread_stack, ThreadStackSize);
+
         R_ABORT_UNLESS(os::CreateThread(&g_thread,
             UsbThreadFunction,
             nullptr,
@@ -0,0 +1,66 @@
+/*
+ * Copyright (c) 2020-2025 ndeadly
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "test_common.hpp"
+#include "controllers/switch_analog_stick.hpp"
+
+namespace {
+
+    using namespace ams;
+    using namespace ams::controller;
+
+    constexpr size_t Iterations = 10'000'000;
+
+    // Cycles through a spread of stick positions so the table lookups aren't all the same entry
+    double Measure(const AnalogStickResponseTable *table) {
+        SwitchAnalogStick stick;
+        u32 sink = 0;
+        const double ns = mc::test::MeasureNanoSeconds(Iterations, [&](size_t i) {
+            stick.SetData((i * 97) & 0xfff, (i * 61) & 0xfff);
+            ApplyAnalogStickResponse(table, &stick);
+            sink += stick.m_xy[0];
+        });
+        asm volatile("" : : "r"(sink));
+        return ns;
+    }
+
+}
+
+int main() {
+    struct {
+        const char *name;
+        float inner, outer, anti, curve;
+        bool invert_x;
+    } profiles[] = {
+        { "invert only",    0.0f,  0.0f,  0.0f,  1.0f, true  },
+        { "deadzones",      0.1f,  0.05f, 0.0f,  1.0f, false },
+        { "full pipeline",  0.1f,  0.05f, 0.15f, 1.5f, true  },
+    };
+
+    for (const auto &p : profiles) {
+        AnalogStickResponseTable table;
+        CompileAnalogStickResponse(p.inner, p.outer, p.anti, p.curve, p.invert_x, false, &table);
+        std::printf("ApplyAnalogStickResponse (%s): %.2f ns/stick\n", p.name, Measure(&table));
+    }
+
+    const double compile_ns = mc::test::MeasureNanoSeconds(1000, [](size_t i) {
+        AnalogStickResponseTable table;
+        CompileAnalogStickResponse(0.1f, 0.05f, 0.15f, 1.0f + i * 0.001f, false, false, &table);
+        asm volatile("" : : "r"(table.radius[100]));
+    });
+    std::printf("CompileAnalogStickResponse: %.0f ns/table\n", compile_ns);
+
+    return 0;
+}
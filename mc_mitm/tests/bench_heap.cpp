@@ -0,0 +1,84 @@
+/*
+ * Copyright (c) 2020-2025 ndeadly
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "test_common.hpp"
+#include "mcmitm_heap.hpp"
+#include <vector>
+
+// The exp heap here is the host stand-in from host_stubs.cpp, a locked first fit search like lmem's, so the
+// comparison shows what the slabs save over a locked heap rather than the exact figures on the console
+namespace {
+
+    using namespace ams;
+    using namespace ams::mitm;
+
+    constexpr size_t Iterations = 2'000'000;
+    constexpr size_t SlotCount = 16;
+
+    // Over-aligned requests skip the slabs, which gives the exp heap path for the same sizes
+    constexpr size_t SlabAlignment = 0;
+    constexpr size_t ExpHeapAlignment = 0x20;
+
+    void *AllocateBlock(size_t size, size_t align) {
+        return align != 0 ? AllocateWithAlign(size, align) : Allocate(size);
+    }
+
+    // Keeps a small working set alive so blocks are recycled out of order, like shared_ptr control blocks and async functions are
+    double MeasureChurn(size_t align, size_t iterations) {
+        void *slots[SlotCount] = {};
+        const double ns = mc::test::MeasureNanoSeconds(iterations, [&](size_t i) {
+            const size_t k = (i * 7) % SlotCount;
+            Deallocate(slots[k], 0);
+            slots[k] = AllocateBlock(16 + (i * 13) % 240, align);
+        });
+
+        for (auto slot : slots) {
+            Deallocate(slot, 0);
+        }
+
+        return ns;
+    }
+
+    double MeasureConcurrentChurn(size_t align, int thread_count) {
+        std::atomic<u64> total_ns = 0;
+        {
+            std::vector<std::thread> threads;
+            for (int t = 0; t < thread_count; ++t) {
+                threads.emplace_back([&] { total_ns += MeasureChurn(align, Iterations / thread_count); });
+            }
+            for (auto &thread : threads) {
+                thread.join();
+            }
+        }
+
+        return static_cast<double>(total_ns) / thread_count;
+    }
+
+}
+
+int main() {
+    std::printf("heap churn, 16-256 bytes (slabs):         %.1f ns/op\n", MeasureChurn(SlabAlignment, Iterations));
+    std::printf("heap churn, 16-256 bytes (exp heap):      %.1f ns/op\n", MeasureChurn(ExpHeapAlignment, Iterations));
+    std::printf("heap churn, 4 threads (slabs):            %.1f ns/op\n", MeasureConcurrentChurn(SlabAlignment, 4));
+    std::printf("heap churn, 4 threads (exp heap):         %.1f ns/op\n", MeasureConcurrentChurn(ExpHeapAlignment, 4));
+
+    HeapStatistics stats;
+    GetHeapStatistics(&stats);
+    for (size_t i = 0; i < HeapSlabClassCount; ++i) {
+        std::printf("slab %zu: %u of %zu chunks\n", static_cast<size_t>(16) << i, stats.slab_chunk_counts[i], HeapSlabMaxChunksPerClass);
+    }
+
+    return 0;
+}
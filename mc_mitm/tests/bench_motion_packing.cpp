@@ -0,0 +1,143 @@
+/*
+ * Copyright (c) 2020-2025 ndeadly
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "test_common.hpp"
+#include "controller_fixtures.hpp"
+#include "controllers/xbox_one_controller.hpp"
+#include "controllers/betop_controller.hpp"
+
+namespace {
+
+    using namespace ams;
+    using namespace ams::controller;
+
+    constexpr size_t Iterations = 1'000'000;
+
+    // Reports are cycled from a pool so generating them stays out of the measurement
+    constexpr size_t ReportPoolSize = 64;
+
+    std::unique_ptr<SwitchController> CreateDualshock4(const bluetooth::Address *address) {
+        auto controller = std::make_unique<Dualshock4Controller>(address, Dualshock4Controller::hardware_ids[0]);
+        mc::test::CalibrateMotion(controller.get());
+        return controller;
+    }
+
+    std::unique_ptr<SwitchController> CreateDualsense(const bluetooth::Address *address) {
+        auto controller = std::make_unique<DualsenseController>(address, DualsenseController::hardware_ids[0]);
+        mc::test::CalibrateMotion(controller.get());
+        return controller;
+    }
+
+    // A Wiimote with MotionPlus attached and active, reporting in mode 0x35
+    std::unique_ptr<SwitchController> CreateWiiMotionPlus(const bluetooth::Address *address) {
+        auto controller = std::make_unique<WiiController>(address, WiiController::hardware_ids[0]);
+        mc::test::AttachExtension(controller.get(), WiiExtensionController_MotionPlus);
+        return controller;
+    }
+
+    std::unique_ptr<SwitchController> CreateXboxOne(const bluetooth::Address *address) {
+        return std::make_unique<XboxOneController>(address, XboxOneController::hardware_ids[0]);
+    }
+
+    std::unique_ptr<SwitchController> CreateBetop(const bluetooth::Address *address) {
+        return std::make_unique<BetopController>(address, BetopController::hardware_ids[0]);
+    }
+
+    // Keeps the report flagged as MotionPlus data, with the extension state the controller already has, and the
+    // accelerometer low bits out of the button bytes so only the motion span carries motion
+    void PrepareWiiReport(u8 *data, size_t index) {
+        AMS_UNUSED(index);
+        auto report = reinterpret_cast<WiiReportData *>(data);
+        report->input0x35.buttons.raw[0] &= ~0x60;
+        report->input0x35.buttons.raw[1] &= ~0x30;
+
+        auto extension = reinterpret_cast<MotionPlusExtensionData *>(report->input0x35.extension);
+        extension->motionplus_report = 1;
+        extension->extension_connected = 0;
+    }
+
+    struct BenchTarget {
+        const char *name;
+        std::unique_ptr<SwitchController> (*create)(const bluetooth::Address *address);
+        u8 report_id;
+        u16 report_size;
+        u16 motion_offset;  // Bytes of the report holding motion data, empty for controllers without any
+        u16 motion_size;
+        void (*prepare)(u8 *data, size_t index);    // Run on each report just before it's sent
+    };
+
+    constexpr BenchTarget BenchTargets[] = {
+        { "Dualshock4",       CreateDualshock4,    0x11, 0x4e, offsetof(Dualshock4ReportData, input0x11.vel_x), 6 * sizeof(s16), mc::test::PrepareDualshock4Report },
+        { "Dualsense",        CreateDualsense,     0x31, 0x4e, offsetof(DualsenseReportData, input0x31.vel_x),  6 * sizeof(s16), mc::test::PrepareDualsenseReport },
+        { "Wii + MotionPlus", CreateWiiMotionPlus, 0x35, 0x16, offsetof(WiiReportData, input0x35.accel),       3 + 6,           PrepareWiiReport },
+        { "XboxOne",          CreateXboxOne,       0x01, 0x12, 0, 0, nullptr },
+        { "Betop",            CreateBetop,         0x03, 0x10, 0, 0, nullptr },
+    };
+
+    void SetSensorMode(SwitchController *controller, SensorSleepType mode) {
+        SwitchOutputReport output = {};
+        output.id = 0x01;
+        output.type0x01.hid_command.id = HidCommand_SensorSleep;
+        output.type0x01.hid_command.sensor_sleep.mode = mode;
+
+        bluetooth::HidReport report = {};
+        report.size = sizeof(output);
+        std::memcpy(report.data, &output, sizeof(output));
+        controller->HandleOutputDataReport(&report);
+    }
+
+    // Nanoseconds per input report through HandleDataReportEvent. Every report in the pool differs, but unless motion_changes
+    // is set they all carry the same motion data
+    double MeasureReportPath(const BenchTarget &target, SensorSleepType mode, bool motion_changes) {
+        const bluetooth::Address address = { { 0x00, 0x11, 0x22, 0x33, 0x44, 0x55 } };
+        auto controller = target.create(&address);
+        SetSensorMode(controller.get(), mode);
+
+        static bluetooth::HidReportEventInfo events[ReportPoolSize];
+        mc::test::Random random(0x12345678);
+        for (auto &event : events) {
+            auto report = &event.data_report.v9.report;
+            report->size = target.report_size;
+            random.Fill(report->data, report->size);
+            report->data[0] = target.report_id;
+
+            if (!motion_changes) {
+                std::memcpy(&report->data[target.motion_offset], &events[0].data_report.v9.report.data[target.motion_offset], target.motion_size);
+            }
+        }
+
+        return mc::test::MeasureNanoSeconds(Iterations, [&](size_t i) {
+            auto event = &events[i % ReportPoolSize];
+            if (target.prepare) {
+                target.prepare(event->data_report.v9.report.data, i);
+            }
+            controller->HandleDataReportEvent(event);
+        });
+    }
+
+}
+
+int main() {
+    std::printf("%-18s %16s %18s %16s  (ns/report)\n", "controller", "motion changed", "motion unchanged", "motion disabled");
+    for (const auto &target : BenchTargets) {
+        std::printf("%-18s %16.1f %18.1f %16.1f\n", target.name,
+            MeasureReportPath(target, SensorSleepType_Active, true),
+            MeasureReportPath(target, SensorSleepType_Active, false),
+            MeasureReportPath(target, SensorSleepType_Inactive, true)
+        );
+    }
+
+    return 0;
+}
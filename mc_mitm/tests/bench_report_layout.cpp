@@ -0,0 +1,102 @@
+/*
+ * Copyright (c) 2020-2025 ndeadly
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "test_common.hpp"
+#include "controller_fixtures.hpp"
+#include "reference/legacy_report_mappers.hpp"
+#include "controllers/betop_controller.hpp"
+#include "controllers/hyperkin_controller.hpp"
+#include "controllers/lanshen_controller.hpp"
+#include "controllers/razer_controller.hpp"
+#include "controllers/xiaomi_controller.hpp"
+#include "mcmitm_config.hpp"
+
+namespace {
+
+    using namespace ams;
+    using namespace ams::controller;
+    namespace ref = mc::test::reference;
+
+    constexpr size_t Iterations = 1'000'000;
+    constexpr int TriggerThreshold = 50;
+
+    // Reports are cycled from a pool so generating them stays out of the measurement
+    constexpr size_t ReportPoolSize = 64;
+
+    template<typename Controller>
+    std::unique_ptr<SwitchController> Create(const bluetooth::Address *address) {
+        return std::make_unique<Controller>(address, Controller::hardware_ids[0]);
+    }
+
+    // Called without virtual dispatch, so both sides pay the same single indirect call
+    template<typename Controller>
+    void MapLayout(SwitchController *controller, const bluetooth::HidReport *report) {
+        static_cast<Controller *>(controller)->Controller::ProcessInputData(report);
+    }
+
+    struct BenchTarget {
+        const char *name;
+        std::unique_ptr<SwitchController> (*create)(const bluetooth::Address *address);
+        void (*map_layout)(SwitchController *controller, const bluetooth::HidReport *report);
+        void (*map_reference)(const u8 *report, int trigger_threshold, ref::MappedState *state);
+        u8 report_id;
+        u16 report_size;
+    };
+
+    constexpr BenchTarget BenchTargets[] = {
+        { "Betop",    Create<BetopController>,    MapLayout<BetopController>,    ref::MapBetopReport,    0x03, sizeof(BetopReportData)    },
+        { "Hyperkin", Create<HyperkinController>, MapLayout<HyperkinController>, ref::MapHyperkinReport, 0x3f, sizeof(HyperkinReportData) },
+        { "LanShen",  Create<LanShenController>,  MapLayout<LanShenController>,  ref::MapLanShenReport,  0x01, sizeof(LanShenReportData)  },
+        { "Razer",    Create<RazerController>,    MapLayout<RazerController>,    ref::MapRazerReport,    0x01, sizeof(RazerReportData)    },
+        { "Xiaomi",   Create<XiaomiController>,   MapLayout<XiaomiController>,   ref::MapXiaomiReport,   0x04, sizeof(XiaomiReportData)   },
+    };
+
+    // Nanoseconds per random input report, mapped by the controller's layout and by the hand written mapper it replaced
+    void MeasureTarget(const BenchTarget &target, double *out_layout, double *out_reference) {
+        const bluetooth::Address address = { { 0x00, 0x11, 0x22, 0x33, 0x44, 0x55 } };
+        auto controller = target.create(&address);
+
+        static bluetooth::HidReport reports[ReportPoolSize];
+        mc::test::Random random(0x12345678);
+        for (auto &report : reports) {
+            report.size = target.report_size;
+            random.Fill(report.data, report.size);
+            report.data[0] = target.report_id;
+        }
+
+        *out_layout = mc::test::MeasureNanoSeconds(Iterations, [&](size_t i) {
+            target.map_layout(controller.get(), &reports[i % ReportPoolSize]);
+        });
+
+        ref::MappedState state = {};
+        *out_reference = mc::test::MeasureNanoSeconds(Iterations, [&](size_t i) {
+            target.map_reference(reports[i % ReportPoolSize].data, TriggerThreshold, &state);
+        });
+    }
+
+}
+
+int main() {
+    mitm::GetGlobalConfig()->misc.analog_trigger_activation_threshold = TriggerThreshold;
+
+    std::printf("%-10s %10s %12s  (ns/report)\n", "controller", "layout", "hand written");
+    for (const auto &target : BenchTargets) {
+        double layout, reference;
+        MeasureTarget(target, &layout, &reference);
+        std::printf("%-10s %10.1f %12.1f\n", target.name, layout, reference);
+    }
+
+    return 0;
+}
@@ -0,0 +1,134 @@
+/*
+ * Copyright (c) 2020-2025 ndeadly
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "test_common.hpp"
+#include "controller_fixtures.hpp"
+#include "controllers/xbox_one_controller.hpp"
+#include "controllers/8bitdo_controller.hpp"
+#include "controllers/betop_controller.hpp"
+
+namespace {
+
+    using namespace ams;
+    using namespace ams::controller;
+
+    constexpr size_t Iterations = 1'000'000;
+
+    // Reports are cycled from a pool so generating them stays out of the measurement
+    constexpr size_t ReportPoolSize = 64;
+
+    std::unique_ptr<SwitchController> CreateDualshock4(const bluetooth::Address *address) {
+        auto controller = std::make_unique<Dualshock4Controller>(address, Dualshock4Controller::hardware_ids[0]);
+        mc::test::CalibrateMotion(controller.get());
+        return controller;
+    }
+
+    std::unique_ptr<SwitchController> CreateDualsense(const bluetooth::Address *address) {
+        auto controller = std::make_unique<DualsenseController>(address, DualsenseController::hardware_ids[0]);
+        mc::test::CalibrateMotion(controller.get());
+        return controller;
+    }
+
+    std::unique_ptr<SwitchController> CreateXboxOne(const bluetooth::Address *address) {
+        return std::make_unique<XboxOneController>(address, XboxOneController::hardware_ids[0]);
+    }
+
+    std::unique_ptr<SwitchController> CreateEightBitDo(const bluetooth::Address *address) {
+        return std::make_unique<EightBitDoController>(address, EightBitDoController::hardware_ids[0]);
+    }
+
+    // A Wiimote with a Nunchuck attached, reporting in mode 0x35
+    std::unique_ptr<SwitchController> CreateWiiNunchuck(const bluetooth::Address *address) {
+        auto controller = std::make_unique<WiiController>(address, WiiController::hardware_ids[0]);
+        mc::test::AttachExtension(controller.get(), WiiExtensionController_Nunchuck);
+        return controller;
+    }
+
+    std::unique_ptr<SwitchController> CreateBetop(const bluetooth::Address *address) {
+        return std::make_unique<BetopController>(address, BetopController::hardware_ids[0]);
+    }
+
+    // Runs only the controller's own mapping, without the Switch report being built and written out
+    template<typename Controller>
+    void MapInputData(SwitchController *controller, const bluetooth::HidReport *report) {
+        static_cast<Controller *>(controller)->ProcessInputData(report);
+    }
+
+    struct BenchTarget {
+        const char *name;
+        std::unique_ptr<SwitchController> (*create)(const bluetooth::Address *address);
+        void (*map)(SwitchController *controller, const bluetooth::HidReport *report);
+        u8 report_ids[4];
+        u16 report_size;
+        void (*prepare)(u8 *data, size_t index);    // Run on each report just before it's sent
+    };
+
+    constexpr BenchTarget BenchTargets[] = {
+        { "Dualshock4",     CreateDualshock4,  MapInputData<Dualshock4Controller>,   { 0x11 },       0x4e, mc::test::PrepareDualshock4Report },
+        { "Dualsense",      CreateDualsense,   MapInputData<DualsenseController>,    { 0x31 },       0x4e, mc::test::PrepareDualsenseReport },
+        { "XboxOne",        CreateXboxOne,     MapInputData<XboxOneController>,      { 0x01 },       0x12, nullptr },
+        { "8BitDo",         CreateEightBitDo,  MapInputData<EightBitDoController>,   { 0x01, 0x03 }, 0x0b, nullptr },
+        { "Wii + Nunchuck", CreateWiiNunchuck, MapInputData<WiiController>,          { 0x35 },       0x16, nullptr },
+        { "Betop (layout)", CreateBetop,       MapInputData<BetopController>,        { 0x03 },       0x10, nullptr },
+    };
+
+    // Nanoseconds per input report, with motion left disabled so the mapping dominates. The report path goes through
+    // HandleDataReportEvent, the mapping alone through the controller's ProcessInputData
+    void MeasureTarget(const BenchTarget &target, double *out_report_path, double *out_mapping) {
+        const bluetooth::Address address = { { 0x00, 0x11, 0x22, 0x33, 0x44, 0x55 } };
+        auto controller = target.create(&address);
+
+        size_t num_ids = 0;
+        while ((num_ids < std::size(target.report_ids)) && (target.report_ids[num_ids] != 0)) {
+            ++num_ids;
+        }
+
+        static bluetooth::HidReportEventInfo events[ReportPoolSize];
+        mc::test::Random random(0x12345678);
+        for (size_t i = 0; i < ReportPoolSize; ++i) {
+            auto report = &events[i].data_report.v9.report;
+            report->size = target.report_size;
+            random.Fill(report->data, report->size);
+            report->data[0] = target.report_ids[i % num_ids];
+        }
+
+        auto next_report = [&](size_t i) {
+            auto event = &events[i % ReportPoolSize];
+            if (target.prepare) {
+                target.prepare(event->data_report.v9.report.data, i);
+            }
+            return event;
+        };
+
+        *out_report_path = mc::test::MeasureNanoSeconds(Iterations, [&](size_t i) {
+            controller->HandleDataReportEvent(next_report(i));
+        });
+        *out_mapping = mc::test::MeasureNanoSeconds(Iterations, [&](size_t i) {
+            target.map(controller.get(), &next_report(i)->data_report.v9.report);
+        });
+    }
+
+}
+
+int main() {
+    std::printf("%-16s %12s %12s  (ns/report)\n", "controller", "report path", "mapping");
+    for (const auto &target : BenchTargets) {
+        double report_path, mapping;
+        MeasureTarget(target, &report_path, &mapping);
+        std::printf("%-16s %12.1f %12.1f\n", target.name, report_path, mapping);
+    }
+
+    return 0;
+}
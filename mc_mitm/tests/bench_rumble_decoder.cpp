@@ -0,0 +1,60 @@
+/*
+ * Copyright (c) 2020-2025 ndeadly
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "test_common.hpp"
+#include "reference/float_rumble_decoder.hpp"
+#include "controllers/switch_rumble_decoder.hpp"
+#include <cstring>
+#include <random>
+#include <vector>
+
+namespace {
+
+    namespace ref = mc::test::reference;
+
+    constexpr size_t Packets = 1 << 20;
+    constexpr size_t Passes = 20;
+
+    template<typename Decoder, typename Encoded, typename Samples>
+    double Measure(const std::vector<u32> &packets) {
+        Decoder decoder;
+        float sink = 0.0f;
+        const double ns = mc::test::MeasureNanoSeconds(Passes * packets.size(), [&](size_t i) {
+            Encoded encoded;
+            std::memcpy(&encoded, &packets[i % packets.size()], sizeof(encoded));
+
+            Samples decoded;
+            decoder.DecodeSamples(&encoded, &decoded);
+            sink += decoded.samples[0].low_band_amp + decoded.samples[0].high_band_freq;
+        });
+        asm volatile("" : : "r"(sink));
+        return ns;
+    }
+
+}
+
+int main() {
+    std::mt19937 rng(2);
+    std::vector<u32> packets(Packets);
+    for (auto &packet : packets) {
+        packet = rng();
+    }
+
+    using namespace ams::controller;
+    std::printf("DecodeSamples (float reference): %.2f ns/packet\n", Measure<ref::SwitchRumbleDecoder, ref::SwitchEncodedVibrationSamples, ref::SwitchVibrationSamples>(packets));
+    std::printf("DecodeSamples (fixed point):     %.2f ns/packet\n", Measure<SwitchRumbleDecoder, SwitchEncodedVibrationSamples, SwitchVibrationSamples>(packets));
+
+    return 0;
+}
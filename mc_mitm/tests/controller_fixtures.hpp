@@ -0,0 +1,140 @@
+/*
+ * Copyright (c) 2020-2025 ndeadly
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+#include "controllers/dualshock4_controller.hpp"
+#include "controllers/dualsense_controller.hpp"
+#include "controllers/wii_controller.hpp"
+
+// Shared setup for tests and benchmarks that run reports through the emulated controllers
+namespace mc::test {
+
+    // xorshift32, so report traces are the same on every run and every host
+    class Random {
+        public:
+            explicit Random(u32 seed) : m_state(seed) { }
+
+            u32 Next() {
+                m_state ^= m_state << 13;
+                m_state ^= m_state >> 17;
+                m_state ^= m_state << 5;
+                return m_state;
+            }
+
+            void Fill(void *data, size_t size) {
+                auto bytes = static_cast<u8 *>(data);
+                for (size_t i = 0; i < size; ++i) {
+                    bytes[i] = this->Next();
+                }
+            }
+
+        private:
+            u32 m_state;
+    };
+
+    // Calibration and extension state normally comes from the controller during Initialize, which needs a live controller
+    // answering reads. Explicit instantiations are exempt from access checks, so they can name the members directly
+    template<auto Member, typename Tag>
+    struct MemberAccess {
+        friend constexpr auto GetMember(Tag) { return Member; }
+    };
+
+    #define MC_TEST_MEMBER_ACCESS(tag, member) \
+        struct tag { friend constexpr auto GetMember(tag); }; \
+        template struct MemberAccess<&member, tag>
+
+    MC_TEST_MEMBER_ACCESS(Dualshock4MotionCalibration, ams::controller::Dualshock4Controller::m_motion_calibration);
+    MC_TEST_MEMBER_ACCESS(Dualshock4AccelScale,        ams::controller::Dualshock4Controller::m_accel_scale);
+    MC_TEST_MEMBER_ACCESS(Dualshock4GyroScale,         ams::controller::Dualshock4Controller::m_gyro_scale);
+    MC_TEST_MEMBER_ACCESS(DualsenseMotionCalibration,  ams::controller::DualsenseController::m_motion_calibration);
+    MC_TEST_MEMBER_ACCESS(DualsenseAccelScale,         ams::controller::DualsenseController::m_accel_scale);
+    MC_TEST_MEMBER_ACCESS(DualsenseGyroScale,          ams::controller::DualsenseController::m_gyro_scale);
+    MC_TEST_MEMBER_ACCESS(WiiAccelCalibration,         ams::controller::WiiController::m_accel_calibration);
+    MC_TEST_MEMBER_ACCESS(WiiAccelScale,               ams::controller::WiiController::m_accel_scale);
+    MC_TEST_MEMBER_ACCESS(WiiOrientation,              ams::controller::WiiController::m_orientation);
+    MC_TEST_MEMBER_ACCESS(WiiExtension,                ams::controller::WiiController::m_extension);
+    MC_TEST_MEMBER_ACCESS(WiiExtCalibration,           ams::controller::WiiController::m_ext_calibration);
+
+    #undef MC_TEST_MEMBER_ACCESS
+
+    // Sets up the motion calibration the way Initialize does after reading it from the controller
+    template<typename Controller, typename CalibrationTag, typename AccelTag, typename GyroTag>
+    void CalibrateSonyMotion(Controller *controller) {
+        auto &cal = controller->*GetMember(CalibrationTag{});
+        cal = {};
+        cal.gyro.pitch_bias = -3;
+        cal.gyro.yaw_bias   = 8;
+        cal.gyro.roll_bias  = -1;
+        cal.gyro.pitch_max  = 8706;
+        cal.gyro.yaw_max    = 8734;
+        cal.gyro.roll_max   = 8575;
+        cal.gyro.speed_max  = 540;
+        cal.acc.x_max = 8192;
+        cal.acc.y_max = 8192;
+        cal.acc.z_max = 8192;
+
+        controller->*GetMember(AccelTag{}) = {
+            ams::controller::MakeAxisCalibration(0, cal.acc.x_max, 1.0f),
+            ams::controller::MakeAxisCalibration(0, cal.acc.y_max, 1.0f),
+            ams::controller::MakeAxisCalibration(0, cal.acc.z_max, 1.0f)
+        };
+        controller->*GetMember(GyroTag{}) = {
+            ams::controller::MakeAxisCalibration(cal.gyro.pitch_bias, cal.gyro.pitch_max, cal.gyro.speed_max),
+            ams::controller::MakeAxisCalibration(cal.gyro.yaw_bias,   cal.gyro.yaw_max,   cal.gyro.speed_max),
+            ams::controller::MakeAxisCalibration(cal.gyro.roll_bias,  cal.gyro.roll_max,  cal.gyro.speed_max)
+        };
+    }
+
+    inline void CalibrateMotion(ams::controller::Dualshock4Controller *controller) {
+        CalibrateSonyMotion<ams::controller::Dualshock4Controller, Dualshock4MotionCalibration, Dualshock4AccelScale, Dualshock4GyroScale>(controller);
+    }
+
+    inline void CalibrateMotion(ams::controller::DualsenseController *controller) {
+        CalibrateSonyMotion<ams::controller::DualsenseController, DualsenseMotionCalibration, DualsenseAccelScale, DualsenseGyroScale>(controller);
+    }
+
+    // Fields random report bytes can't stand in for: sensor timestamps advancing at the controller's report rate, and a touchpad
+    // report count within the report
+
+    inline void PrepareDualshock4Report(u8 *data, size_t index) {
+        auto report = reinterpret_cast<ams::controller::Dualshock4ReportData *>(data);
+        report->input0x11.timestamp = index * 1500;     // 125Hz in units of 16/3us
+        report->input0x11.num_reports = 1;
+    }
+
+    inline void PrepareDualsenseReport(u8 *data, size_t index) {
+        auto report = reinterpret_cast<ams::controller::DualsenseReportData *>(data);
+        report->input0x31.timestamp = index * 12000;    // 250Hz in units of 1/3us
+    }
+
+    // A Wiimote with the given extension attached and initialised, as HandleStatusReport leaves it
+    inline void AttachExtension(ams::controller::WiiController *controller, ams::controller::WiiExtensionController extension) {
+        auto &accel = controller->*GetMember(WiiAccelCalibration{});
+        accel = { 0x200, 0x200, 0x200, 0x268, 0x268, 0x268 };
+        controller->*GetMember(WiiAccelScale{}) = {
+            ams::controller::MakeAxisCalibration(accel.acc_x_0g, accel.acc_x_1g, 1.0f),
+            ams::controller::MakeAxisCalibration(accel.acc_y_0g, accel.acc_y_1g, 1.0f),
+            ams::controller::MakeAxisCalibration(accel.acc_z_0g, accel.acc_z_1g, 1.0f)
+        };
+
+        constexpr ams::controller::MotionPlusCalibration MotionPlus = { 0x7c00, 0x7c00, 0x7c00, 0x9800, 0x9800, 0x9800, 0x5a };
+        auto &ext_calibration = controller->*GetMember(WiiExtCalibration{});
+        ext_calibration.motion_plus = { MotionPlus, MotionPlus };
+
+        controller->*GetMember(WiiExtension{}) = extension;
+        controller->*GetMember(WiiOrientation{}) = extension == ams::controller::WiiExtensionController_MotionPlus ? ams::controller::WiiControllerOrientation_Horizontal : ams::controller::WiiControllerOrientation_Vertical;
+    }
+
+}
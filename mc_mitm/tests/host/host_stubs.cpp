@@ -0,0 +1,422 @@
+/*
+ * Copyright (c) 2020-2025 ndeadly
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <stratosphere.hpp>
+#include <pthread.h>
+#include <map>
+#include "host_stubs.hpp"
+#include "bluetooth_mitm/bluetooth/bluetooth_core.hpp"
+#include "bluetooth_mitm/bluetooth/bluetooth_hid_report.hpp"
+#include "controllers/switch_rumble_scheduler.hpp"
+#include "async/async.hpp"
+
+namespace mc::test {
+
+    namespace {
+
+        std::atomic<u32> g_fake_input_report_count;
+        BtdrvHidReport g_last_fake_input_report;
+
+        std::atomic<u32> g_controller_write_count;
+        BtdrvHidReport g_last_controller_write;
+
+        struct HostOpenFile {
+            std::string path;
+            int mode;
+        };
+
+        std::mutex g_file_mutex;
+        std::map<std::string, std::vector<u8>> g_files;
+        std::atomic<u32> g_file_flush_count;
+
+        void CopyReport(BtdrvHidReport *dst, const BtdrvHidReport *src) {
+            dst->size = src->size;
+            std::memcpy(dst->data, src->data, std::min<size_t>(src->size, sizeof(dst->data)));
+        }
+
+    }
+
+    u32 GetFakeInputReportCount() { return g_fake_input_report_count; }
+    const BtdrvHidReport *GetLastFakeInputReport() { return &g_last_fake_input_report; }
+
+    u32 GetControllerWriteCount() { return g_controller_write_count; }
+    const BtdrvHidReport *GetLastControllerWrite() { return &g_last_controller_write; }
+
+    std::vector<u8> *GetFile(const char *path) {
+        std::scoped_lock lk(g_file_mutex);
+        auto it = g_files.find(path);
+        return it != g_files.end() ? &it->second : nullptr;
+    }
+
+    void DeleteAllFiles() {
+        std::scoped_lock lk(g_file_mutex);
+        g_files.clear();
+    }
+
+    u32 GetFileFlushCount() { return g_file_flush_count; }
+
+}
+
+// libnx
+NxResult btdrvWriteHidData(BtdrvAddress address, const BtdrvHidReport *report) {
+    AMS_UNUSED(address);
+    mc::test::CopyReport(&mc::test::g_last_controller_write, report);
+    ++mc::test::g_controller_write_count;
+    return 0;
+}
+
+NxResult btdrvSetHidReport(BtdrvAddress address, BtdrvBluetoothHhReportType type, const BtdrvHidReport *report) {
+    AMS_UNUSED(type);
+    return btdrvWriteHidData(address, report);
+}
+
+NxResult btdrvGetHidReport(BtdrvAddress address, u8 report_id, BtdrvBluetoothHhReportType type) {
+    AMS_UNUSED(address, report_id, type);
+    return 0;
+}
+
+NxResult btdrvGetAdapterProperty(BtdrvAdapterPropertyType type, BtdrvAdapterProperty *property) {
+    AMS_UNUSED(type);
+    std::memset(property, 0, sizeof(*property));
+    return 0;
+}
+
+NxResult btdrvAddPairedDeviceInfo(const SetSysBluetoothDevicesSettings *settings) {
+    AMS_UNUSED(settings);
+    return 0;
+}
+
+NxResult setInitialize(void) { return 0; }
+void setExit(void) { }
+NxResult setGetSystemLanguage(u64 *language_code) { *language_code = 0; return 0; }
+NxResult setMakeLanguage(u64 language_code, SetLanguage *language) { AMS_UNUSED(language_code); *language = SetLanguage_ENUS; return 0; }
+
+NxResult usbHsIfCtrlXfer(UsbHsClientIfSession *s, u8 bmRequestType, u8 bRequest, u16 wValue, u16 wIndex, u16 wLength, void *buffer, u32 *transferredSize) {
+    AMS_UNUSED(s, bmRequestType, bRequest, wValue, wIndex, wLength, buffer);
+    *transferredSize = 0;
+    return 0;
+}
+
+NxResult usbHsAcquireUsbIf(UsbHsClientIfSession *s, UsbHsInterface *inf) { s->inf = *inf; return 0; }
+bool usbHsIfIsActive(UsbHsClientIfSession *s) { AMS_UNUSED(s); return false; }
+void usbHsIfClose(UsbHsClientIfSession *s) { AMS_UNUSED(s); }
+
+u32 crc32CalculateWithSeed(u32 seed, const void *src, size_t size) {
+    auto bytes = static_cast<const u8 *>(src);
+
+    u32 crc = ~seed;
+    for (size_t i = 0; i < size; ++i) {
+        crc ^= bytes[i];
+        for (int b = 0; b < 8; ++b) {
+            crc = (crc >> 1) ^ (0xedb88320 & -(crc & 1));
+        }
+    }
+
+    return ~crc;
+}
+
+u32 crc32Calculate(const void *src, size_t size) {
+    return crc32CalculateWithSeed(0, src, size);
+}
+
+NxResult svcQueryMemory(MemoryInfo *meminfo_ptr, u32 *pageinfo, u64 addr) {
+    std::memset(meminfo_ptr, 0, sizeof(*meminfo_ptr));
+    meminfo_ptr->addr = addr & ~static_cast<u64>(ams::os::MemoryPageSize - 1);
+    meminfo_ptr->size = ams::os::MemoryPageSize;
+    *pageinfo = 0;
+    return 0;
+}
+
+namespace ams {
+
+    namespace hos {
+
+        Version GetVersion() { return Version_Current; }
+
+    }
+
+    namespace fs {
+
+        namespace {
+
+            // Open handles hold on to the path, so a file deleted while open fails like any other missing file
+            std::vector<u8> *FindFile(FileHandle handle) {
+                auto it = mc::test::g_files.find(static_cast<mc::test::HostOpenFile *>(handle.handle)->path);
+                return it != mc::test::g_files.end() ? &it->second : nullptr;
+            }
+
+        }
+
+        Result HasFile(bool *out, const char *path) {
+            std::scoped_lock lk(mc::test::g_file_mutex);
+            *out = mc::test::g_files.contains(path);
+            R_SUCCEED();
+        }
+
+        Result CreateFile(const char *path, s64 size) {
+            std::scoped_lock lk(mc::test::g_file_mutex);
+            R_UNLESS(!mc::test::g_files.contains(path), ResultPathAlreadyExists());
+            mc::test::g_files[path].resize(size);
+            R_SUCCEED();
+        }
+
+        Result DeleteFile(const char *path) {
+            std::scoped_lock lk(mc::test::g_file_mutex);
+            R_UNLESS(mc::test::g_files.erase(path) != 0, ResultPathNotFound());
+            R_SUCCEED();
+        }
+
+        Result EnsureDirectory(const char *path) { AMS_UNUSED(path); R_SUCCEED(); }
+
+        Result OpenFile(FileHandle *out, const char *path, int mode) {
+            std::scoped_lock lk(mc::test::g_file_mutex);
+            R_UNLESS(mc::test::g_files.contains(path), ResultPathNotFound());
+            out->handle = new mc::test::HostOpenFile{ path, mode };
+            R_SUCCEED();
+        }
+
+        void CloseFile(FileHandle handle) {
+            delete static_cast<mc::test::HostOpenFile *>(handle.handle);
+        }
+
+        Result ReadFile(size_t *out, FileHandle handle, s64 offset, void *buffer, size_t size) {
+            std::scoped_lock lk(mc::test::g_file_mutex);
+            auto file = FindFile(handle);
+            R_UNLESS(file != nullptr, ResultPathNotFound());
+            R_UNLESS(offset >= 0 && static_cast<size_t>(offset) <= file->size(), ResultOutOfRange());
+
+            *out = std::min(size, file->size() - offset);
+            std::memcpy(buffer, file->data() + offset, *out);
+            R_SUCCEED();
+        }
+
+        Result ReadFile(FileHandle handle, s64 offset, void *buffer, size_t size) {
+            size_t read_size;
+            R_TRY(ReadFile(&read_size, handle, offset, buffer, size));
+            R_UNLESS(read_size == size, ResultOutOfRange());
+            R_SUCCEED();
+        }
+
+        Result WriteFile(FileHandle handle, s64 offset, const void *buffer, size_t size, const WriteOption &option) {
+            std::scoped_lock lk(mc::test::g_file_mutex);
+            auto file = FindFile(handle);
+            R_UNLESS(file != nullptr, ResultPathNotFound());
+            R_UNLESS(offset >= 0, ResultOutOfRange());
+
+            // Growing a file needs it to have been opened for appending
+            const auto open_file = static_cast<mc::test::HostOpenFile *>(handle.handle);
+            if (offset + size > file->size()) {
+                R_UNLESS(open_file->mode & OpenMode_AllowAppend, ResultOutOfRange());
+                file->resize(offset + size);
+            }
+
+            std::memcpy(file->data() + offset, buffer, size);
+            if (option.value == WriteOption::Flush.value) {
+                ++mc::test::g_file_flush_count;
+            }
+            R_SUCCEED();
+        }
+
+        Result FlushFile(FileHandle handle) {
+            AMS_UNUSED(handle);
+            ++mc::test::g_file_flush_count;
+            R_SUCCEED();
+        }
+
+        Result GetFileSize(s64 *out, FileHandle handle) {
+            std::scoped_lock lk(mc::test::g_file_mutex);
+            auto file = FindFile(handle);
+            R_UNLESS(file != nullptr, ResultPathNotFound());
+            *out = file->size();
+            R_SUCCEED();
+        }
+
+    }
+
+    namespace os {
+
+        ThreadType *GetCurrentThread() {
+            thread_local ThreadType thread = [] {
+                ThreadType current = {};
+                pthread_attr_t attr;
+                AMS_ABORT_UNLESS(pthread_getattr_np(pthread_self(), &attr) == 0);
+                pthread_attr_getstack(&attr, &current.stack, &current.stack_size);
+                pthread_attr_destroy(&attr);
+                return current;
+            }();
+
+            return &thread;
+        }
+
+    }
+
+    namespace lmem {
+
+        // Tracks ownership per 16 byte unit, which keeps the heap itself free of headers and of allocations
+        struct HostExpHeap {
+            static constexpr size_t UnitSize = 0x10;
+            static constexpr size_t MaxUnits = 1024_KB / UnitSize;
+
+            std::mutex mutex;
+            u8 *base;
+            size_t unit_count;
+            size_t free_units;
+            u32 block_ends[MaxUnits];   // One past the last unit of the block covering each unit, or 0 if it's free
+        };
+
+        namespace {
+
+            HostExpHeap g_host_exp_heap;
+
+            size_t GetFirstAlignedUnit(const HostExpHeap *heap, size_t unit, size_t alignment) {
+                const uintptr_t base = reinterpret_cast<uintptr_t>(heap->base);
+                return (util::AlignUp(base + unit * HostExpHeap::UnitSize, alignment) - base) / HostExpHeap::UnitSize;
+            }
+
+            size_t GetBlockUnit(const void *block) {
+                return (static_cast<const u8 *>(block) - g_host_exp_heap.base) / HostExpHeap::UnitSize;
+            }
+
+        }
+
+        HeapHandle CreateExpHeap(void *address, size_t size, int option) {
+            AMS_UNUSED(option);
+            AMS_ABORT_UNLESS(size / HostExpHeap::UnitSize <= HostExpHeap::MaxUnits);
+
+            auto heap = &g_host_exp_heap;
+            heap->base = static_cast<u8 *>(address);
+            heap->unit_count = size / HostExpHeap::UnitSize;
+            heap->free_units = heap->unit_count;
+            std::fill_n(heap->block_ends, heap->unit_count, 0);
+
+            return heap;
+        }
+
+        void *AllocateFromExpHeap(HeapHandle handle, size_t size) {
+            return AllocateFromExpHeap(handle, size, HostExpHeap::UnitSize);
+        }
+
+        void *AllocateFromExpHeap(HeapHandle handle, size_t size, s32 alignment) {
+            const size_t unit_alignment = std::max<size_t>(std::abs(alignment), HostExpHeap::UnitSize);
+            const size_t units = std::max<size_t>(util::AlignUp(size, HostExpHeap::UnitSize) / HostExpHeap::UnitSize, 1);
+
+            std::scoped_lock lk(handle->mutex);
+
+            size_t first = GetFirstAlignedUnit(handle, 0, unit_alignment);
+            while (first + units <= handle->unit_count) {
+                size_t unit = first;
+                while ((unit < first + units) && (handle->block_ends[unit] == 0)) {
+                    ++unit;
+                }
+
+                if (unit == first + units) {
+                    std::fill_n(handle->block_ends + first, units, first + units);
+                    handle->free_units -= units;
+                    return handle->base + first * HostExpHeap::UnitSize;
+                }
+
+                // Skip past the block in the way
+                first = GetFirstAlignedUnit(handle, handle->block_ends[unit], unit_alignment);
+            }
+
+            return nullptr;
+        }
+
+        void FreeToExpHeap(HeapHandle handle, void *block) {
+            std::scoped_lock lk(handle->mutex);
+
+            const size_t first = GetBlockUnit(block);
+            const size_t end = handle->block_ends[first];
+            std::fill(handle->block_ends + first, handle->block_ends + end, 0);
+            handle->free_units += end - first;
+        }
+
+        size_t GetExpHeapTotalFreeSize(HeapHandle handle) {
+            std::scoped_lock lk(handle->mutex);
+            return handle->free_units * HostExpHeap::UnitSize;
+        }
+
+        size_t GetExpHeapAllocatableSize(HeapHandle handle, s32 alignment) {
+            AMS_UNUSED(alignment);
+            std::scoped_lock lk(handle->mutex);
+
+            size_t largest = 0;
+            size_t run = 0;
+            for (size_t unit = 0; unit < handle->unit_count; ++unit) {
+                run = handle->block_ends[unit] == 0 ? run + 1 : 0;
+                largest = std::max(largest, run);
+            }
+
+            return largest * HostExpHeap::UnitSize;
+        }
+
+        size_t GetExpHeapMemoryBlockSize(const void *block) {
+            const size_t first = GetBlockUnit(block);
+            return (g_host_exp_heap.block_ends[first] - first) * HostExpHeap::UnitSize;
+        }
+
+    }
+
+    namespace util::ini {
+
+        int ParseFile(fs::FileHandle file, void *user, Handler handler) { AMS_UNUSED(file, user, handler); return 0; }
+
+    }
+
+    namespace bluetooth::core {
+
+        void SignalFakeEvent(bluetooth::EventType type, const void *data, size_t size) {
+            AMS_UNUSED(type, data, size);
+        }
+
+    }
+
+    // Fake HID report ring
+    namespace bluetooth::hid::report {
+
+        Result WriteHidDataReport(const bluetooth::Address address, const bluetooth::HidReport *report) {
+            AMS_UNUSED(address);
+            mc::test::CopyReport(&mc::test::g_last_fake_input_report, report);
+            ++mc::test::g_fake_input_report_count;
+            R_SUCCEED();
+        }
+
+        Result WriteHidSetReport(const bluetooth::Address address, u32 status) {
+            AMS_UNUSED(address, status);
+            R_SUCCEED();
+        }
+
+        Result WriteHidGetReport(const bluetooth::Address address, const bluetooth::HidReport *report) {
+            AMS_UNUSED(address, report);
+            R_SUCCEED();
+        }
+
+    }
+
+    // There's no worker thread on the host, so work queued from the report path is dropped
+    namespace async {
+
+        void QueueWork(AsyncFunction *function) { delete function; }
+
+    }
+
+    // The tests drive ProcessScheduledOutput themselves instead of running the scheduler thread
+    namespace controller {
+
+        void SignalRumbleScheduler() { }
+
+    }
+
+}
@@ -0,0 +1,38 @@
+/*
+ * Copyright (c) 2020-2025 ndeadly
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+#include <switch.h>
+#include <vector>
+
+// Hooks into the host definitions of calls that would otherwise reach the console
+namespace mc::test {
+
+    // Input reports written to the fake HID report ring, as seen by the console
+    u32 GetFakeInputReportCount();
+    const BtdrvHidReport *GetLastFakeInputReport();
+
+    // Reports written out to the physical controller, through either the interrupt or control channel
+    u32 GetControllerWriteCount();
+    const BtdrvHidReport *GetLastControllerWrite();
+
+    // In-memory files standing in for the SD card. GetFile returns nullptr for a path that doesn't exist
+    std::vector<u8> *GetFile(const char *path);
+    void DeleteAllFiles();
+
+    // Writes made with WriteOption::Flush, plus explicit FlushFile calls
+    u32 GetFileFlushCount();
+
+}
@@ -0,0 +1,396 @@
+/*
+ * Copyright (c) 2020-2025 ndeadly
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+// Minimal host stand-in for the parts of libstratosphere used by the code under test.
+// Only what the host tests need is provided, everything runs on std primitives.
+#include <switch.h>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <climits>
+#include <cmath>
+#include <concepts>
+#include <condition_variable>
+#include <cstdarg>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <numbers>
+#include <optional>
+#include <string>
+#include <strings.h>
+#include <thread>
+#include <utility>
+
+#define ALWAYS_INLINE inline __attribute__((always_inline))
+#define NOINLINE __attribute__((noinline))
+#define AMS_UNUSED(...) ::ams::impl::UnusedImpl(__VA_ARGS__)
+#define AMS_LIKELY(x) __builtin_expect(!!(x), 1)
+#define AMS_UNLIKELY(x) __builtin_expect(!!(x), 0)
+#define AMS_ASSERT(...) ((void)0)
+#define AMS_ABORT_UNLESS(expr) do { if (!(expr)) { std::abort(); } } while (0)
+#define AMS_ABORT(...) std::abort()
+#define AMS_UNREACHABLE_DEFAULT_CASE() default: __builtin_unreachable()
+#define NON_COPYABLE(cls) cls(const cls &) = delete; cls &operator=(const cls &) = delete
+#define NON_MOVEABLE(cls) cls(cls &&) = delete; cls &operator=(cls &&) = delete
+#define BITSIZEOF(x) (sizeof(x) * 8)
+
+#define AMS_HOST_CONCAT_IMPL(a, b) a##b
+#define AMS_HOST_CONCAT(a, b) AMS_HOST_CONCAT_IMPL(a, b)
+#define ON_SCOPE_EXIT auto AMS_HOST_CONCAT(scope_exit_, __COUNTER__) = ::ams::impl::ScopeGuardBuilder() + [&]() ALWAYS_INLINE_LAMBDA
+#define ALWAYS_INLINE_LAMBDA
+
+namespace ams {
+
+    class Result {
+        private:
+            u32 m_value;
+        public:
+            constexpr Result(u32 value = 0) : m_value(value) { }
+            constexpr bool IsSuccess() const { return m_value == 0; }
+            constexpr bool IsFailure() const { return m_value != 0; }
+            constexpr u32 GetValue() const { return m_value; }
+    };
+
+    constexpr Result ResultSuccess() { return Result(0); }
+
+    namespace impl {
+
+        template<typename... Args>
+        constexpr void UnusedImpl(Args &&...) { }
+
+        template<typename F>
+        class ScopeGuard {
+            private:
+                F m_f;
+            public:
+                explicit ScopeGuard(F f) : m_f(std::move(f)) { }
+                ~ScopeGuard() { m_f(); }
+        };
+
+        struct ScopeGuardBuilder {
+            template<typename F>
+            ScopeGuard<F> operator+(F f) { return ScopeGuard<F>(std::move(f)); }
+        };
+
+    }
+
+    constexpr size_t operator""_KB(unsigned long long v) { return v * 1024; }
+
+    class TimeSpan {
+        private:
+            s64 m_ns;
+        public:
+            constexpr TimeSpan(s64 ns = 0) : m_ns(ns) { }
+            static constexpr TimeSpan FromNanoSeconds(s64 v) { return TimeSpan(v); }
+            static constexpr TimeSpan FromMicroSeconds(s64 v) { return TimeSpan(v * 1000); }
+            static constexpr TimeSpan FromMilliSeconds(s64 v) { return TimeSpan(v * 1000'000); }
+            static constexpr TimeSpan FromSeconds(s64 v) { return TimeSpan(v * 1000'000'000); }
+            static constexpr TimeSpan FromMinutes(s64 v) { return TimeSpan(v * 60'000'000'000); }
+            constexpr s64 GetNanoSeconds() const { return m_ns; }
+            constexpr s64 GetMicroSeconds() const { return m_ns / 1000; }
+            constexpr s64 GetMilliSeconds() const { return m_ns / 1000'000; }
+            constexpr auto operator<=>(const TimeSpan &) const = default;
+            constexpr TimeSpan operator+(TimeSpan rhs) const { return TimeSpan(m_ns + rhs.m_ns); }
+            constexpr TimeSpan operator-(TimeSpan rhs) const { return TimeSpan(m_ns - rhs.m_ns); }
+    };
+
+    namespace os {
+
+        // Host ticks are nanoseconds
+        class Tick {
+            private:
+                s64 m_tick;
+            public:
+                constexpr explicit Tick(s64 tick = 0) : m_tick(tick) { }
+                constexpr s64 GetInt64Value() const { return m_tick; }
+                constexpr Tick operator-(Tick rhs) const { return Tick(m_tick - rhs.m_tick); }
+                constexpr Tick operator+(Tick rhs) const { return Tick(m_tick + rhs.m_tick); }
+                constexpr auto operator<=>(const Tick &) const = default;
+        };
+
+        inline Tick GetSystemTick() {
+            return Tick(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+        }
+
+        inline TimeSpan ConvertToTimeSpan(Tick tick) { return TimeSpan(tick.GetInt64Value()); }
+        inline Tick ConvertToTick(TimeSpan ts) { return Tick(ts.GetNanoSeconds()); }
+
+        inline void SleepThread(TimeSpan ts) { std::this_thread::sleep_for(std::chrono::nanoseconds(ts.GetNanoSeconds())); }
+
+        class SdkMutex {
+            private:
+                std::mutex m_mutex;
+            public:
+                constexpr SdkMutex() = default;
+                void Lock() { m_mutex.lock(); }
+                void Unlock() { m_mutex.unlock(); }
+                bool TryLock() { return m_mutex.try_lock(); }
+                void lock() { this->Lock(); }
+                void unlock() { this->Unlock(); }
+                bool try_lock() { return this->TryLock(); }
+        };
+
+        class SdkConditionVariable {
+            private:
+                std::condition_variable_any m_cv;
+            public:
+                void Wait(SdkMutex &mutex) { m_cv.wait(mutex); }
+                bool TimedWait(SdkMutex &mutex, TimeSpan timeout) {
+                    return m_cv.wait_for(mutex, std::chrono::nanoseconds(timeout.GetNanoSeconds())) == std::cv_status::no_timeout;
+                }
+                void Signal() { m_cv.notify_one(); }
+                void Broadcast() { m_cv.notify_all(); }
+        };
+
+        enum EventClearMode {
+            EventClearMode_ManualClear,
+            EventClearMode_AutoClear,
+        };
+
+        struct EventType {
+            std::mutex mutex;
+            std::condition_variable cv;
+            EventClearMode clear_mode;
+            bool signaled;
+        };
+
+        inline void InitializeEvent(EventType *event, bool signaled, EventClearMode clear_mode) {
+            event->signaled = signaled;
+            event->clear_mode = clear_mode;
+        }
+
+        inline void FinalizeEvent(EventType *event) { AMS_UNUSED(event); }
+
+        inline void SignalEvent(EventType *event) {
+            std::scoped_lock lk(event->mutex);
+            event->signaled = true;
+            event->cv.notify_all();
+        }
+
+        inline void ClearEvent(EventType *event) {
+            std::scoped_lock lk(event->mutex);
+            event->signaled = false;
+        }
+
+        inline bool TimedWaitEvent(EventType *event, TimeSpan timeout) {
+            std::unique_lock lk(event->mutex);
+            if (!event->cv.wait_for(lk, std::chrono::nanoseconds(timeout.GetNanoSeconds()), [event] { return event->signaled; })) {
+                return false;
+            }
+
+            if (event->clear_mode == EventClearMode_AutoClear) {
+                event->signaled = false;
+            }
+            return true;
+        }
+
+        inline void WaitEvent(EventType *event) {
+            while (!TimedWaitEvent(event, TimeSpan::FromSeconds(1))) { /* ... */ }
+        }
+
+        inline bool TryWaitEvent(EventType *event) {
+            return TimedWaitEvent(event, 0);
+        }
+
+        class Event {
+            NON_COPYABLE(Event);
+            NON_MOVEABLE(Event);
+
+            private:
+                EventType m_event;
+            public:
+                explicit Event(EventClearMode clear_mode) { InitializeEvent(&m_event, false, clear_mode); }
+                void Signal() { SignalEvent(&m_event); }
+                void Clear() { ClearEvent(&m_event); }
+                void Wait() { WaitEvent(&m_event); }
+                bool TryWait() { return TryWaitEvent(&m_event); }
+                bool TimedWait(TimeSpan timeout) { return TimedWaitEvent(&m_event, timeout); }
+                EventType *GetBase() { return &m_event; }
+        };
+
+        using NativeHandle = u32;
+        constexpr inline NativeHandle InvalidNativeHandle = 0;
+        constexpr inline size_t MemoryPageSize = 0x1000;
+        constexpr inline size_t ThreadStackAlignment = 0x1000;
+
+        // Declared for headers that mention them, the host tests never use them
+        class SystemEvent;
+        class SharedMemory;
+
+        struct ThreadType {
+            void *stack;
+            size_t stack_size;
+        };
+
+        // Describes the calling thread's stack as pthreads reports it
+        ThreadType *GetCurrentThread();
+
+        // Host threads are never registered, so they have no name
+        inline const char *GetThreadNamePointer(const ThreadType *thread) { AMS_UNUSED(thread); return nullptr; }
+
+    }
+
+    // A locked first fit heap over the caller's buffer, defined in host_stubs.cpp. Supports the single heap mcmitm_heap.cpp creates
+    namespace lmem {
+
+        using HeapHandle = struct HostExpHeap *;
+
+        enum CreateOption {
+            CreateOption_None       = 0,
+            CreateOption_ThreadSafe = 1,
+        };
+
+        HeapHandle CreateExpHeap(void *address, size_t size, int option);
+        void *AllocateFromExpHeap(HeapHandle handle, size_t size);
+        void *AllocateFromExpHeap(HeapHandle handle, size_t size, s32 alignment);
+        void FreeToExpHeap(HeapHandle handle, void *block);
+        size_t GetExpHeapTotalFreeSize(HeapHandle handle);
+        size_t GetExpHeapAllocatableSize(HeapHandle handle, s32 alignment);
+        size_t GetExpHeapMemoryBlockSize(const void *block);
+
+    }
+
+
+    namespace hos {
+
+        enum Version : u32 {
+            Version_5_0_0  = 5,
+            Version_7_0_0  = 7,
+            Version_9_0_0  = 9,
+            Version_12_0_0 = 12,
+            Version_13_0_0 = 13,
+            Version_Current = Version_13_0_0,
+        };
+
+        Version GetVersion();
+
+    }
+
+    namespace ncm {
+
+        struct ProgramId {
+            u64 value;
+            constexpr bool operator==(const ProgramId &) const = default;
+        };
+
+        constexpr inline ProgramId InvalidProgramId = {};
+
+    }
+
+    namespace fs {
+
+        enum OpenMode {
+            OpenMode_Read        = BIT(0),
+            OpenMode_Write       = BIT(1),
+            OpenMode_AllowAppend = BIT(2),
+            OpenMode_ReadWrite   = OpenMode_Read | OpenMode_Write,
+        };
+
+        struct WriteOption {
+            int value;
+
+            static const WriteOption None;
+            static const WriteOption Flush;
+        };
+
+        inline constexpr WriteOption WriteOption::None  = { 0 };
+        inline constexpr WriteOption WriteOption::Flush = { 1 };
+
+        struct FileHandle {
+            void *handle;
+        };
+
+        constexpr Result ResultPathNotFound()      { return Result(0x202); }
+        constexpr Result ResultPathAlreadyExists() { return Result(0x402); }
+        constexpr Result ResultOutOfRange()        { return Result(0x3e02); }
+
+        // Files live in memory on the host, starting out empty for each test process
+        Result HasFile(bool *out, const char *path);
+        Result CreateFile(const char *path, s64 size);
+        Result DeleteFile(const char *path);
+        Result EnsureDirectory(const char *path);
+        Result OpenFile(FileHandle *out, const char *path, int mode);
+        void CloseFile(FileHandle handle);
+        Result ReadFile(FileHandle handle, s64 offset, void *buffer, size_t size);
+        Result ReadFile(size_t *out, FileHandle handle, s64 offset, void *buffer, size_t size);
+        Result WriteFile(FileHandle handle, s64 offset, const void *buffer, size_t size, const WriteOption &option);
+        Result FlushFile(FileHandle handle);
+        Result GetFileSize(s64 *out, FileHandle handle);
+
+    }
+
+    namespace util {
+
+        template<typename T>
+        constexpr int PopCount(T x) { return std::popcount(static_cast<std::make_unsigned_t<T>>(x)); }
+
+        template<typename T>
+        constexpr int CountTrailingZeros(T x) { return std::countr_zero(static_cast<std::make_unsigned_t<T>>(x)); }
+
+        template<typename T>
+        constexpr T AlignDown(T value, size_t alignment) { return value & ~static_cast<T>(alignment - 1); }
+
+        template<typename T>
+        constexpr T AlignUp(T value, size_t alignment) { return AlignDown(value + static_cast<T>(alignment - 1), alignment); }
+
+        template<typename T>
+        constexpr T SwapEndian(T value) { return std::byteswap(value); }
+
+        template<typename T, size_t N>
+        constexpr size_t size(const T (&)[N]) { return N; }
+
+        template<char A, char B, char C, char D>
+        struct FourCC {
+            static constexpr u32 Code = (static_cast<u32>(A) << 0) | (static_cast<u32>(B) << 8) | (static_cast<u32>(C) << 16) | (static_cast<u32>(D) << 24);
+        };
+
+        inline int VSNPrintf(char *dst, size_t dst_size, const char *fmt, std::va_list vl) { return std::vsnprintf(dst, dst_size, fmt, vl); }
+
+        inline int SNPrintf(char *dst, size_t dst_size, const char *fmt, ...) {
+            std::va_list vl;
+            va_start(vl, fmt);
+            const int len = VSNPrintf(dst, dst_size, fmt, vl);
+            va_end(vl);
+            return len;
+        }
+
+        namespace ini {
+
+            using Handler = int (*)(void *user, const char *section, const char *name, const char *value);
+
+            int ParseFile(fs::FileHandle file, void *user, Handler handler);
+
+        }
+
+    }
+
+}
+
+#define R_SUCCEED() return ::ams::ResultSuccess()
+#define R_RETURN(expr) return (expr)
+#define R_TRY(expr) do { const ::ams::Result _tmp_r = (expr); if (_tmp_r.IsFailure()) { return _tmp_r; } } while (0)
+#define R_UNLESS(cond, res) do { if (!(cond)) { return (res); } } while (0)
+#define R_ABORT_UNLESS(expr) AMS_ABORT_UNLESS(::ams::Result(expr).IsSuccess())
+#define R_FAILED(expr) (::ams::Result(expr).IsFailure())
+#define R_SUCCEEDED(expr) (::ams::Result(expr).IsSuccess())
+// The host tests only exercise success paths, so failure cleanup is compiled but never run
+#define ON_RESULT_FAILURE [[maybe_unused]] auto AMS_HOST_CONCAT(result_failure_, __COUNTER__) = [&]()
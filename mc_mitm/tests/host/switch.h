@@ -0,0 +1,172 @@
+/*
+ * Copyright (c) 2020-2025 ndeadly
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+// Minimal host stand-in for the libnx types and calls used by the code under test.
+// Calls that would reach the console are defined in host_stubs.cpp
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+
+typedef uint8_t  u8;
+typedef uint16_t u16;
+typedef uint32_t u32;
+typedef uint64_t u64;
+typedef int8_t   s8;
+typedef int16_t  s16;
+typedef int32_t  s32;
+typedef int64_t  s64;
+
+typedef u32 NxResult;
+
+#define BIT(n) (1U << (n))
+#define PACKED __attribute__((packed))
+#define NX_PACKED PACKED
+
+// Bluetooth driver
+typedef struct { u8 address[0x6]; } BtdrvAddress;
+typedef struct { u8 class_of_device[0x3]; } BtdrvClassOfDevice;
+typedef struct { char code[0x10]; } BtdrvBluetoothPinCode;
+typedef struct { u8 type; u8 size; u8 data[0x100]; } BtdrvAdapterProperty;
+typedef struct { u16 size; u8 data[0x2BC]; } BtdrvHidReport;
+typedef struct { char name[0x20]; } SetSysBluetoothDevicesName;
+
+typedef struct {
+    BtdrvAddress addr;
+    SetSysBluetoothDevicesName name;
+    BtdrvClassOfDevice class_of_device;
+    u8 link_key[0x10];
+    u8 link_key_present;
+    u16 version;
+    u32 trusted_services;
+    u16 vid;
+    u16 pid;
+    u8 sub_class;
+    u8 attribute_mask;
+    u16 descriptor_length;
+    u8 descriptor[0x80];
+    u8 key_type;
+    u8 device_type;
+    u16 brr_size;
+    u8 brr[0x9];
+    u8 audio_source_volume;
+    char name2[0xF9];
+    u8 reserved[0x45];
+} SetSysBluetoothDevicesSettings;
+
+typedef enum {
+    BtdrvBluetoothHhReportType_Other   = 0,
+    BtdrvBluetoothHhReportType_Input   = 1,
+    BtdrvBluetoothHhReportType_Output  = 2,
+    BtdrvBluetoothHhReportType_Feature = 3,
+} BtdrvBluetoothHhReportType;
+
+typedef enum {
+    BtdrvAdapterPropertyType_Name    = 1,
+    BtdrvAdapterPropertyType_Address = 2,
+} BtdrvAdapterPropertyType;
+
+typedef enum {
+    BtdrvEventTypeOld_Connection = 4,
+    BtdrvEventType_Connection    = 7,
+} BtdrvEventType;
+
+enum { BtdrvConnectionEventType_Suspended = 2 };
+
+typedef union { u8 data[0x400]; } BtdrvEventInfo;
+
+typedef enum {
+    BtdrvHidEventType_Connection = 0,
+    BtdrvHidEventType_Data       = 4,
+    BtdrvHidEventType_SetReport  = 5,
+    BtdrvHidEventType_GetReport  = 6,
+} BtdrvHidEventType;
+
+typedef union { u8 data[0x480]; } BtdrvHidEventInfo;
+
+typedef u32 BtdrvBleEventType;
+typedef union { u8 data[0x400]; } BtdrvBleEventInfo;
+
+typedef union {
+    u8 data[0x480];
+
+    struct {
+        union {
+            struct { struct { BtdrvAddress addr; u8 pad[2]; u32 res; u32 size; } hdr; BtdrvAddress addr; u8 pad[2]; BtdrvHidReport report; } v1;
+            struct { u32 size; BtdrvAddress addr; u8 pad[2]; BtdrvHidReport report; } v7;
+            struct { BtdrvAddress addr; u8 pad[2]; BtdrvHidReport report; } v9;
+        };
+    } data_report;
+
+    struct {
+        BtdrvAddress addr;
+        u8 pad[2];
+        u32 res;
+    } set_report;
+
+    struct {
+        union {
+            struct { BtdrvAddress addr; u8 pad[2]; u32 res; BtdrvHidReport report; } v1;
+            struct { BtdrvAddress addr; u8 pad[2]; u32 res; BtdrvHidReport report; } v9;
+        };
+    } get_report;
+} BtdrvHidReportEventInfo;
+
+NxResult btdrvWriteHidData(BtdrvAddress address, const BtdrvHidReport *report);
+NxResult btdrvSetHidReport(BtdrvAddress address, BtdrvBluetoothHhReportType type, const BtdrvHidReport *report);
+NxResult btdrvGetHidReport(BtdrvAddress address, u8 report_id, BtdrvBluetoothHhReportType type);
+NxResult btdrvGetAdapterProperty(BtdrvAdapterPropertyType type, BtdrvAdapterProperty *property);
+NxResult btdrvAddPairedDeviceInfo(const SetSysBluetoothDevicesSettings *settings);
+
+// Settings
+typedef enum { SetLanguage_ENUS = 1 } SetLanguage;
+
+NxResult setInitialize(void);
+void setExit(void);
+NxResult setGetSystemLanguage(u64 *language_code);
+NxResult setMakeLanguage(u64 language_code, SetLanguage *language);
+
+// USB host
+enum {
+    UsbHsInterfaceFilterFlags_idVendor        = BIT(0),
+    UsbHsInterfaceFilterFlags_idProduct       = BIT(1),
+    UsbHsInterfaceFilterFlags_bInterfaceClass = BIT(6),
+};
+
+enum {
+    USB_CLASS_HID                 = 3,
+    USB_ENDPOINT_OUT              = 0x00,
+    USB_ENDPOINT_IN               = 0x80,
+    USB_REQUEST_CLEAR_FEATURE     = 0x01,
+    USB_REQUEST_SET_CONFIGURATION = 0x09,
+};
+
+typedef struct { u16 Flags; u16 idVendor; u16 idProduct; u8 bInterfaceClass; } UsbHsInterfaceFilter;
+typedef struct { struct { u16 idVendor; u16 idProduct; } device_desc; } UsbHsInterface;
+typedef struct { UsbHsInterface inf; } UsbHsClientIfSession;
+
+NxResult usbHsIfCtrlXfer(UsbHsClientIfSession *s, u8 bmRequestType, u8 bRequest, u16 wValue, u16 wIndex, u16 wLength, void *buffer, u32 *transferredSize);
+NxResult usbHsAcquireUsbIf(UsbHsClientIfSession *s, UsbHsInterface *inf);
+bool usbHsIfIsActive(UsbHsClientIfSession *s);
+void usbHsIfClose(UsbHsClientIfSession *s);
+
+// CRC
+u32 crc32Calculate(const void *src, size_t size);
+u32 crc32CalculateWithSeed(u32 seed, const void *src, size_t size);
+
+// Kernel
+typedef struct { u64 addr; u64 size; u32 type; u32 attr; u32 perm; u32 ipc_refcount; u32 device_refcount; u32 padding; } MemoryInfo;
+
+NxResult svcQueryMemory(MemoryInfo *meminfo_ptr, u32 *pageinfo, u64 addr);
@@ -0,0 +1,64 @@
+/*
+ * Copyright (c) 2020-2025 ndeadly
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+#include <cstdio>
+#include <cstdlib>
+#include <chrono>
+
+// Tiny assertion helpers shared by the host tests. A failing check prints its location and
+// marks the test as failed, TEST_REQUIRE additionally stops the test immediately
+namespace mc::test {
+
+    inline int g_failures = 0;
+
+    inline int Finish(const char *name) {
+        if (g_failures) {
+            std::printf("[FAIL] %s: %d check(s) failed\n", name, g_failures);
+            return EXIT_FAILURE;
+        }
+
+        std::printf("[PASS] %s\n", name);
+        return EXIT_SUCCESS;
+    }
+
+    // Nanoseconds per iteration of fn, averaged over iterations
+    template<typename F>
+    double MeasureNanoSeconds(size_t iterations, F fn) {
+        const auto start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < iterations; ++i) {
+            fn(i);
+        }
+        const auto end = std::chrono::steady_clock::now();
+        return std::chrono::duration<double, std::nano>(end - start).count() / iterations;
+    }
+
+}
+
+#define TEST_CHECK(cond) \
+    do { \
+        if (!(cond)) { \
+            std::printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+            ++::mc::test::g_failures; \
+        } \
+    } while (0)
+
+#define TEST_REQUIRE(cond) \
+    do { \
+        if (!(cond)) { \
+            std::printf("%s:%d: requirement failed: %s\n", __FILE__, __LINE__, #cond); \
+            std::exit(EXIT_FAILURE); \
+        } \
+    } while (0)
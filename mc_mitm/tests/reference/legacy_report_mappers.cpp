@@ -0,0 +1,236 @@
+/*
+ * Copyright (c) 2020-2025 ndeadly
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "legacy_report_mappers.hpp"
+#include "controllers/betop_controller.hpp"
+#include "controllers/hyperkin_controller.hpp"
+#include "controllers/lanshen_controller.hpp"
+#include "controllers/razer_controller.hpp"
+#include "controllers/xiaomi_controller.hpp"
+#include "controllers/controller_utils.hpp"
+
+namespace mc::test::reference {
+
+    using namespace ams::controller;
+
+    namespace {
+
+        constexpr u8 TriggerMax = UINT8_MAX;
+
+        int GetTriggerThreshold(int trigger_max, int trigger_threshold) {
+            return trigger_max * trigger_threshold / 100;
+        }
+
+    }
+
+    void MapBetopReport(const u8 *report, int trigger_threshold, MappedState *state) {
+        AMS_UNUSED(trigger_threshold);
+        auto src = reinterpret_cast<const BetopReportData *>(report);
+        if (src->id != 0x03) {
+            return;
+        }
+
+        state->left_stick  = PackAnalogStickValues(src->input0x03.left_stick.x,  InvertAnalogStickValue(src->input0x03.left_stick.y));
+        state->right_stick = PackAnalogStickValues(src->input0x03.right_stick.x, InvertAnalogStickValue(src->input0x03.right_stick.y));
+
+        state->buttons.dpad_down  = (src->input0x03.buttons.dpad == BetopDPad_S)  ||
+                                    (src->input0x03.buttons.dpad == BetopDPad_SE) ||
+                                    (src->input0x03.buttons.dpad == BetopDPad_SW);
+        state->buttons.dpad_up    = (src->input0x03.buttons.dpad == BetopDPad_N)  ||
+                                    (src->input0x03.buttons.dpad == BetopDPad_NE) ||
+                                    (src->input0x03.buttons.dpad == BetopDPad_NW);
+        state->buttons.dpad_right = (src->input0x03.buttons.dpad == BetopDPad_E)  ||
+                                    (src->input0x03.buttons.dpad == BetopDPad_NE) ||
+                                    (src->input0x03.buttons.dpad == BetopDPad_SE);
+        state->buttons.dpad_left  = (src->input0x03.buttons.dpad == BetopDPad_W)  ||
+                                    (src->input0x03.buttons.dpad == BetopDPad_NW) ||
+                                    (src->input0x03.buttons.dpad == BetopDPad_SW);
+
+        state->buttons.A = src->input0x03.buttons.B;
+        state->buttons.B = src->input0x03.buttons.A;
+        state->buttons.X = src->input0x03.buttons.Y;
+        state->buttons.Y = src->input0x03.buttons.X;
+
+        state->buttons.R  = src->input0x03.buttons.R1;
+        state->buttons.ZR = src->input0x03.buttons.R2;
+        state->buttons.L  = src->input0x03.buttons.L1;
+        state->buttons.ZL = src->input0x03.buttons.L2;
+
+        state->buttons.lstick_press = src->input0x03.buttons.L3;
+        state->buttons.rstick_press = src->input0x03.buttons.R3;
+
+        state->buttons.minus = src->input0x03.buttons.select;
+        state->buttons.plus  = src->input0x03.buttons.start;
+
+        state->buttons.home = src->input0x03.buttons.home;
+    }
+
+    void MapHyperkinReport(const u8 *report, int trigger_threshold, MappedState *state) {
+        AMS_UNUSED(trigger_threshold);
+        auto src = reinterpret_cast<const HyperkinReportData *>(report);
+        if (src->id != 0x3f) {
+            return;
+        }
+
+        state->buttons.dpad_down  = (src->input0x3f.buttons.dpad == HyperkinDPad_S)  ||
+                                    (src->input0x3f.buttons.dpad == HyperkinDPad_SE) ||
+                                    (src->input0x3f.buttons.dpad == HyperkinDPad_SW);
+        state->buttons.dpad_up    = (src->input0x3f.buttons.dpad == HyperkinDPad_N)  ||
+                                    (src->input0x3f.buttons.dpad == HyperkinDPad_NE) ||
+                                    (src->input0x3f.buttons.dpad == HyperkinDPad_NW);
+        state->buttons.dpad_right = (src->input0x3f.buttons.dpad == HyperkinDPad_E)  ||
+                                    (src->input0x3f.buttons.dpad == HyperkinDPad_NE) ||
+                                    (src->input0x3f.buttons.dpad == HyperkinDPad_SE);
+        state->buttons.dpad_left  = (src->input0x3f.buttons.dpad == HyperkinDPad_W)  ||
+                                    (src->input0x3f.buttons.dpad == HyperkinDPad_NW) ||
+                                    (src->input0x3f.buttons.dpad == HyperkinDPad_SW);
+
+        state->buttons.A = src->input0x3f.buttons.A;
+        state->buttons.B = src->input0x3f.buttons.B;
+        state->buttons.X = src->input0x3f.buttons.X;
+        state->buttons.Y = src->input0x3f.buttons.Y;
+
+        state->buttons.L = src->input0x3f.buttons.L;
+        state->buttons.R = src->input0x3f.buttons.R;
+
+        state->buttons.minus = src->input0x3f.buttons.select;
+        state->buttons.plus  = src->input0x3f.buttons.start;
+    }
+
+    void MapLanShenReport(const u8 *report, int trigger_threshold, MappedState *state) {
+        AMS_UNUSED(trigger_threshold);
+        auto src = reinterpret_cast<const LanShenReportData *>(report);
+        if (src->id != 0x01) {
+            return;
+        }
+
+        state->left_stick  = PackAnalogStickValues(src->input0x01.left_stick.x,  InvertAnalogStickValue(src->input0x01.left_stick.y));
+        state->right_stick = PackAnalogStickValues(src->input0x01.right_stick.x, InvertAnalogStickValue(src->input0x01.right_stick.y));
+
+        state->buttons.dpad_down  = (src->input0x01.buttons.dpad == LanShenDPad_S)  ||
+                                    (src->input0x01.buttons.dpad == LanShenDPad_SE) ||
+                                    (src->input0x01.buttons.dpad == LanShenDPad_SW);
+        state->buttons.dpad_up    = (src->input0x01.buttons.dpad == LanShenDPad_N)  ||
+                                    (src->input0x01.buttons.dpad == LanShenDPad_NE) ||
+                                    (src->input0x01.buttons.dpad == LanShenDPad_NW);
+        state->buttons.dpad_right = (src->input0x01.buttons.dpad == LanShenDPad_E)  ||
+                                    (src->input0x01.buttons.dpad == LanShenDPad_NE) ||
+                                    (src->input0x01.buttons.dpad == LanShenDPad_SE);
+        state->buttons.dpad_left  = (src->input0x01.buttons.dpad == LanShenDPad_W)  ||
+                                    (src->input0x01.buttons.dpad == LanShenDPad_NW) ||
+                                    (src->input0x01.buttons.dpad == LanShenDPad_SW);
+
+        state->buttons.A = src->input0x01.buttons.B;
+        state->buttons.B = src->input0x01.buttons.A;
+        state->buttons.X = src->input0x01.buttons.Y;
+        state->buttons.Y = src->input0x01.buttons.X;
+
+        state->buttons.R  = src->input0x01.buttons.R1;
+        state->buttons.ZR = src->input0x01.buttons.R2;
+        state->buttons.L  = src->input0x01.buttons.L1;
+        state->buttons.ZL = src->input0x01.buttons.L2;
+
+        state->buttons.plus  = src->input0x01.buttons.start;
+
+        state->buttons.lstick_press = src->input0x01.buttons.L3;
+        state->buttons.rstick_press = src->input0x01.buttons.R3;
+    }
+
+    void MapRazerReport(const u8 *report, int trigger_threshold, MappedState *state) {
+        auto src = reinterpret_cast<const RazerReportData *>(report);
+        if (src->id != 0x01) {
+            return;
+        }
+
+        state->left_stick  = PackAnalogStickValues(src->input0x01.left_stick.x,  InvertAnalogStickValue(src->input0x01.left_stick.y));
+        state->right_stick = PackAnalogStickValues(src->input0x01.right_stick.x, InvertAnalogStickValue(src->input0x01.right_stick.y));
+
+        state->buttons.dpad_down  = (src->input0x01.buttons.dpad == RazerDPad_S)  ||
+                                    (src->input0x01.buttons.dpad == RazerDPad_SE) ||
+                                    (src->input0x01.buttons.dpad == RazerDPad_SW);
+        state->buttons.dpad_up    = (src->input0x01.buttons.dpad == RazerDPad_N)  ||
+                                    (src->input0x01.buttons.dpad == RazerDPad_NE) ||
+                                    (src->input0x01.buttons.dpad == RazerDPad_NW);
+        state->buttons.dpad_right = (src->input0x01.buttons.dpad == RazerDPad_E)  ||
+                                    (src->input0x01.buttons.dpad == RazerDPad_NE) ||
+                                    (src->input0x01.buttons.dpad == RazerDPad_SE);
+        state->buttons.dpad_left  = (src->input0x01.buttons.dpad == RazerDPad_W)  ||
+                                    (src->input0x01.buttons.dpad == RazerDPad_NW) ||
+                                    (src->input0x01.buttons.dpad == RazerDPad_SW);
+
+        state->buttons.A = src->input0x01.buttons.B;
+        state->buttons.B = src->input0x01.buttons.A;
+        state->buttons.X = src->input0x01.buttons.Y;
+        state->buttons.Y = src->input0x01.buttons.X;
+
+        state->buttons.R  = src->input0x01.buttons.R1;
+        state->buttons.ZR = src->input0x01.right_trigger > GetTriggerThreshold(TriggerMax, trigger_threshold);
+        state->buttons.L  = src->input0x01.buttons.L1;
+        state->buttons.ZL = src->input0x01.left_trigger  > GetTriggerThreshold(TriggerMax, trigger_threshold);
+
+        state->buttons.minus = src->input0x01.buttons.select;
+        state->buttons.plus  = src->input0x01.buttons.start;
+
+        state->buttons.lstick_press = src->input0x01.buttons.L3;
+        state->buttons.rstick_press = src->input0x01.buttons.R3;
+
+        state->buttons.capture = src->input0x01.buttons.back;
+        state->buttons.home    = src->input0x01.buttons.home;
+    }
+
+    void MapXiaomiReport(const u8 *report, int trigger_threshold, MappedState *state) {
+        auto src = reinterpret_cast<const XiaomiReportData *>(report);
+        if (src->id != 0x04) {
+            return;
+        }
+
+        state->battery = convert_battery_100(src->input0x04.battery);
+
+        state->left_stick  = PackAnalogStickValues(src->input0x04.left_stick.x,  InvertAnalogStickValue(src->input0x04.left_stick.y));
+        state->right_stick = PackAnalogStickValues(src->input0x04.right_stick.x, InvertAnalogStickValue(src->input0x04.right_stick.y));
+
+        state->buttons.dpad_down  = (src->input0x04.buttons.dpad == XiaomiDPad_S)  ||
+                                    (src->input0x04.buttons.dpad == XiaomiDPad_SE) ||
+                                    (src->input0x04.buttons.dpad == XiaomiDPad_SW);
+        state->buttons.dpad_up    = (src->input0x04.buttons.dpad == XiaomiDPad_N)  ||
+                                    (src->input0x04.buttons.dpad == XiaomiDPad_NE) ||
+                                    (src->input0x04.buttons.dpad == XiaomiDPad_NW);
+        state->buttons.dpad_right = (src->input0x04.buttons.dpad == XiaomiDPad_E)  ||
+                                    (src->input0x04.buttons.dpad == XiaomiDPad_NE) ||
+                                    (src->input0x04.buttons.dpad == XiaomiDPad_SE);
+        state->buttons.dpad_left  = (src->input0x04.buttons.dpad == XiaomiDPad_W)  ||
+                                    (src->input0x04.buttons.dpad == XiaomiDPad_NW) ||
+                                    (src->input0x04.buttons.dpad == XiaomiDPad_SW);
+
+        state->buttons.A = src->input0x04.buttons.B;
+        state->buttons.B = src->input0x04.buttons.A;
+        state->buttons.X = src->input0x04.buttons.Y;
+        state->buttons.Y = src->input0x04.buttons.X;
+
+        state->buttons.R  = src->input0x04.buttons.R1;
+        state->buttons.ZR = src->input0x04.right_trigger > GetTriggerThreshold(TriggerMax, trigger_threshold);
+        state->buttons.L  = src->input0x04.buttons.L1;
+        state->buttons.ZL = src->input0x04.left_trigger  > GetTriggerThreshold(TriggerMax, trigger_threshold);
+
+        state->buttons.minus = src->input0x04.buttons.back;
+        state->buttons.plus  = src->input0x04.buttons.menu;
+
+        state->buttons.lstick_press = src->input0x04.buttons.lstick_press;
+        state->buttons.rstick_press = src->input0x04.buttons.rstick_press;
+
+        state->buttons.home = src->input0x04.home;
+    }
+
+}
@@ -0,0 +1,37 @@
+/*
+ * Copyright (c) 2020-2025 ndeadly
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+#include "controllers/switch_controller.hpp"
+
+// The hand written input mappers from before the declarative report layouts, kept unchanged apart from writing to
+// a MappedState instead of controller members, as the reference the layouts have to match bit for bit
+namespace mc::test::reference {
+
+    struct MappedState {
+        ams::controller::SwitchButtonData buttons;
+        ams::controller::SwitchAnalogStick left_stick;
+        ams::controller::SwitchAnalogStick right_stick;
+        u8 battery;
+    };
+
+    // report points at the report id, trigger_threshold is the configured percentage
+    void MapBetopReport(const u8 *report, int trigger_threshold, MappedState *state);
+    void MapHyperkinReport(const u8 *report, int trigger_threshold, MappedState *state);
+    void MapLanShenReport(const u8 *report, int trigger_threshold, MappedState *state);
+    void MapRazerReport(const u8 *report, int trigger_threshold, MappedState *state);
+    void MapXiaomiReport(const u8 *report, int trigger_threshold, MappedState *state);
+
+}
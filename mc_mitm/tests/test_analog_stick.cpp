@@ -0,0 +1,155 @@
+/*
+ * Copyright (c) 2020-2025 ndeadly
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "test_common.hpp"
+#include "controllers/switch_analog_stick.hpp"
+#include <cmath>
+
+namespace {
+
+    using namespace ams;
+    using namespace ams::controller;
+
+    constexpr s32 Center = SwitchAnalogStick::Center;
+
+    struct StickSample {
+        u16 x;
+        u16 y;
+    };
+
+    StickSample Apply(const AnalogStickResponseTable *table, u16 x, u16 y) {
+        SwitchAnalogStick stick;
+        stick.SetData(x, y);
+        ApplyAnalogStickResponse(table, &stick);
+        return { stick.GetX(), stick.GetY() };
+    }
+
+    bool Near(s32 value, s32 expected, s32 tolerance = 1) {
+        return std::abs(value - expected) <= tolerance;
+    }
+
+    // The default profile leaves the stick untouched
+    void TestDefaultProfileDisabled() {
+        AnalogStickResponseTable table;
+        CompileAnalogStickResponse(0.0f, 0.0f, 0.0f, 1.0f, false, false, &table);
+        TEST_CHECK(!table.enabled);
+        TEST_CHECK(!table.remap_radius);
+    }
+
+    // Inverting an axis must not reshape the stick, square-gate corners included
+    void TestInversionOnly() {
+        AnalogStickResponseTable table;
+        CompileAnalogStickResponse(0.0f, 0.0f, 0.0f, 1.0f, true, false, &table);
+        TEST_CHECK(table.enabled);
+        TEST_CHECK(!table.remap_radius);
+
+        for (u32 y = 0; y <= SwitchAnalogStick::Max; y += 0x3f) {
+            for (u32 x = 0; x <= SwitchAnalogStick::Max; x += 0x3f) {
+                const auto out = Apply(&table, x, y);
+                TEST_CHECK(out.x == SwitchAnalogStick::Max - x);
+                TEST_CHECK(out.y == y);
+            }
+        }
+
+        CompileAnalogStickResponse(0.0f, 0.0f, 0.0f, 1.0f, false, true, &table);
+        const auto corner = Apply(&table, SwitchAnalogStick::Max, SwitchAnalogStick::Max);
+        TEST_CHECK(corner.x == SwitchAnalogStick::Max);
+        TEST_CHECK(corner.y == SwitchAnalogStick::Min);
+    }
+
+    // Golden points for each stage of the response, checked against the closed form within a step of rounding
+    void TestInnerDeadzone() {
+        AnalogStickResponseTable table;
+        CompileAnalogStickResponse(0.1f, 0.0f, 0.0f, 1.0f, false, false, &table);
+        TEST_CHECK(table.remap_radius);
+
+        // Anything inside 10% of the radius (204.8) reads as centred
+        auto out = Apply(&table, Center + 200, Center);
+        TEST_CHECK(out.x == Center && out.y == Center);
+        out = Apply(&table, Center, Center - 140);
+        TEST_CHECK(out.x == Center && out.y == Center);
+
+        // Halfway through the live range
+        const s32 r = 205 + (2048 - 205) / 2;
+        out = Apply(&table, Center + r, Center);
+        TEST_CHECK(Near(out.x, Center + (r - 204.8f) / (2048 - 204.8f) * 2048));
+        TEST_CHECK(out.y == Center);
+
+        // Full deflection still reaches the edge
+        out = Apply(&table, Center, SwitchAnalogStick::Min);
+        TEST_CHECK(out.x == Center && Near(out.y, SwitchAnalogStick::Min));
+    }
+
+    void TestOuterDeadzone() {
+        AnalogStickResponseTable table;
+        CompileAnalogStickResponse(0.0f, 0.2f, 0.0f, 1.0f, false, false, &table);
+
+        // 80% of the radius already reads as full deflection
+        auto out = Apply(&table, Center - 1640, Center);
+        TEST_CHECK(Near(out.x, SwitchAnalogStick::Min));
+        out = Apply(&table, Center + 1024, Center);
+        TEST_CHECK(Near(out.x, Center + 1280));
+    }
+
+    void TestAntiDeadzone() {
+        AnalogStickResponseTable table;
+        CompileAnalogStickResponse(0.0f, 0.0f, 0.25f, 1.0f, false, false, &table);
+
+        // The slightest movement jumps past the game's own deadzone
+        auto out = Apply(&table, Center + 8, Center);
+        TEST_CHECK(Near(out.x, Center + 512 + 1536 * 8 / 2048));
+        out = Apply(&table, Center + 1024, Center);
+        TEST_CHECK(Near(out.x, Center + 512 + 1536 / 2));
+        out = Apply(&table, Center, Center);
+        TEST_CHECK(out.x == Center && out.y == Center);
+    }
+
+    void TestCurve() {
+        AnalogStickResponseTable table;
+        CompileAnalogStickResponse(0.0f, 0.0f, 0.0f, 2.0f, false, false, &table);
+
+        auto out = Apply(&table, Center + 1024, Center);
+        TEST_CHECK(Near(out.x, Center + 512));
+        out = Apply(&table, Center - 512, Center);
+        TEST_CHECK(Near(out.x, Center - 128));
+    }
+
+    // Both axes are scaled by the same factor, so the direction survives
+    void TestDirectionPreserved() {
+        AnalogStickResponseTable table;
+        CompileAnalogStickResponse(0.1f, 0.1f, 0.1f, 1.5f, false, false, &table);
+
+        for (s32 r = 300; r < 1400; r += 37) {
+            const auto out = Apply(&table, Center + r, Center - 2 * r / 3);
+            const s32 dx = out.x - Center;
+            const s32 dy = out.y - Center;
+            TEST_CHECK(dx > 0 && dy < 0);
+            TEST_CHECK(std::abs(dx * 2 + dy * 3) <= 6);
+        }
+    }
+
+}
+
+int main() {
+    TestDefaultProfileDisabled();
+    TestInversionOnly();
+    TestInnerDeadzone();
+    TestOuterDeadzone();
+    TestAntiDeadzone();
+    TestCurve();
+    TestDirectionPreserved();
+
+    return mc::test::Finish("analog_stick");
+}
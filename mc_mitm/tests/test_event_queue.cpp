@@ -0,0 +1,197 @@
+/*
+ * Copyright (c) 2020-2025 ndeadly
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "test_common.hpp"
+#include "bluetooth_mitm/bluetooth/bluetooth_event_queue.hpp"
+#include <atomic>
+#include <thread>
+
+namespace {
+
+    using namespace ams;
+
+    struct TestEventInfo {
+        u32 sequence;
+        u8 payload[60];
+    };
+
+    constexpr size_t Capacity = 4;
+    using TestEventQueue = bluetooth::EventQueue<u32, TestEventInfo, Capacity>;
+
+    constexpr TimeSpan StallTimeout = TimeSpan::FromMilliSeconds(500);
+
+    // Mirrors HandleEvent: queue the event then signal the auto-clear forward event
+    void PublishEvent(TestEventQueue *queue, os::Event *forward_event, u32 sequence) {
+        const TestEventInfo info = { .sequence = sequence, .payload = {} };
+        queue->Publish(1, &info, sizeof(info), true);
+        forward_event->Signal();
+    }
+
+    // Mirrors GetEventInfo for the forward client. Returns false if the forward event never arrived
+    bool ReadEvent(TestEventQueue *queue, os::Event *forward_event, TestEventInfo *info, bool resignal) {
+        if (!forward_event->TimedWait(StallTimeout)) {
+            return false;
+        }
+
+        u32 type;
+        bool pending = false;
+        if (!queue->Pop(&type, info, sizeof(*info), &pending)) {
+            queue->GetLatest(&type, info, sizeof(*info));
+        }
+
+        if (resignal && pending) {
+            forward_event->Signal();
+        }
+
+        return true;
+    }
+
+    // A full burst published before the reader wakes collapses into a single signal
+    u32 DrainBurst(bool resignal) {
+        TestEventQueue queue;
+        os::Event forward_event(os::EventClearMode_AutoClear);
+
+        for (u32 i = 0; i < Capacity; ++i) {
+            PublishEvent(&queue, &forward_event, i);
+        }
+
+        u32 received = 0;
+        TestEventInfo info;
+        while (received < Capacity && ReadEvent(&queue, &forward_event, &info, resignal)) {
+            TEST_CHECK(info.sequence == received);
+            ++received;
+        }
+
+        return received;
+    }
+
+    void TestBurstIsDrained() {
+        // Without re-signalling the reader only ever sees the first record of a merged burst
+        TEST_CHECK(DrainBurst(false) == 1);
+        TEST_CHECK(DrainBurst(true) == Capacity);
+    }
+
+    // Publishing past capacity returns straight away. The newest event waits behind the queued ones, and the
+    // overflowed events it replaced are counted
+    void TestOverflowDoesNotBlock() {
+        constexpr u32 Overflow = 3;
+
+        TestEventQueue queue;
+        os::Event forward_event(os::EventClearMode_AutoClear);
+
+        for (u32 i = 0; i < Capacity + Overflow; ++i) {
+            PublishEvent(&queue, &forward_event, i);
+        }
+        TEST_CHECK(queue.GetDroppedCount() == Overflow - 1);
+
+        u32 type;
+        bool pending;
+        TestEventInfo info;
+        for (u32 i = 0; i < Capacity; ++i) {
+            TEST_REQUIRE(queue.Pop(&type, &info, sizeof(info), &pending));
+            TEST_CHECK(info.sequence == i && pending);
+        }
+
+        TEST_REQUIRE(queue.Pop(&type, &info, sizeof(info), &pending));
+        TEST_CHECK(info.sequence == Capacity + Overflow - 1 && !pending);
+        TEST_CHECK(!queue.Pop(&type, &info, sizeof(info), &pending));
+
+        // With room again, nothing more is dropped
+        for (u32 i = 0; i < Capacity + 1; ++i) {
+            PublishEvent(&queue, &forward_event, i);
+        }
+        TEST_CHECK(queue.GetDroppedCount() == Overflow - 1);
+    }
+
+    // The publisher produces bursts faster than the single reader consumes them, and must never wait on it. Every event
+    // is either read in order or counted as dropped, and a lost wakeup shows up as the reader timing out
+    void TestPublisherOutrunsReader() {
+        constexpr u32 NumBursts = 200;
+        constexpr u32 BurstSize = 7;
+        constexpr u32 NumEvents = NumBursts * BurstSize;
+
+        TestEventQueue queue;
+        os::Event forward_event(os::EventClearMode_AutoClear);
+        std::atomic<bool> published = false;
+
+        std::thread publisher([&] {
+            u32 sequence = 0;
+            for (u32 burst = 0; burst < NumBursts; ++burst) {
+                for (u32 i = 0; i < BurstSize; ++i) {
+                    PublishEvent(&queue, &forward_event, sequence++);
+                }
+                std::this_thread::yield();
+            }
+            published = true;
+        });
+
+        // Keep reading until the publisher is done and the last event has been read
+        u32 received = 0;
+        s64 last_sequence = -1;
+        TestEventInfo info;
+        while (!published || last_sequence != NumEvents - 1) {
+            if (!ReadEvent(&queue, &forward_event, &info, true)) {
+                break;
+            }
+
+            // Woken for an event already read, which the empty queue answers with the latest one again
+            if (s64(info.sequence) == last_sequence) {
+                continue;
+            }
+
+            TEST_CHECK(s64(info.sequence) > last_sequence);
+            last_sequence = info.sequence;
+            ++received;
+
+            if ((received % 16) == 0) {
+                std::this_thread::sleep_for(std::chrono::microseconds(50));
+            }
+        }
+
+        publisher.join();
+
+        TEST_CHECK(last_sequence == NumEvents - 1);
+        TEST_CHECK(received + queue.GetDroppedCount() == NumEvents);
+    }
+
+    void TestLatestForSecondaryReaders() {
+        TestEventQueue queue;
+
+        const TestEventInfo first = { .sequence = 1, .payload = {} };
+        const TestEventInfo second = { .sequence = 2, .payload = {} };
+        queue.Publish(1, &first, sizeof(first), true);
+        queue.Publish(2, &second, sizeof(second), false);
+
+        u32 type;
+        TestEventInfo info;
+        queue.GetLatest(&type, &info, sizeof(info));
+        TEST_CHECK(type == 2 && info.sequence == 2);
+
+        // Events that aren't forwarded aren't queued
+        bool pending;
+        TEST_CHECK(queue.Pop(&type, &info, sizeof(info), &pending));
+        TEST_CHECK(type == 1 && info.sequence == 1 && !pending);
+        TEST_CHECK(!queue.Pop(&type, &info, sizeof(info), &pending));
+    }
+
+}
+
+int main() {
+    TestBurstIsDrained();
+    TestOverflowDoesNotBlock();
+    TestPublisherOutrunsReader();
+    TestLatestForSecondaryReaders();
+    return mc::test::Finish("event_queue");
+}
@@ -0,0 +1,87 @@
+/*
+ * Copyright (c) 2020-2025 ndeadly
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "test_common.hpp"
+#include "controllers/switch_controller.hpp"
+
+namespace {
+
+    using namespace ams;
+    using namespace ams::controller;
+
+    // Directions in the order every controller's hat enum lists them, starting from north
+    enum HatDirection {
+        Hat_N,
+        Hat_NE,
+        Hat_E,
+        Hat_SE,
+        Hat_S,
+        Hat_SW,
+        Hat_W,
+        Hat_NW,
+    };
+
+    // The per-direction comparisons the mappers used before the lookup table
+    SwitchButtonData MapHatSwitchByComparison(u8 north, u8 hat) {
+        auto is = [=](HatDirection direction) { return hat == ((north + direction) & 0xff); };
+
+        SwitchButtonData buttons = {};
+        buttons.dpad_down  = is(Hat_S) || is(Hat_SE) || is(Hat_SW);
+        buttons.dpad_up    = is(Hat_N) || is(Hat_NE) || is(Hat_NW);
+        buttons.dpad_right = is(Hat_E) || is(Hat_NE) || is(Hat_SE);
+        buttons.dpad_left  = is(Hat_W) || is(Hat_NW) || is(Hat_SW);
+        return buttons;
+    }
+
+    // Every hat value, not just the eight directions and the neutral one, maps the same as the comparisons did
+    template<u8 North>
+    void TestEncoding(u8 neutral) {
+        for (unsigned int hat = 0; hat < 0x100; ++hat) {
+            SwitchButtonData buttons = {};
+            MapHatSwitch<North>(&buttons, hat);
+
+            const auto expected = MapHatSwitchByComparison(North, hat);
+            TEST_CHECK(buttons.dpad_down  == expected.dpad_down);
+            TEST_CHECK(buttons.dpad_up    == expected.dpad_up);
+            TEST_CHECK(buttons.dpad_right == expected.dpad_right);
+            TEST_CHECK(buttons.dpad_left  == expected.dpad_left);
+        }
+
+        SwitchButtonData buttons = {};
+        MapHatSwitch<North>(&buttons, neutral);
+        TEST_CHECK(!buttons.dpad_down && !buttons.dpad_up && !buttons.dpad_right && !buttons.dpad_left);
+    }
+
+    // Hats reporting north as 0 only differ in the neutral value: 8 (Dualshock4, Razer), 0x0f (Betop, Xiaomi),
+    // 0x80 (Nvidia Shield) or 0x88 (Ipega)
+    void TestZeroBasedHats() {
+        for (u8 neutral : { 0x08, 0x0f, 0x80, 0x88 }) {
+            TestEncoding<0>(neutral);
+        }
+    }
+
+    // Hats reporting north as 1, with 0 as neutral (Xbox One, Hyperkin, Mad Catz)
+    void TestOneBasedHats() {
+        TestEncoding<1>(0x00);
+    }
+
+}
+
+int main() {
+    TestZeroBasedHats();
+    TestOneBasedHats();
+
+    return mc::test::Finish("hat_switch");
+}
@@ -0,0 +1,148 @@
+/*
+ * Copyright (c) 2020-2025 ndeadly
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "test_common.hpp"
+#include "mcmitm_heap.hpp"
+#include <random>
+#include <vector>
+
+// mcmitm_heap.cpp replaces the global operator new here too, so the test harness allocates from the module heap as well
+namespace {
+
+    using namespace ams;
+    using namespace ams::mitm;
+
+    constexpr size_t SlabChunkSize = 1_KB;  // As in mcmitm_heap.cpp
+
+    HeapStatistics GetStatistics() {
+        HeapStatistics stats;
+        GetHeapStatistics(&stats);
+        return stats;
+    }
+
+    // Once a class is at its chunk cap, further blocks of that size come from the exp heap and go back there when freed
+    void TestSlabChunkCap() {
+        const HeapStatistics before = GetStatistics();
+
+        constexpr size_t SlabBlockCount = HeapSlabMaxChunksPerClass * (SlabChunkSize / 16);
+        void *blocks[SlabBlockCount + 100];
+        for (size_t i = 0; i < util::size(blocks); ++i) {
+            blocks[i] = Allocate(16);
+            TEST_REQUIRE(blocks[i] != nullptr);
+            std::memset(blocks[i], i, 16);
+        }
+
+        const HeapStatistics full = GetStatistics();
+        TEST_CHECK(full.slab_chunk_counts[0] == HeapSlabMaxChunksPerClass);
+        TEST_CHECK(full.slab_free_counts[0] == 0);
+        TEST_CHECK(full.failed_count == before.failed_count);
+        TEST_CHECK(full.current_usage >= before.current_usage + util::size(blocks) * 16);
+
+        for (size_t i = 0; i < util::size(blocks); ++i) {
+            TEST_CHECK(*static_cast<u8 *>(blocks[i]) == static_cast<u8>(i));
+            Deallocate(blocks[i], 16);
+        }
+
+        const HeapStatistics after = GetStatistics();
+        TEST_CHECK(after.slab_chunk_counts[0] == HeapSlabMaxChunksPerClass);
+        TEST_CHECK(after.slab_free_counts[0] == SlabBlockCount);
+        TEST_CHECK(after.current_usage == before.current_usage);
+    }
+
+    // Over-aligned requests bypass the slabs and still get their alignment
+    void TestOverAlignedBlocks() {
+        const HeapStatistics before = GetStatistics();
+
+        void *block = AllocateWithAlign(48, 0x40);
+        TEST_REQUIRE(block != nullptr);
+        TEST_CHECK(util::AlignDown(reinterpret_cast<uintptr_t>(block), 0x40) == reinterpret_cast<uintptr_t>(block));
+
+        const HeapStatistics during = GetStatistics();
+        TEST_CHECK(std::equal(std::begin(during.slab_free_counts), std::end(during.slab_free_counts), std::begin(before.slab_free_counts)));
+
+        Deallocate(block, 48);
+        TEST_CHECK(GetStatistics().current_usage == before.current_usage);
+    }
+
+    // Threads allocate and free random sizes across the slab classes and the exp heap without corrupting each other's blocks
+    void TestConcurrentChurn() {
+        constexpr int ThreadCount = 4;
+        constexpr int SlotCount = 24;
+        constexpr int Iterations = 200'000;
+
+        const HeapStatistics before = GetStatistics();
+        std::atomic<u32> corrupted = 0;
+        std::atomic<u32> failed = 0;
+
+        auto worker = [&](int id) {
+            std::mt19937 rng(id);
+            u8 *slots[SlotCount] = {};
+            size_t sizes[SlotCount] = {};
+
+            for (int i = 0; i < Iterations; ++i) {
+                const int k = rng() % SlotCount;
+                const u8 fill = id * SlotCount + k;
+                if (slots[k] != nullptr) {
+                    if (std::any_of(slots[k], slots[k] + sizes[k], [fill](u8 b) { return b != fill; })) {
+                        ++corrupted;
+                    }
+                    Deallocate(slots[k], sizes[k]);
+                    slots[k] = nullptr;
+                } else {
+                    sizes[k] = 1 + rng() % 384;
+                    slots[k] = static_cast<u8 *>(Allocate(sizes[k]));
+                    if (slots[k] == nullptr) {
+                        ++failed;
+                        continue;
+                    }
+                    std::memset(slots[k], fill, sizes[k]);
+                }
+            }
+
+            for (int k = 0; k < SlotCount; ++k) {
+                Deallocate(slots[k], sizes[k]);
+            }
+        };
+
+        {
+            std::vector<std::thread> threads;
+            for (int i = 0; i < ThreadCount; ++i) {
+                threads.emplace_back(worker, i);
+            }
+            for (auto &thread : threads) {
+                thread.join();
+            }
+        }
+
+        TEST_CHECK(corrupted == 0);
+        TEST_CHECK(failed == 0);
+
+        const HeapStatistics after = GetStatistics();
+        TEST_CHECK(after.current_usage == before.current_usage);
+        TEST_CHECK(after.allocation_count - before.allocation_count == after.free_count - before.free_count);
+        for (size_t i = 0; i < HeapSlabClassCount; ++i) {
+            TEST_CHECK(after.slab_chunk_counts[i] <= HeapSlabMaxChunksPerClass);
+        }
+    }
+
+}
+
+int main() {
+    TestSlabChunkCap();
+    TestOverAlignedBlocks();
+    TestConcurrentChurn();
+
+    return mc::test::Finish("heap");
+}
@@ -0,0 +1,119 @@
+/*
+ * Copyright (c) 2020-2025 ndeadly
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "test_common.hpp"
+#include "controllers/hid_response_queue.hpp"
+
+namespace {
+
+    using namespace ams;
+    using namespace ams::controller;
+
+    s64 Now() {
+        return os::ConvertToTimeSpan(os::GetSystemTick()).GetNanoSeconds();
+    }
+
+    void MakeDataReply(bluetooth::HidReportEventInfo *event_info, u8 report_id, u8 value) {
+        std::memset(event_info, 0, sizeof(*event_info));
+        event_info->data_report.v9.report.size = 2;
+        event_info->data_report.v9.report.data[0] = report_id;
+        event_info->data_report.v9.report.data[1] = value;
+    }
+
+    void MakeSetReportReply(bluetooth::HidReportEventInfo *event_info, u32 res) {
+        std::memset(event_info, 0, sizeof(*event_info));
+        event_info->set_report.res = res;
+    }
+
+    // A reply completes the oldest request of the same kind, and data replies only match their report id
+    void TestRepliesMatchOldestRequest() {
+        HidResponseQueue queue;
+        bluetooth::HidReport first = {}, second = {}, other = {};
+
+        HidResponseQueue::Ticket t_first, t_second, t_other;
+        TEST_REQUIRE(queue.Push(&t_first,  BtdrvHidEventType_Data, 0x21, &first,  true, Now()));
+        TEST_REQUIRE(queue.Push(&t_other,  BtdrvHidEventType_Data, 0x22, &other,  true, Now()));
+        TEST_REQUIRE(queue.Push(&t_second, BtdrvHidEventType_Data, 0x21, &second, true, Now()));
+
+        bluetooth::HidReportEventInfo reply;
+        MakeDataReply(&reply, 0x21, 1);
+        TEST_CHECK(queue.Complete(BtdrvHidEventType_Data, &reply));
+        MakeDataReply(&reply, 0x21, 2);
+        TEST_CHECK(queue.Complete(BtdrvHidEventType_Data, &reply));
+        MakeDataReply(&reply, 0x30, 3);
+        TEST_CHECK(!queue.Complete(BtdrvHidEventType_Data, &reply));
+        TEST_CHECK(!queue.Complete(BtdrvHidEventType_SetReport, &reply));
+
+        TEST_CHECK(queue.Wait(t_second).IsSuccess() && second.data[1] == 2);
+        TEST_CHECK(queue.Wait(t_first).IsSuccess() && first.data[1] == 1);
+
+        queue.Cancel(t_other);
+        MakeDataReply(&reply, 0x22, 4);
+        TEST_CHECK(!queue.Complete(BtdrvHidEventType_Data, &reply));
+    }
+
+    // A request waiting on a slow reply doesn't hold up anything else
+    void TestSlowReplyDoesNotBlock() {
+        HidResponseQueue queue;
+
+        bluetooth::HidReport slow_report;
+        HidResponseQueue::Ticket t_slow;
+        TEST_REQUIRE(queue.Push(&t_slow, BtdrvHidEventType_Data, 0x21, &slow_report, true, Now()));
+
+        std::thread waiter([&] {
+            TEST_CHECK(queue.Wait(t_slow).IsFailure());
+        });
+
+        // Fire-and-forget requests keep being sent and acknowledged while the waiter is blocked
+        const s64 start = Now();
+        for (int i = 0; i < 100; ++i) {
+            HidResponseQueue::Ticket t;
+            TEST_REQUIRE(queue.Push(&t, BtdrvHidEventType_SetReport, 0, nullptr, false, Now()));
+
+            bluetooth::HidReportEventInfo reply;
+            MakeSetReportReply(&reply, 0);
+            TEST_CHECK(queue.Complete(BtdrvHidEventType_SetReport, &reply));
+        }
+        TEST_CHECK(Now() - start < HidResponseQueue::ResponseTimeout.GetNanoSeconds());
+
+        waiter.join();
+    }
+
+    // Unanswered fire-and-forget requests are reclaimed once they time out, waiting ones time out in Wait
+    void TestTimeouts() {
+        HidResponseQueue queue;
+        const s64 now = Now();
+
+        HidResponseQueue::Ticket t;
+        for (size_t i = 0; i < HidResponseQueue::MaxOutstandingRequests; ++i) {
+            TEST_REQUIRE(queue.Push(&t, BtdrvHidEventType_SetReport, 0, nullptr, false, now));
+        }
+        TEST_CHECK(!queue.Push(&t, BtdrvHidEventType_SetReport, 0, nullptr, false, now));
+        TEST_CHECK(queue.Push(&t, BtdrvHidEventType_SetReport, 0, nullptr, true, now + HidResponseQueue::ResponseTimeout.GetNanoSeconds()));
+
+        bluetooth::HidReportEventInfo reply;
+        MakeSetReportReply(&reply, 0x1234);
+        TEST_CHECK(queue.Complete(BtdrvHidEventType_SetReport, &reply));
+        TEST_CHECK(queue.Wait(t).GetValue() == 0x1234);
+    }
+
+}
+
+int main() {
+    TestRepliesMatchOldestRequest();
+    TestSlowReplyDoesNotBlock();
+    TestTimeouts();
+    return mc::test::Finish("hid_response_queue");
+}
@@ -0,0 +1,281 @@
+/*
+ * Copyright (c) 2020-2025 ndeadly
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "test_common.hpp"
+#include "controllers/switch_motion_filter.hpp"
+#include "controllers/switch_motion_packing.hpp"
+#include "controllers/controller_utils.hpp"
+#include <cmath>
+#include <functional>
+
+namespace {
+
+    using namespace ams;
+    using namespace ams::controller;
+
+    // Matches MotionDriftCorrectionScale applied to the default motion_drift_correction setting
+    constexpr float DefaultDriftCorrection = 10 * 0.05f;
+
+    constexpr s64 ReportInterval = SwitchMotionSampleCount * SwitchMotionSampleInterval;
+
+    // Packed quaternion components are 21 bit fixed point values where 1 << 20 is 1.0
+    constexpr float PackedScale = 1 << 20;
+
+    s32 SignExtend(u32 value, int bits) {
+        return s32(value << (32 - bits)) >> (32 - bits);
+    }
+
+    struct Quaternion {
+        float raw[4];   // x, y, z, w
+    };
+
+    // Rebuilds the newest sample of a packing mode 2 report, the way the console does
+    Quaternion DecodeLastSample(const SwitchMotionData &motion_data, s32 out_packed[3] = nullptr) {
+        const auto &q = motion_data.quaternion.packing_mode_2;
+        const s32 packed[3] = {
+            SignExtend(q.last_sample_0, 21),
+            SignExtend(q.last_sample_1l | (q.last_sample_1h << 7), 21),
+            SignExtend(q.last_sample_2l | (q.last_sample_2h << 2), 21),
+        };
+
+        Quaternion out = {};
+        float sum = 0.0f;
+        for (int i = 0; i < 3; ++i) {
+            const float c = packed[i] / PackedScale;
+            out.raw[(q.max_index + i + 1) & 3] = c;
+            sum += c * c;
+            if (out_packed) {
+                out_packed[i] = packed[i];
+            }
+        }
+        out.raw[q.max_index] = std::sqrt(std::max(1.0f - sum, 0.0f));
+
+        return out;
+    }
+
+    void DecodeDeltaLastFirst(const SwitchMotionData &motion_data, s32 out[3]) {
+        const auto &q = motion_data.quaternion.packing_mode_2;
+        out[0] = SignExtend(q.delta_last_first_0, 13);
+        out[1] = SignExtend(q.delta_last_first_1, 13);
+        out[2] = SignExtend(q.delta_last_first_2l | (q.delta_last_first_2h << 3), 13);
+    }
+
+    // Angle between two orientations in degrees
+    float AngleBetween(const Quaternion &a, const Quaternion &b) {
+        float dot = 0.0f;
+        for (int i = 0; i < 4; ++i) {
+            dot += a.raw[i] * b.raw[i];
+        }
+        return 2.0f * std::acos(std::min(std::fabs(dot), 1.0f)) * 180.0f / std::numbers::pi_v<float>;
+    }
+
+    // An IMU trace is a function of time giving the accel (g) and gyro (deg/s) the controller reads
+    using ImuTrace = std::function<void(s64 timestamp, Vec3d<float> *accel, Vec3d<float> *gyro)>;
+
+    // Plays a trace through the quaternion packer one Switch report at a time, handing each packed report to on_report
+    void PlayTrace(SwitchMotionPacker *packer, s64 duration, const ImuTrace &trace, const std::function<void(s64, const SwitchMotionData &)> &on_report) {
+        MotionSample samples[SwitchMotionSampleCount];
+        for (s64 t = ReportInterval; t <= duration; t += ReportInterval) {
+            for (size_t i = 0; i < SwitchMotionSampleCount; ++i) {
+                samples[i].timestamp = t - (SwitchMotionSampleCount - 1 - i) * SwitchMotionSampleInterval;
+                trace(samples[i].timestamp, &samples[i].accel, &samples[i].gyro);
+            }
+
+            SwitchMotionData motion_data = {};
+            packer->PackData(&motion_data, samples);
+            on_report(t, motion_data);
+        }
+    }
+
+    SwitchMotionPacker MakeQuaternionPacker(float drift_correction) {
+        SwitchMotionPacker packer;
+        packer.SetDriftCorrection(drift_correction);
+        packer.SetMode(MotionPackingMode_Quaternion);
+        return packer;
+    }
+
+    // Without drift correction the state starts at identity, the same as a real controller
+    void TestIdentityStart() {
+        auto packer = MakeQuaternionPacker(0.0f);
+
+        int reports = 0;
+        PlayTrace(&packer, ReportInterval, [](s64, Vec3d<float> *accel, Vec3d<float> *gyro) {
+            *accel = { 0.0f, 1.0f, 0.0f };
+            *gyro = {};
+        }, [&](s64, const SwitchMotionData &motion_data) {
+            const auto q = DecodeLastSample(motion_data);
+            TEST_CHECK(motion_data.quaternion.packing_mode_2.max_index == 3);
+            TEST_CHECK(AngleBetween(q, { { 0.0f, 0.0f, 0.0f, 1.0f } }) < 0.1f);
+            ++reports;
+        });
+        TEST_CHECK(reports == 1);
+    }
+
+    // A controller resting on its side must not appear to rotate while drift correction settles
+    void TestRestingTiltedDoesNotRotate() {
+        const Vec3d<float> gravities[] = {
+            { 0.0f, 1.0f, 0.0f }, { 1.0f, 0.0f, 0.0f }, { 0.0f, 0.0f, -1.0f }, { 0.6f, -0.48f, 0.64f },
+        };
+
+        for (const auto &gravity : gravities) {
+            auto packer = MakeQuaternionPacker(DefaultDriftCorrection);
+
+            Quaternion first = {};
+            float max_angle = 0.0f;
+            PlayTrace(&packer, 3'000'000'000, [&](s64, Vec3d<float> *accel, Vec3d<float> *gyro) {
+                *accel = gravity;
+                *gyro = {};
+            }, [&](s64 t, const SwitchMotionData &motion_data) {
+                const auto q = DecodeLastSample(motion_data);
+                if (t == ReportInterval) {
+                    first = q;
+                }
+                max_angle = std::max(max_angle, AngleBetween(first, q));
+            });
+
+            TEST_CHECK(max_angle < 0.5f);
+        }
+    }
+
+    // A steady turn integrates to the expected angle, and drift correction leaves rotation about gravity alone
+    void TestSteadyTurn() {
+        for (float drift_correction : { 0.0f, DefaultDriftCorrection }) {
+            auto packer = MakeQuaternionPacker(drift_correction);
+
+            Quaternion last = {};
+            PlayTrace(&packer, 1'005'000'000, [](s64, Vec3d<float> *accel, Vec3d<float> *gyro) {
+                *accel = { 0.0f, 0.0f, 1.0f };
+                *gyro = { 0.0f, 0.0f, 90.0f };
+            }, [&](s64, const SwitchMotionData &motion_data) {
+                last = DecodeLastSample(motion_data);
+            });
+
+            // The first report only sets the starting point, so one report interval less is integrated
+            const float expected = 90.0f * (1'005'000'000 - ReportInterval) / 1e9f;
+            TEST_CHECK(std::fabs(AngleBetween(last, { { 0.0f, 0.0f, 0.0f, 1.0f } }) - expected) < 0.5f);
+        }
+    }
+
+    // Drift correction cancels a gyro bias in the forward step. The earlier samples of each report have to be rotated back with the same
+    // corrected rate, otherwise they disagree with the newest one by the bias over the span of the report
+    void TestRewindMatchesForwardStep() {
+        auto packer = MakeQuaternionPacker(DefaultDriftCorrection);
+
+        s32 previous_last[3] = {};
+        s32 max_delta = 0;
+        s32 max_step = 0;
+        PlayTrace(&packer, 12'000'000'000, [](s64, Vec3d<float> *accel, Vec3d<float> *gyro) {
+            *accel = { 0.0f, 0.0f, 1.0f };
+            *gyro = { 2.0f, -1.5f, 0.0f };
+        }, [&](s64 t, const SwitchMotionData &motion_data) {
+            s32 last[3];
+            s32 delta[3];
+            DecodeLastSample(motion_data, last);
+            DecodeDeltaLastFirst(motion_data, delta);
+
+            // Give the correction time to settle before checking
+            if (t > 10'000'000'000) {
+                for (int i = 0; i < 3; ++i) {
+                    max_delta = std::max(max_delta, std::abs(delta[i]));
+                    max_step = std::max(max_step, std::abs(last[i] - previous_last[i]));
+                }
+            }
+            std::copy(last, last + 3, previous_last);
+        });
+
+        // The state has stopped moving between reports, so the samples within a report mustn't move either
+        TEST_CHECK(max_step <= 4);
+        TEST_CHECK(max_delta <= 4);
+    }
+
+    // Bias estimation only learns from a controller at rest
+    void TestGyroBiasCalibration() {
+        MotionFilter filter;
+        const Vec3d<float> bias = { 1.5f, -0.75f, 0.5f };
+
+        Vec3d<float> corrected = {};
+        for (s64 t = 0; t <= 10'000'000'000; t += SwitchMotionSampleInterval) {
+            corrected = filter.Apply(t, { 0.0f, 0.0f, 1.0f }, bias);
+        }
+
+        TEST_CHECK(std::fabs(filter.GetGyroBias().x - bias.x) < 0.05f);
+        TEST_CHECK(std::fabs(filter.GetGyroBias().y - bias.y) < 0.05f);
+        TEST_CHECK(std::fabs(filter.GetGyroBias().z - bias.z) < 0.05f);
+        TEST_CHECK(std::fabs(corrected.x) < 0.05f && std::fabs(corrected.y) < 0.05f && std::fabs(corrected.z) < 0.05f);
+
+        // A slow deliberate turn is well above the stationary threshold and mustn't be learned as bias
+        MotionFilter moving;
+        for (s64 t = 0; t <= 10'000'000'000; t += SwitchMotionSampleInterval) {
+            const float angle = t / 1e9f;
+            moving.Apply(t, { std::sin(angle) * 0.3f, 0.0f, std::cos(angle) }, { 0.0f, 20.0f, 0.0f });
+        }
+        TEST_CHECK(moving.GetGyroBias().y == 0.0f);
+    }
+
+    // Gyro calibrations as read from Dualshock4 and DualSense controllers, plus an exact divisor and a small one
+    struct GyroCalibration {
+        s16 bias;
+        s16 max;
+        s16 speed_max;
+    };
+
+    constexpr GyroCalibration GyroCalibrations[] = {
+        {  -3, 8706, 540 },
+        {   8, 8734, 540 },
+        {  -1, 8575, 540 },
+        {   0, 8640, 540 },
+        { -12, 2271, 1000 },
+    };
+
+    // The old Sony conversion divided by (max - bias) / speed_max evaluated in integer maths, truncating the divisor d to floor(d)
+    // and reading rates high by d / floor(d). AxisCalibration uses the exact ratio, so the two differ by exactly that factor
+    void TestAxisCalibrationAgainstTruncatedDivisor() {
+        for (const auto &cal : GyroCalibrations) {
+            const auto axis = MakeAxisCalibration(cal.bias, cal.max, cal.speed_max);
+            const double divisor = double(cal.max - cal.bias) / cal.speed_max;
+            const double truncation = divisor / std::floor(divisor);
+
+            for (s32 vel = INT16_MIN; vel <= INT16_MAX; vel += 7) {
+                const double exact = (double(vel) - cal.bias) / divisor;
+                const float value = axis.Apply(vel);
+                TEST_CHECK(std::fabs(value - exact) <= 1e-5 * std::max(1.0, std::fabs(exact)));
+
+                // Old DualSense mapping: float numerator, truncated divisor
+                const float dualsense = (float(vel) - cal.bias) / ((cal.max - cal.bias) / cal.speed_max);
+                TEST_CHECK(std::fabs(value * truncation - dualsense) <= 1e-5 * std::max(1.0, std::fabs(exact)));
+
+                // Old Dualshock4 mapping: everything in integer maths, so the result was truncated as well
+                const s32 dualshock4 = (vel - cal.bias) / ((cal.max - cal.bias) / cal.speed_max);
+                TEST_CHECK(std::fabs(value * truncation - dualshock4) < 1.0f);
+            }
+        }
+
+        // Nothing changes when the divisor was already a whole number
+        const auto whole = MakeAxisCalibration(0, 8640, 540);
+        TEST_CHECK(whole.Apply(16 * 100) == 100.0f);
+    }
+
+}
+
+int main() {
+    TestIdentityStart();
+    TestRestingTiltedDoesNotRotate();
+    TestSteadyTurn();
+    TestRewindMatchesForwardStep();
+    TestGyroBiasCalibration();
+    TestAxisCalibrationAgainstTruncatedDivisor();
+
+    return mc::test::Finish("motion");
+}
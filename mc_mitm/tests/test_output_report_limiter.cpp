@@ -0,0 +1,114 @@
+/*
+ * Copyright (c) 2020-2025 ndeadly
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "test_common.hpp"
+#include "controllers/output_report_limiter.hpp"
+
+namespace {
+
+    using namespace ams;
+    using namespace ams::controller;
+
+    constexpr s64 MinInterval     = TimeSpan::FromMilliSeconds(5).GetNanoSeconds();
+    constexpr s64 RefreshInterval = TimeSpan::FromMilliSeconds(50).GetNanoSeconds();
+
+    bluetooth::HidReport MakeReport(u8 level) {
+        bluetooth::HidReport report = {};
+        report.size = 4;
+        report.data[0] = 0x01;
+        report.data[2] = level;
+        return report;
+    }
+
+    // Mirrors EmulatedSwitchController::WriteOutputReport, with the commit succeeding or failing on request
+    OutputReportAction Write(OutputReportLimiter *limiter, const bluetooth::HidReport *report, s64 now, bool commit_succeeds = true) {
+        const auto action = limiter->Submit(report, now);
+        if (action == OutputReportAction_Write && commit_succeeds) {
+            limiter->RecordWrite(report, now);
+        }
+        return action;
+    }
+
+    void TestDeduplicateAndDefer() {
+        OutputReportLimiter limiter;
+        limiter.SetMinInterval(MinInterval);
+
+        auto report = MakeReport(1);
+        TEST_CHECK(Write(&limiter, &report, 0) == OutputReportAction_Write);
+        TEST_CHECK(Write(&limiter, &report, MinInterval * 10) == OutputReportAction_Drop);
+
+        // Changes inside the interval are held back, and only the newest survives
+        const s64 t = MinInterval * 20;
+        TEST_CHECK(Write(&limiter, &report, t) == OutputReportAction_Drop);
+        auto changed = MakeReport(2);
+        TEST_CHECK(Write(&limiter, &changed, t) == OutputReportAction_Write);
+        auto newer = MakeReport(3);
+        auto newest = MakeReport(4);
+        TEST_CHECK(Write(&limiter, &newer, t + 1) == OutputReportAction_Defer);
+        TEST_CHECK(Write(&limiter, &newest, t + 2) == OutputReportAction_Defer);
+        TEST_CHECK(limiter.GetPendingDue() == t + MinInterval);
+
+        bluetooth::HidReport out;
+        TEST_CHECK(!limiter.TakePendingReport(t + MinInterval - 1, &out));
+        TEST_CHECK(limiter.TakePendingReport(t + MinInterval, &out));
+        TEST_CHECK(out.size == newest.size && out.data[2] == 4);
+        TEST_CHECK(!limiter.TakePendingReport(t + MinInterval * 2, &out));
+    }
+
+    // Controllers that only play a report for a limited time must keep receiving an unchanged report
+    void TestRefreshFiniteDurationReports() {
+        OutputReportLimiter limiter;
+        limiter.SetMinInterval(MinInterval);
+        limiter.SetRefreshInterval(RefreshInterval);
+
+        // Constant rumble arrives roughly every 15ms
+        constexpr s64 Period = TimeSpan::FromMilliSeconds(15).GetNanoSeconds();
+        auto report = MakeReport(0x80);
+
+        s64 last_write = -1;
+        s64 longest_gap = 0;
+        for (s64 now = 0; now < TimeSpan::FromSeconds(2).GetNanoSeconds(); now += Period) {
+            if (Write(&limiter, &report, now) == OutputReportAction_Write) {
+                if (last_write >= 0) {
+                    longest_gap = std::max(longest_gap, now - last_write);
+                }
+                last_write = now;
+            }
+        }
+
+        TEST_CHECK(last_write > 0);
+        TEST_CHECK(longest_gap < RefreshInterval + Period);
+        TEST_CHECK(limiter.GetSuppressedCount() > 0);
+    }
+
+    // A write that fails must not be remembered as sent
+    void TestFailedWriteIsRetried() {
+        OutputReportLimiter limiter;
+        limiter.SetMinInterval(MinInterval);
+
+        auto report = MakeReport(1);
+        TEST_CHECK(Write(&limiter, &report, 0, false) == OutputReportAction_Write);
+        TEST_CHECK(Write(&limiter, &report, 1) == OutputReportAction_Write);
+        TEST_CHECK(Write(&limiter, &report, MinInterval * 2) == OutputReportAction_Drop);
+    }
+
+}
+
+int main() {
+    TestDeduplicateAndDefer();
+    TestRefreshFiniteDurationReports();
+    TestFailedWriteIsRetried();
+    return mc::test::Finish("output_report_limiter");
+}
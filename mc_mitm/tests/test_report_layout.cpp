@@ -0,0 +1,119 @@
+/*
+ * Copyright (c) 2020-2025 ndeadly
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "test_common.hpp"
+#include "host_stubs.hpp"
+#include "reference/legacy_report_mappers.hpp"
+#include "controllers/betop_controller.hpp"
+#include "controllers/hyperkin_controller.hpp"
+#include "controllers/lanshen_controller.hpp"
+#include "controllers/razer_controller.hpp"
+#include "controllers/xiaomi_controller.hpp"
+#include "mcmitm_config.hpp"
+#include <cstring>
+#include <random>
+
+namespace {
+
+    using namespace ams;
+    using namespace ams::controller;
+    namespace ref = mc::test::reference;
+
+    constexpr int TriggerThresholds[] = { 0, 1, 33, 50, 99, 100 };
+    constexpr size_t ReportsPerThreshold = 50000;
+
+    struct LayoutTarget {
+        const char *name;
+        std::unique_ptr<EmulatedSwitchController> (*create)(const bluetooth::Address *address);
+        void (*map_reference)(const u8 *report, int trigger_threshold, ref::MappedState *state);
+        u8 report_id;
+        u16 report_size;
+        bool has_battery;
+    };
+
+    template<typename Controller>
+    std::unique_ptr<EmulatedSwitchController> Create(const bluetooth::Address *address) {
+        return std::make_unique<Controller>(address, Controller::hardware_ids[0]);
+    }
+
+    constexpr LayoutTarget LayoutTargets[] = {
+        { "Betop",    Create<BetopController>,    ref::MapBetopReport,    0x03, sizeof(BetopReportData),    false },
+        { "Hyperkin", Create<HyperkinController>, ref::MapHyperkinReport, 0x3f, sizeof(HyperkinReportData), false },
+        { "LanShen",  Create<LanShenController>,  ref::MapLanShenReport,  0x01, sizeof(LanShenReportData),  false },
+        { "Razer",    Create<RazerController>,    ref::MapRazerReport,    0x01, sizeof(RazerReportData),    false },
+        { "Xiaomi",   Create<XiaomiController>,   ref::MapXiaomiReport,   0x04, sizeof(XiaomiReportData),   true  },
+    };
+
+    // Random payloads, with trigger bytes biased towards the threshold boundaries so the comparisons either side of them are exercised
+    void MakeReport(std::mt19937 *rng, const LayoutTarget &target, int trigger_threshold, bluetooth::HidReport *report) {
+        report->size = target.report_size;
+        for (size_t i = 0; i < report->size; ++i) {
+            report->data[i] = (*rng)();
+            if (((*rng)() & 3) == 0) {
+                report->data[i] = UINT8_MAX * trigger_threshold / 100 + ((*rng)() % 3) - 1;
+            }
+        }
+        report->data[0] = target.report_id;
+    }
+
+    // Runs random reports through the controller and the previous hand written mapper, and compares the state the console sees
+    void CompareLayout(const LayoutTarget &target) {
+        const bluetooth::Address address = { { 0x00, 0x11, 0x22, 0x33, 0x44, 0x55 } };
+        std::mt19937 rng(0x4c61796f);
+
+        size_t mismatches = 0;
+        for (int trigger_threshold : TriggerThresholds) {
+            mitm::GetGlobalConfig()->misc.analog_trigger_activation_threshold = trigger_threshold;
+            auto controller = target.create(&address);
+
+            ref::MappedState expected = {};
+            expected.left_stick.SetData(SwitchAnalogStick::Center, SwitchAnalogStick::Center);
+            expected.right_stick.SetData(SwitchAnalogStick::Center, SwitchAnalogStick::Center);
+
+            static bluetooth::HidReportEventInfo event_info;
+            auto report = &event_info.data_report.v9.report;
+            for (size_t i = 0; i < ReportsPerThreshold; ++i) {
+                MakeReport(&rng, target, trigger_threshold, report);
+
+                target.map_reference(report->data, trigger_threshold, &expected);
+                TEST_REQUIRE(controller->HandleDataReportEvent(&event_info).IsSuccess());
+
+                auto actual = reinterpret_cast<const SwitchInputReport *>(mc::test::GetLastFakeInputReport()->data);
+                const bool match = std::memcmp(&actual->buttons, &expected.buttons, sizeof(expected.buttons)) == 0 &&
+                                   std::memcmp(&actual->left_stick, &expected.left_stick, sizeof(expected.left_stick)) == 0 &&
+                                   std::memcmp(&actual->right_stick, &expected.right_stick, sizeof(expected.right_stick)) == 0 &&
+                                   (!target.has_battery || (actual->battery & ~1) == (expected.battery & 0xe));
+
+                if (!match && mismatches++ == 0) {
+                    std::printf("%s: first mismatch at threshold %d, report %zu\n", target.name, trigger_threshold, i);
+                }
+            }
+        }
+
+        TEST_CHECK(mismatches == 0);
+    }
+
+}
+
+int main() {
+    // Button combos would rewrite the mapped buttons before they reach the console
+    mitm::GetGlobalConfig()->button_combos.count = 0;
+
+    for (const auto &target : LayoutTargets) {
+        CompareLayout(target);
+    }
+
+    return mc::test::Finish("report_layout");
+}
@@ -0,0 +1,202 @@
+/*
+ * Copyright (c) 2020-2025 ndeadly
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "test_common.hpp"
+#include "host_stubs.hpp"
+#include "controller_fixtures.hpp"
+#include "controllers/switch_controller.hpp"
+#include "controllers/dualshock3_controller.hpp"
+#include "controllers/xbox_one_controller.hpp"
+#include "controllers/8bitdo_controller.hpp"
+#include "controllers/betop_controller.hpp"
+#include "controllers/hyperkin_controller.hpp"
+#include "controllers/lanshen_controller.hpp"
+#include "controllers/razer_controller.hpp"
+#include "controllers/xiaomi_controller.hpp"
+#include <new>
+
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+
+// Every heap allocation in the process is counted, so the replay can check that the report paths don't allocate
+namespace {
+
+    std::atomic<u64> g_allocation_count;
+
+}
+
+void *operator new(size_t size) {
+    ++g_allocation_count;
+    if (void *p = std::malloc(size ? size : 1); p != nullptr) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void *operator new[](size_t size) {
+    return operator new(size);
+}
+
+void operator delete(void *p) noexcept { std::free(p); }
+void operator delete[](void *p) noexcept { std::free(p); }
+void operator delete(void *p, size_t) noexcept { std::free(p); }
+void operator delete[](void *p, size_t) noexcept { std::free(p); }
+
+namespace {
+
+    using namespace ams;
+    using namespace ams::controller;
+
+    // Reports replayed before allocations start being counted. Anything lazily set up on the first few reports is fine
+    constexpr size_t WarmupReports = 64;
+    constexpr size_t ReplayReports = 20000;
+
+    // Rumble packets are sent by the console at roughly this rate
+    constexpr size_t ReportsPerRumblePacket = 3;
+
+    struct ReplayTarget {
+        const char *name;
+        std::unique_ptr<SwitchController> (*create)(const bluetooth::Address *address);
+        u8 report_ids[4];
+        u16 report_size;
+    };
+
+    template<typename Controller>
+    std::unique_ptr<SwitchController> Create(const bluetooth::Address *address) {
+        return std::make_unique<Controller>(address, Controller::hardware_ids[0]);
+    }
+
+    constexpr ReplayTarget ReplayTargets[] = {
+        { "Switch",     Create<SwitchController>,     { 0x30 },             0x31 },
+        { "Dualshock3", Create<Dualshock3Controller>, { 0x01 },             0x31 },
+        { "Dualshock4", Create<Dualshock4Controller>, { 0x01, 0x11 },       0x4e },
+        { "Dualsense",  Create<DualsenseController>,  { 0x01, 0x31 },       0x4e },
+        { "XboxOne",    Create<XboxOneController>,    { 0x01, 0x02, 0x04 }, 0x12 },
+        { "8BitDo",     Create<EightBitDoController>, { 0x01, 0x03 },       0x0b },
+        { "Betop",      Create<BetopController>,      { 0x03 },             0x10 },
+        { "Hyperkin",   Create<HyperkinController>,   { 0x3f },             0x10 },
+        { "LanShen",    Create<LanShenController>,    { 0x01 },             0x10 },
+        { "Razer",      Create<RazerController>,      { 0x01 },             0x10 },
+        { "Xiaomi",     Create<XiaomiController>,     { 0x04 },             0x15 },
+    };
+
+    void MakeInputReport(mc::test::Random *random, const ReplayTarget &target, size_t index, bluetooth::HidReportEventInfo *event_info) {
+        auto report = &event_info->data_report.v9.report;
+
+        size_t num_ids = 0;
+        while ((num_ids < std::size(target.report_ids)) && (target.report_ids[num_ids] != 0)) {
+            ++num_ids;
+        }
+
+        report->size = target.report_size;
+        random->Fill(report->data, report->size);
+        report->data[0] = target.report_ids[index % num_ids];
+    }
+
+    void MakeRumbleReport(mc::test::Random *random, bluetooth::HidReport *report) {
+        SwitchOutputReport output = {};
+        output.id = 0x10;
+        random->Fill(&output.enc_motor_data, sizeof(output.enc_motor_data));
+
+        report->size = sizeof(output.id) + sizeof(output.counter) + sizeof(output.enc_motor_data);
+        std::memcpy(report->data, &output, report->size);
+    }
+
+    // Feeds one report through the input path, and every few reports a rumble packet through the output path
+    void ReplayReport(SwitchController *controller, mc::test::Random *random, const ReplayTarget &target, size_t index, bluetooth::HidReportEventInfo *event_info, bluetooth::HidReport *rumble_report) {
+        MakeInputReport(random, target, index, event_info);
+        TEST_CHECK(controller->HandleDataReportEvent(event_info).IsSuccess());
+
+        if ((index % ReportsPerRumblePacket) == 0) {
+            MakeRumbleReport(random, rumble_report);
+            controller->HandleOutputDataReport(rumble_report);
+
+            // Play back everything that was scheduled, as the scheduler thread would over the next few milliseconds
+            const s64 now = os::ConvertToTimeSpan(os::GetSystemTick()).GetNanoSeconds();
+            for (s64 offset = 0; offset <= TimeSpan::FromMilliSeconds(15).GetNanoSeconds(); offset += TimeSpan::FromMilliSeconds(5).GetNanoSeconds()) {
+                controller->ProcessScheduledOutput(now + offset);
+            }
+        }
+    }
+
+    void ReplayTrace(const ReplayTarget &target) {
+        const bluetooth::Address address = { { 0x00, 0x11, 0x22, 0x33, 0x44, 0x55 } };
+        auto controller = target.create(&address);
+
+        mc::test::Random random(0x12345678);
+        static bluetooth::HidReportEventInfo event_info;
+        static bluetooth::HidReport rumble_report;
+
+        const u32 reports_before = mc::test::GetFakeInputReportCount();
+
+        for (size_t i = 0; i < WarmupReports; ++i) {
+            ReplayReport(controller.get(), &random, target, i, &event_info, &rumble_report);
+        }
+
+        const u64 allocations_before = g_allocation_count;
+
+        for (size_t i = WarmupReports; i < WarmupReports + ReplayReports; ++i) {
+            ReplayReport(controller.get(), &random, target, i, &event_info, &rumble_report);
+        }
+
+        const u64 allocations = g_allocation_count - allocations_before;
+        if (allocations != 0) {
+            std::printf("%s: %llu allocation(s) after warm-up\n", target.name, static_cast<unsigned long long>(allocations));
+        }
+
+        TEST_CHECK(allocations == 0);
+        TEST_CHECK(mc::test::GetFakeInputReportCount() - reports_before == WarmupReports + ReplayReports);
+    }
+
+    // Dualshock3 output is written with SET_REPORT. Nothing acknowledges it here, so a write that waited on the acknowledgement would stall for the full timeout
+    void TestDualshock3OutputDoesNotBlock() {
+        const bluetooth::Address address = { { 0x00, 0x11, 0x22, 0x33, 0x44, 0x56 } };
+        Dualshock3Controller controller(&address, Dualshock3Controller::hardware_ids[0]);
+
+        mc::test::Random random(0x87654321);
+        static bluetooth::HidReport rumble_report;
+
+        const u32 writes_before = mc::test::GetControllerWriteCount();
+        const s64 start = os::ConvertToTimeSpan(os::GetSystemTick()).GetNanoSeconds();
+
+        for (int i = 0; i < 50; ++i) {
+            MakeRumbleReport(&random, &rumble_report);
+            controller.HandleOutputDataReport(&rumble_report);
+            controller.ProcessScheduledOutput(os::ConvertToTimeSpan(os::GetSystemTick()).GetNanoSeconds() + TimeSpan::FromMilliSeconds(15).GetNanoSeconds());
+        }
+
+        const s64 elapsed = os::ConvertToTimeSpan(os::GetSystemTick()).GetNanoSeconds() - start;
+        TEST_CHECK(elapsed < HidResponseQueue::ResponseTimeout.GetNanoSeconds());
+        TEST_CHECK(mc::test::GetControllerWriteCount() != writes_before);
+    }
+
+    // Make sure the counter would actually catch an allocation
+    void TestAllocationCounter() {
+        const u64 before = g_allocation_count;
+        auto p = std::make_unique<u32>(0);
+        TEST_CHECK(g_allocation_count - before == 1);
+    }
+
+}
+
+int main() {
+    TestAllocationCounter();
+    TestDualshock3OutputDoesNotBlock();
+
+    for (const auto &target : ReplayTargets) {
+        ReplayTrace(target);
+    }
+
+    return mc::test::Finish("report_replay");
+}
@@ -0,0 +1,102 @@
+/*
+ * Copyright (c) 2020-2025 ndeadly
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "test_common.hpp"
+#include "reference/float_rumble_decoder.hpp"
+#include "controllers/switch_rumble_decoder.hpp"
+#include <cstring>
+#include <random>
+
+namespace {
+
+    namespace ref = mc::test::reference;
+    using namespace ams::controller;
+
+    constexpr size_t RandomSequences = 20000;
+    constexpr size_t PacketsPerSequence = 64;
+
+    // Decodes the same packet with both decoders, returns whether the decoded samples and the resulting state match bit for bit
+    bool DecodeMatches(ref::SwitchRumbleDecoder *expected, SwitchRumbleDecoder *actual, u32 raw) {
+        ref::SwitchEncodedVibrationSamples ref_encoded;
+        SwitchEncodedVibrationSamples encoded;
+        std::memcpy(&ref_encoded, &raw, sizeof(raw));
+        std::memcpy(&encoded, &raw, sizeof(raw));
+
+        ref::SwitchVibrationSamples ref_decoded = {};
+        SwitchVibrationSamples decoded = {};
+        expected->DecodeSamples(&ref_encoded, &ref_decoded);
+        actual->DecodeSamples(&encoded, &decoded);
+
+        if ((ref_decoded.count != decoded.count) || std::memcmp(ref_decoded.samples, decoded.samples, decoded.count * sizeof(decoded.samples[0])) != 0) {
+            return false;
+        }
+
+        ref::SwitchVibrationValues ref_current;
+        SwitchVibrationValues current;
+        expected->GetCurrentOutputValue(&ref_current);
+        actual->GetCurrentOutputValue(&current);
+
+        return std::memcmp(&ref_current, &current, sizeof(current)) == 0;
+    }
+
+    // The decoders carry state between packets, so compare them over long runs of random packets
+    void TestRandomSequences() {
+        std::mt19937 rng(1);
+
+        size_t mismatches = 0;
+        for (size_t sequence = 0; sequence < RandomSequences; ++sequence) {
+            ref::SwitchRumbleDecoder expected;
+            SwitchRumbleDecoder actual;
+
+            for (size_t i = 0; i < PacketsPerSequence; ++i) {
+                const u32 raw = rng();
+                if (!DecodeMatches(&expected, &actual, raw)) {
+                    if (mismatches++ == 0) {
+                        std::printf("first mismatch: sequence %zu packet %zu (0x%08x)\n", sequence, i, raw);
+                    }
+                }
+            }
+        }
+
+        TEST_CHECK(mismatches == 0);
+    }
+
+    // Every possible packet decoded from the initial state. Takes a few minutes, so only run on request
+    void TestExhaustive() {
+        size_t mismatches = 0;
+        for (u64 raw = 0; raw <= UINT32_MAX; ++raw) {
+            ref::SwitchRumbleDecoder expected;
+            SwitchRumbleDecoder actual;
+            if (!DecodeMatches(&expected, &actual, raw)) {
+                if (mismatches++ == 0) {
+                    std::printf("first mismatch: 0x%08x\n", static_cast<u32>(raw));
+                }
+            }
+        }
+
+        TEST_CHECK(mismatches == 0);
+    }
+
+}
+
+int main(int argc, char **argv) {
+    TestRandomSequences();
+
+    if ((argc > 1) && (std::strcmp(argv[1], "--exhaustive") == 0)) {
+        TestExhaustive();
+    }
+
+    return mc::test::Finish("rumble_decoder");
+}
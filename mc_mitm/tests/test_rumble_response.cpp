@@ -0,0 +1,98 @@
+/*
+ * Copyright (c) 2020-2025 ndeadly
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "test_common.hpp"
+#include "controllers/rumble_response.hpp"
+#include <cmath>
+#include <random>
+
+namespace {
+
+    using namespace ams;
+    using namespace ams::controller;
+
+    constexpr u8 OutputMaxes[] = { 0xff, 100 };
+
+    // Linear response has to reproduce the mapping every controller used before the response tables, output_max * amplitude truncated
+    void TestLinearMatchesDirectScaling() {
+        std::mt19937 rng(3);
+        std::uniform_real_distribution<float> amplitude_dist(0.0f, 1.0f);
+        std::uniform_real_distribution<float> frequency_dist(SwitchRumbleCenterFreqLow / 4, SwitchRumbleCenterFreqLow * 4);
+
+        for (u8 output_max : OutputMaxes) {
+            RumbleResponseTable table;
+            CompileLinearRumbleResponse(SwitchRumbleCenterFreqLow, output_max, &table);
+
+            size_t mismatches = 0;
+            auto check = [&](float amplitude) {
+                const u8 expected = static_cast<u8>(output_max * amplitude);
+                if (ApplyRumbleResponse(&table, amplitude, frequency_dist(rng)) != expected) {
+                    if (mismatches++ == 0) {
+                        std::printf("output_max %u: amplitude %.9g maps to %u, expected %u\n", output_max, amplitude, ApplyRumbleResponse(&table, amplitude, SwitchRumbleCenterFreqLow), expected);
+                    }
+                }
+            };
+
+            for (int i = 0; i < 1'000'000; ++i) {
+                check(amplitude_dist(rng));
+            }
+
+            // Either side of every output step, where truncation is most sensitive
+            for (int step = 0; step <= output_max; ++step) {
+                const float amplitude = float(step) / output_max;
+                check(amplitude);
+                check(std::nextafter(amplitude, 0.0f));
+                check(std::nextafter(amplitude, 1.0f));
+            }
+            check(1.0f);
+
+            TEST_CHECK(mismatches == 0);
+        }
+    }
+
+    void TestPerceptualShape() {
+        for (u8 output_max : OutputMaxes) {
+            RumbleResponseTable table;
+            CompileRumbleResponse(0.05f, 0.2f, 0.9f, 0.7f, 0.2f, SwitchRumbleCenterFreqHigh, output_max, &table);
+
+            const float centre = SwitchRumbleCenterFreqHigh;
+            TEST_CHECK(ApplyRumbleResponse(&table, 0.0f, centre) == 0);
+            TEST_CHECK(ApplyRumbleResponse(&table, 0.04f, centre) == 0);
+
+            // Just outside the deadzone the motor gets at least the threshold duty, and full amplitude the saturation duty
+            TEST_CHECK(ApplyRumbleResponse(&table, 0.06f, centre) >= static_cast<u8>(0.2f * output_max));
+            TEST_CHECK(ApplyRumbleResponse(&table, 1.0f, centre) == static_cast<u8>(0.9f * output_max + 0.5f));
+
+            u8 previous = 0;
+            for (int i = 0; i <= 1000; ++i) {
+                const u8 duty = ApplyRumbleResponse(&table, i / 1000.0f, centre);
+                TEST_CHECK(duty >= previous);
+                previous = duty;
+            }
+
+            // An octave away from the centre loses rolloff of the amplitude, two octaves twice that
+            TEST_CHECK(ApplyRumbleResponse(&table, 1.0f, centre * 2) == ApplyRumbleResponse(&table, 0.8f, centre));
+            TEST_CHECK(ApplyRumbleResponse(&table, 1.0f, centre / 4) == ApplyRumbleResponse(&table, 0.6f, centre));
+        }
+    }
+
+}
+
+int main() {
+    TestLinearMatchesDirectScaling();
+    TestPerceptualShape();
+
+    return mc::test::Finish("rumble_response");
+}
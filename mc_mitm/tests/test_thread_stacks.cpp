@@ -0,0 +1,97 @@
+/*
+ * Copyright (c) 2020-2025 ndeadly
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "test_common.hpp"
+#include "mcmitm_thread_stacks.hpp"
+#include <pthread.h>
+
+namespace {
+
+    using namespace ams;
+    using namespace ams::mitm;
+
+    constexpr size_t ThreadStackSize = 0x20000;
+    constexpr size_t FrameSize = 0x400;
+    constexpr size_t FrameDepth = 16;
+
+    alignas(os::ThreadStackAlignment) u8 g_idle_stack[0x1000];
+    alignas(os::ThreadStackAlignment) u8 g_running_stack[ThreadStackSize];
+
+    ThreadStackUsage GetUsage(size_t index) {
+        static ThreadStackStatistics stats;
+        GetThreadStackStatistics(&stats);
+        TEST_REQUIRE(index < stats.count);
+        return stats.threads[index];
+    }
+
+    NOINLINE u32 UseStack(size_t depth) {
+        volatile u8 frame[FrameSize];
+        frame[0] = depth;
+        return depth != 0 ? UseStack(depth - 1) + frame[0] : frame[0];
+    }
+
+    // A stack registered before its thread starts is entirely unused, and usage grows from the top
+    void TestIdleStack() {
+        static os::ThreadType thread;
+        RegisterThreadStack(&thread, g_idle_stack, sizeof(g_idle_stack));
+        TEST_CHECK(GetUsage(0).peak_usage == 0);
+        TEST_CHECK(GetUsage(0).stack_size == sizeof(g_idle_stack));
+
+        std::memset(g_idle_stack + sizeof(g_idle_stack) - 0x180, 0, 0x180);
+        TEST_CHECK(GetUsage(0).peak_usage == 0x180);
+    }
+
+    void *RunningThreadMain(void *arg) {
+        AMS_UNUSED(arg);
+
+        // Lives in a frame above the one doing the fill, so it must survive registration
+        volatile u64 sentinel = 0x0123456789abcdef;
+
+        RegisterCurrentThreadStack();
+        TEST_CHECK(sentinel == 0x0123456789abcdef);
+
+        const ThreadStackUsage registered = GetUsage(1);
+        TEST_CHECK(registered.stack_size == ThreadStackSize);
+        TEST_CHECK(registered.peak_usage > 0);
+        TEST_CHECK(registered.peak_usage < ThreadStackSize / 2);
+
+        TEST_CHECK(UseStack(FrameDepth) == FrameDepth * (FrameDepth + 1) / 2);
+        const ThreadStackUsage used = GetUsage(1);
+        TEST_CHECK(used.peak_usage >= registered.peak_usage + FrameDepth * FrameSize);
+        TEST_CHECK(used.peak_usage < ThreadStackSize);
+
+        return nullptr;
+    }
+
+    // A thread registering itself while running, as the main thread does, only has the part below its frame filled
+    void TestRunningStack() {
+        pthread_attr_t attr;
+        pthread_attr_init(&attr);
+        pthread_attr_setstack(&attr, g_running_stack, sizeof(g_running_stack));
+
+        pthread_t thread;
+        TEST_REQUIRE(pthread_create(&thread, &attr, RunningThreadMain, nullptr) == 0);
+        pthread_join(thread, nullptr);
+        pthread_attr_destroy(&attr);
+    }
+
+}
+
+int main() {
+    TestIdleStack();
+    TestRunningStack();
+
+    return mc::test::Finish("thread_stacks");
+}
@@ -0,0 +1,250 @@
+/*
+ * Copyright (c) 2020-2025 ndeadly
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "test_common.hpp"
+#include "host_stubs.hpp"
+#include "controllers/virtual_spi_flash.hpp"
+
+namespace {
+
+    using namespace ams;
+    using namespace ams::controller;
+
+    constexpr const char *Directory = "/config/MissionControl/controllers/001122334455";
+    constexpr const char *JournalPath = "/config/MissionControl/controllers/001122334455/spi_flash.journal";
+
+    // On-disk journal layout, kept separate from the one in virtual_spi_flash.cpp so a change to it shows up here
+    constexpr u32 JournalMagic = util::FourCC<'S','P','I','J'>::Code;
+
+    struct JournalHeader {
+        u32 magic;
+        u16 erased_sectors;
+        u16 page_count;
+        u32 crc;
+    };
+
+    struct JournalEntry {
+        u32 offset;
+        u8 data[VirtualSpiFlash::PageSize];
+    };
+
+    // Pages written by hid: pairing info and the user calibration
+    constexpr int PairingPage = 0x2000;
+    constexpr int UserCalibrationPage = 0x8000;
+
+    std::string GetSectorPath(int offset) {
+        char path[0x80];
+        std::snprintf(path, sizeof(path), "%s/spi_flash_%04x.bin", Directory, offset);
+        return path;
+    }
+
+    JournalEntry MakeEntry(int offset, u8 fill) {
+        JournalEntry entry = { static_cast<u32>(offset), {} };
+        std::memset(entry.data, fill, sizeof(entry.data));
+        return entry;
+    }
+
+    // Writes a complete journal, as left behind by a write-back that was interrupted before reaching the overlay
+    void WriteJournal(u16 erased_sectors, std::initializer_list<JournalEntry> entries) {
+        JournalHeader header = {
+            .magic = JournalMagic,
+            .erased_sectors = erased_sectors,
+            .page_count = static_cast<u16>(entries.size()),
+            .crc = crc32Calculate(&erased_sectors, sizeof(erased_sectors))
+        };
+
+        std::vector<u8> journal(sizeof(header));
+        for (auto &entry : entries) {
+            header.crc = crc32CalculateWithSeed(header.crc, &entry, sizeof(entry));
+            auto bytes = reinterpret_cast<const u8 *>(&entry);
+            journal.insert(journal.end(), bytes, bytes + sizeof(entry));
+        }
+        std::memcpy(journal.data(), &header, sizeof(header));
+
+        TEST_REQUIRE(fs::CreateFile(JournalPath, 0).IsSuccess());
+        *mc::test::GetFile(JournalPath) = journal;
+    }
+
+    void WriteOverlaySector(int offset, u8 fill) {
+        TEST_REQUIRE(fs::CreateFile(GetSectorPath(offset).c_str(), VirtualSpiFlash::SectorSize).IsSuccess());
+        std::fill_n(mc::test::GetFile(GetSectorPath(offset).c_str())->data(), VirtualSpiFlash::SectorSize, fill);
+    }
+
+    bool PageEquals(VirtualSpiFlash *flash, int offset, u8 value) {
+        u8 data[VirtualSpiFlash::PageSize];
+        if (flash->Read(offset, data, sizeof(data)).IsFailure()) {
+            return false;
+        }
+
+        return std::all_of(std::begin(data), std::end(data), [=](u8 b) { return b == value; });
+    }
+
+    bool IsJournalRetired() {
+        JournalHeader header;
+        std::memcpy(&header, mc::test::GetFile(JournalPath)->data(), sizeof(header));
+        return header.magic != JournalMagic;
+    }
+
+    void TestJournalReplay() {
+        mc::test::DeleteAllFiles();
+        WriteOverlaySector(PairingPage, 0x11);
+        WriteJournal(BIT(PairingPage / VirtualSpiFlash::SectorSize), { MakeEntry(UserCalibrationPage, 0x5a), MakeEntry(UserCalibrationPage + 0x100, 0xa5) });
+
+        VirtualSpiFlash flash;
+        TEST_REQUIRE(flash.Initialize(Directory).IsSuccess());
+
+        TEST_CHECK(PageEquals(&flash, PairingPage, 0xff));
+        TEST_CHECK(PageEquals(&flash, UserCalibrationPage, 0x5a));
+        TEST_CHECK(PageEquals(&flash, UserCalibrationPage + 0x100, 0xa5));
+        TEST_CHECK(IsJournalRetired());
+
+        // Replayed straight into the overlay, not just the cache
+        auto sector = mc::test::GetFile(GetSectorPath(UserCalibrationPage).c_str());
+        TEST_REQUIRE(sector != nullptr);
+        TEST_CHECK((*sector)[0] == 0x5a && (*sector)[0x100] == 0xa5 && (*sector)[0x200] == 0xff);
+    }
+
+    // The header claims more pages than made it to the file
+    void TestTornJournalIsIgnored() {
+        mc::test::DeleteAllFiles();
+        WriteJournal(0, { MakeEntry(UserCalibrationPage, 0x5a), MakeEntry(UserCalibrationPage + 0x100, 0xa5) });
+        mc::test::GetFile(JournalPath)->resize(sizeof(JournalHeader) + sizeof(JournalEntry) + 0x10);
+
+        VirtualSpiFlash flash;
+        TEST_REQUIRE(flash.Initialize(Directory).IsSuccess());
+
+        TEST_CHECK(PageEquals(&flash, UserCalibrationPage, 0xff));
+        TEST_CHECK(PageEquals(&flash, UserCalibrationPage + 0x100, 0xff));
+        TEST_CHECK(mc::test::GetFile(GetSectorPath(UserCalibrationPage).c_str()) == nullptr);
+    }
+
+    // Only part of the header made it to the file
+    void TestTornHeaderIsIgnored() {
+        mc::test::DeleteAllFiles();
+        WriteJournal(BIT(PairingPage / VirtualSpiFlash::SectorSize), { MakeEntry(UserCalibrationPage, 0x5a) });
+        mc::test::GetFile(JournalPath)->resize(sizeof(JournalHeader) / 2);
+        WriteOverlaySector(PairingPage, 0x11);
+
+        VirtualSpiFlash flash;
+        TEST_REQUIRE(flash.Initialize(Directory).IsSuccess());
+
+        TEST_CHECK(PageEquals(&flash, PairingPage, 0x11));
+        TEST_CHECK(PageEquals(&flash, UserCalibrationPage, 0xff));
+    }
+
+    void TestCrcMismatchIsIgnored() {
+        mc::test::DeleteAllFiles();
+        WriteOverlaySector(PairingPage, 0x11);
+        WriteJournal(BIT(PairingPage / VirtualSpiFlash::SectorSize), { MakeEntry(UserCalibrationPage, 0x5a) });
+        mc::test::GetFile(JournalPath)->back() ^= 0x01;
+
+        VirtualSpiFlash flash;
+        TEST_REQUIRE(flash.Initialize(Directory).IsSuccess());
+
+        // Neither the erase nor the page is applied, and the journal isn't replayed again on the next start
+        TEST_CHECK(PageEquals(&flash, PairingPage, 0x11));
+        TEST_CHECK(PageEquals(&flash, UserCalibrationPage, 0xff));
+        TEST_CHECK(IsJournalRetired());
+    }
+
+    // Reading other pages while hid's writes are pending must not write them back on the spot
+    void TestDirtyPagesAreNotEvicted() {
+        mc::test::DeleteAllFiles();
+
+        {
+            VirtualSpiFlash flash;
+            TEST_REQUIRE(flash.Initialize(Directory).IsSuccess());
+
+            u8 data[VirtualSpiFlash::PageSize];
+            std::memset(data, 0x5a, sizeof(data));
+            TEST_REQUIRE(flash.Write(PairingPage, data, sizeof(data)).IsSuccess());
+            TEST_REQUIRE(flash.Write(UserCalibrationPage, data, sizeof(data)).IsSuccess());
+
+            const u32 flushes_before = mc::test::GetFileFlushCount();
+            for (int offset = 0; offset < static_cast<int>(VirtualSpiFlash::Size); offset += 3 * VirtualSpiFlash::PageSize) {
+                TEST_CHECK(flash.Read(offset, data, sizeof(data)).IsSuccess());
+            }
+            TEST_CHECK(mc::test::GetFileFlushCount() == flushes_before);
+            TEST_CHECK(mc::test::GetFile(GetSectorPath(UserCalibrationPage).c_str()) == nullptr);
+
+            TEST_CHECK(PageEquals(&flash, PairingPage, 0x5a));
+            TEST_CHECK(PageEquals(&flash, UserCalibrationPage, 0x5a));
+            TEST_CHECK(PageEquals(&flash, 0x6000 + VirtualSpiFlash::PageSize, 0xff));
+
+            TEST_CHECK(flash.Flush().IsSuccess());
+            TEST_CHECK(mc::test::GetFileFlushCount() != flushes_before);
+        }
+
+        VirtualSpiFlash flash;
+        TEST_REQUIRE(flash.Initialize(Directory).IsSuccess());
+        TEST_CHECK(PageEquals(&flash, PairingPage, 0x5a));
+        TEST_CHECK(PageEquals(&flash, UserCalibrationPage, 0x5a));
+    }
+
+    // Modifying more pages between flushes than the cache holds still keeps every write
+    void TestWritesBeyondCacheAreKept() {
+        mc::test::DeleteAllFiles();
+
+        constexpr int PageCount = 24;
+        {
+            VirtualSpiFlash flash;
+            TEST_REQUIRE(flash.Initialize(Directory).IsSuccess());
+
+            for (int i = 0; i < PageCount; ++i) {
+                u8 data[VirtualSpiFlash::PageSize];
+                std::memset(data, i, sizeof(data));
+                TEST_REQUIRE(flash.Write(0x8000 + i * VirtualSpiFlash::PageSize, data, sizeof(data)).IsSuccess());
+            }
+
+            for (int i = 0; i < PageCount; ++i) {
+                TEST_CHECK(PageEquals(&flash, 0x8000 + i * VirtualSpiFlash::PageSize, i));
+            }
+        }
+
+        VirtualSpiFlash flash;
+        TEST_REQUIRE(flash.Initialize(Directory).IsSuccess());
+        for (int i = 0; i < PageCount; ++i) {
+            TEST_CHECK(PageEquals(&flash, 0x8000 + i * VirtualSpiFlash::PageSize, i));
+        }
+    }
+
+    // An erase that hasn't been written back yet hides the old contents, whether or not the page is cached
+    void TestPendingEraseReadsErased() {
+        mc::test::DeleteAllFiles();
+        WriteOverlaySector(PairingPage, 0x11);
+
+        VirtualSpiFlash flash;
+        TEST_REQUIRE(flash.Initialize(Directory).IsSuccess());
+        TEST_CHECK(PageEquals(&flash, PairingPage, 0x11));
+
+        TEST_REQUIRE(flash.SectorErase(PairingPage).IsSuccess());
+        for (int offset = 0; offset < static_cast<int>(VirtualSpiFlash::SectorSize); offset += VirtualSpiFlash::PageSize) {
+            TEST_CHECK(PageEquals(&flash, PairingPage + offset, 0xff));
+        }
+    }
+
+}
+
+int main() {
+    TestJournalReplay();
+    TestTornJournalIsIgnored();
+    TestTornHeaderIsIgnored();
+    TestCrcMismatchIsIgnored();
+    TestDirtyPagesAreNotEvicted();
+    TestWritesBeyondCacheAreKept();
+    TestPendingEraseReadsErased();
+
+    return mc::test::Finish("virtual_spi_flash");
+}
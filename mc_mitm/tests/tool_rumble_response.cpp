@@ -0,0 +1,138 @@
+/*
+ * Copyright (c) 2020-2025 ndeadly
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "controllers/rumble_response.hpp"
+#include "mcmitm_config.hpp"
+#include <cstdlib>
+#include <cstring>
+#include <strings.h>
+
+// Renders the rumble response the sysmodule would compile for a controller, starting from its built-in defaults with
+// any [rumble <controller>] settings given on the command line applied on top, e.g.
+//
+//   build/tool_rumble_response xbox_one strong_threshold=25 strong_curve=60
+//
+// Prints the motor output for every amplitude step, then the gain for every frequency step, as tab separated columns
+namespace {
+
+    using namespace ams;
+    using namespace ams::controller;
+
+    constexpr const char *ProfileNames[RumbleProfile_Count] = { "dualshock3", "dualshock4", "dualsense", "xbox_one", "wii" };
+
+    int Usage() {
+        std::fprintf(stderr, "usage: tool_rumble_response <dualshock3|dualshock4|dualsense|xbox_one|wii> [response=linear|perceptual] [strong_|weak_<setting>=<value> ...]\n");
+        return EXIT_FAILURE;
+    }
+
+    bool ApplySetting(mitm::RumbleProfileConfig *profile, const char *setting) {
+        const char *equals = std::strchr(setting, '=');
+        if (equals == nullptr) {
+            return false;
+        }
+
+        const std::string name(setting, equals);
+        const char *value = equals + 1;
+
+        if (name == "response") {
+            profile->perceptual = strcasecmp(value, "linear") != 0;
+            return true;
+        }
+
+        mitm::RumbleMotorConfig *motor;
+        std::string field;
+        if (name.starts_with("strong_")) {
+            motor = &profile->strong;
+            field = name.substr(7);
+        } else if (name.starts_with("weak_")) {
+            motor = &profile->weak;
+            field = name.substr(5);
+        } else {
+            return false;
+        }
+
+        const int number = std::atoi(value);
+        if (field == "deadzone") {
+            motor->deadzone = number;
+        } else if (field == "threshold") {
+            motor->threshold = number;
+        } else if (field == "saturation") {
+            motor->saturation = number;
+        } else if (field == "curve") {
+            motor->curve = number;
+        } else if (field == "frequency_rolloff") {
+            motor->frequency_rolloff = number;
+        } else {
+            return false;
+        }
+
+        return true;
+    }
+
+    // Same conversion as the config loader
+    void Compile(const mitm::RumbleMotorConfig *motor, bool perceptual, float center_frequency, u8 output_max, RumbleResponseTable *out) {
+        if (perceptual) {
+            CompileRumbleResponse(motor->deadzone / 100.0f, motor->threshold / 100.0f, motor->saturation / 100.0f, motor->curve / 100.0f, motor->frequency_rolloff / 100.0f, center_frequency, output_max, out);
+        } else {
+            CompileLinearRumbleResponse(center_frequency, output_max, out);
+        }
+    }
+
+}
+
+int main(int argc, char **argv) {
+    if (argc < 2) {
+        return Usage();
+    }
+
+    int profile_index = -1;
+    for (int i = 0; i < RumbleProfile_Count; ++i) {
+        if (strcasecmp(argv[1], ProfileNames[i]) == 0) {
+            profile_index = i;
+        }
+    }
+    if (profile_index < 0) {
+        return Usage();
+    }
+
+    mitm::RumbleProfileConfig profile = mitm::GetGlobalConfig()->rumble[profile_index];
+    for (int i = 2; i < argc; ++i) {
+        if (!ApplySetting(&profile, argv[i])) {
+            std::fprintf(stderr, "unknown setting: %s\n", argv[i]);
+            return Usage();
+        }
+    }
+
+    const u8 output_max = RumbleProfileOutputMax[profile_index];
+    RumbleResponseTable strong, weak;
+    Compile(&profile.strong, profile.perceptual, SwitchRumbleCenterFreqLow,  output_max, &strong);
+    Compile(&profile.weak,   profile.perceptual, SwitchRumbleCenterFreqHigh, output_max, &weak);
+
+    std::printf("# %s, %s response, output max %u\n", ProfileNames[profile_index], profile.perceptual ? "perceptual" : "linear", output_max);
+    std::printf("amplitude\tstrong\tweak\n");
+    for (size_t i = 0; i < RumbleAmplitudeSteps; ++i) {
+        const float amplitude = float(i) / (RumbleAmplitudeSteps - 1);
+        std::printf("%.4f\t%u\t%u\n", amplitude,
+            ApplyRumbleResponse(&strong, amplitude, SwitchRumbleCenterFreqLow),
+            ApplyRumbleResponse(&weak, amplitude, SwitchRumbleCenterFreqHigh));
+    }
+
+    std::printf("\nfrequency_ratio\tstrong_gain\tweak_gain\n");
+    for (size_t i = 0; i < RumbleFrequencySteps; ++i) {
+        std::printf("%.3f\t%.3f\t%.3f\n", float(i) / (1 << RumbleFrequencyShift), strong.frequency_gain[i] / 255.0f, weak.frequency_gain[i] / 255.0f);
+    }
+
+    return EXIT_SUCCESS;
+}